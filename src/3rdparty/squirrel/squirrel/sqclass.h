@@ -54,7 +54,7 @@ public:
 	bool GetAttributes(const SQObjectPtr &key,SQObjectPtr &outval);
 	void Lock() { _locked = true; if(_base) _base->Lock(); }
 	void Release() {
-		if (_hook) { _hook(_typetag,0);}
+		if (_hook) { SQNativeScope ns; _hook(_typetag,0);}
 		sq_delete(this, SQClass);
 	}
 	void Finalize();
@@ -129,7 +129,7 @@ public:
 	void Release() {
 		_uiRef++;
 		try {
-			if (_hook) { _hook(_userpointer,0);}
+			if (_hook) { SQNativeScope ns; _hook(_userpointer,0);}
 		} catch (...) {
 			_uiRef--;
 			if (_uiRef == 0) {
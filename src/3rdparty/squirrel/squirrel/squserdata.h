@@ -22,7 +22,7 @@ struct SQUserData : SQDelegable
 	void Finalize(){SetDelegate(NULL);}
 #endif
 	void Release() {
-		if (_hook) _hook(_val,_size);
+		if (_hook) { SQNativeScope ns; _hook(_val,_size); }
 		SQInteger tsize = _size - 1;
 		this->~SQUserData();
 		SQ_FREE(this, sizeof(SQUserData) + tsize);
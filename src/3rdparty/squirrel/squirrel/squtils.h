@@ -5,6 +5,16 @@
 void *sq_vm_malloc(SQUnsignedInteger size);
 void *sq_vm_realloc(void *p,SQUnsignedInteger oldsize,SQUnsignedInteger size);
 void sq_vm_free(void *p,SQUnsignedInteger size);
+bool sq_vm_set_native(bool native);
+
+/* Marks a scope in which the VM runs native code (or only bytecode), see sq_vm_set_native. */
+struct SQNativeScope
+{
+	SQNativeScope(bool native = true) : _was_native(sq_vm_set_native(native)) {}
+	~SQNativeScope() { sq_vm_set_native(_was_native); }
+private:
+	bool _was_native;
+};
 
 #define sq_new(__ptr,__type) {__ptr=(__type *)sq_vm_malloc(sizeof(__type));new (__ptr) __type;}
 #define sq_delete(__ptr,__type) {__ptr->~__type();sq_vm_free(__ptr,sizeof(__type));}
@@ -696,6 +696,7 @@ bool SQVM::Execute(SQObjectPtr &closure, SQInteger target, SQInteger nargs, SQIn
 	if ((_nnativecalls + 1) > MAX_NATIVE_CALLS) { Raise_Error("Native stack overflow"); return false; }
 	_nnativecalls++;
 	AutoDec ad(&_nnativecalls);
+	SQNativeScope ns(false);
 	SQInteger traps = 0;
 	//temp_reg vars for OP_CALL
 	SQInteger ct_target;
@@ -1184,7 +1185,10 @@ bool SQVM::CallNative(SQNativeClosure *nclosure,SQInteger nargs,SQInteger stackb
 	try {
 		SQBool can_suspend = this->_can_suspend;
 		this->_can_suspend = false;
-		ret = (nclosure->_function)(this);
+		{
+			SQNativeScope ns;
+			ret = (nclosure->_function)(this);
+		}
 		this->_can_suspend = can_suspend;
 	} catch (...) {
 		_nnativecalls--;
@@ -13,10 +13,14 @@
 #include "../company_base.h"
 #include "../company_func.h"
 #include "../network/network.h"
+#include "../network/network_func.h"
 #include "../window_func.h"
 #include "../framerate_type.h"
 #include "../scope_info.h"
 #include "../string_func.h"
+#include "../settings_type.h"
+#include "../worker_thread.h"
+#include "../script/squirrel.hpp"
 #include "ai_scanner.hpp"
 #include "ai_instance.hpp"
 #include "ai_config.hpp"
@@ -76,15 +80,46 @@
 	assert(_settings_game.difficulty.competitor_speed <= 4);
 	if ((AI::frame_counter & ((1 << (4 - _settings_game.difficulty.competitor_speed)) - 1)) != 0) return;
 
+	/* A server only executes the commands of its AIs in a later tick, so while
+	 * they run no AI changes the game state, and their VMs can run concurrently. */
+	std::vector<const Company *> ais;
+	if (_network_server && _settings_client.gui.parallel_ai_scripts && _general_worker_pool.GetWorkerCount() > 0) {
+		for (const Company *c : Company::Iterate()) {
+			if (c->is_ai) ais.push_back(c);
+		}
+	}
+
 	Backup<CompanyID> cur_company(_current_company, FILE_LINE);
-	for (const Company *c : Company::Iterate()) {
-		if (c->is_ai) {
-			SCOPE_INFO_FMT([&], "AI::GameLoop: %i: %s (v%d)\n", (int)c->index, c->ai_info->GetName(), c->ai_info->GetVersion());
-			PerformanceMeasurer framerate((PerformanceElement)(PFE_AI0 + c->index));
-			cur_company.Change(c->index);
-			c->ai_instance->GameLoop();
-		} else {
-			PerformanceMeasurer::SetInactive((PerformanceElement)(PFE_AI0 + c->index));
+	if (ais.size() > 1) {
+		TICK_PROFILE_SCOPE("AI");
+		for (const Company *c : Company::Iterate()) {
+			if (!c->is_ai) PerformanceMeasurer::SetInactive((PerformanceElement)(PFE_AI0 + c->index));
+		}
+
+		/* Queue the commands per company, and append them in company order afterwards,
+		 * so that they are executed in the same order as when the AIs run one by one. */
+		NetworkServerDeferLocalCommands();
+		_general_worker_pool.ParallelFor(ais.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const Company *c = ais[i];
+				SCOPE_INFO_FMT([&], "AI::GameLoop: %i: %s (v%d)\n", (int)c->index, c->ai_info->GetName(), c->ai_info->GetVersion());
+				PerformanceMeasurer framerate((PerformanceElement)(PFE_AI0 + c->index));
+				ScriptConcurrentScope concurrent(c->index);
+				c->ai_instance->GameLoop();
+			}
+		});
+		NetworkServerFlushDeferredLocalCommands();
+	} else {
+		for (const Company *c : Company::Iterate()) {
+			if (c->is_ai) {
+				SCOPE_INFO_FMT([&], "AI::GameLoop: %i: %s (v%d)\n", (int)c->index, c->ai_info->GetName(), c->ai_info->GetVersion());
+				PerformanceMeasurer framerate((PerformanceElement)(PFE_AI0 + c->index));
+				TICK_PROFILE_SCOPE("AI");
+				cur_company.Change(c->index);
+				c->ai_instance->GameLoop();
+			} else {
+				PerformanceMeasurer::SetInactive((PerformanceElement)(PFE_AI0 + c->index));
+			}
 		}
 	}
 	cur_company.Restore();
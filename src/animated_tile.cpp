@@ -9,88 +9,225 @@
 
 #include "stdafx.h"
 #include "core/alloc_func.hpp"
-#include "core/smallvec_type.hpp"
+#include "animated_tile_func.h"
 #include "tile_cmd.h"
 #include "viewport_func.h"
 #include "framerate_type.h"
+#include "date_func.h"
+#include <algorithm>
+#include <unordered_map>
 
 #include "safeguards.h"
 
-/** The table/list with animated tiles. */
-std::vector<TileIndex> _animated_tiles;
+/** Entry of an animated tile in the list of its animation speed. */
+struct AnimatedTileEntry {
+	TileIndex tile; ///< The animated tile.
+	uint32 serial;  ///< Serial number of the entry, the entry is stale when it is not the current one of the tile.
+};
+
+/** Current entry of an animated tile. */
+struct AnimatedTileState {
+	uint32 serial;  ///< Serial number of the current entry.
+	uint8 speed;    ///< Animation speed, i.e.\ the list the current entry is in.
+};
+
+/**
+ * The animated tiles of each animation speed, in the order in which they are animated.
+ * The tiles of animation speed N only have to be animated when the scaled tick counter is a multiple of 1 << N.
+ * Removed and moved tiles leave stale entries behind, which are dropped when the list is animated next,
+ * or earlier when a list holds more stale than current entries.
+ */
+static std::vector<AnimatedTileEntry> _animated_tiles[ANIMATED_TILE_SPEEDS];
+/** The number of stale entries in the list of each animation speed. */
+static uint32 _animated_tile_stale_counts[ANIMATED_TILE_SPEEDS];
+/** The animation speed of which the list is being animated, or #ANIMATED_TILE_SPEEDS; that list is not compacted meanwhile. */
+static uint8 _animated_tile_speed_animating = ANIMATED_TILE_SPEEDS;
+/** The current entry of each animated tile. */
+static std::unordered_map<TileIndex, AnimatedTileState> _animated_tile_states;
+/** Serial number of the next entry. */
+static uint32 _animated_tile_next_serial = 0;
+
+/**
+ * Check whether an entry is the current entry of its tile.
+ * @param entry The entry to check.
+ * @return True if the entry is not stale.
+ */
+static inline bool IsCurrentAnimatedTileEntry(const AnimatedTileEntry &entry)
+{
+	auto it = _animated_tile_states.find(entry.tile);
+	return it != _animated_tile_states.end() && it->second.serial == entry.serial;
+}
+
+/**
+ * Count an entry of the list of an animation speed which became stale.
+ * The list is compacted when it holds more stale than current entries, so lists which are
+ * seldom due do not grow without bounds. This does not change the order of the current entries.
+ * @param speed The animation speed.
+ */
+static void AddStaleAnimatedTileEntry(uint8 speed)
+{
+	std::vector<AnimatedTileEntry> &list = _animated_tiles[speed];
+	if (++_animated_tile_stale_counts[speed] * 2 <= list.size() || speed == _animated_tile_speed_animating) return;
+
+	list.erase(std::remove_if(list.begin(), list.end(), [](const AnimatedTileEntry &entry) { return !IsCurrentAnimatedTileEntry(entry); }), list.end());
+	_animated_tile_stale_counts[speed] = 0;
+}
+
+/**
+ * Append a new entry for a tile to the list of an animation speed, making it the current entry of the tile.
+ * The previous entry of the tile, if any, becomes stale.
+ * @param tile The tile.
+ * @param speed The animation speed.
+ */
+static void AppendAnimatedTileEntry(TileIndex tile, uint8 speed)
+{
+	const uint32 serial = _animated_tile_next_serial++;
+	_animated_tiles[speed].push_back({ tile, serial });
+	auto result = _animated_tile_states.insert({ tile, { serial, speed } });
+	if (!result.second) {
+		const uint8 old_speed = result.first->second.speed;
+		result.first->second = { serial, speed };
+		AddStaleAnimatedTileEntry(old_speed);
+	}
+}
 
 /**
  * Removes the given tile from the animated tile table.
+ * This may be called at any time, including for other tiles while animating a tile.
  * @param tile the tile to remove
  */
 void DeleteAnimatedTile(TileIndex tile)
 {
-	auto to_remove = std::find(_animated_tiles.begin(), _animated_tiles.end(), tile);
-	if (to_remove != _animated_tiles.end()) {
-		/* The order of the remaining elements must stay the same, otherwise the animation loop may miss a tile. */
-		_animated_tiles.erase(to_remove);
-		MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
-	}
+	auto it = _animated_tile_states.find(tile);
+	if (it == _animated_tile_states.end()) return;
+
+	const uint8 speed = it->second.speed;
+	_animated_tile_states.erase(it);
+	AddStaleAnimatedTileEntry(speed);
+	MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 }
 
 /**
  * Add the given tile to the animated tile table (if it does not exist
- * on that table yet). Also increases the size of the table if necessary.
+ * on that table yet). A tile which is already on the table is animated
+ * again from the next tick on, so that a changed animation speed is noticed.
  * @param tile the tile to make animated
  */
 void AddAnimatedTile(TileIndex tile)
 {
 	MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
-	include(_animated_tiles, tile);
+	auto it = _animated_tile_states.find(tile);
+	if (it != _animated_tile_states.end() && it->second.speed == 0) return;
+	AppendAnimatedTileEntry(tile, 0);
+}
+
+/**
+ * Add a tile to the end of the animated tiles of an animation speed, when loading a savegame.
+ * @param tile The tile to make animated.
+ * @param speed The animation speed of the tile.
+ */
+void LoadAnimatedTile(TileIndex tile, uint8 speed)
+{
+	if (_animated_tile_states.find(tile) != _animated_tile_states.end()) return;
+	AppendAnimatedTileEntry(tile, min<uint8>(speed, ANIMATED_TILE_SPEEDS - 1));
+}
+
+/**
+ * Get all animated tiles, in the order in which they are animated.
+ * @param tiles The animated tiles are added to this.
+ * @param speeds If not nullptr, the animation speed of each tile is added to this.
+ */
+void GetAnimatedTiles(std::vector<TileIndex> &tiles, std::vector<uint8> *speeds)
+{
+	for (uint8 speed = 0; speed < ANIMATED_TILE_SPEEDS; speed++) {
+		for (const AnimatedTileEntry &entry : _animated_tiles[speed]) {
+			if (!IsCurrentAnimatedTileEntry(entry)) continue;
+			tiles.push_back(entry.tile);
+			if (speeds != nullptr) speeds->push_back(speed);
+		}
+	}
 }
 
 /**
  * Animate all tiles in the animated tile list, i.e.\ call AnimateTile on them.
+ * Only the tiles of the animation speeds which are due this tick are visited.
  */
 void AnimateAnimatedTiles()
 {
-	extern void AnimateTile_Town(TileIndex tile);
-	extern void AnimateTile_Station(TileIndex tile);
-	extern void AnimateTile_Industry(TileIndex tile);
-	extern void AnimateTile_Object(TileIndex tile);
+	extern uint8 AnimateTile_Town(TileIndex tile);
+	extern uint8 AnimateTile_Station(TileIndex tile);
+	extern uint8 AnimateTile_Industry(TileIndex tile);
+	extern uint8 AnimateTile_Object(TileIndex tile);
 
 	PerformanceAccumulator framerate(PFE_GL_LANDSCAPE);
+	TICK_PROFILE_SCOPE("AnimatedTiles");
+
+	/* Tiles whose animation speed changed; they are moved to their new list once all lists are done,
+	 * so that a tile moved to a list which is still due this tick is not animated twice. */
+	static std::vector<std::pair<AnimatedTileEntry, uint8>> moved;
+
+	for (uint8 speed = 0; speed < ANIMATED_TILE_SPEEDS; speed++) {
+		if ((_scaled_tick_counter & ((1 << speed) - 1)) != 0) break;
 
-	const TileIndex *ti = _animated_tiles.data();
-	while (ti < _animated_tiles.data() + _animated_tiles.size()) {
-		const TileIndex curr = *ti;
-		switch (GetTileType(curr)) {
-			case MP_HOUSE:
-				AnimateTile_Town(curr);
-				break;
+		std::vector<AnimatedTileEntry> &list = _animated_tiles[speed];
+		_animated_tile_speed_animating = speed;
 
-			case MP_STATION:
-				AnimateTile_Station(curr);
-				break;
+		/* Tiles added to this list while it is animated have to wait for the next time it is due. */
+		const size_t count = list.size();
+		size_t kept = 0;
+		for (size_t i = 0; i < count; i++) {
+			const AnimatedTileEntry entry = list[i];
+			if (!IsCurrentAnimatedTileEntry(entry)) {
+				_animated_tile_stale_counts[speed]--;
+				continue;
+			}
 
-			case MP_INDUSTRY:
-				AnimateTile_Industry(curr);
-				break;
+			uint8 new_speed;
+			switch (GetTileType(entry.tile)) {
+				case MP_HOUSE:
+					new_speed = AnimateTile_Town(entry.tile);
+					break;
 
-			case MP_OBJECT:
-				AnimateTile_Object(curr);
-				break;
+				case MP_STATION:
+					new_speed = AnimateTile_Station(entry.tile);
+					break;
 
-			default:
-				NOT_REACHED();
+				case MP_INDUSTRY:
+					new_speed = AnimateTile_Industry(entry.tile);
+					break;
+
+				case MP_OBJECT:
+					new_speed = AnimateTile_Object(entry.tile);
+					break;
+
+				default:
+					NOT_REACHED();
+			}
+
+			/* The tile may have been removed, or added again, while it was animated. */
+			if (!IsCurrentAnimatedTileEntry(entry)) {
+				_animated_tile_stale_counts[speed]--;
+				continue;
+			}
+
+			new_speed = min<uint8>(new_speed, ANIMATED_TILE_SPEEDS - 1);
+			if (new_speed == speed) {
+				list[kept++] = entry;
+			} else {
+				moved.emplace_back(entry, new_speed);
+			}
 		}
+		list.erase(list.begin() + kept, list.begin() + count);
+		_animated_tile_speed_animating = ANIMATED_TILE_SPEEDS;
+	}
 
-		/* During the AnimateTile call, DeleteAnimatedTile could have been called,
-		 * deleting an element we've already processed and pushing the rest one
-		 * slot to the left. We can detect this by checking whether the index
-		 * in the current slot has changed - if it has, an element has been deleted,
-		 * and we should process the current slot again instead of going forward.
-		 * NOTE: this will still break if more than one animated tile is being
-		 *       deleted during the same AnimateTile call, but no code seems to
-		 *       be doing this anyway.
-		 */
-		if (*ti == curr) ++ti;
+	for (const auto &it : moved) {
+		if (!IsCurrentAnimatedTileEntry(it.first)) continue;
+		/* The entry is not in its list anymore, so it does not become stale. */
+		_animated_tile_states.erase(it.first.tile);
+		AppendAnimatedTileEntry(it.first.tile, it.second);
 	}
+	moved.clear();
 }
 
 /**
@@ -98,5 +235,9 @@ void AnimateAnimatedTiles()
  */
 void InitializeAnimatedTiles()
 {
-	_animated_tiles.clear();
+	for (std::vector<AnimatedTileEntry> &list : _animated_tiles) list.clear();
+	_animated_tile_states.clear();
+	_animated_tile_next_serial = 0;
+	std::fill(std::begin(_animated_tile_stale_counts), std::end(_animated_tile_stale_counts), 0);
+	_animated_tile_speed_animating = ANIMATED_TILE_SPEEDS;
 }
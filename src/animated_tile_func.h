@@ -11,10 +11,16 @@
 #define ANIMATED_TILE_FUNC_H
 
 #include "tile_type.h"
+#include <vector>
+
+static const uint8 ANIMATED_TILE_SPEEDS = 17; ///< Number of animation speeds animated tiles are scheduled by, see #AnimateTileProc.
 
 void AddAnimatedTile(TileIndex tile);
 void DeleteAnimatedTile(TileIndex tile);
 void AnimateAnimatedTiles();
 void InitializeAnimatedTiles();
 
+void LoadAnimatedTile(TileIndex tile, uint8 speed);
+void GetAnimatedTiles(std::vector<TileIndex> &tiles, std::vector<uint8> *speeds = nullptr);
+
 #endif /* ANIMATED_TILE_FUNC_H */
@@ -282,6 +282,7 @@ void Blitter_32bppAnim::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomL
 	}
 
 	const BlitterSpriteFlags sprite_flags = ((const SpriteData *) bp->sprite)->flags;
+	this->MarkAnimatedSprite(bp, mode, sprite_flags);
 
 	switch (mode) {
 		default: NOT_REACHED();
@@ -355,7 +356,9 @@ void Blitter_32bppAnim::SetPixel(void *video, int x, int y, uint8 colour)
 
 	/* Set the colour in the anim-buffer too, if we are rendering to the screen */
 	if (_screen_disable_anim) return;
-	this->anim_buf[this->ScreenToAnimOffset((uint32 *)video) + x + y * this->anim_buf_pitch] = colour | (DEFAULT_BRIGHTNESS << 8);
+	const int anim_offset = this->ScreenToAnimOffset((uint32 *)video) + x + y * this->anim_buf_pitch;
+	this->anim_buf[anim_offset] = colour | (DEFAULT_BRIGHTNESS << 8);
+	if (colour >= PALETTE_ANIM_START) this->MarkAnimated(anim_offset, 1, 1);
 }
 
 void Blitter_32bppAnim::DrawLine(void *video, int x, int y, int x2, int y2, int screen_width, int screen_height, uint8 colour, int width, int dash)
@@ -367,11 +370,14 @@ void Blitter_32bppAnim::DrawLine(void *video, int x, int y, int x2, int y2, int
 			*((Colour *)video + x + y * _screen.pitch) = c;
 		});
 	} else {
-		uint16 * const offset_anim_buf = this->anim_buf + this->ScreenToAnimOffset((uint32 *)video);
+		const int anim_offset = this->ScreenToAnimOffset((uint32 *)video);
+		uint16 * const offset_anim_buf = this->anim_buf + anim_offset;
 		const uint16 anim_colour = colour | (DEFAULT_BRIGHTNESS << 8);
+		const bool animated = colour >= PALETTE_ANIM_START;
 		this->DrawLineGeneric(x, y, x2, y2, screen_width, screen_height, width, dash, [&](int x, int y) {
 			*((Colour *)video + x + y * _screen.pitch) = c;
 			offset_anim_buf[x + y * this->anim_buf_pitch] = anim_colour;
+			if (animated) this->MarkAnimated(anim_offset + x + y * this->anim_buf_pitch, 1, 1);
 		});
 	}
 }
@@ -387,14 +393,18 @@ void Blitter_32bppAnim::SetLine(void *video, int x, int y, uint8 *colours, uint
 			colours++;
 		} while (--width);
 	} else {
-		uint16 *dstanim = (uint16 *)(&this->anim_buf[this->ScreenToAnimOffset((uint32 *)video) + x + y * this->anim_buf_pitch]);
-		do {
+		const int anim_offset = this->ScreenToAnimOffset((uint32 *)video) + x + y * this->anim_buf_pitch;
+		uint16 *dstanim = &this->anim_buf[anim_offset];
+		bool animated = false;
+		for (uint i = 0; i < width; i++) {
 			*dstanim = *colours | (DEFAULT_BRIGHTNESS << 8);
 			*dst = LookupColourInPalette(*colours);
+			if (*colours >= PALETTE_ANIM_START) animated = true;
 			dst++;
 			dstanim++;
 			colours++;
-		} while (--width);
+		}
+		if (animated) this->MarkAnimated(anim_offset, width, 1);
 	}
 }
 
@@ -429,7 +439,9 @@ void Blitter_32bppAnim::DrawRect(void *video, int width, int height, uint8 colou
 	}
 
 	Colour colour32 = LookupColourInPalette(colour);
-	uint16 *anim_line = this->ScreenToAnimOffset((uint32 *)video) + this->anim_buf;
+	const int anim_offset = this->ScreenToAnimOffset((uint32 *)video);
+	uint16 *anim_line = anim_offset + this->anim_buf;
+	if (colour >= PALETTE_ANIM_START) this->MarkAnimated(anim_offset, width, height);
 
 	do {
 		Colour *dst = (Colour *)video;
@@ -453,9 +465,10 @@ void Blitter_32bppAnim::CopyFromBuffer(void *video, const void *src, int width,
 	assert(video >= _screen.dst_ptr && video <= (uint32 *)_screen.dst_ptr + _screen.width + _screen.height * _screen.pitch);
 	Colour *dst = (Colour *)video;
 	const uint32 *usrc = (const uint32 *)src;
-	uint16 *anim_line = this->ScreenToAnimOffset((uint32 *)video) + this->anim_buf;
+	int anim_offset = this->ScreenToAnimOffset((uint32 *)video);
+	uint16 *anim_line = anim_offset + this->anim_buf;
 
-	for (; height > 0; height--) {
+	for (; height > 0; height--, anim_offset += this->anim_buf_pitch) {
 		/* We need to keep those for palette animation. */
 		Colour *dst_pal = dst;
 		uint16 *anim_pal = anim_line;
@@ -475,15 +488,20 @@ void Blitter_32bppAnim::CopyFromBuffer(void *video, const void *src, int width,
 		 * however that forces a full screen redraw which is expensive
 		 * for just the cursor. This just copies the implementation of
 		 * palette animation, much cheaper though slightly nastier. */
+		int left = width;
+		int right = 0;
 		for (int i = 0; i < width; i++) {
 			uint colour = GB(*anim_pal, 0, 8);
 			if (colour >= PALETTE_ANIM_START) {
 				/* Update this pixel */
 				*dst_pal = this->AdjustBrightness(LookupColourInPalette(colour), GB(*anim_pal, 8, 8));
+				left = min(left, i);
+				right = i + 1;
 			}
 			dst_pal++;
 			anim_pal++;
 		}
+		if (left < right) this->MarkAnimated(anim_offset + left, right - left, 1);
 	}
 }
 
@@ -557,6 +575,16 @@ void Blitter_32bppAnim::ScrollBuffer(void *video, int &left, int &top, int &widt
 		}
 	}
 
+	/* Move the animated spans along. The lines that are scrolled onto keep their own span too,
+	 * as the parts of them outside the scrolled area did not change. */
+	const std::vector<AnimatedSpan> spans(this->anim_spans.begin() + top, this->anim_spans.begin() + top + height);
+	for (int y = max(top, top + scroll_y); y < min(top + height, top + height + scroll_y); y++) {
+		const AnimatedSpan &src_span = spans[y - scroll_y - top];
+		const int span_left = max(left, src_span.left + scroll_x);
+		const int span_right = min(left + width, src_span.right + scroll_x);
+		if (span_left < span_right) this->MarkAnimated(y * this->anim_buf_pitch + span_left, span_right - span_left, 1);
+	}
+
 	Blitter_32bppBase::ScrollBuffer(video, left, top, width, height, scroll_x, scroll_y);
 }
 
@@ -575,30 +603,69 @@ void Blitter_32bppAnim::PaletteAnimate(const Palette &palette)
 	 *  Especially when going between toyland and non-toyland. */
 	assert(this->palette.first_dirty == PALETTE_ANIM_START || this->palette.first_dirty == 0);
 
-	const uint16 *anim = this->anim_buf;
-	Colour *dst = (Colour *)_screen.dst_ptr;
+	AnimatedDirtyRect dirty;
+
+	/* Only walk the parts of the lines which may contain animated pixels, and shrink them to the pixels that are found */
+	for (int y = 0; y < this->anim_buf_height; y++) {
+		AnimatedSpan &span = this->anim_spans[y];
+		if (span.left >= span.right) continue;
 
-	/* Let's walk the anim buffer and try to find the pixels */
-	const int width = this->anim_buf_width;
-	const int pitch_offset = _screen.pitch - width;
-	const int anim_pitch_offset = this->anim_buf_pitch - width;
-	for (int y = this->anim_buf_height; y != 0 ; y--) {
-		for (int x = width; x != 0 ; x--) {
-			uint16 value = *anim;
+		const uint16 *anim = this->anim_buf + y * this->anim_buf_pitch;
+		Colour *dst = (Colour *)_screen.dst_ptr + y * _screen.pitch;
+		int left = this->anim_buf_width;
+		int right = 0;
+		for (int x = span.left; x < span.right; x++) {
+			uint16 value = anim[x];
 			uint8 colour = GB(value, 0, 8);
 			if (colour >= PALETTE_ANIM_START) {
 				/* Update this pixel */
-				*dst = this->AdjustBrightness(LookupColourInPalette(colour), GB(value, 8, 8));
+				dst[x] = this->AdjustBrightness(LookupColourInPalette(colour), GB(value, 8, 8));
+				left = min(left, x);
+				right = x + 1;
 			}
-			dst++;
-			anim++;
 		}
-		dst += pitch_offset;
-		anim += anim_pitch_offset;
+		span.left = left;
+		span.right = right;
+		dirty.AddLine(y, left, right);
 	}
 
-	/* Make sure the backend redraws the whole screen */
-	VideoDriver::GetInstance()->MakeDirty(0, 0, _screen.width, _screen.height);
+	/* Make sure the backend redraws the animated pixels */
+	dirty.Flush();
+}
+
+/**
+ * Add the part of a line which was changed by palette animation to the rectangle.
+ * A rectangle which is too far away from the line is passed to the video driver first.
+ * @param y The line.
+ * @param left First changed column.
+ * @param right One past the last changed column, not greater than \a left if nothing changed.
+ */
+void Blitter_32bppAnim::AnimatedDirtyRect::AddLine(int y, int left, int right)
+{
+	/* Number of unchanged lines a rectangle may span, to not pass too many small rectangles to the video driver. */
+	static const int MAX_GAP = 8;
+
+	if (left >= right) return;
+
+	if (this->bottom != this->top && y > this->bottom + MAX_GAP) this->Flush();
+
+	if (this->bottom == this->top) {
+		this->left = left;
+		this->top = y;
+		this->right = right;
+	} else {
+		this->left = min(this->left, left);
+		this->right = max(this->right, right);
+	}
+	this->bottom = y + 1;
+}
+
+/** Pass the rectangle to the video driver, if it is not empty, and empty it. */
+void Blitter_32bppAnim::AnimatedDirtyRect::Flush()
+{
+	if (this->bottom == this->top) return;
+	VideoDriver::GetInstance()->MakeDirty(this->left, this->top, this->right - this->left, this->bottom - this->top);
+	this->bottom = this->top;
 }
 
 Blitter::PaletteAnimation Blitter_32bppAnim::UsePaletteAnimation()
@@ -618,5 +685,8 @@ void Blitter_32bppAnim::PostResize()
 
 		/* align buffer to next 16 byte boundary */
 		this->anim_buf = reinterpret_cast<uint16 *>((reinterpret_cast<uintptr_t>(this->anim_alloc) + 0xF) & (~0xF));
+
+		/* The buffer is empty, so no line contains animated pixels */
+		this->anim_spans.assign(this->anim_buf_height, { this->anim_buf_width, 0 });
 	}
 }
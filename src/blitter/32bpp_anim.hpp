@@ -11,6 +11,7 @@
 #define BLITTER_32BPP_ANIM_HPP
 
 #include "32bpp_optimized.hpp"
+#include <vector>
 
 /** The optimised 32 bpp blitter with palette animation. */
 class Blitter_32bppAnim : public Blitter_32bppOptimized {
@@ -22,6 +23,66 @@ protected:
 	int anim_buf_height; ///< The height of the animation buffer.
 	Palette palette;     ///< The current palette.
 
+	/** Columns of a line of the animation buffer which may contain palette animated pixels. */
+	struct AnimatedSpan {
+		int left;  ///< First column which may contain an animated pixel.
+		int right; ///< One past the last column which may contain an animated pixel; the span is empty when this is not greater than #left.
+	};
+	std::vector<AnimatedSpan> anim_spans; ///< For each line of the animation buffer, the columns which may contain animated pixels.
+
+	/** Rectangle of lines changed by palette animation, which is passed to the video driver in one go. */
+	struct AnimatedDirtyRect {
+		int left = 0;   ///< Left edge of the rectangle.
+		int top = 0;    ///< Top edge of the rectangle.
+		int right = 0;  ///< Right edge of the rectangle.
+		int bottom = 0; ///< Bottom edge of the rectangle, the rectangle is empty when this equals #top.
+
+		void AddLine(int y, int left, int right);
+		void Flush();
+	};
+
+	/**
+	 * Note that a rectangle of the animation buffer may contain palette animated pixels.
+	 * @param anim_offset Offset in the animation buffer of the top left pixel of the rectangle.
+	 * @param width Width of the rectangle.
+	 * @param height Height of the rectangle.
+	 */
+	inline void MarkAnimated(int anim_offset, int width, int height)
+	{
+		const int left = anim_offset % this->anim_buf_pitch;
+		const int right = left + width;
+		AnimatedSpan *span = this->anim_spans.data() + anim_offset / this->anim_buf_pitch;
+		for (; height > 0; height--, span++) {
+			span->left = min(span->left, left);
+			span->right = max(span->right, right);
+		}
+	}
+
+	/**
+	 * Note the pixels of a sprite which is drawn, if it may contain palette animated pixels.
+	 * @param bp The parameters of the sprite.
+	 * @param mode The mode the sprite is drawn with.
+	 * @param sprite_flags The flags of the sprite.
+	 */
+	inline void MarkAnimatedSprite(const Blitter::BlitterParams *bp, BlitterMode mode, BlitterSpriteFlags sprite_flags)
+	{
+		switch (mode) {
+			case BM_NORMAL:
+				if (sprite_flags & SF_NO_ANIM) return;
+				break;
+
+			case BM_COLOUR_REMAP:
+			case BM_CRASH_REMAP:
+				/* The remap may result in animated colours */
+				if (sprite_flags & SF_NO_REMAP) return;
+				break;
+
+			default:
+				return;
+		}
+		this->MarkAnimated(this->ScreenToAnimOffset((uint32 *)bp->dst) + bp->top * this->anim_buf_pitch + bp->left, bp->width, bp->height);
+	}
+
 public:
 	Blitter_32bppAnim() :
 		anim_buf(nullptr),
@@ -0,0 +1,22 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_anim_avx512.cpp Implementation of the AVX-512 32 bpp blitter with animation support. */
+
+#ifdef WITH_SSE
+
+#include "../stdafx.h"
+#include "../video/video_driver.hpp"
+#include "32bpp_anim_avx512.hpp"
+#include "32bpp_avx_func.hpp"
+
+#include "../safeguards.h"
+
+/** Instantiation of the AVX-512 32bpp blitter with animation factory. */
+static FBlitter_32bppAVX512_Anim iFBlitter_32bppAVX512_Anim;
+
+#endif /* WITH_SSE */
@@ -29,23 +29,24 @@ void Blitter_32bppSSE2_Anim::PaletteAnimate(const Palette &palette)
 	 *  Especially when going between toyland and non-toyland. */
 	assert(this->palette.first_dirty == PALETTE_ANIM_START || this->palette.first_dirty == 0);
 
-	const uint16 *anim = this->anim_buf;
-	Colour *dst = (Colour *)_screen.dst_ptr;
+	AnimatedDirtyRect dirty;
 
-	bool screen_dirty = false;
-
-	/* Let's walk the anim buffer and try to find the pixels */
+	/* Only walk the parts of the lines which may contain animated pixels, and shrink them to the pixels that are found */
 	const int width = this->anim_buf_width;
-	const int screen_pitch = _screen.pitch;
-	const int anim_pitch = this->anim_buf_pitch;
 	__m128i anim_cmp = _mm_set1_epi16(PALETTE_ANIM_START - 1);
 	__m128i brightness_cmp = _mm_set1_epi16(Blitter_32bppBase::DEFAULT_BRIGHTNESS);
 	__m128i colour_mask = _mm_set1_epi16(0xFF);
-	for (int y = this->anim_buf_height; y != 0 ; y--) {
-		Colour *next_dst_ln = dst + screen_pitch;
-		const uint16 *next_anim_ln = anim + anim_pitch;
-		int x = width;
-		while (x > 0) {
+	for (int y = 0; y < this->anim_buf_height; y++) {
+		AnimatedSpan &span = this->anim_spans[y];
+		if (span.left >= span.right) continue;
+
+		/* The lines of the anim buffer are aligned to 8 pixels */
+		int x = span.left & ~7;
+		const uint16 *anim = this->anim_buf + y * this->anim_buf_pitch + x;
+		Colour *dst = (Colour *)_screen.dst_ptr + y * _screen.pitch + x;
+		int left = width;
+		int right = 0;
+		for (; x < span.right; x += 8) {
 			__m128i data = _mm_load_si128((const __m128i *) anim);
 
 			/* low bytes only, shifted into high positions */
@@ -55,20 +56,22 @@ void Blitter_32bppSSE2_Anim::PaletteAnimate(const Palette &palette)
 			int colour_cmp_result = _mm_movemask_epi8(_mm_cmpgt_epi16(colour_data, anim_cmp));
 			if (unlikely(colour_cmp_result)) {
 				/* test if any brightness is unexpected */
-				if (unlikely(x < 8 || colour_cmp_result != 0xFFFF ||
+				if (unlikely(width - x < 8 || colour_cmp_result != 0xFFFF ||
 						_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_srli_epi16(data, 8), brightness_cmp)) != 0xFFFF)) {
 					/* slow path: < 8 pixels left or unexpected brightnesses */
-					for (int z = min<int>(x, 8); z != 0 ; z--) {
+					for (int z = 0; z < min<int>(width - x, 8); z++) {
 						int value = _mm_extract_epi16(data, 0);
 						uint8 colour = GB(value, 0, 8);
 						if (colour >= PALETTE_ANIM_START) {
 							/* Update this pixel */
 							*dst = AdjustBrightneSSE(LookupColourInPalette(colour), GB(value, 8, 8));
-							screen_dirty = true;
+							left = min(left, x + z);
+							right = x + z + 1;
 						}
 						data = _mm_srli_si128(data, 2);
 						dst++;
 					}
+					dst += 8 - min<int>(width - x, 8);
 				} else {
 					/* medium path: 8 pixels to animate all of expected brightnesses */
 					for (int z = 0; z < 8; z++) {
@@ -76,23 +79,22 @@ void Blitter_32bppSSE2_Anim::PaletteAnimate(const Palette &palette)
 						colour_data = _mm_srli_si128(colour_data, 2);
 						dst++;
 					}
-					screen_dirty = true;
+					left = min(left, x);
+					right = x + 8;
 				}
 			} else {
 				/* fast path, no animation */
 				dst += 8;
 			}
 			anim += 8;
-			x -= 8;
 		}
-		dst = next_dst_ln;
-		anim = next_anim_ln;
+		span.left = left;
+		span.right = right;
+		dirty.AddLine(y, left, right);
 	}
 
-	if (screen_dirty) {
-		/* Make sure the backend redraws the whole screen */
-		VideoDriver::GetInstance()->MakeDirty(0, 0, _screen.width, _screen.height);
-	}
+	/* Make sure the backend redraws the animated pixels */
+	dirty.Flush();
 }
 
 #endif /* WITH_SSE */
@@ -0,0 +1,45 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_avx512.hpp AVX-512 32 bpp blitter. */
+
+#ifndef BLITTER_32BPP_AVX512_HPP
+#define BLITTER_32BPP_AVX512_HPP
+
+#ifdef WITH_SSE
+
+#ifndef SSE_VERSION
+#define SSE_VERSION 4
+#endif
+
+#ifndef AVX_VERSION
+#define AVX_VERSION 512
+#endif
+
+#ifndef FULL_ANIMATION
+#define FULL_ANIMATION 0
+#endif
+
+#include "32bpp_avx2.hpp"
+
+/** The AVX-512 32 bpp blitter (without palette animation). */
+class Blitter_32bppAVX512 : public Blitter_32bppAVX2 {
+public:
+	void Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom) override;
+	void DrawColourMappingRect(void *dst, int width, int height, PaletteID pal) override;
+	const char *GetName() override { return "32bpp-avx512"; }
+};
+
+/** Factory for the AVX-512 32 bpp blitter (without palette animation). */
+class FBlitter_32bppAVX512: public BlitterFactory {
+public:
+	FBlitter_32bppAVX512() : BlitterFactory("32bpp-avx512", "32bpp AVX-512 Blitter (no palette animation)", HasCPUAVX512Support()) {}
+	Blitter *CreateInstance() override { return new Blitter_32bppAVX512(); }
+};
+
+#endif /* WITH_SSE */
+#endif /* BLITTER_32BPP_AVX512_HPP */
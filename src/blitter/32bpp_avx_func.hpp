@@ -0,0 +1,684 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_avx_func.hpp Functions related to AVX2 and AVX-512 32 bpp blitters. */
+
+#ifndef BLITTER_32BPP_AVX_FUNC_HPP
+#define BLITTER_32BPP_AVX_FUNC_HPP
+
+#ifdef WITH_SSE
+
+#include <immintrin.h>
+#include "../table/sprites.h"
+
+#if (AVX_VERSION == 512) && defined(__GNUC__) && !defined(__clang__)
+/* GCC warns about the undefined unused lanes with which its own AVX-512 intrinsics are implemented. */
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+/*
+ * The AVX blitters use the sprite format of the SSE blitters, but process a whole vector of pixels at once:
+ * 8 pixels for AVX2 and 16 pixels for AVX-512. The last pixels of a line are processed with masked loads and stores.
+ * The arithmetic is the one of the SSE4 blitter, so both blitters draw the same colours.
+ */
+#if (AVX_VERSION == 512)
+typedef __m512i avx_vec;  ///< A vector of pixels, or of other 32 bits values for each pixel.
+typedef __mmask16 avx_mask; ///< Selection of pixels of a vector.
+#define AVX_PIXELS 16
+#define AVX_OP(op) _mm512_##op
+#define AVX_SI(op) _mm512_##op##_si512
+#define AVX_SET1_EPI64(x) _mm512_set1_epi64(x)
+#define AVX_BROADCAST128(x) _mm512_broadcast_i32x4(x)
+#define AVX_PERM(x) ((_MM_PERM_ENUM) (x))
+#else
+typedef __m256i avx_vec;  ///< A vector of pixels, or of other 32 bits values for each pixel.
+typedef __m256i avx_mask; ///< Selection of pixels of a vector.
+#define AVX_PIXELS 8
+#define AVX_OP(op) _mm256_##op
+#define AVX_SI(op) _mm256_##op##_si256
+#define AVX_SET1_EPI64(x) _mm256_set1_epi64x(x)
+#define AVX_BROADCAST128(x) _mm256_broadcastsi128_si256(x)
+#define AVX_PERM(x) (x)
+#endif
+
+/*
+ * Only the drawing functions are compiled for the AVX instruction sets. The rest of the blitter, like its factory
+ * and the inline functions it shares with other blitters, must run on any CPU, as it runs before the CPU is checked.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#if (AVX_VERSION == 512)
+#define AVX_TARGET __attribute__((target("avx2,avx512f,avx512bw,avx512vl")))
+#else
+#define AVX_TARGET __attribute__((target("avx2")))
+#endif
+#else
+#define AVX_TARGET
+#endif
+
+/**
+ * Get the selection of the first pixels of a vector.
+ * @param count The number of pixels to select, at least 1.
+ * @return The selection.
+ */
+AVX_TARGET static inline avx_mask AVXMaskFirst(int count)
+{
+#if (AVX_VERSION == 512)
+	return count >= AVX_PIXELS ? (avx_mask) 0xFFFF : (avx_mask) ((1 << count) - 1);
+#else
+	return _mm256_cmpgt_epi32(_mm256_set1_epi32(count), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+#endif
+}
+
+AVX_TARGET static inline bool AVXMaskNone(avx_mask mask)
+{
+#if (AVX_VERSION == 512)
+	return mask == 0;
+#else
+	return _mm256_testz_si256(mask, mask) != 0;
+#endif
+}
+
+AVX_TARGET static inline bool AVXMaskAll(avx_mask mask)
+{
+#if (AVX_VERSION == 512)
+	return mask == 0xFFFF;
+#else
+	return _mm256_movemask_epi8(mask) == -1;
+#endif
+}
+
+AVX_TARGET static inline avx_mask AVXMaskEqual(avx_vec a, avx_vec b)
+{
+#if (AVX_VERSION == 512)
+	return _mm512_cmpeq_epi32_mask(a, b);
+#else
+	return _mm256_cmpeq_epi32(a, b);
+#endif
+}
+
+/** Select the pixels with a value greater than another one; only for values up to INT32_MAX. */
+AVX_TARGET static inline avx_mask AVXMaskGreater(avx_vec a, avx_vec b)
+{
+#if (AVX_VERSION == 512)
+	return _mm512_cmpgt_epi32_mask(a, b);
+#else
+	return _mm256_cmpgt_epi32(a, b);
+#endif
+}
+
+/** Select the pixels which are not fully transparent. */
+AVX_TARGET static inline avx_mask AVXMaskAlphaNonZero(avx_vec pixels)
+{
+	return AVXMaskGreater(AVX_OP(srli_epi32)(pixels, 24), AVX_SI(setzero)());
+}
+
+/** Select the pixels which are fully opaque. */
+AVX_TARGET static inline avx_mask AVXMaskAlphaFull(avx_vec pixels)
+{
+	return AVXMaskEqual(AVX_OP(srli_epi32)(pixels, 24), AVX_OP(set1_epi32)(0xFF));
+}
+
+/** Per pixel: selected ? a : b. */
+AVX_TARGET static inline avx_vec AVXSelect(avx_mask mask, avx_vec a, avx_vec b)
+{
+#if (AVX_VERSION == 512)
+	return _mm512_mask_blend_epi32(mask, b, a);
+#else
+	return _mm256_blendv_epi8(b, a, mask);
+#endif
+}
+
+/**
+ * Load the pixels of a vector, or only the remaining pixels of a line.
+ * @param src The pixels.
+ * @param remaining The number of remaining pixels of the line.
+ * @return The pixels; the ones after the end of the line are zero, i.e.\ fully transparent.
+ */
+AVX_TARGET static inline avx_vec AVXLoadPixels(const Colour *src, int remaining)
+{
+#if (AVX_VERSION == 512)
+	if (likely(remaining >= AVX_PIXELS)) return _mm512_loadu_si512(src);
+	return _mm512_maskz_loadu_epi32(AVXMaskFirst(remaining), src);
+#else
+	if (likely(remaining >= AVX_PIXELS)) return _mm256_loadu_si256((const __m256i *) src);
+	return _mm256_maskload_epi32((const int *) src, AVXMaskFirst(remaining));
+#endif
+}
+
+/**
+ * Store the pixels of a vector, or only the remaining pixels of a line.
+ * @param dst The destination.
+ * @param pixels The pixels.
+ * @param remaining The number of remaining pixels of the line.
+ */
+AVX_TARGET static inline void AVXStorePixels(Colour *dst, avx_vec pixels, int remaining)
+{
+#if (AVX_VERSION == 512)
+	if (likely(remaining >= AVX_PIXELS)) {
+		_mm512_storeu_si512(dst, pixels);
+	} else {
+		_mm512_mask_storeu_epi32(dst, AVXMaskFirst(remaining), pixels);
+	}
+#else
+	if (likely(remaining >= AVX_PIXELS)) {
+		_mm256_storeu_si256((__m256i *) dst, pixels);
+	} else {
+		_mm256_maskstore_epi32((int *) dst, AVXMaskFirst(remaining), pixels);
+	}
+#endif
+}
+
+/**
+ * Load the map values of a vector of pixels, or only of the remaining pixels of a line.
+ * @param src The map values.
+ * @param remaining The number of remaining pixels of the line.
+ * @return For each pixel m | v << 8; zero after the end of the line.
+ */
+AVX_TARGET static inline avx_vec AVXLoadMapValues(const Blitter_32bppSSE_Base::MapValue *src, int remaining)
+{
+#if (AVX_VERSION == 512)
+	if (likely(remaining >= AVX_PIXELS)) return _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *) src));
+	return _mm512_cvtepu16_epi32(_mm256_maskz_loadu_epi16(AVXMaskFirst(remaining), src));
+#else
+	if (likely(remaining >= AVX_PIXELS)) return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) src));
+	uint16 values[AVX_PIXELS] = {};
+	memcpy(values, src, remaining * sizeof(*src));
+	return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) values));
+#endif
+}
+
+/**
+ * Store the selected 16 bits values in the animation buffer.
+ * @param anim The animation buffer.
+ * @param values For each pixel the value, in the low 16 bits.
+ * @param mask The pixels to store the value of.
+ * @param remaining The number of remaining pixels of the line.
+ */
+AVX_TARGET static inline void AVXStoreAnim(uint16 *anim, avx_vec values, avx_mask mask, int remaining)
+{
+#if (AVX_VERSION == 512)
+	_mm256_mask_storeu_epi16(anim, mask & AVXMaskFirst(remaining), _mm512_cvtepi32_epi16(values));
+#else
+	if (likely(remaining >= AVX_PIXELS)) {
+		/* Pack the 32 bits values and selections to 16 bits; packing works per 128 bits lane, so gather the low halves of both lanes afterwards. */
+		__m128i packed = _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(values, values), 0x08));
+		__m128i packed_mask = _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packs_epi32(mask, mask), 0x08));
+		__m128i old = _mm_loadu_si128((const __m128i *) anim);
+		_mm_storeu_si128((__m128i *) anim, _mm_blendv_epi8(old, packed, packed_mask));
+	} else {
+		uint32 value[AVX_PIXELS];
+		_mm256_storeu_si256((__m256i *) value, values);
+		const uint bits = _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+		for (int i = 0; i < remaining; i++) {
+			if (HasBit(bits, i)) anim[i] = value[i];
+		}
+	}
+#endif
+}
+
+/**
+ * Look up the remapped colour indices of a vector of pixels.
+ * @param remap The remap table.
+ * @param src The map values.
+ * @param remaining The number of remaining pixels of the line.
+ * @return For each pixel remap[m]; zero after the end of the line.
+ */
+AVX_TARGET static inline avx_vec AVXLookupRemap(const byte *remap, const Blitter_32bppSSE_Base::MapValue *src, int remaining)
+{
+	uint32 indices[AVX_PIXELS];
+	const int count = min(remaining, AVX_PIXELS);
+	for (int i = 0; i < AVX_PIXELS; i++) indices[i] = i < count ? remap[src[i].m] : 0;
+	return AVX_SI(loadu)((const avx_vec *) indices);
+}
+
+/**
+ * Look up the colours of a vector of palette indices.
+ * @param palette The palette.
+ * @param indices The palette indices.
+ * @return The colours.
+ */
+AVX_TARGET static inline avx_vec AVXLookupColourInPalette(const Colour *palette, avx_vec indices)
+{
+#if (AVX_VERSION == 512)
+	return _mm512_i32gather_epi32(indices, palette, 4);
+#else
+	return _mm256_i32gather_epi32((const int *) palette, indices, 4);
+#endif
+}
+
+/** Alpha blend half of the pixels, expanded to uint16, as AlphaBlendTwoPixels() does. */
+AVX_TARGET static inline avx_vec AVXAlphaBlendHalf(avx_vec src, avx_vec dst)
+{
+	avx_vec alpha = AVX_OP(add_epi16)(src, AVX_OP(min_epu16)(src, AVX_OP(set1_epi16)(1))); // if (alpha > 0) a++;
+	alpha = AVX_OP(shuffle_epi8)(alpha, AVX_BROADCAST128(ALPHA_CONTROL_MASK));
+
+	src = AVX_OP(sub_epi16)(src, dst);       //    (r - Cr)
+	src = AVX_OP(mullo_epi16)(src, alpha);   //  a*(r - Cr)
+	src = AVX_OP(srli_epi16)(src, 8);        //  a*(r - Cr)/256
+	src = AVX_OP(add_epi16)(src, dst);       //  a*(r - Cr)/256 + Cr
+	return AVX_SI(and)(src, AVX_OP(set1_epi16)(0xFF)); // the low bytes are right, the high bytes are not
+}
+
+/**
+ * Alpha blend a vector of pixels onto another one.
+ * @param src The pixels to draw.
+ * @param dst The pixels to draw onto.
+ * @return The blended pixels, with an alpha of zero.
+ */
+AVX_TARGET static inline avx_vec AVXAlphaBlendPixels(avx_vec src, avx_vec dst)
+{
+	const avx_vec zero = AVX_SI(setzero)();
+	avx_vec lo = AVXAlphaBlendHalf(AVX_OP(unpacklo_epi8)(src, zero), AVX_OP(unpacklo_epi8)(dst, zero));
+	avx_vec hi = AVXAlphaBlendHalf(AVX_OP(unpackhi_epi8)(src, zero), AVX_OP(unpackhi_epi8)(dst, zero));
+	return AVX_OP(packus_epi16)(lo, hi);
+}
+
+/** Darken half of the pixels, expanded to uint16, as DarkenTwoPixels() does. */
+AVX_TARGET static inline avx_vec AVXDarkenHalf(avx_vec src, avx_vec dst)
+{
+	avx_vec alpha = AVX_OP(shuffle_epi8)(src, AVX_BROADCAST128(ALPHA_CONTROL_MASK));
+	alpha = AVX_OP(srli_epi16)(alpha, 2); // Reduce to 64 levels of shades so the max value fits in 16 bits.
+	avx_vec nom = AVX_OP(sub_epi16)(AVX_OP(set1_epi16)(256), alpha);
+	return AVX_OP(srli_epi16)(AVX_OP(mullo_epi16)(dst, nom), 8);
+}
+
+/**
+ * Darken a vector of pixels by the alpha of another one, for BM_TRANSPARENT.
+ * @param src The pixels whose alpha tells how much to darken.
+ * @param dst The pixels to darken.
+ * @return The darkened pixels.
+ */
+AVX_TARGET static inline avx_vec AVXDarkenPixels(avx_vec src, avx_vec dst)
+{
+	const avx_vec zero = AVX_SI(setzero)();
+	avx_vec lo = AVXDarkenHalf(AVX_OP(unpacklo_epi8)(src, zero), AVX_OP(unpacklo_epi8)(dst, zero));
+	avx_vec hi = AVXDarkenHalf(AVX_OP(unpackhi_epi8)(src, zero), AVX_OP(unpackhi_epi8)(dst, zero));
+	return AVX_OP(packus_epi16)(lo, hi);
+}
+
+/**
+ * Adjust the brightness of half of the pixels, expanded to uint16, as AdjustBrightnessOfTwoPixels() does.
+ * @param colour The pixels.
+ * @param brightness For each pixel the brightness for r, g and b, and DEFAULT_BRIGHTNESS for alpha.
+ */
+AVX_TARGET static inline avx_vec AVXAdjustBrightnessHalf(avx_vec colour, avx_vec brightness)
+{
+	colour = AVX_OP(mullo_epi16)(colour, brightness);
+	avx_vec overbright = AVX_OP(srli_epi16)(colour, 8 + 7);
+	colour = AVX_OP(srli_epi16)(colour, 7);
+
+	/* Sum overbright.
+	 * Maximum for each rgb is 508 => 9 bits. The highest bit tells if there is overbright.
+	 * -255 is changed in -256 so we just have to take the 8 lower bits into account.
+	 */
+	colour = AVX_SI(and)(colour, AVX_SET1_EPI64(0x00FF01FF01FF01FFLL));
+	overbright = AVX_SI(and)(colour, AVX_OP(mullo_epi16)(overbright, AVX_OP(set1_epi16)(0xFF)));
+	overbright = AVX_OP(madd_epi16)(overbright, AVX_OP(set1_epi16)(1));                                 // b + g, r + a
+	overbright = AVX_OP(add_epi32)(overbright, AVX_OP(shuffle_epi32)(overbright, AVX_PERM(0xB1))); // b + g + r + a
+	overbright = AVX_OP(srli_epi32)(overbright, 1); // Reduce overbright strength.
+	overbright = AVX_SI(or)(overbright, AVX_OP(slli_epi32)(overbright, 16));
+	overbright = AVX_SI(and)(overbright, AVX_SET1_EPI64(0x0000FFFFFFFFFFFFLL)); // Not for alpha.
+
+	avx_vec ret = AVX_OP(subs_epu16)(AVX_SET1_EPI64(0x000000FF00FF00FFLL), colour); //    (255 - rgb)
+	ret = AVX_OP(mullo_epi16)(ret, overbright); // ob*(255 - rgb)
+	ret = AVX_OP(srli_epi16)(ret, 8);           // ob*(255 - rgb)/256
+	return AVX_OP(add_epi16)(ret, colour);      // ob*(255 - rgb)/256 + rgb
+}
+
+/**
+ * Adjust the brightness of a vector of pixels.
+ * @param colour The pixels.
+ * @param mv For each pixel the map value, m | v << 8.
+ * @return The pixels with adjusted brightness; pixels with a brightness of DEFAULT_BRIGHTNESS are unchanged.
+ */
+AVX_TARGET static inline avx_vec AVXAdjustBrightnessPixels(avx_vec colour, avx_vec mv)
+{
+	/* Only bother when there is a pixel whose brightness is not the default one. */
+	const avx_vec v = AVX_OP(srli_epi32)(AVX_SI(and)(mv, AVX_OP(set1_epi32)(0xFF00)), 8);
+	if (AVXMaskAll(AVXMaskEqual(v, AVX_OP(set1_epi32)(Blitter_32bppBase::DEFAULT_BRIGHTNESS)))) return colour;
+
+	/* Brightness of r, g and b, and DEFAULT_BRIGHTNESS for alpha to keep it (a*128/128 = a). */
+	const avx_vec vv = AVX_SI(or)(v, AVX_OP(slli_epi32)(v, 16));
+	const avx_vec vd = AVX_SI(or)(v, AVX_OP(set1_epi32)(Blitter_32bppBase::DEFAULT_BRIGHTNESS << 16));
+
+	const avx_vec zero = AVX_SI(setzero)();
+	avx_vec lo = AVXAdjustBrightnessHalf(AVX_OP(unpacklo_epi8)(colour, zero), AVX_OP(unpacklo_epi32)(vv, vd));
+	avx_vec hi = AVXAdjustBrightnessHalf(AVX_OP(unpackhi_epi8)(colour, zero), AVX_OP(unpackhi_epi32)(vv, vd));
+	return AVX_OP(packus_epi16)(lo, hi);
+}
+
+/**
+ * Replace the colours of the pixels with a palette animated colour index by the colour of the palette.
+ * @param src The pixels.
+ * @param mv For each pixel the map value, m | v << 8.
+ * @param palette The palette.
+ * @return The pixels, with the alpha unchanged.
+ */
+AVX_TARGET static inline avx_vec AVXRecolourAnimated(avx_vec src, avx_vec mv, const Colour *palette)
+{
+	const avx_vec m = AVX_SI(and)(mv, AVX_OP(set1_epi32)(0xFF));
+	const avx_mask animated = AVXMaskGreater(m, AVX_OP(set1_epi32)(PALETTE_ANIM_START - 1));
+	if (likely(AVXMaskNone(animated))) return src;
+
+	avx_vec colour = AVX_SI(and)(AVXLookupColourInPalette(palette, m), AVX_OP(set1_epi32)(0x00FFFFFF));
+	colour = AVX_SI(or)(colour, AVX_SI(and)(src, AVX_OP(set1_epi32)(0xFF000000)));
+	return AVXSelect(animated, AVXAdjustBrightnessPixels(colour, mv), src);
+}
+
+/**
+ * Draws a sprite to a (screen) buffer. It is templated to allow faster operation.
+ *
+ * @tparam mode blitter mode; only BM_NORMAL, BM_COLOUR_REMAP and BM_TRANSPARENT
+ * @tparam read_mode where the pixels of a line start and end
+ * @tparam translucent whether the sprite may have pixels which are neither fully transparent nor fully opaque
+ * @tparam animated whether palette animated pixels are drawn with the colours of the palette and stored in the animation buffer
+ * @tparam anim_buffer whether there is an animation buffer to update
+ * @param bp further blitting parameters
+ * @param zoom zoom level at which we are drawing
+ * @param palette the palette of the blitter
+ * @param anim_line the animation buffer at the top left pixel to draw, if there is one
+ * @param anim_pitch the pitch of the animation buffer
+ */
+template <BlitterMode mode, Blitter_32bppSSE_Base::ReadMode read_mode, bool translucent, bool animated, bool anim_buffer>
+AVX_TARGET static void DrawAVX(const Blitter::BlitterParams *bp, ZoomLevel zoom, const Colour *palette, uint16 *anim_line, int anim_pitch)
+{
+	typedef Blitter_32bppSSE_Base::MapValue MapValue;
+
+	const byte * const remap = bp->remap;
+	Colour *dst_line = (Colour *) bp->dst + bp->top * bp->pitch + bp->left;
+	int effective_width = bp->width;
+
+	/* Find where to start reading in the source sprite. */
+	const Blitter_32bppSSE_Base::SpriteData * const sd = (const Blitter_32bppSSE_Base::SpriteData *) bp->sprite;
+	const Blitter_32bppSSE_Base::SpriteInfo * const si = &sd->infos[zoom];
+	const MapValue *src_mv_line = (const MapValue *) &sd->data[si->mv_offset] + bp->skip_top * si->sprite_width;
+	const Colour *src_rgba_line = (const Colour *) ((const byte *) &sd->data[si->sprite_offset] + bp->skip_top * si->sprite_line_size);
+
+	if (read_mode != Blitter_32bppSSE_Base::RM_WITH_MARGIN) {
+		src_rgba_line += bp->skip_left;
+		src_mv_line += bp->skip_left;
+	}
+
+	for (int y = bp->height; y != 0; y--) {
+		Colour *dst = dst_line;
+		const Colour *src = src_rgba_line + META_LENGTH;
+		const MapValue *src_mv = src_mv_line;
+		uint16 *anim = anim_line;
+
+		if (read_mode == Blitter_32bppSSE_Base::RM_WITH_MARGIN) {
+			src += src_rgba_line[0].data;
+			dst += src_rgba_line[0].data;
+			src_mv += src_rgba_line[0].data;
+			if (anim_buffer) anim += src_rgba_line[0].data;
+			const int width_diff = si->sprite_width - bp->width;
+			effective_width = bp->width - (int) src_rgba_line[0].data;
+			const int delta_diff = (int) src_rgba_line[1].data - width_diff;
+			const int new_width = effective_width - delta_diff;
+			effective_width = delta_diff > 0 ? new_width : effective_width;
+		}
+
+		for (int remaining = effective_width; remaining > 0; remaining -= AVX_PIXELS, src += AVX_PIXELS, dst += AVX_PIXELS, src_mv += AVX_PIXELS, anim += AVX_PIXELS) {
+			avx_vec src_px = AVXLoadPixels(src, remaining);
+			const avx_mask visible = AVXMaskAlphaNonZero(src_px);
+			if (AVXMaskNone(visible)) continue;
+			const avx_mask opaque = AVXMaskAlphaFull(src_px);
+
+			switch (mode) {
+				default: {
+					avx_vec mv = AVX_SI(setzero)();
+					if (animated) {
+						mv = AVXLoadMapValues(src_mv, remaining);
+						src_px = AVXRecolourAnimated(src_px, mv, palette);
+					}
+					if (anim_buffer) {
+						/* Fully opaque pixels take over the colour index and brightness, the other visible ones have no colour index any more. */
+						const avx_vec anim_values = animated ? AVXSelect(opaque, mv, AVX_SI(setzero)()) : AVX_SI(setzero)();
+						AVXStoreAnim(anim, anim_values, visible, remaining);
+					}
+					const avx_vec dst_px = AVXLoadPixels(dst, remaining);
+					AVXStorePixels(dst, translucent ? AVXAlphaBlendPixels(src_px, dst_px) : AVXSelect(visible, src_px, dst_px), remaining);
+					break;
+				}
+
+				case BM_COLOUR_REMAP: {
+					const avx_vec mv = AVXLoadMapValues(src_mv, remaining);
+					const avx_vec m = AVX_SI(and)(mv, AVX_OP(set1_epi32)(0xFF));
+					const avx_mask no_remap = AVXMaskEqual(m, AVX_SI(setzero)());
+					const avx_vec r = AVXLookupRemap(remap, src_mv, remaining);
+
+					/* Remap colours; remapping to colour index 0 makes the pixel transparent. */
+					if (!AVXMaskAll(no_remap)) {
+						const avx_vec zero = AVX_SI(setzero)();
+						avx_vec colour = AVX_SI(and)(AVXLookupColourInPalette(palette, r), AVX_OP(set1_epi32)(0x00FFFFFF));
+						colour = AVX_SI(or)(colour, AVX_SI(and)(src_px, AVX_OP(set1_epi32)(0xFF000000)));
+						colour = AVXSelect(AVXMaskEqual(r, zero), zero, colour);
+						src_px = AVXAdjustBrightnessPixels(AVXSelect(no_remap, src_px, colour), mv);
+					}
+
+					if (anim_buffer) {
+						const avx_vec anim_values = animated ? AVXSelect(opaque, AVX_SI(or)(r, AVX_SI(and)(mv, AVX_OP(set1_epi32)(0xFF00))), AVX_SI(setzero)()) : AVX_SI(setzero)();
+						AVXStoreAnim(anim, anim_values, visible, remaining);
+					}
+					AVXStorePixels(dst, AVXAlphaBlendPixels(src_px, AVXLoadPixels(dst, remaining)), remaining);
+					break;
+				}
+
+				case BM_TRANSPARENT:
+					/* Make the current colour a bit more black, so it looks like this image is transparent. */
+					if (anim_buffer) AVXStoreAnim(anim, AVX_SI(setzero)(), visible, remaining);
+					AVXStorePixels(dst, AVXDarkenPixels(src_px, AVXLoadPixels(dst, remaining)), remaining);
+					break;
+			}
+		}
+
+		src_mv_line += si->sprite_width;
+		src_rgba_line = (const Colour*) ((const byte*) src_rgba_line + si->sprite_line_size);
+		dst_line += bp->pitch;
+		if (anim_buffer) anim_line += anim_pitch;
+	}
+}
+
+/**
+ * Draws a sprite to a (screen) buffer. Calls adequate templated function.
+ *
+ * @tparam anim_buffer whether there is an animation buffer to update
+ * @param bp further blitting parameters
+ * @param mode blitter mode; not BM_CRASH_REMAP nor BM_BLACK_REMAP
+ * @param zoom zoom level at which we are drawing
+ * @param palette the palette of the blitter
+ * @param anim_line the animation buffer at the top left pixel to draw, if there is one
+ * @param anim_pitch the pitch of the animation buffer
+ */
+template <bool anim_buffer>
+AVX_TARGET static void DrawSpriteAVX(const Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom, const Colour *palette, uint16 *anim_line, int anim_pitch)
+{
+	typedef Blitter_32bppSSE_Base Base;
+
+	const BlitterSpriteFlags sprite_flags = ((const Base::SpriteData *) bp->sprite)->flags;
+	const bool animated = anim_buffer && !(sprite_flags & SF_NO_ANIM);
+	switch (mode) {
+		default:
+bm_normal:
+			if (bp->skip_left != 0 || bp->width <= MARGIN_NORMAL_THRESHOLD) {
+				if (animated) DrawAVX<BM_NORMAL, Base::RM_WITH_SKIP, true, true, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+				else          DrawAVX<BM_NORMAL, Base::RM_WITH_SKIP, true, false, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+			} else if (sprite_flags & SF_TRANSLUCENT) {
+				if (animated) DrawAVX<BM_NORMAL, Base::RM_WITH_MARGIN, true, true, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+				else          DrawAVX<BM_NORMAL, Base::RM_WITH_MARGIN, true, false, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+			} else {
+				if (animated) DrawAVX<BM_NORMAL, Base::RM_WITH_MARGIN, false, true, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+				else          DrawAVX<BM_NORMAL, Base::RM_WITH_MARGIN, false, false, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+			}
+			return;
+
+		case BM_COLOUR_REMAP:
+			if (sprite_flags & SF_NO_REMAP) goto bm_normal;
+			if (bp->skip_left != 0 || bp->width <= MARGIN_REMAP_THRESHOLD) {
+				if (animated) DrawAVX<BM_COLOUR_REMAP, Base::RM_WITH_SKIP, true, true, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+				else          DrawAVX<BM_COLOUR_REMAP, Base::RM_WITH_SKIP, true, false, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+			} else {
+				if (animated) DrawAVX<BM_COLOUR_REMAP, Base::RM_WITH_MARGIN, true, true, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+				else          DrawAVX<BM_COLOUR_REMAP, Base::RM_WITH_MARGIN, true, false, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+			}
+			return;
+
+		case BM_TRANSPARENT:
+			DrawAVX<BM_TRANSPARENT, Base::RM_NONE, true, false, anim_buffer>(bp, zoom, palette, anim_line, anim_pitch);
+			return;
+	}
+}
+
+/**
+ * Make a vector of pixels transparent, as Blitter_32bppBase::MakeTransparent(colour, 154) does.
+ * @param pixels The pixels.
+ * @return The darkened, fully opaque, pixels.
+ */
+AVX_TARGET static inline avx_vec AVXMakeTransparentPixels(avx_vec pixels)
+{
+	const avx_vec zero = AVX_SI(setzero)();
+	const avx_vec nom = AVX_OP(set1_epi16)(154);
+	avx_vec lo = AVX_OP(srli_epi16)(AVX_OP(mullo_epi16)(AVX_OP(unpacklo_epi8)(pixels, zero), nom), 8);
+	avx_vec hi = AVX_OP(srli_epi16)(AVX_OP(mullo_epi16)(AVX_OP(unpackhi_epi8)(pixels, zero), nom), 8);
+	return AVX_SI(or)(AVX_OP(packus_epi16)(lo, hi), AVX_OP(set1_epi32)(0xFF000000));
+}
+
+/**
+ * Make a vector of pixels grey, as Blitter_32bppBase::MakeGrey() does.
+ * @param pixels The pixels.
+ * @return The grey, fully opaque, pixels.
+ */
+AVX_TARGET static inline avx_vec AVXMakeGreyPixels(avx_vec pixels)
+{
+	const avx_vec r = AVX_OP(shuffle_epi8)(pixels, AVX_BROADCAST128(_mm_setr_epi8(2, -1, -1, -1, 6, -1, -1, -1, 10, -1, -1, -1, 14, -1, -1, -1)));
+	const avx_vec g = AVX_OP(shuffle_epi8)(pixels, AVX_BROADCAST128(_mm_setr_epi8(1, -1, -1, -1, 5, -1, -1, -1,  9, -1, -1, -1, 13, -1, -1, -1)));
+	const avx_vec b = AVX_OP(shuffle_epi8)(pixels, AVX_BROADCAST128(_mm_setr_epi8(0, -1, -1, -1, 4, -1, -1, -1,  8, -1, -1, -1, 12, -1, -1, -1)));
+	avx_vec grey = AVX_OP(mullo_epi32)(r, AVX_OP(set1_epi32)(19595));
+	grey = AVX_OP(add_epi32)(grey, AVX_OP(mullo_epi32)(g, AVX_OP(set1_epi32)(38470)));
+	grey = AVX_OP(add_epi32)(grey, AVX_OP(mullo_epi32)(b, AVX_OP(set1_epi32)(7471)));
+	/* The grey level is the third byte of the sum; copy it to the red, green and blue byte. */
+	grey = AVX_OP(shuffle_epi8)(grey, AVX_BROADCAST128(_mm_setr_epi8(2, 2, 2, -1, 6, 6, 6, -1, 10, 10, 10, -1, 14, 14, 14, -1)));
+	return AVX_SI(or)(grey, AVX_OP(set1_epi32)(0xFF000000));
+}
+
+/**
+ * Draw a colourtable to the screen, for the palettes the 32 bpp blitters know about.
+ * @param dst the destination pointer (video-buffer)
+ * @param width the width of the buffer
+ * @param height the height of the buffer
+ * @param pal the palette to use
+ * @param anim the animation buffer at the same pixel, if it is to be cleared
+ * @param anim_pitch the pitch of the animation buffer
+ */
+AVX_TARGET static void DrawColourMappingRectAVX(void *dst, int width, int height, PaletteID pal, uint16 *anim, int anim_pitch)
+{
+	if (pal != PALETTE_TO_TRANSPARENT && pal != PALETTE_NEWSPAPER) {
+		DEBUG(misc, 0, "32bpp blitter doesn't know how to draw this colour table ('%d')", pal);
+		return;
+	}
+
+	Colour *udst = (Colour *)dst;
+	do {
+		Colour *line = udst;
+		for (int remaining = width; remaining > 0; remaining -= AVX_PIXELS, line += AVX_PIXELS) {
+			const avx_vec pixels = AVXLoadPixels(line, remaining);
+			AVXStorePixels(line, pal == PALETTE_TO_TRANSPARENT ? AVXMakeTransparentPixels(pixels) : AVXMakeGreyPixels(pixels), remaining);
+		}
+		udst += _screen.pitch;
+		if (anim != nullptr) {
+			memset(anim, 0, width * sizeof(uint16));
+			anim += anim_pitch;
+		}
+	} while (--height);
+}
+
+#if FULL_ANIMATION == 0
+/**
+ * Draws a sprite to a (screen) buffer.
+ *
+ * @param bp further blitting parameters
+ * @param mode blitter mode
+ * @param zoom zoom level at which we are drawing
+ */
+#if (AVX_VERSION == 2)
+void Blitter_32bppAVX2::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
+#elif (AVX_VERSION == 512)
+void Blitter_32bppAVX512::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
+#endif
+{
+	switch (mode) {
+		case BM_CRASH_REMAP:
+		case BM_BLACK_REMAP:
+			/* These are rare and do not blend, leave them to the SSE4 blitter. */
+			Blitter_32bppSSE4::Draw(bp, mode, zoom);
+			return;
+
+		default:
+			DrawSpriteAVX<false>(bp, mode, zoom, _cur_palette.palette, nullptr, 0);
+			return;
+	}
+}
+
+#if (AVX_VERSION == 2)
+void Blitter_32bppAVX2::DrawColourMappingRect(void *dst, int width, int height, PaletteID pal)
+#elif (AVX_VERSION == 512)
+void Blitter_32bppAVX512::DrawColourMappingRect(void *dst, int width, int height, PaletteID pal)
+#endif
+{
+	DrawColourMappingRectAVX(dst, width, height, pal, nullptr, 0);
+}
+#else /* FULL_ANIMATION */
+/**
+ * Draws a sprite to a (screen) buffer, and updates the animation buffer when drawing to the screen.
+ *
+ * @param bp further blitting parameters
+ * @param mode blitter mode
+ * @param zoom zoom level at which we are drawing
+ */
+#if (AVX_VERSION == 2)
+void Blitter_32bppAVX2_Anim::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
+#elif (AVX_VERSION == 512)
+void Blitter_32bppAVX512_Anim::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
+#endif
+{
+	switch (mode) {
+		case BM_CRASH_REMAP:
+		case BM_BLACK_REMAP:
+			/* These are rare and do not blend, leave them to the SSE4 blitter. */
+			Blitter_32bppSSE4_Anim::Draw(bp, mode, zoom);
+			return;
+
+		default:
+			if (_screen_disable_anim) {
+				/* Not drawing to the screen, so there is no animation buffer. */
+				DrawSpriteAVX<false>(bp, mode, zoom, this->palette.palette, nullptr, 0);
+				return;
+			}
+			this->MarkAnimatedSprite(bp, mode, ((const Blitter_32bppSSE_Base::SpriteData *) bp->sprite)->flags);
+			uint16 *anim_line = this->anim_buf + this->ScreenToAnimOffset((uint32 *)bp->dst) + bp->top * this->anim_buf_pitch + bp->left;
+			DrawSpriteAVX<true>(bp, mode, zoom, this->palette.palette, anim_line, this->anim_buf_pitch);
+			return;
+	}
+}
+
+#if (AVX_VERSION == 2)
+void Blitter_32bppAVX2_Anim::DrawColourMappingRect(void *dst, int width, int height, PaletteID pal)
+#elif (AVX_VERSION == 512)
+void Blitter_32bppAVX512_Anim::DrawColourMappingRect(void *dst, int width, int height, PaletteID pal)
+#endif
+{
+	if (_screen_disable_anim) {
+		/* This means our output is not to the screen, so we can't be doing any animation stuff. */
+		DrawColourMappingRectAVX(dst, width, height, pal, nullptr, 0);
+	} else {
+		DrawColourMappingRectAVX(dst, width, height, pal, this->anim_buf + this->ScreenToAnimOffset((uint32 *)dst), this->anim_buf_pitch);
+	}
+}
+#endif /* FULL_ANIMATION */
+
+#endif /* WITH_SSE */
+#endif /* BLITTER_32BPP_AVX_FUNC_HPP */
@@ -15,6 +15,7 @@
 #include "../string_func.h"
 #include "../core/string_compare_type.hpp"
 #include <map>
+#include <vector>
 
 #if defined(WITH_COCOA)
 bool QZ_CanDisplay8bpp();
@@ -147,6 +148,17 @@ public:
 		return *GetActiveBlitter();
 	}
 
+	/**
+	 * Get the names of the usable blitters.
+	 * @return The names, in the order of #GetBlittersInfo.
+	 */
+	static std::vector<const char *> GetBlitterNames()
+	{
+		std::vector<const char *> names;
+		for (const auto &it : GetBlitters()) names.push_back(it.second->name);
+		return names;
+	}
+
 	/**
 	 * Fill a buffer with information about the blitters.
 	 * @param p The buffer to fill.
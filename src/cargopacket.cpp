@@ -9,6 +9,7 @@
 
 #include "stdafx.h"
 #include "station_base.h"
+#include "vehicle_base.h"
 #include "core/pool_func.hpp"
 #include "core/random_func.hpp"
 #include "economy_base.h"
@@ -21,6 +22,7 @@
 #include "3rdparty/cpp-btree/btree_map.h"
 
 #include <vector>
+#include <chrono>
 
 #include "safeguards.h"
 
@@ -177,6 +179,7 @@ CargoPacket *CargoPacket::Split(uint new_size)
 
 	Money fs = this->FeederShare(new_size);
 	CargoPacket *cp_new = new CargoPacket(new_size, this->days_in_transit, this->source, this->source_xy, this->loaded_at_xy, fs, this->source_type, this->source_id);
+	cp_new->age_epoch = this->age_epoch;
 	this->feeder_share -= fs;
 
 	if (this->flags & CPF_HAS_DEFERRED_PAYMENT) {
@@ -299,6 +302,23 @@ void CargoPacket::PayDeferredPayments()
 	return true;
 }
 
+/**
+ * Check the deferred payments of the cargo packets in a range of the cargo packet pool.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ * @return True if all deferred payments belong to cargo packets with a deferred payment.
+ */
+/* static */ bool CargoPacket::ValidateDeferredCargoPayments(size_t first, size_t last)
+{
+	for (auto it = _cargo_packet_deferred_payments.lower_bound((uint64)first << 32); it != _cargo_packet_deferred_payments.end() && (it->first >> 32) < last; ++it) {
+		uint id = it->first >> 32;
+		const CargoPacket *cp = CargoPacket::GetIfValid(id);
+		if (!cp) return false;
+		if (!(cp->flags & CPF_HAS_DEFERRED_PAYMENT)) return false;
+	}
+	return true;
+}
+
 /*
  *
  * Cargo list implementation
@@ -419,6 +439,7 @@ void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
 	uint sum = cp->count;
 	for (ReverseIterator it(this->packets.rbegin()); it != this->packets.rend(); it++) {
 		CargoPacket *icp = *it;
+		this->UpdatePacketAge(icp);
 		if (VehicleCargoList::TryMerge(icp, cp)) return;
 		sum += icp->count;
 		if (sum >= this->action_counts[action]) {
@@ -508,11 +529,14 @@ void VehicleCargoList::PopCargo(Taction action)
 /**
  * Update the cached values to reflect the removal of this packet or part of it.
  * Decreases count, feeder share and days_in_transit.
+ * The days in transit of the packet are brought up to date, so it can be moved to another list.
  * @param cp Packet to be removed from cache.
  * @param count Amount of cargo from the given packet to be removed.
  */
-void VehicleCargoList::RemoveFromCache(const CargoPacket *cp, uint count)
+void VehicleCargoList::RemoveFromCache(CargoPacket *cp, uint count)
 {
+	this->UpdatePacketAge(cp);
+	if (cp->days_in_transit != 0xFF) this->unsaturated_count -= count;
 	this->feeder_share -= cp->FeederShare(count);
 	this->Parent::RemoveFromCache(cp, count);
 }
@@ -520,10 +544,18 @@ void VehicleCargoList::RemoveFromCache(const CargoPacket *cp, uint count)
 /**
  * Update the cache to reflect adding of this packet.
  * Increases count, feeder share and days_in_transit.
- * @param cp New packet to be inserted.
+ * @param cp Packet to be inserted, its age epoch has to be relative to this list.
  */
-void VehicleCargoList::AddToCache(const CargoPacket *cp)
+void VehicleCargoList::AddToCache(CargoPacket *cp)
 {
+	this->UpdatePacketAge(cp);
+	if (cp->days_in_transit != 0xFF) {
+		const uint32 saturation_epoch = this->age_epoch + (0xFF - cp->days_in_transit);
+		if (this->unsaturated_count == 0 || (int32)(saturation_epoch - this->next_saturation_epoch) < 0) {
+			this->next_saturation_epoch = saturation_epoch;
+		}
+		this->unsaturated_count += cp->count;
+	}
 	this->feeder_share += cp->feeder_share;
 	this->Parent::AddToCache(cp);
 }
@@ -534,7 +566,7 @@ void VehicleCargoList::AddToCache(const CargoPacket *cp)
  * @param action MoveToAction of the packet (for updating the counts).
  * @param count Amount of cargo to be removed.
  */
-void VehicleCargoList::RemoveFromMeta(const CargoPacket *cp, MoveToAction action, uint count)
+void VehicleCargoList::RemoveFromMeta(CargoPacket *cp, MoveToAction action, uint count)
 {
 	assert(count <= this->action_counts[action]);
 	this->AssertCountConsistency();
@@ -545,12 +577,13 @@ void VehicleCargoList::RemoveFromMeta(const CargoPacket *cp, MoveToAction action
 
 /**
  * Adds a packet to the metadata.
- * @param cp Packet to be added.
+ * @param cp Packet to be added, its days in transit have to be up to date.
  * @param action MoveToAction of the packet.
  */
-void VehicleCargoList::AddToMeta(const CargoPacket *cp, MoveToAction action)
+void VehicleCargoList::AddToMeta(CargoPacket *cp, MoveToAction action)
 {
 	this->AssertCountConsistency();
+	cp->age_epoch = this->age_epoch;
 	this->AddToCache(cp);
 	this->action_counts[action] += cp->count;
 	this->AssertCountConsistency();
@@ -558,16 +591,45 @@ void VehicleCargoList::AddToMeta(const CargoPacket *cp, MoveToAction action)
 
 /**
  * Ages the all cargo in this list.
+ * The packets themselves are not touched, only the age epoch of the list is
+ * advanced. The packets are walked only when some cargo reaches the maximum
+ * days in transit, to find out which cargo is still unsaturated.
  */
 void VehicleCargoList::AgeCargo()
 {
-	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
-		CargoPacket *cp = *it;
-		/* If we're at the maximum, then we can't increase no more. */
+	/* If all cargo is at the maximum, then we can't increase no more. */
+	if (this->unsaturated_count == 0) return;
+
+	this->cargo_days_in_transit += this->unsaturated_count;
+	this->age_epoch++;
+	if ((int32)(this->next_saturation_epoch - this->age_epoch) <= 0) this->RescanSaturation();
+}
+
+/**
+ * Bring all packets up to date and recompute the unsaturated cargo count and the epoch at which
+ * the next packet reaches the maximum days in transit.
+ */
+void VehicleCargoList::RescanSaturation()
+{
+	this->unsaturated_count = 0;
+	for (CargoPacket *cp : this->packets) {
+		this->UpdatePacketAge(cp);
 		if (cp->days_in_transit == 0xFF) continue;
+		const uint32 saturation_epoch = this->age_epoch + (0xFF - cp->days_in_transit);
+		if (this->unsaturated_count == 0 || (int32)(saturation_epoch - this->next_saturation_epoch) < 0) {
+			this->next_saturation_epoch = saturation_epoch;
+		}
+		this->unsaturated_count += cp->count;
+	}
+}
 
-		cp->days_in_transit++;
-		this->cargo_days_in_transit += cp->count;
+/**
+ * Bring the days in transit of all packets in this list up to date, e.g. before saving.
+ */
+void VehicleCargoList::UpdatePacketAges()
+{
+	for (CargoPacket *cp : this->packets) {
+		this->UpdatePacketAge(cp);
 	}
 }
 
@@ -640,6 +702,7 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 	assert(this->count > 0 || it == this->packets.end());
 	while (sum < this->count) {
 		CargoPacket *cp = *it;
+		this->UpdatePacketAge(cp);
 
 		it = this->packets.erase(it);
 		StationID cargo_next = INVALID_STATION;
@@ -721,8 +784,15 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 /** Invalidates the cached data and rebuild it. */
 void VehicleCargoList::InvalidateCache()
 {
+	const bool had_unsaturated = this->unsaturated_count > 0;
+	const uint32 old_next_saturation_epoch = this->next_saturation_epoch;
 	this->feeder_share = 0;
+	this->unsaturated_count = 0;
 	this->Parent::InvalidateCache();
+	/* An earlier saturation epoch is still a valid lower bound, which only causes an additional rescan. */
+	if (had_unsaturated && this->unsaturated_count > 0 && (int32)(old_next_saturation_epoch - this->next_saturation_epoch) < 0) {
+		this->next_saturation_epoch = old_next_saturation_epoch;
+	}
 }
 
 /**
@@ -1051,6 +1121,96 @@ uint StationCargoList::Reroute(uint max_move, StationCargoList *dest, StationID
 	return this->ShiftCargo(StationCargoReroute(this, dest, max_move, avoid, avoid2, ge), avoid, false);
 }
 
+/**
+ * Benchmark aging the cargo of all vehicles lazily against walking all packets of each vehicle, as done before.
+ * The ages of the cargo are restored afterwards, so the game state is not affected.
+ * @param b Buffer to write to.
+ * @param last Last valid position in the buffer.
+ * @param iterations Number of times to age the cargo of all vehicles.
+ */
+void DumpCargoAgingBenchmark(char *b, const char *last, uint iterations)
+{
+	struct ListState {
+		VehicleCargoList *cargo;
+		uint cargo_days_in_transit;
+		uint32 age_epoch;
+		uint unsaturated_count;
+		uint32 next_saturation_epoch;
+	};
+	std::vector<ListState> lists;
+	std::vector<byte> days;
+	uint64 items = 0;
+	for (Vehicle *v : Vehicle::Iterate()) {
+		VehicleCargoList &cargo = v->cargo;
+		if (cargo.packets.empty()) continue;
+		cargo.UpdatePacketAges();
+		lists.push_back({ &cargo, cargo.cargo_days_in_transit, cargo.age_epoch, cargo.unsaturated_count, cargo.next_saturation_epoch });
+		for (const CargoPacket *cp : cargo.packets) days.push_back(cp->days_in_transit);
+		items += cargo.count;
+	}
+
+	auto restore = [&]() {
+		size_t i = 0;
+		for (const ListState &state : lists) {
+			VehicleCargoList &cargo = *state.cargo;
+			cargo.cargo_days_in_transit = state.cargo_days_in_transit;
+			cargo.age_epoch = state.age_epoch;
+			cargo.unsaturated_count = state.unsaturated_count;
+			cargo.next_saturation_epoch = state.next_saturation_epoch;
+			for (CargoPacket *cp : cargo.packets) {
+				cp->days_in_transit = days[i++];
+				cp->age_epoch = state.age_epoch;
+			}
+		}
+	};
+	auto get_days = [&](std::vector<byte> &packet_days) -> uint64 {
+		uint64 total = 0;
+		packet_days.clear();
+		for (const ListState &state : lists) {
+			state.cargo->UpdatePacketAges();
+			for (const CargoPacket *cp : state.cargo->packets) packet_days.push_back(cp->days_in_transit);
+			total += state.cargo->cargo_days_in_transit;
+		}
+		return total;
+	};
+
+	b += seprintf(b, last, "Cargo aging benchmark, %u agings of %u vehicle cargo lists, %u packets, " OTTD_PRINTF64U " items\n",
+			iterations, (uint)lists.size(), (uint)days.size(), items);
+	if (lists.empty()) return;
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint i = 0; i < iterations; i++) {
+		for (const ListState &state : lists) {
+			VehicleCargoList &cargo = *state.cargo;
+			for (CargoPacket *cp : cargo.packets) {
+				if (cp->days_in_transit == 0xFF) continue;
+				cp->days_in_transit++;
+				cargo.cargo_days_in_transit += cp->count;
+			}
+		}
+	}
+	auto walk_end = std::chrono::steady_clock::now();
+	std::vector<byte> walk_days;
+	const uint64 walk_total = get_days(walk_days);
+	restore();
+
+	auto lazy_start = std::chrono::steady_clock::now();
+	for (uint i = 0; i < iterations; i++) {
+		for (const ListState &state : lists) {
+			state.cargo->AgeCargo();
+		}
+	}
+	auto lazy_end = std::chrono::steady_clock::now();
+	std::vector<byte> lazy_days;
+	const uint64 lazy_total = get_days(lazy_days);
+	restore();
+
+	b += seprintf(b, last, "  packet walk: %9.1f us/aging, lazy: %9.1f us/aging, cargo days: " OTTD_PRINTF64U " / " OTTD_PRINTF64U "%s\n",
+			std::chrono::duration<double, std::micro>(walk_end - start).count() / iterations,
+			std::chrono::duration<double, std::micro>(lazy_end - lazy_start).count() / iterations,
+			walk_total, lazy_total, (walk_total == lazy_total && walk_days == lazy_days) ? "" : " MISMATCH");
+}
+
 /*
  * We have to instantiate everything we want to be usable.
  */
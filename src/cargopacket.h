@@ -57,6 +57,7 @@ private:
 		TileOrStationID next_station; ///< Station where the cargo wants to go next.
 	};
 	uint flags = 0;             ///< NOSAVE: temporary flags
+	uint32 age_epoch = 0;       ///< NOSAVE: Age epoch of the vehicle cargo list at which days_in_transit was last brought up to date, see VehicleCargoList::UpdatePacketAge
 
 	/** Cargo packet flag bits in CargoPacket::flags. */
 	enum CargoPacketFlags {
@@ -70,6 +71,7 @@ private:
 	/** We want this to be saved, right? */
 	friend const struct SaveLoad *GetCargoPacketDesc();
 	friend void Load_CPDP();
+	friend void DumpCargoAgingBenchmark(char *b, const char *last, uint iterations);
 public:
 	/** Maximum number of items in a single cargo packet. */
 	static const uint16 MAX_COUNT = UINT16_MAX;
@@ -138,6 +140,7 @@ public:
 	 * Gets the number of days this cargo has been in transit.
 	 * This number isn't really in days, but in 2.5 days (CARGO_AGING_TICKS = 185 ticks) and
 	 * it is capped at 255.
+	 * For a packet in a vehicle cargo list this is only up to date after VehicleCargoList::UpdatePacketAge.
 	 * @return Length this cargo has been in transit.
 	 */
 	inline byte DaysInTransit() const
@@ -204,6 +207,7 @@ public:
 	static void AfterLoad();
 	static void PostVehiclesAfterLoad();
 	static bool ValidateDeferredCargoPayments();
+	static bool ValidateDeferredCargoPayments(size_t first, size_t last);
 };
 
 /**
@@ -286,6 +290,9 @@ protected:
 
 	Money feeder_share;                     ///< Cache for the feeder share.
 	uint action_counts[NUM_MOVE_TO_ACTION]; ///< Counts of cargo to be transferred, delivered, kept and loaded.
+	uint32 age_epoch;                       ///< NOSAVE: Number of times the unsaturated cargo of this list has been aged.
+	uint unsaturated_count;                 ///< Cache for the amount of cargo which has not yet reached the maximum days in transit.
+	uint32 next_saturation_epoch;           ///< NOSAVE: Lower bound of the age epoch at which unsaturated cargo reaches the maximum days in transit, only valid if unsaturated_count > 0.
 
 	template<class Taction>
 	void ShiftCargo(Taction action);
@@ -327,11 +334,28 @@ public:
 	}
 
 protected:
-	void AddToCache(const CargoPacket *cp);
-	void RemoveFromCache(const CargoPacket *cp, uint count);
+	void AddToCache(CargoPacket *cp);
+	void RemoveFromCache(CargoPacket *cp, uint count);
+
+	void AddToMeta(CargoPacket *cp, MoveToAction action);
+	void RemoveFromMeta(CargoPacket *cp, MoveToAction action, uint count);
+
+	/**
+	 * Bring the days in transit of a packet in this list up to date.
+	 * Packets are aged lazily: a packet stores the age epoch of the list at
+	 * which its days_in_transit was last updated, and is only brought up
+	 * to date when it is paid for, compared, moved out of the list or saved.
+	 * @param cp Packet in this list.
+	 */
+	inline void UpdatePacketAge(CargoPacket *cp) const
+	{
+		const uint32 elapsed = this->age_epoch - cp->age_epoch;
+		if (elapsed == 0) return;
+		cp->days_in_transit = (byte)min<uint32>(cp->days_in_transit + min<uint32>(elapsed, 0xFF), 0xFF);
+		cp->age_epoch = this->age_epoch;
+	}
 
-	void AddToMeta(const CargoPacket *cp, MoveToAction action);
-	void RemoveFromMeta(const CargoPacket *cp, MoveToAction action, uint count);
+	void RescanSaturation();
 
 	static MoveToAction ChooseAction(const CargoPacket *cp, StationID cargo_next,
 			StationID current_station, bool accepted, StationIDStack next_station);
@@ -352,6 +376,9 @@ public:
 	friend class CargoReturn;
 	friend class VehicleCargoReroute;
 
+	/** The cargo aging benchmark restores the ages of the cargo after measuring. */
+	friend void DumpCargoAgingBenchmark(char *b, const char *last, uint iterations);
+
 	/**
 	 * Returns source of the first cargo packet in this list.
 	 * @return The before mentioned source.
@@ -430,6 +457,8 @@ public:
 
 	void AgeCargo();
 
+	void UpdatePacketAges();
+
 	void InvalidateCache();
 
 	void SetTransferLoadPlace(TileIndex xy);
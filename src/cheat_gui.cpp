@@ -129,12 +129,10 @@ static int32 ClickChangeMaxHlCheat(int32 p1, int32 p2)
 
 	/* Check if at least one mountain on the map is higher than the new value.
 	 * If yes, disallow the change. */
-	for (TileIndex t = 0; t < MapSize(); t++) {
-		if ((int32)TileHeight(t) > p1) {
-			ShowErrorMessage(STR_CONFIG_SETTING_TOO_HIGH_MOUNTAIN, INVALID_STRING_ID, WL_ERROR);
-			/* Return old, unchanged value */
-			return _settings_game.construction.max_heightlevel;
-		}
+	if ((int32)GetMapMaxHeight() > p1) {
+		ShowErrorMessage(STR_CONFIG_SETTING_TOO_HIGH_MOUNTAIN, INVALID_STRING_ID, WL_ERROR);
+		/* Return old, unchanged value */
+		return _settings_game.construction.max_heightlevel;
 	}
 
 	/* Execute the change and reload GRF Data */
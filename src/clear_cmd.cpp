@@ -198,20 +198,23 @@ static void UpdateFences(TileIndex tile)
 }
 
 
-/** Convert to or from snowy tiles. */
-static void TileLoopClearAlps(TileIndex tile)
+/**
+ * Convert to or from snowy tiles.
+ * @param tile Tile to update.
+ * @return Whether the tile has been changed.
+ */
+static bool TileLoopClearAlps(TileIndex tile)
 {
 	int k = GetTileZ(tile) - GetSnowLine() + 1;
 
 	if (k < 0) {
 		/* Below the snow line, do nothing if no snow. */
-		if (!IsSnowTile(tile)) return;
+		if (!IsSnowTile(tile)) return false;
 	} else {
 		/* At or above the snow line, make snow tile if needed. */
 		if (!IsSnowTile(tile)) {
 			MakeSnow(tile);
-			MarkTileDirtyByTile(tile);
-			return;
+			return true;
 		}
 	}
 	/* Update snow density. */
@@ -224,10 +227,10 @@ static void TileLoopClearAlps(TileIndex tile)
 		AddClearDensity(tile, -1);
 	} else {
 		/* Density at the required level. */
-		if (k >= 0) return;
+		if (k >= 0) return false;
 		ClearSnow(tile);
 	}
-	MarkTileDirtyByTile(tile);
+	return true;
 }
 
 /**
@@ -246,7 +249,12 @@ static inline bool NeighbourIsNormal(TileIndex tile)
 	return false;
 }
 
-static void TileLoopClearDesert(TileIndex tile)
+/**
+ * Convert to or from desert tiles.
+ * @param tile Tile to update.
+ * @return Whether the tile has been changed.
+ */
+static bool TileLoopClearDesert(TileIndex tile)
 {
 	/* Current desert level - 0 if it is not desert */
 	uint current = 0;
@@ -258,7 +266,7 @@ static void TileLoopClearDesert(TileIndex tile)
 		expected = NeighbourIsNormal(tile) ? 1 : 3;
 	}
 
-	if (current == expected) return;
+	if (current == expected) return false;
 
 	if (expected == 0) {
 		SetClearGroundDensity(tile, CLEAR_GRASS, 3);
@@ -267,7 +275,25 @@ static void TileLoopClearDesert(TileIndex tile)
 		SetClearGroundDensity(tile, CLEAR_DESERT, expected);
 	}
 
-	MarkTileDirtyByTile(tile);
+	return true;
+}
+
+/**
+ * Let the grass on a clear tile grow, outside of the scenario editor.
+ * @param tile Tile with grass.
+ * @return Whether the tile has been changed.
+ */
+static bool TileLoopClearGrass(TileIndex tile)
+{
+	if (GetClearDensity(tile) == 3) return false;
+
+	if (GetClearCounter(tile) < 7) {
+		AddClearCounter(tile, 1);
+		return false;
+	}
+	SetClearCounter(tile, 0);
+	AddClearDensity(tile, 1);
+	return true;
 }
 
 static void TileLoop_Clear(TileIndex tile)
@@ -283,23 +309,16 @@ static void TileLoop_Clear(TileIndex tile)
 	AmbientSoundEffect(tile);
 
 	switch (_settings_game.game_creation.landscape) {
-		case LT_TROPIC: TileLoopClearDesert(tile); break;
-		case LT_ARCTIC: TileLoopClearAlps(tile);   break;
+		case LT_TROPIC: if (TileLoopClearDesert(tile)) MarkTileDirtyByTile(tile); break;
+		case LT_ARCTIC: if (TileLoopClearAlps(tile)) MarkTileDirtyByTile(tile); break;
 	}
 
 	switch (GetClearGround(tile)) {
 		case CLEAR_GRASS:
-			if (GetClearDensity(tile) == 3) return;
-
 			if (_game_mode != GM_EDITOR) {
-				if (GetClearCounter(tile) < 7) {
-					AddClearCounter(tile, 1);
-					return;
-				} else {
-					SetClearCounter(tile, 0);
-					AddClearDensity(tile, 1);
-				}
+				if (!TileLoopClearGrass(tile)) return;
 			} else {
+				if (GetClearDensity(tile) == 3) return;
 				SetClearGroundDensity(tile, GB(Random(), 0, 8) > 21 ? CLEAR_GRASS : CLEAR_ROUGH, 3);
 			}
 			break;
@@ -333,6 +352,25 @@ static void TileLoop_Clear(TileIndex tile)
 	MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 }
 
+static TileLoopParallelResult TileLoopParallel_Clear(TileIndex tile, uint32 random)
+{
+	/* Flooding, fences (which look at the neighbouring fields), NewGRF sounds and the scenario editor need the serial tile loop. */
+	if (_game_mode == GM_EDITOR || HasGrfMiscBit(GMB_AMBIENT_SOUND_CALLBACK) || IsClearGround(tile, CLEAR_FIELDS)) return { TLPF_SERIAL, SND_BEGIN };
+	if (_settings_game.construction.freeform_edges && DistanceFromEdge(tile) == 1) {
+		int z;
+		if (IsTileFlat(tile, &z) && z == 0) return { TLPF_SERIAL, SND_BEGIN };
+	}
+
+	TileLoopParallelFlags flags = TLPF_NONE;
+	switch (_settings_game.game_creation.landscape) {
+		case LT_TROPIC: if (TileLoopClearDesert(tile)) flags |= TLPF_DIRTY; break;
+		case LT_ARCTIC: if (TileLoopClearAlps(tile)) flags |= TLPF_DIRTY; break;
+	}
+
+	if (GetClearGround(tile) == CLEAR_GRASS && TileLoopClearGrass(tile)) flags |= TLPF_DIRTY_DETAIL;
+	return { flags, SND_BEGIN };
+}
+
 void GenerateClearTile()
 {
 	uint i, gi;
@@ -417,6 +455,7 @@ extern const TileTypeProcs _tile_type_clear_procs = {
 	nullptr,                     ///< click_tile_proc
 	nullptr,                     ///< animate_tile_proc
 	TileLoop_Clear,           ///< tile_loop_proc
+	TileLoopParallel_Clear,   ///< tile_loop_parallel_proc
 	ChangeTileOwner_Clear,    ///< change_tile_owner_proc
 	nullptr,                     ///< add_produced_cargo_proc
 	nullptr,                     ///< vehicle_enter_tile_proc
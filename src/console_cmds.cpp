@@ -1413,9 +1413,10 @@ DEF_CONSOLE_CMD(ConAlias)
 DEF_CONSOLE_CMD(ConScreenShot)
 {
 	if (argc == 0) {
-		IConsoleHelp("Create a screenshot of the game. Usage: 'screenshot [big | giant | no_con | minimap] [file name]'");
+		IConsoleHelp("Create a screenshot of the game. Usage: 'screenshot [big | giant | giant_tiles | no_con | minimap] [file name]'");
 		IConsoleHelp("'big' makes a zoomed-in screenshot of the visible area, 'giant' makes a screenshot of the "
-				"whole map, 'no_con' hides the console to create the screenshot. 'big' or 'giant' "
+				"whole map, 'giant_tiles' writes the screenshot of the whole map as a directory of 256x256 image tiles "
+				"named 'column_row', for web map viewers. 'no_con' hides the console to create the screenshot. 'big' or 'giant' "
 				"screenshots are always drawn without console. "
 				"'minimap' makes a top-viewed minimap screenshot of whole world which represents one tile by one pixel.");
 		return true;
@@ -1435,6 +1436,10 @@ DEF_CONSOLE_CMD(ConScreenShot)
 			/* screenshot giant [filename] */
 			type = SC_WORLD;
 			if (argc > 2) name = argv[2];
+		} else if (strcmp(argv[1], "giant_tiles") == 0) {
+			/* screenshot giant_tiles [directory name] */
+			type = SC_WORLD_TILES;
+			if (argc > 2) name = argv[2];
 		} else if (strcmp(argv[1], "minimap") == 0) {
 			/* screenshot minimap [filename] */
 			type = SC_MINIMAP;
@@ -2044,6 +2049,132 @@ DEF_CONSOLE_CMD(ConDumpCpdpStats)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConSavegameBenchmark)
+{
+	if (argc == 0) {
+		IConsoleHelp("Benchmark saving and loading the current game with each savegame format. Usage: 'benchmark_savegame [<iterations>]'");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	uint iterations = (argc == 2) ? max<uint>(atoi(argv[1]), 1) : 1;
+
+	extern void DumpSavegameBenchmark(char *b, const char *last, uint iterations);
+	char buffer[32768];
+	DumpSavegameBenchmark(buffer, lastof(buffer), iterations);
+	PrintLineByLine(buffer);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConVehicleLookupBenchmark)
+{
+	if (argc == 0) {
+		IConsoleHelp("Benchmark the vehicle tile lookup against the previous tile hash. Usage: 'benchmark_vehicle_lookup [<iterations>]'");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	uint iterations = (argc == 2) ? max<uint>(atoi(argv[1]), 1) : 1000000;
+
+	extern void DumpVehicleTileGridBenchmark(char *b, const char *last, uint iterations);
+	char buffer[32768];
+	DumpVehicleTileGridBenchmark(buffer, lastof(buffer), iterations);
+	PrintLineByLine(buffer);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConMapBenchmark)
+{
+	if (argc == 0) {
+		IConsoleHelp("Benchmark whole map passes and the smallmap redraw with the map layout of this build. Usage: 'benchmark_map [<iterations>]'");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	uint iterations = (argc == 2) ? max<uint>(atoi(argv[1]), 1) : 10;
+
+	extern void DumpMapBenchmark(char *b, const char *last, uint iterations);
+	extern void DumpSmallMapBenchmark(char *b, const char *last, uint iterations);
+	char buffer[32768];
+	char *b = buffer;
+	DumpMapBenchmark(b, lastof(buffer), iterations);
+	b += strlen(b);
+	DumpSmallMapBenchmark(b, lastof(buffer), iterations);
+	PrintLineByLine(buffer);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConTgpBenchmark)
+{
+	if (argc == 0) {
+		IConsoleHelp("Benchmark the phases of the TGP height map generation for the current map size and settings, with and without worker threads. Usage: 'benchmark_tgp [<iterations>]'");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	uint iterations = (argc == 2) ? max<uint>(atoi(argv[1]), 1) : 3;
+
+	extern void DumpTgpBenchmark(char *b, const char *last, uint iterations);
+	char buffer[32768];
+	DumpTgpBenchmark(buffer, lastof(buffer), iterations);
+	PrintLineByLine(buffer);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConCargoAgingBenchmark)
+{
+	if (argc == 0) {
+		IConsoleHelp("Benchmark lazy aging of vehicle cargo against walking all cargo packets. Usage: 'benchmark_cargo_aging [<iterations>]'");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	uint iterations = (argc == 2) ? max<uint>(atoi(argv[1]), 1) : 100;
+
+	extern void DumpCargoAgingBenchmark(char *b, const char *last, uint iterations);
+	char buffer[32768];
+	DumpCargoAgingBenchmark(buffer, lastof(buffer), iterations);
+	PrintLineByLine(buffer);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConBlitterBenchmark)
+{
+	if (argc == 0) {
+		IConsoleHelp("Benchmark drawing a viewport at the middle of the map with each usable blitter, needs the null video driver. Usage: 'benchmark_blitter [<iterations>]'");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	uint iterations = (argc == 2) ? max<uint>(atoi(argv[1]), 1) : 20;
+
+	extern void DumpBlitterBenchmark(char *b, const char *last, uint iterations);
+	char buffer[32768];
+	DumpBlitterBenchmark(buffer, lastof(buffer), iterations);
+	PrintLineByLine(buffer);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConDumpYapfCacheStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Dump YAPF rail segment cost cache stats.");
+		return true;
+	}
+
+	extern void DumpYapfCacheStats(char *b, const char *last);
+	char buffer[32768];
+	DumpYapfCacheStats(buffer, lastof(buffer));
+	PrintLineByLine(buffer);
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConVehicleStats)
 {
 	if (argc == 0) {
@@ -2441,6 +2572,20 @@ DEF_CONSOLE_CMD(ConFramerateWindow)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConTickProfile)
+{
+	extern bool TickProfilerConsoleCommand(byte argc, char *argv[]); // framerate_gui.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Record nested timings of the last game loop ticks. Usage: 'tick_profile [status | start [<ticks>] | stop | dump [<file>]]'");
+		IConsoleHelp("  'dump' writes the recorded ticks as Chrome trace event JSON, by default to tick_profile.json in the personal directory");
+		IConsoleHelp("  Set tick_profiler_slow_tick_ms to start profiling and dump automatically when a tick takes longer than that");
+		return true;
+	}
+
+	return TickProfilerConsoleCommand(argc, argv);
+}
+
 /*******************************
  * console command registration
  *******************************/
@@ -2579,11 +2724,19 @@ void IConsoleStdLibRegister()
 #endif
 	IConsoleCmdRegister("fps",     ConFramerate);
 	IConsoleCmdRegister("fps_wnd", ConFramerateWindow);
+	IConsoleCmdRegister("tick_profile", ConTickProfile);
 
 	IConsoleCmdRegister("dump_command_log", ConDumpCommandLog, nullptr, true);
 	IConsoleCmdRegister("dump_inflation", ConDumpInflation, nullptr, true);
 	IConsoleCmdRegister("dump_cpdp_stats", ConDumpCpdpStats, nullptr, true);
 	IConsoleCmdRegister("dump_veh_stats", ConVehicleStats, nullptr, true);
+	IConsoleCmdRegister("dump_yapf_cache_stats", ConDumpYapfCacheStats, nullptr, true);
+	IConsoleCmdRegister("benchmark_savegame", ConSavegameBenchmark, nullptr, true);
+	IConsoleCmdRegister("benchmark_vehicle_lookup", ConVehicleLookupBenchmark, nullptr, true);
+	IConsoleCmdRegister("benchmark_map", ConMapBenchmark, nullptr, true);
+	IConsoleCmdRegister("benchmark_cargo_aging", ConCargoAgingBenchmark, nullptr, true);
+	IConsoleCmdRegister("benchmark_tgp", ConTgpBenchmark, nullptr, true);
+	IConsoleCmdRegister("benchmark_blitter", ConBlitterBenchmark, nullptr, true);
 	IConsoleCmdRegister("dump_map_stats", ConMapStats, nullptr, true);
 	IConsoleCmdRegister("dump_st_flow_stats", ConStFlowStats, nullptr, true);
 	IConsoleCmdRegister("dump_game_events", ConDumpGameEvents, nullptr, true);
@@ -88,7 +88,12 @@ uint64 ottd_rdtsc() {return 0;}
 #if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
 void ottd_cpuid(int info[4], int type)
 {
-	__cpuid(info, type);
+	__cpuidex(info, type, 0);
+}
+
+static uint64 ottd_xgetbv()
+{
+	return _xgetbv(0);
 }
 #elif defined(__x86_64__) || defined(__i386)
 void ottd_cpuid(int info[4], int type)
@@ -108,21 +113,38 @@ void ottd_cpuid(int info[4], int type)
 			/* It is safe to write "=r" for (info[1]) as in case that PIC is enabled for i386,
 			 * the compiler will not choose EBX as target register (but something else).
 			 */
-			: "a" (type)
+			: "a" (type), "c" (0)
 	);
 #else
 	__asm__ __volatile__ (
 			"cpuid           \n\t"
 			: "=a" (info[0]), "=b" (info[1]), "=c" (info[2]), "=d" (info[3])
-			: "a" (type)
+			: "a" (type), "c" (0)
 	);
 #endif /* i386 PIC */
 }
+
+static uint64 ottd_xgetbv()
+{
+	uint32 low, high;
+	/* xgetbv, spelled out for assemblers which do not know it */
+	__asm__ __volatile__ (
+			".byte 0x0f, 0x01, 0xd0 \n\t"
+			: "=a" (low), "=d" (high)
+			: "c" (0)
+	);
+	return ((uint64)high << 32) | low;
+}
 #else
 void ottd_cpuid(int info[4], int type)
 {
 	info[0] = info[1] = info[2] = info[3] = 0;
 }
+
+static uint64 ottd_xgetbv()
+{
+	return 0;
+}
 #endif
 
 bool HasCPUIDFlag(uint type, uint index, uint bit)
@@ -135,3 +157,28 @@ bool HasCPUIDFlag(uint type, uint index, uint bit)
 	ottd_cpuid(cpu_info, type);
 	return HasBit(cpu_info[index], bit);
 }
+
+/**
+ * Check whether the operating system saves the given extended register states on context switches.
+ * Without that, the instructions using these registers must not be used, even when the CPU has them.
+ * @param mask The bits of the extended control register XCR0 that all need to be set.
+ * @return True when the CPU has XGETBV and the OS enabled all the register states.
+ */
+static bool HasOSRegisterStates(uint64 mask)
+{
+	/* OSXSAVE: the OS enabled XSAVE and XGETBV. */
+	if (!HasCPUIDFlag(1, 2, 27)) return false;
+	return (ottd_xgetbv() & mask) == mask;
+}
+
+bool HasCPUAVX2Support()
+{
+	/* AVX and AVX2, with the SSE and AVX (YMM) register states. */
+	return HasCPUIDFlag(1, 2, 28) && HasCPUIDFlag(7, 1, 5) && HasOSRegisterStates(0x06);
+}
+
+bool HasCPUAVX512Support()
+{
+	/* AVX-512 F, BW and VL, with the opmask and ZMM register states too. */
+	return HasCPUAVX2Support() && HasCPUIDFlag(7, 1, 16) && HasCPUIDFlag(7, 1, 30) && HasCPUIDFlag(7, 1, 31) && HasOSRegisterStates(0xE6);
+}
@@ -32,4 +32,16 @@ void ottd_cpuid(int info[4], int type);
  */
 bool HasCPUIDFlag(uint type, uint index, uint bit);
 
+/**
+ * Check whether the current CPU and operating system support AVX2.
+ * @return True when AVX2 instructions can be used.
+ */
+bool HasCPUAVX2Support();
+
+/**
+ * Check whether the current CPU and operating system support the AVX-512 F, BW and VL instructions.
+ * @return True when these AVX-512 instructions can be used.
+ */
+bool HasCPUAVX512Support();
+
 #endif /* CPU_H */
@@ -38,6 +38,8 @@
 #include <set>
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <tuple>
 
 /* A cache of used departure time for scheduled dispatch in departure time calculation */
 typedef std::map<uint32, std::set<DateTicksScaled>> schdispatch_cache_t;
@@ -792,3 +794,121 @@ DepartureList* MakeDepartureList(StationID station, const std::vector<const Vehi
 	/* Done. Phew! */
 	return result;
 }
+
+/** Parameters of a departure list in the departure list cache. */
+struct DepartureListKey {
+	StationID station;      ///< The station of the departures.
+	uint8 vehicle_types;    ///< Bit mask of the vehicle types included.
+	DepartureType type;     ///< Departures or arrivals.
+	bool show_vehicles_via; ///< Whether to include vehicles passing via the station.
+	bool show_pax;          ///< Whether to include passenger vehicles.
+	bool show_freight;      ///< Whether to include freight vehicles.
+
+	bool operator<(const DepartureListKey &other) const
+	{
+		return std::tie(this->station, this->vehicle_types, this->type, this->show_vehicles_via, this->show_pax, this->show_freight) <
+				std::tie(other.station, other.vehicle_types, other.type, other.show_vehicles_via, other.show_pax, other.show_freight);
+	}
+};
+
+/** A departure list in the departure list cache. */
+struct DepartureListCacheEntry {
+	std::shared_ptr<const DepartureList> list; ///< The departure list.
+	DateTicksScaled built;                     ///< When the list was built.
+	bool valid;                                ///< Whether the list is still valid, apart from its age.
+};
+
+/** Departure lists by their parameters, shared by all departure boards. */
+static std::map<DepartureListKey, DepartureListCacheEntry> _departure_list_cache;
+/** Vehicles with orders to a station by station and bit mask of vehicle types, shared by all departure boards. */
+static std::map<std::pair<StationID, uint8>, std::shared_ptr<const std::vector<const Vehicle *>>> _departure_vehicles_cache;
+
+/**
+ * Delete a departure list including its departures.
+ * @param list The list to delete.
+ */
+static void DeleteDepartureList(const DepartureList *list)
+{
+	for (Departure *d : *list) delete d;
+	delete list;
+}
+
+/**
+ * Get the primary vehicles of some types with an order to a station.
+ * The list is shared by all callers, and kept until the orders of any vehicle change.
+ * @param station The station.
+ * @param vehicle_types Bit mask of the vehicle types to include.
+ * @return The vehicles.
+ */
+std::shared_ptr<const std::vector<const Vehicle *>> GetDepartureVehicles(StationID station, uint8 vehicle_types)
+{
+	std::shared_ptr<const std::vector<const Vehicle *>> &cached = _departure_vehicles_cache[std::make_pair(station, vehicle_types)];
+	/* A list which nobody holds may refer to vehicles deleted since, as it is not invalidated. See #InvalidateDepartureLists. */
+	if (cached != nullptr && cached.use_count() > 1) return cached;
+
+	std::vector<const Vehicle *> *vehicles = new std::vector<const Vehicle *>();
+	for (const Vehicle *v : Vehicle::Iterate()) {
+		if (v->type < 4 && HasBit(vehicle_types, v->type) && v->IsPrimaryVehicle()) {
+			const Order *order;
+
+			FOR_VEHICLE_ORDERS(v, order) {
+				if ((order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT) || order->IsType(OT_IMPLICIT))
+						&& order->GetDestination() == station) {
+					vehicles->push_back(v);
+					break;
+				}
+			}
+		}
+	}
+	cached.reset(vehicles);
+	return cached;
+}
+
+/**
+ * Get the departure list of a station.
+ * The list is shared by all callers with the same parameters. It is rebuilt when it has been invalidated,
+ * or when it is older than the departure calculation frequency, as the vehicles progress.
+ * @param station The station.
+ * @param vehicle_types Bit mask of the vehicle types to include.
+ * @param type Departures or arrivals.
+ * @param show_vehicles_via Whether to include vehicles passing via the station.
+ * @param show_pax Whether to include passenger vehicles.
+ * @param show_freight Whether to include freight vehicles.
+ * @return The departure list.
+ */
+std::shared_ptr<const DepartureList> GetDepartureList(StationID station, uint8 vehicle_types, DepartureType type, bool show_vehicles_via, bool show_pax, bool show_freight)
+{
+	DepartureListCacheEntry &entry = _departure_list_cache[{ station, vehicle_types, type, show_vehicles_via, show_pax, show_freight }];
+
+	/* A list which nobody holds may refer to vehicles deleted since, as it is not invalidated. */
+	if (entry.list != nullptr && entry.valid && entry.list.use_count() > 1 &&
+			_scaled_date_ticks - entry.built < (DateTicksScaled)_settings_client.gui.departure_calc_frequency) {
+		return entry.list;
+	}
+
+	std::shared_ptr<const std::vector<const Vehicle *>> vehicles = GetDepartureVehicles(station, vehicle_types);
+	entry.list.reset(MakeDepartureList(station, *vehicles, type, show_vehicles_via, show_pax, show_freight), DeleteDepartureList);
+	entry.built = _scaled_date_ticks;
+	entry.valid = true;
+	return entry.list;
+}
+
+/**
+ * Invalidate the cached departure lists, because the orders, timetables or schedules of some vehicles changed.
+ * Lists which are not held by anyone are freed.
+ * The departure boards call this when their data is invalidated, which happens whenever orders change or vehicles are deleted.
+ * Hence lists held by a board are always invalidated in time, and lists not held by anyone are rebuilt on their next use.
+ * @param vehicles Whether the vehicles with orders to the stations may have changed as well.
+ */
+void InvalidateDepartureLists(bool vehicles)
+{
+	for (auto it = _departure_list_cache.begin(); it != _departure_list_cache.end();) {
+		if (it->second.list.use_count() <= 1) {
+			it = _departure_list_cache.erase(it);
+		} else {
+			it->second.valid = false;
+			++it;
+		}
+	}
+	if (vehicles) _departure_vehicles_cache.clear();
+}
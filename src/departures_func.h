@@ -17,8 +17,14 @@
 #include "departures_type.h"
 
 #include <vector>
+#include <memory>
 
 DepartureList* MakeDepartureList(StationID station, const std::vector<const Vehicle *> &vehicles, DepartureType type = D_DEPARTURE,
 		bool show_vehicles_via = false, bool show_pax = true, bool show_freight = true);
 
+std::shared_ptr<const std::vector<const Vehicle *>> GetDepartureVehicles(StationID station, uint8 vehicle_types);
+std::shared_ptr<const DepartureList> GetDepartureList(StationID station, uint8 vehicle_types, DepartureType type = D_DEPARTURE,
+		bool show_vehicles_via = false, bool show_pax = true, bool show_freight = true);
+void InvalidateDepartureLists(bool vehicles);
+
 #endif /* DEPARTURES_FUNC_H */
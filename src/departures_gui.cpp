@@ -88,11 +88,11 @@ template<bool Twaypoint = false>
 struct DeparturesWindow : public Window {
 protected:
 	StationID station;         ///< The station whose departures we're showing.
-	DepartureList *departures; ///< The current list of departures from this station.
-	DepartureList *arrivals;   ///< The current list of arrivals from this station.
+	std::shared_ptr<const DepartureList> departures; ///< The current list of departures from this station, shared with other windows.
+	std::shared_ptr<const DepartureList> arrivals;   ///< The current list of arrivals from this station, shared with other windows.
 	uint entry_height;         ///< The height of an entry in the departures list.
 	uint tick_count;           ///< The number of ticks that have elapsed since the window was created. Used for scrolling text.
-	int calc_tick_countdown;   ///< The number of ticks to wait until recomputing the departure list. Signed in case it goes below zero.
+	int calc_tick_countdown;   ///< The number of ticks to wait until fetching the departure list again. Signed in case it goes below zero.
 	bool show_types[4];        ///< The vehicle types to show in the departure list.
 	bool departure_types[3];   ///< The types of departure to show in the departure list.
 	bool show_pax;             ///< Show passenger vehicles
@@ -100,7 +100,7 @@ protected:
 	bool cargo_buttons_disabled;///< Show pax/freight buttons disabled
 	uint min_width;            ///< The minimum width of this window.
 	Scrollbar *vscroll;
-	std::vector<const Vehicle *> vehicles; /// current set of vehicles
+	std::shared_ptr<const std::vector<const Vehicle *>> vehicles; /// current set of vehicles, shared with other windows
 	int veh_width;                         /// current width of vehicle field
 	int group_width;                       /// current width of group field
 	int toc_width;                         /// current width of company field
@@ -108,7 +108,19 @@ protected:
 	virtual uint GetMinWidth() const;
 	static void RecomputeDateWidth();
 	virtual void DrawDeparturesListItems(const Rect &r) const;
-	void DeleteDeparturesList(DepartureList* list);
+
+	/**
+	 * Get the vehicle types to show in the departure list.
+	 * @return Bit mask of the vehicle types.
+	 */
+	uint8 GetVehicleTypes() const
+	{
+		uint8 vehicle_types = 0;
+		for (uint i = 0; i < 4; i++) {
+			if (this->show_types[i]) SetBit(vehicle_types, i);
+		}
+		return vehicle_types;
+	}
 
 	void ToggleCargoFilter(int widget, bool &flag)
 	{
@@ -135,7 +147,7 @@ protected:
 
 	void FillVehicleList()
 	{
-		this->vehicles.clear();
+		this->vehicles = GetDepartureVehicles(this->station, this->GetVehicleTypes());
 		this->veh_width = 0;
 		this->group_width = 0;
 		this->toc_width = 0;
@@ -144,32 +156,20 @@ protected:
 		CompanyMask companies = 0;
 		int unitnumber_max[4] = { -1, -1, -1, -1 };
 
-		for (const Vehicle *v : Vehicle::Iterate()) {
-			if (v->type < 4 && this->show_types[v->type] && v->IsPrimaryVehicle()) {
-				const Order *order;
-
-				FOR_VEHICLE_ORDERS(v, order) {
-					if ((order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT) || order->IsType(OT_IMPLICIT))
-							&& order->GetDestination() == this->station) {
-						this->vehicles.push_back(v);
-
-						if (v->name == nullptr) {
-							if (v->unitnumber > unitnumber_max[v->type]) unitnumber_max[v->type] = v->unitnumber;
-						} else {
-							SetDParam(0, (uint64)(v->index));
-							int width = (GetStringBoundingBox(STR_DEPARTURES_VEH)).width;
-							if (width > this->veh_width) this->veh_width = width;
-						}
-
-						if (v->group_id != INVALID_GROUP && v->group_id != DEFAULT_GROUP) {
-							groups.insert(v->group_id);
-						}
+		for (const Vehicle *v : *this->vehicles) {
+			if (v->name == nullptr) {
+				if (v->unitnumber > unitnumber_max[v->type]) unitnumber_max[v->type] = v->unitnumber;
+			} else {
+				SetDParam(0, (uint64)(v->index));
+				int width = (GetStringBoundingBox(STR_DEPARTURES_VEH)).width;
+				if (width > this->veh_width) this->veh_width = width;
+			}
 
-						SetBit(companies, v->owner);
-						break;
-					}
-				}
+			if (v->group_id != INVALID_GROUP && v->group_id != DEFAULT_GROUP) {
+				groups.insert(v->group_id);
 			}
+
+			SetBit(companies, v->owner);
 		}
 
 		for (uint i = 0; i < 4; i++) {
@@ -211,8 +211,8 @@ public:
 
 	DeparturesWindow(WindowDesc *desc, WindowNumber window_number) : Window(desc),
 		station(window_number),
-		departures(new DepartureList()),
-		arrivals(new DepartureList()),
+		departures(std::make_shared<DepartureList>()),
+		arrivals(std::make_shared<DepartureList>()),
 		entry_height(1 + FONT_HEIGHT_NORMAL + 1 + (_settings_client.gui.departure_larger_font ? FONT_HEIGHT_NORMAL : FONT_HEIGHT_SMALL) + 1 + 1),
 		tick_count(0),
 		calc_tick_countdown(0),
@@ -265,12 +265,6 @@ public:
 		if (_pause_mode != PM_UNPAUSED) this->OnGameTick();
 	}
 
-	virtual ~DeparturesWindow()
-	{
-		this->DeleteDeparturesList(departures);
-		this->DeleteDeparturesList(this->arrivals);
-	}
-
 	virtual void UpdateWidgetSize(int widget, Dimension *size, const Dimension &padding, Dimension *fill, Dimension *resize) override
 	{
 		switch (widget) {
@@ -436,12 +430,11 @@ public:
 		/* Recompute the list of departures if we're due to. */
 		if (this->calc_tick_countdown <= 0) {
 			this->calc_tick_countdown = _settings_client.gui.departure_calc_frequency;
-			this->DeleteDeparturesList(this->departures);
-			this->DeleteDeparturesList(this->arrivals);
 			bool show_pax = _settings_client.gui.departure_only_passengers ? true : this->show_pax;
 			bool show_freight = _settings_client.gui.departure_only_passengers ? false : this->show_freight;
-			this->departures = (this->departure_types[0] ? MakeDepartureList(this->station, this->vehicles, D_DEPARTURE, Twaypoint || this->departure_types[2], show_pax, show_freight) : new DepartureList());
-			this->arrivals   = (this->departure_types[1] && !_settings_client.gui.departure_show_both ? MakeDepartureList(this->station, this->vehicles, D_ARRIVAL, false, show_pax, show_freight) : new DepartureList());
+			uint8 vehicle_types = this->GetVehicleTypes();
+			this->departures = (this->departure_types[0] ? GetDepartureList(this->station, vehicle_types, D_DEPARTURE, Twaypoint || this->departure_types[2], show_pax, show_freight) : std::make_shared<DepartureList>());
+			this->arrivals   = (this->departure_types[1] && !_settings_client.gui.departure_show_both ? GetDepartureList(this->station, vehicle_types, D_ARRIVAL, false, show_pax, show_freight) : std::make_shared<DepartureList>());
 			this->SetWidgetDirty(WID_DB_LIST);
 		}
 
@@ -499,6 +492,12 @@ public:
 	 */
 	void OnInvalidateData(int data = 0, bool gui_scope = true) override
 	{
+		/* The shared lists are invalidated immediately, as they may refer to deleted vehicles.
+		 * They are rebuilt in GUI scope, once for all windows. */
+		if (!gui_scope) {
+			InvalidateDepartureLists(true);
+			return;
+		}
 		this->RefreshVehicleList();
 	}
 };
@@ -570,23 +569,6 @@ uint DeparturesWindow<Twaypoint>::GetMinWidth() const
 	return result + 140;
 }
 
-/**
- * Deletes this window's departure list.
- */
-template<bool Twaypoint>
-void DeparturesWindow<Twaypoint>::DeleteDeparturesList(DepartureList *list)
-{
-	/* SmallVector uses free rather than delete on its contents (which doesn't invoke the destructor), so we need to delete each departure manually. */
-	for (uint i = 0; i < list->size(); ++i) {
-		Departure **d = &(*list)[i];
-		delete *d;
-		/* Make sure a double free doesn't happen. */
-		*d = nullptr;
-	}
-	delete list;
-	list = nullptr;
-}
-
 /**
  * Draws a list of departures.
  */
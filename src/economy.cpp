@@ -509,10 +509,15 @@ void ChangeOwnershipOfCompanyItems(Owner old_owner, Owner new_owner)
 
 	/*  Change ownership of tiles */
 	{
-		TileIndex tile = 0;
-		do {
-			ChangeTileOwner(tile, old_owner, new_owner);
-		} while (++tile != MapSize());
+		/* Clear land, trees, houses and void tiles have no owner, water and objects have a single owner.
+		 * Only look at the tiles for which the owner change can do anything. */
+		const uint16 skip_types = (1 << MP_CLEAR) | (1 << MP_TREES) | (1 << MP_HOUSE) | (1 << MP_VOID);
+		const uint16 owner_types = (1 << MP_WATER) | (1 << MP_OBJECT);
+		TileIndex tiles[256];
+		for (TileIndex begin = 0; begin < MapSize(); begin += lengthof(tiles)) {
+			uint count = FindOwnedMapTiles(begin, lengthof(tiles), skip_types, owner_types, old_owner, tiles);
+			for (uint i = 0; i < count; i++) ChangeTileOwner(tiles[i], old_owner, new_owner);
+		}
 
 		if (new_owner != INVALID_OWNER) {
 			/* Update all signals because there can be new segment that was owned by two companies
@@ -43,15 +43,17 @@ struct Fio {
 	FILE *cur_fh;                          ///< current file handle
 	const char *filename;                  ///< current filename
 	FILE *handles[MAX_FILE_SLOTS];         ///< array of file handles we can have open
-	const char *filenames[MAX_FILE_SLOTS]; ///< array of filenames we (should) have open
+	char *filenames[MAX_FILE_SLOTS];       ///< array of filenames we (should) have open
 	char *shortnames[MAX_FILE_SLOTS];      ///< array of short names for spriteloader's use
+	Subdirectory subdirs[MAX_FILE_SLOTS];  ///< array of sub directories the files were opened from
 #if defined(LIMITED_FDS)
 	uint open_handles;                     ///< current amount of open handles
 	uint usage_count[MAX_FILE_SLOTS];      ///< count how many times this file has been opened
 #endif /* LIMITED_FDS */
 };
 
-static Fio _fio; ///< #Fio instance.
+static Fio _fio; ///< #Fio instance of the main thread, owning the slotted files.
+static thread_local Fio *_fio_current = &_fio; ///< #Fio instance the read functions of the current thread use, see #FioThreadReadScope.
 
 /** Whether the working directory should be scanned. */
 static bool _do_scan_working_directory = true;
@@ -65,7 +67,7 @@ extern char *_highscore_file;
  */
 size_t FioGetPos()
 {
-	return _fio.pos + (_fio.buffer - _fio.buffer_end);
+	return _fio_current->pos + (_fio_current->buffer - _fio_current->buffer_end);
 }
 
 /**
@@ -85,11 +87,12 @@ const char *FioGetFilename(uint slot)
  */
 void FioSeekTo(size_t pos, int mode)
 {
+	Fio &fio = *_fio_current;
 	if (mode == SEEK_CUR) pos += FioGetPos();
-	_fio.buffer = _fio.buffer_end = _fio.buffer_start + FIO_BUFFER_SIZE;
-	_fio.pos = pos;
-	if (fseek(_fio.cur_fh, _fio.pos, SEEK_SET) < 0) {
-		DEBUG(misc, 0, "Seeking in %s failed", _fio.filename);
+	fio.buffer = fio.buffer_end = fio.buffer_start + FIO_BUFFER_SIZE;
+	fio.pos = pos;
+	if (fseek(fio.cur_fh, fio.pos, SEEK_SET) < 0) {
+		DEBUG(misc, 0, "Seeking in %s failed", fio.filename);
 	}
 }
 
@@ -112,15 +115,21 @@ static void FioRestoreFile(int slot)
  */
 void FioSeekToFile(uint slot, size_t pos)
 {
+	Fio &fio = *_fio_current;
 	FILE *f;
 #if defined(LIMITED_FDS)
 	/* Make sure we have this file open */
 	FioRestoreFile(slot);
 #endif /* LIMITED_FDS */
-	f = _fio.handles[slot];
+	f = fio.handles[slot];
+	if (f == nullptr && &fio != &_fio && _fio.handles[slot] != nullptr) {
+		/* Reading on behalf of another thread, open our own handle to the file in the main thread's slot. */
+		f = FioFOpenFile(_fio.filenames[slot], "rb", _fio.subdirs[slot]);
+		fio.handles[slot] = f;
+	}
 	assert(f != nullptr);
-	_fio.cur_fh = f;
-	_fio.filename = _fio.filenames[slot];
+	fio.cur_fh = f;
+	fio.filename = _fio.filenames[slot];
 	FioSeekTo(pos, SEEK_SET);
 }
 
@@ -130,15 +139,16 @@ void FioSeekToFile(uint slot, size_t pos)
  */
 byte FioReadByte()
 {
-	if (_fio.buffer == _fio.buffer_end) {
-		_fio.buffer = _fio.buffer_start;
-		size_t size = fread(_fio.buffer, 1, FIO_BUFFER_SIZE, _fio.cur_fh);
-		_fio.pos += size;
-		_fio.buffer_end = _fio.buffer_start + size;
+	Fio &fio = *_fio_current;
+	if (fio.buffer == fio.buffer_end) {
+		fio.buffer = fio.buffer_start;
+		size_t size = fread(fio.buffer, 1, FIO_BUFFER_SIZE, fio.cur_fh);
+		fio.pos += size;
+		fio.buffer_end = fio.buffer_start + size;
 
 		if (size == 0) return 0;
 	}
-	return *_fio.buffer++;
+	return *fio.buffer++;
 }
 
 /**
@@ -147,9 +157,10 @@ byte FioReadByte()
  */
 void FioSkipBytes(int n)
 {
+	Fio &fio = *_fio_current;
 	for (;;) {
-		int m = min(_fio.buffer_end - _fio.buffer, n);
-		_fio.buffer += m;
+		int m = min(fio.buffer_end - fio.buffer, n);
+		fio.buffer += m;
 		n -= m;
 		if (n == 0) break;
 		FioReadByte();
@@ -185,7 +196,7 @@ uint32 FioReadDword()
 void FioReadBlock(void *ptr, size_t size)
 {
 	FioSeekTo(FioGetPos(), SEEK_SET);
-	_fio.pos += fread(ptr, 1, size, _fio.cur_fh);
+	_fio_current->pos += fread(ptr, 1, size, _fio_current->cur_fh);
 }
 
 /**
@@ -197,6 +208,9 @@ static inline void FioCloseFile(int slot)
 	if (_fio.handles[slot] != nullptr) {
 		fclose(_fio.handles[slot]);
 
+		free(_fio.filenames[slot]);
+		_fio.filenames[slot] = nullptr;
+
 		free(_fio.shortnames[slot]);
 		_fio.shortnames[slot] = nullptr;
 
@@ -215,6 +229,27 @@ void FioCloseAll()
 	}
 }
 
+/**
+ * Start reading the slotted files from the current (non-main) thread.
+ * The thread gets its own buffer and opens its own handles to the files on first use.
+ */
+FioThreadReadScope::FioThreadReadScope()
+{
+	assert(_fio_current == &_fio);
+	this->fio = new Fio();
+	_fio_current = this->fio;
+}
+
+/** Stop reading the slotted files from the current thread, and close the handles it opened. */
+FioThreadReadScope::~FioThreadReadScope()
+{
+	for (uint i = 0; i != lengthof(this->fio->handles); i++) {
+		if (this->fio->handles[i] != nullptr) fclose(this->fio->handles[i]);
+	}
+	delete this->fio;
+	_fio_current = &_fio;
+}
+
 #if defined(LIMITED_FDS)
 static void FioFreeHandle()
 {
@@ -259,7 +294,9 @@ void FioOpenFile(uint slot, const char *filename, Subdirectory subdir, char **ou
 
 	FioCloseFile(slot); // if file was opened before, close it
 	_fio.handles[slot] = f;
-	_fio.filenames[slot] = filename;
+	/* Keep a copy of the name, so other threads can open the file again later on. */
+	_fio.filenames[slot] = stredup(filename);
+	_fio.subdirs[slot] = subdir;
 
 	/* Store the filename without path and extension */
 	const char *t = strrchr(filename, PATHSEPCHAR);
@@ -25,6 +25,19 @@ void FioOpenFile(uint slot, const char *filename, Subdirectory subdir, char **ou
 void FioReadBlock(void *ptr, size_t size);
 void FioSkipBytes(int n);
 
+/**
+ * Scope in which the Fio read functions of the current thread use their own buffer and file handles.
+ * This allows reading the slotted files of the main thread from another thread, as long as
+ * the main thread does not open or close the slotted files in the meantime.
+ */
+class FioThreadReadScope {
+	struct Fio *fio; ///< Reader state of this thread.
+
+public:
+	FioThreadReadScope();
+	~FioThreadReadScope();
+};
+
 /**
  * The search paths OpenTTD could search through.
  * At least one of the slots has to be filled with a path.
@@ -17,12 +17,18 @@
 #include "strings_func.h"
 #include "console_func.h"
 #include "console_type.h"
+#include "console_internal.h"
 #include "guitimer_func.h"
 #include "company_base.h"
 #include "ai/ai_info.hpp"
 #include "ai/ai_instance.hpp"
 #include "game/game.hpp"
 #include "game/game_instance.hpp"
+#include "date_func.h"
+#include "fileio_func.h"
+#include "settings_type.h"
+#include "debug.h"
+#include <vector>
 
 #include "widgets/framerate_widget.h"
 #include "safeguards.h"
@@ -1076,3 +1082,224 @@ void ConPrintFramerate()
 		IConsoleWarning("No performance measurements have been taken yet");
 	}
 }
+
+
+/**
+ * Private declarations of the tick profiler implementation
+ */
+namespace {
+
+	/** Default number of ticks kept by the tick profiler */
+	const uint TICK_PROFILE_DEFAULT_TICKS = 64;
+	/** Maximum number of events recorded in a single tick, further events are counted but dropped */
+	const uint TICK_PROFILE_MAX_EVENTS = 1 << 16;
+
+	/** A recorded scope */
+	struct TickProfileEvent {
+		const char *name;         ///< Name of the scope.
+		TimingMeasurement start;  ///< Start time of the scope.
+		TimingMeasurement end;    ///< End time of the scope.
+	};
+
+	/** A recorded tick */
+	struct TickProfileTick {
+		DateTicksScaled date_ticks;            ///< Scaled date ticks at the start of the tick.
+		TimingMeasurement start;               ///< Start time of the tick.
+		TimingMeasurement end;                 ///< End time of the tick.
+		uint dropped;                          ///< Number of events which did not fit.
+		std::vector<TickProfileEvent> events;  ///< Recorded scopes, in order of their start.
+	};
+
+	/** Ring buffer of the recorded ticks, empty when the profiler is not running */
+	std::vector<TickProfileTick> _tick_profile;
+	/** Index in #_tick_profile of the next tick to record */
+	uint _tick_profile_next = 0;
+	/** Number of valid ticks in #_tick_profile */
+	uint _tick_profile_valid = 0;
+	/** Number of ticks to record before a slow tick may cause another automatic dump */
+	uint _tick_profile_dump_holdoff = 0;
+}
+
+/* static */ thread_local bool TickProfilerScope::recording = false;
+
+/**
+ * Record the start of a scope.
+ * @param name Name of the scope.
+ */
+void TickProfilerScope::Begin(const char *name)
+{
+	TickProfileTick &tick = _tick_profile[_tick_profile_next];
+	if (tick.events.size() >= TICK_PROFILE_MAX_EVENTS) {
+		tick.dropped++;
+		return;
+	}
+	this->event = (uint32)tick.events.size();
+	TimingMeasurement now = GetPerformanceTimer();
+	tick.events.push_back({ name, now, now });
+}
+
+/** Record the end of a scope. */
+void TickProfilerScope::End()
+{
+	/* The profiler may have been stopped by the scope, e.g. by a console command. */
+	if (!recording) return;
+	_tick_profile[_tick_profile_next].events[this->event].end = GetPerformanceTimer();
+}
+
+/**
+ * Start the tick profiler, discarding any previously recorded ticks.
+ * @param ticks Number of ticks to keep.
+ */
+static void TickProfilerStart(uint ticks)
+{
+	TickProfilerScope::recording = false;
+	_tick_profile.clear();
+	_tick_profile.resize(max<uint>(ticks, 1));
+	_tick_profile_next = 0;
+	_tick_profile_valid = 0;
+	_tick_profile_dump_holdoff = 0;
+}
+
+/** Stop the tick profiler and free the recorded ticks. */
+static void TickProfilerStop()
+{
+	TickProfilerScope::recording = false;
+	_tick_profile.clear();
+	_tick_profile.shrink_to_fit();
+	_tick_profile_next = 0;
+	_tick_profile_valid = 0;
+}
+
+/**
+ * Write the recorded ticks as Chrome trace event JSON, which can be opened in chrome://tracing or Perfetto.
+ * @param filename Name of the file to write.
+ * @return Whether the file could be written.
+ */
+static bool TickProfilerDump(const char *filename)
+{
+	FILE *f = FioFOpenFile(filename, "w", NO_DIRECTORY);
+	if (f == nullptr) return false;
+
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+	bool first = true;
+	const uint count = (uint)_tick_profile.size();
+	for (uint i = 0; i < _tick_profile_valid; i++) {
+		const TickProfileTick &tick = _tick_profile[(_tick_profile_next + count - _tick_profile_valid + i) % count];
+		fprintf(f, "%s{\"name\":\"Tick\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" OTTD_PRINTF64U ",\"dur\":" OTTD_PRINTF64U ",\"args\":{\"date_ticks\":" OTTD_PRINTF64 ",\"dropped_events\":%u}}",
+				first ? "" : ",\n", tick.start, tick.end - tick.start, tick.date_ticks, tick.dropped);
+		first = false;
+		for (const TickProfileEvent &ev : tick.events) {
+			fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" OTTD_PRINTF64U ",\"dur\":" OTTD_PRINTF64U "}",
+					ev.name, ev.start, ev.end - ev.start);
+		}
+	}
+	fputs("\n]}\n", f);
+
+	bool ok = ferror(f) == 0;
+	FioFCloseFile(f);
+	return ok;
+}
+
+/**
+ * Begin recording a tick of the game loop, when the tick profiler is running.
+ * The profiler is started automatically when slow ticks should be dumped.
+ */
+void TickProfilerBeginTick()
+{
+	if (_tick_profile.empty()) {
+		if (_settings_client.gui.tick_profiler_slow_tick_ms == 0) return;
+		TickProfilerStart(TICK_PROFILE_DEFAULT_TICKS);
+	}
+
+	TickProfileTick &tick = _tick_profile[_tick_profile_next];
+	tick.date_ticks = _scaled_date_ticks;
+	tick.dropped = 0;
+	tick.events.clear();
+	tick.start = GetPerformanceTimer();
+	tick.end = tick.start;
+	TickProfilerScope::recording = true;
+}
+
+/**
+ * Finish recording a tick of the game loop.
+ * When the tick took longer than the slow tick threshold, the recorded ticks are dumped to the personal directory.
+ */
+void TickProfilerEndTick()
+{
+	if (!TickProfilerScope::recording) return;
+	TickProfilerScope::recording = false;
+
+	TickProfileTick &tick = _tick_profile[_tick_profile_next];
+	tick.end = GetPerformanceTimer();
+	_tick_profile_next = (_tick_profile_next + 1) % _tick_profile.size();
+	_tick_profile_valid = min<uint>(_tick_profile_valid + 1, (uint)_tick_profile.size());
+
+	if (_tick_profile_dump_holdoff > 0) {
+		_tick_profile_dump_holdoff--;
+		return;
+	}
+
+	const uint threshold = _settings_client.gui.tick_profiler_slow_tick_ms;
+	if (threshold == 0 || tick.end - tick.start < (TimingMeasurement)threshold * TIMESTAMP_PRECISION / 1000) return;
+
+	/* Do not dump again until the ticks of this dump have left the ring buffer. */
+	_tick_profile_dump_holdoff = (uint)_tick_profile.size();
+
+	char filename[MAX_PATH];
+	seprintf(filename, lastof(filename), "%stick_profile_" OTTD_PRINTF64 ".json", _personal_dir, tick.date_ticks);
+	if (TickProfilerDump(filename)) {
+		DEBUG(misc, 0, "Slow tick of %.2fms, tick profile written to %s", (double)(tick.end - tick.start) * 1000 / TIMESTAMP_PRECISION, filename);
+	} else {
+		DEBUG(misc, 0, "Slow tick of %.2fms, writing tick profile to %s failed", (double)(tick.end - tick.start) * 1000 / TIMESTAMP_PRECISION, filename);
+	}
+}
+
+/**
+ * Handle the arguments of the tick_profile console command.
+ * @param argc Number of arguments.
+ * @param argv Arguments, the first is the name of the command.
+ * @return Whether the arguments were valid.
+ */
+bool TickProfilerConsoleCommand(byte argc, char *argv[])
+{
+	if (argc >= 2 && strcmp(argv[1], "start") == 0 && argc <= 3) {
+		uint ticks = TICK_PROFILE_DEFAULT_TICKS;
+		if (argc == 3 && (!GetArgumentInteger(&ticks, argv[2]) || ticks == 0)) return false;
+		TickProfilerStart(ticks);
+		IConsolePrintF(CC_DEFAULT, "Tick profiler started, keeping the last %u ticks", ticks);
+		return true;
+	}
+	if (argc == 2 && strcmp(argv[1], "stop") == 0) {
+		TickProfilerStop();
+		IConsolePrint(CC_DEFAULT, "Tick profiler stopped");
+		if (_settings_client.gui.tick_profiler_slow_tick_ms != 0) IConsoleWarning("The profiler restarts on the next tick, as tick_profiler_slow_tick_ms is set");
+		return true;
+	}
+	if (argc >= 2 && strcmp(argv[1], "dump") == 0 && argc <= 3) {
+		if (_tick_profile_valid == 0) {
+			IConsoleError("No ticks have been profiled yet");
+			return true;
+		}
+		char filename[MAX_PATH];
+		if (argc == 3) {
+			strecpy(filename, argv[2], lastof(filename));
+		} else {
+			seprintf(filename, lastof(filename), "%stick_profile.json", _personal_dir);
+		}
+		if (TickProfilerDump(filename)) {
+			IConsolePrintF(CC_DEFAULT, "Tick profile of %u ticks written to %s", _tick_profile_valid, filename);
+		} else {
+			IConsolePrintF(CC_ERROR, "Writing tick profile to %s failed", filename);
+		}
+		return true;
+	}
+	if (argc == 1 || (argc == 2 && strcmp(argv[1], "status") == 0)) {
+		if (_tick_profile.empty()) {
+			IConsolePrint(CC_DEFAULT, "Tick profiler not running");
+		} else {
+			IConsolePrintF(CC_DEFAULT, "Tick profiler running, %u of %u ticks recorded", _tick_profile_valid, (uint)_tick_profile.size());
+		}
+		return true;
+	}
+	return false;
+}
@@ -120,6 +120,54 @@ public:
 	static void Reset(PerformanceElement elem);
 };
 
+/**
+ * RAII class for recording a nested scope of the game loop in the tick profiler.
+ * Do not use it directly, use #TICK_PROFILE_SCOPE instead, so the profiler can be compiled out.
+ *
+ * Scopes are only recorded on the game loop thread, while the profiler is running.
+ * Otherwise constructing an object costs a single check of a thread local flag.
+ */
+class TickProfilerScope {
+	uint32 event; ///< Index of the event of this scope in the current tick, or \c UINT32_MAX when it is not recorded.
+
+	void Begin(const char *name);
+	void End();
+
+public:
+	static thread_local bool recording; ///< Whether scopes of this thread are being recorded.
+
+	/**
+	 * Begin a scope.
+	 * @param name Name of the scope, must be a string literal without quotes or backslashes.
+	 */
+	inline TickProfilerScope(const char *name) : event(UINT32_MAX)
+	{
+		if (recording) this->Begin(name);
+	}
+
+	/** End the scope. */
+	inline ~TickProfilerScope()
+	{
+		if (this->event != UINT32_MAX) this->End();
+	}
+};
+
+#ifdef NO_TICK_PROFILER
+#	define TICK_PROFILE_SCOPE(name)
+#else
+#	define TICK_PROFILE_SCOPE_NAME2(line) tick_profile_scope_ ## line
+#	define TICK_PROFILE_SCOPE_NAME(line) TICK_PROFILE_SCOPE_NAME2(line)
+/**
+ * Record the rest of the enclosing block as a scope in the tick profiler.
+ * Defining \c NO_TICK_PROFILER removes all scopes at compile time.
+ * @param name Name of the scope, must be a string literal without quotes or backslashes.
+ */
+#	define TICK_PROFILE_SCOPE(name) TickProfilerScope TICK_PROFILE_SCOPE_NAME(__LINE__)(name)
+#endif /* NO_TICK_PROFILER */
+
+void TickProfilerBeginTick();
+void TickProfilerEndTick();
+
 void ShowFramerateWindow();
 
 #endif /* FRAMERATE_TYPE_H */
@@ -40,6 +40,7 @@
 	}
 
 	PerformanceMeasurer framerate(PFE_GAMESCRIPT);
+	TICK_PROFILE_SCOPE("GameScript");
 
 	Game::frame_counter++;
 
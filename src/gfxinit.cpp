@@ -337,6 +337,9 @@ static bool SwitchNewGRFBlitter()
 	const bool animation_wanted = HasBit(_display_opt, DO_FULL_ANIMATION);
 	const char *cur_blitter = BlitterFactory::GetCurrentBlitter()->GetName();
 
+	/* Sprites being decoded in the background use the current blitter. */
+	DiscardPrefetchedSprites();
+
 	VideoDriver::GetInstance()->AcquireBlitterLock();
 	auto guard = scope_guard([&]() {
 		VideoDriver::GetInstance()->ReleaseBlitterLock();
@@ -552,14 +552,17 @@ static bool TransportIndustryGoods(TileIndex tile)
 	return moved_cargo;
 }
 
-
-void AnimateTile_Industry(TileIndex tile)
+/**
+ * Animate an industry tile.
+ * @param tile The tile to animate.
+ * @return The animation speed to schedule the tile with, see #AnimateTileProc.
+ */
+uint8 AnimateTile_Industry(TileIndex tile)
 {
 	IndustryGfx gfx = GetIndustryGfx(tile);
 
 	if (GetIndustryTileSpec(gfx)->animation.status != ANIM_STATUS_NO_ANIMATION) {
-		AnimateNewIndustryTile(tile);
-		return;
+		return AnimateNewIndustryTile(tile);
 	}
 
 	switch (gfx) {
@@ -582,7 +585,7 @@ void AnimateTile_Industry(TileIndex tile)
 
 			MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 		}
-		break;
+		return 1;
 
 	case GFX_TOFFEE_QUARY:
 		if ((_scaled_tick_counter & 3) == 0) {
@@ -600,7 +603,7 @@ void AnimateTile_Industry(TileIndex tile)
 
 			MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 		}
-		break;
+		return 2;
 
 	case GFX_BUBBLE_CATCHER:
 		if ((_scaled_tick_counter & 1) == 0) {
@@ -614,7 +617,7 @@ void AnimateTile_Industry(TileIndex tile)
 
 			MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 		}
-		break;
+		return 1;
 
 	/* Sparks on a coal plant */
 	case GFX_POWERPLANT_SPARKS:
@@ -628,7 +631,7 @@ void AnimateTile_Industry(TileIndex tile)
 				MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 			}
 		}
-		break;
+		return 2;
 
 	case GFX_TOY_FACTORY:
 		if ((_scaled_tick_counter & 1) == 0) {
@@ -653,7 +656,7 @@ void AnimateTile_Industry(TileIndex tile)
 			SetAnimationFrame(tile, m);
 			MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 		}
-		break;
+		return 1;
 
 	case GFX_PLASTIC_FOUNTAIN_ANIMATED_1: case GFX_PLASTIC_FOUNTAIN_ANIMATED_2:
 	case GFX_PLASTIC_FOUNTAIN_ANIMATED_3: case GFX_PLASTIC_FOUNTAIN_ANIMATED_4:
@@ -666,7 +669,7 @@ void AnimateTile_Industry(TileIndex tile)
 			SetIndustryGfx(tile, gfx);
 			MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 		}
-		break;
+		return 2;
 
 	case GFX_OILWELL_ANIMATED_1:
 	case GFX_OILWELL_ANIMATED_2:
@@ -686,14 +689,14 @@ void AnimateTile_Industry(TileIndex tile)
 				MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 			}
 		}
-		break;
+		return 3;
 
 	case GFX_COAL_MINE_TOWER_ANIMATED:
 	case GFX_COPPER_MINE_TOWER_ANIMATED:
 	case GFX_GOLD_MINE_TOWER_ANIMATED: {
 			int state = _scaled_tick_counter & 0x7FF;
 
-			if ((state -= 0x400) < 0) return;
+			if ((state -= 0x400) < 0) return 0;
 
 			if (state < 0x1A0) {
 				if (state < 0x20 || state >= 0x180) {
@@ -702,9 +705,9 @@ void AnimateTile_Industry(TileIndex tile)
 						SetAnimationFrame(tile, m | 0x40);
 						if (_settings_client.sound.ambient) SndPlayTileFx(SND_0B_MINING_MACHINERY, tile);
 					}
-					if (state & 7) return;
+					if (state & 7) return 0;
 				} else {
-					if (state & 3) return;
+					if (state & 3) return 0;
 				}
 				byte m = (GetAnimationFrame(tile) + 1) | 0x40;
 				if (m > 0xC2) m = 0xC0;
@@ -712,16 +715,18 @@ void AnimateTile_Industry(TileIndex tile)
 				MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 			} else if (state >= 0x200 && state < 0x3A0) {
 				int i = (state < 0x220 || state >= 0x380) ? 7 : 3;
-				if (state & i) return;
+				if (state & i) return 0;
 
 				byte m = (GetAnimationFrame(tile) & 0xBF) - 1;
 				if (m < 0x80) m = 0x82;
 				SetAnimationFrame(tile, m);
 				MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 			}
-			break;
+			return 0;
 		}
 	}
+
+	return 0;
 }
 
 static void CreateChimneySmoke(TileIndex tile)
@@ -3008,6 +3013,7 @@ extern const TileTypeProcs _tile_type_industry_procs = {
 	ClickTile_Industry,          // click_tile_proc
 	AnimateTile_Industry,        // animate_tile_proc
 	TileLoop_Industry,           // tile_loop_proc
+	nullptr,                     // tile_loop_parallel_proc
 	ChangeTileOwner_Industry,    // change_tile_owner_proc
 	nullptr,                        // add_produced_cargo_proc
 	nullptr,                        // vehicle_enter_tile_proc
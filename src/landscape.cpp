@@ -34,6 +34,8 @@
 #include "framerate_type.h"
 #include "3rdparty/cpp-btree/btree_set.h"
 #include "scope_info.h"
+#include "sound_func.h"
+#include "worker_thread.h"
 #include <list>
 #include <set>
 #include <deque>
@@ -803,12 +805,84 @@ CommandCost CmdClearArea(TileIndex tile, DoCommandFlag flags, uint32 p1, uint32
 
 TileIndex _cur_tileloop_tile;
 
+/**
+ * Get the random bits of a tile in a batch of the parallel tile loop.
+ * @param seed Random bits drawn for the whole batch.
+ * @param tile Tile to get the random bits for.
+ * @return Random bits of the tile.
+ */
+static inline uint32 GetTileLoopRandom(uint32 seed, TileIndex tile)
+{
+	uint32 x = seed ^ (tile * 0x9E3779B9U);
+	x ^= x >> 16;
+	x *= 0x7FEB352DU;
+	x ^= x >> 15;
+	x *= 0x846CA68BU;
+	x ^= x >> 16;
+	return x;
+}
+
+/**
+ * Process a batch of the tile loop in parallel.
+ * First the TileLoopParallelProcs of all tiles are called, with the tiles grouped into stripes of map rows which are distributed between the worker threads.
+ * Then the tiles which have to be processed serially are passed to their TileLoopProcs, and redrawing and sounds are handled, in the order of the batch.
+ * The result only depends on the game state, not on the number of threads.
+ * @param tiles Tiles of the batch, in tile loop order.
+ */
+static void RunParallelTileLoop(const std::vector<TileIndex> &tiles)
+{
+	static std::vector<TileLoopParallelResult> results;
+	static std::vector<uint32> order;
+	static std::vector<uint32> stripe_start;
+	static std::vector<uint32> stripe_pos;
+
+	const uint32 seed = Random();
+
+	/* Counting sort of the tiles by stripe, at most 64 stripes. */
+	const uint stripe_shift = max<int>(MapLogY() - 6, 0);
+	const uint stripes = MapSizeY() >> stripe_shift;
+	stripe_start.assign(stripes + 1, 0);
+	for (TileIndex tile : tiles) stripe_start[(TileY(tile) >> stripe_shift) + 1]++;
+	for (uint i = 0; i < stripes; i++) stripe_start[i + 1] += stripe_start[i];
+	stripe_pos.assign(stripe_start.begin(), stripe_start.end() - 1);
+	order.resize(tiles.size());
+	for (uint32 i = 0; i < tiles.size(); i++) order[stripe_pos[TileY(tiles[i]) >> stripe_shift]++] = i;
+
+	results.resize(tiles.size());
+	/* Small batches are not worth distributing. */
+	const size_t chunk_size = tiles.size() < 1024 ? stripes : 1;
+	_general_worker_pool.ParallelFor(stripes, chunk_size, [&](size_t begin, size_t end) {
+		for (uint32 k = stripe_start[begin]; k < stripe_start[end]; k++) {
+			const uint32 i = order[k];
+			const TileIndex tile = tiles[i];
+			TileLoopParallelProc *proc = _tile_type_procs[GetTileType(tile)]->tile_loop_parallel_proc;
+			results[i] = (proc != nullptr) ? proc(tile, GetTileLoopRandom(seed, tile)) : TileLoopParallelResult{ TLPF_SERIAL, SND_BEGIN };
+		}
+	});
+
+	for (uint32 i = 0; i < tiles.size(); i++) {
+		const TileIndex tile = tiles[i];
+		const TileLoopParallelResult &result = results[i];
+		if (result.flags & TLPF_SERIAL) {
+			_tile_type_procs[GetTileType(tile)]->tile_loop_proc(tile);
+			continue;
+		}
+		if (result.flags & TLPF_DIRTY) {
+			MarkTileDirtyByTile(tile);
+		} else if (result.flags & TLPF_DIRTY_DETAIL) {
+			MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
+		}
+		if ((result.flags & TLPF_SOUND) && _settings_client.sound.ambient) SndPlayTileFx(result.sound, tile);
+	}
+}
+
 /**
  * Gradually iterate over all tiles on the map, calling their TileLoopProcs once every 256 ticks.
  */
 void RunTileLoop()
 {
 	PerformanceAccumulator framerate(PFE_GL_LANDSCAPE);
+	TICK_PROFILE_SCOPE("TileLoop");
 
 	/* The pseudorandom sequence of tiles is generated using a Galois linear feedback
 	 * shift register (LFSR). This allows a deterministic pseudorandom ordering, but
@@ -832,6 +906,22 @@ void RunTileLoop()
 
 	SCOPE_INFO_FMT([&], "RunTileLoop: tile: %dx%d", TileX(tile), TileY(tile));
 
+	if (_settings_game.construction.parallel_tile_loop) {
+		static std::vector<TileIndex> tiles;
+		tiles.clear();
+		if (_tick_counter % 256 == 0) {
+			tiles.push_back(0);
+			count--;
+		}
+		while (count--) {
+			tiles.push_back(tile);
+			tile = (tile >> 1) ^ (-(int32)(tile & 1) & feedback);
+		}
+		RunParallelTileLoop(tiles);
+		_cur_tileloop_tile = tile;
+		return;
+	}
+
 	/* Manually update tile 0 every 256 ticks - the LFSR never iterates over it itself.  */
 	if (_tick_counter % 256 == 0) {
 		_tile_type_procs[GetTileType(0)]->tile_loop_proc(0);
@@ -1306,7 +1396,7 @@ void GenerateLandscape(byte mode)
 	/** Number of steps of landscape generation */
 	enum GenLandscapeSteps {
 		GLS_HEIGHTMAP    =  3, ///< Loading a heightmap
-		GLS_TERRAGENESIS =  5, ///< Terragenesis generator
+		GLS_TERRAGENESIS =  8, ///< Terragenesis generator
 		GLS_ORIGINAL     =  2, ///< Original generator
 		GLS_TROPIC       = 12, ///< Extra steps needed for tropic landscape
 		GLS_OTHER        =  0, ///< Extra steps for other landscapes
@@ -1399,13 +1489,23 @@ void CallLandscapeTick()
 {
 	{
 		PerformanceAccumulator framerate(PFE_GL_LANDSCAPE);
+		TICK_PROFILE_SCOPE("LandscapeTick");
 
-		OnTick_Town();
+		{
+			TICK_PROFILE_SCOPE("Towns");
+			OnTick_Town();
+		}
 		OnTick_Trees();
 		OnTick_Station();
-		OnTick_Industry();
+		{
+			TICK_PROFILE_SCOPE("Industries");
+			OnTick_Industry();
+		}
 	}
 
-	OnTick_Companies();
+	{
+		TICK_PROFILE_SCOPE("Companies");
+		OnTick_Companies();
+	}
 	OnTick_LinkGraph();
 }
@@ -61,5 +61,5 @@ void FlowMapper::Run(LinkGraphJob &job) const
 		/* Clear paths. */
 		node.Paths().clear();
 	}
-	job.path_allocator.ResetArena();
+	for (DynUniformArenaAllocator &allocator : job.path_allocators) allocator.ResetArena();
 }
@@ -75,7 +75,7 @@ void LinkGraphJob::SetJobGroup(std::shared_ptr<LinkGraphJobGroup> group)
 void LinkGraphJob::JoinThread()
 {
 	if (this->group != nullptr) {
-		this->group->JoinThread();
+		this->group->Join();
 		this->group.reset();
 	}
 }
@@ -70,6 +70,8 @@ protected:
 	EdgeAnnotationMatrix edges;       ///< Extra edge data necessary for link graph calculation.
 	bool job_completed;               ///< Is the job still running. This is accessed by multiple threads and is permitted to be spuriously incorrect.
 	bool abort_job;                   ///< Abort the job at the next available opportunity. This is accessed by multiple threads.
+	uint32 queue_time_ms = 0;         ///< Time the job waited for a link graph worker thread, in milliseconds.
+	uint32 run_time_ms = 0;           ///< Time the handlers of the job took, in milliseconds.
 
 	void EraseFlows(NodeID from);
 	void JoinThread();
@@ -77,7 +79,9 @@ protected:
 
 public:
 
-	DynUniformArenaAllocator path_allocator; ///< Arena allocator used for paths
+	static const uint PATH_SEARCH_BATCH = 16; ///< Maximum number of concurrent path searches of the MCF passes.
+
+	DynUniformArenaAllocator path_allocators[PATH_SEARCH_BATCH]; ///< Arena allocators used for paths, one for each concurrent path search
 
 	bool IsJobAborted() const;
 
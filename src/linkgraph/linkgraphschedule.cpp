@@ -131,6 +131,8 @@ void LinkGraphSchedule::JoinNext()
 		LinkGraphID id = next->LinkGraphIndex();
 		next->FinaliseJob(); // joins the thread and finalises the job
 		assert(!next->IsJobAborted());
+		DEBUG(linkgraph, 2, "LinkGraphSchedule::JoinNext(): Joined job: id: %u, nodes: %u, queued: %u ms, run time: %u ms",
+				id, next->Size(), next->queue_time_ms, next->run_time_ms);
 		next.reset();
 		if (LinkGraph::IsValidID(id)) {
 			LinkGraph *lg = LinkGraph::Get(id);
@@ -146,10 +148,12 @@ void LinkGraphSchedule::JoinNext()
  */
 /* static */ void LinkGraphSchedule::Run(LinkGraphJob *job)
 {
+	auto start = std::chrono::steady_clock::now();
 	for (uint i = 0; i < lengthof(instance.handlers); ++i) {
 		if (job->IsJobAborted()) return;
 		instance.handlers[i]->Run(*job);
 	}
+	job->run_time_ms = (uint32)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
 
 	/*
 	 * Note that this it not guaranteed to be an atomic write and there are no memory barriers or other protections.
@@ -227,50 +231,51 @@ LinkGraphSchedule::~LinkGraphSchedule()
 LinkGraphJobGroup::LinkGraphJobGroup(constructor_token token, std::vector<LinkGraphJob *> jobs) :
 	jobs(std::move(jobs)) { }
 
-void LinkGraphJobGroup::SpawnThread()
+/**
+ * Add the job group to the link graph worker pool.
+ * If the pool has no worker threads, the jobs are run right now in the current thread.
+ */
+void LinkGraphJobGroup::Enqueue()
 {
-	/**
-	 * Spawn a thread if possible and run the link graph job in the thread. If
-	 * that's not possible run the job right now in the current thread.
-	 */
-	if (StartNewThread(&this->thread, "ottd:linkgraph", &(LinkGraphJobGroup::Run), this)) {
-		for (auto &it : this->jobs) {
-			it->SetJobGroup(this->shared_from_this());
-		}
-	} else {
-		/* Of course this will hang a bit.
-		 * On the other hand, if you want to play games which make this hang noticably
-		 * on a platform without threads then you'll probably get other problems first.
-		 * OK:
-		 * If someone comes and tells me that this hangs for him/her, I'll implement a
-		 * smaller grained "Step" method for all handlers and add some more ticks where
-		 * "Step" is called. No problem in principle. */
-		LinkGraphJobGroup::Run(this);
+	for (auto &it : this->jobs) {
+		it->SetJobGroup(this->shared_from_this());
 	}
+	this->enqueue_time = std::chrono::steady_clock::now();
+	/* The pool job keeps the group alive until it has run. */
+	_linkgraph_worker_pool.EnqueueJob(&LinkGraphJobGroup::Run, new std::shared_ptr<LinkGraphJobGroup>(this->shared_from_this()));
 }
 
-void LinkGraphJobGroup::JoinThread()
+/**
+ * Wait until all jobs of the group have been run.
+ */
+void LinkGraphJobGroup::Join()
 {
-	if (this->thread.joinable()) {
-		this->thread.join();
-	}
+	std::unique_lock<std::mutex> lk(this->lock);
+	this->done_cv.wait(lk, [this]() { return this->finished; });
 }
 
 /**
  * Run all jobs for the given LinkGraphJobGroup. This method is tailored to
- * ThreadObject::New.
- * @param j Pointer to a LinkGraphJobGroup.
+ * WorkStealingThreadPool::EnqueueJob.
+ * @param group Pointer to a shared pointer to the LinkGraphJobGroup, which is deleted.
  */
-/* static */ void LinkGraphJobGroup::Run(void *group)
+/* static */ void LinkGraphJobGroup::Run(void *group, void *, void *)
 {
-	LinkGraphJobGroup *job_group = (LinkGraphJobGroup *)group;
+	std::unique_ptr<std::shared_ptr<LinkGraphJobGroup>> holder(static_cast<std::shared_ptr<LinkGraphJobGroup> *>(group));
+	LinkGraphJobGroup *job_group = holder->get();
 	for (LinkGraphJob *job : job_group->jobs) {
+		job->queue_time_ms = (uint32)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - job_group->enqueue_time).count();
 		LinkGraphSchedule::Run(job);
 	}
+
+	std::lock_guard<std::mutex> lk(job_group->lock);
+	job_group->finished = true;
+	job_group->done_cv.notify_all();
 }
 
 /* static */ void LinkGraphJobGroup::ExecuteJobSet(std::vector<JobInfo> jobs) {
-	const uint thread_budget = 200000;
+	/* Cheap jobs with the same join date are batched into one job of the worker pool. */
+	const uint group_budget = 200000;
 
 	std::sort(jobs.begin(), jobs.end(), [](const JobInfo &a, const JobInfo &b) {
 		return std::make_pair(a.job->JoinDateTicks(), a.cost_estimate) < std::make_pair(b.job->JoinDateTicks(), b.cost_estimate);
@@ -281,16 +286,16 @@ void LinkGraphJobGroup::JoinThread()
 	DateTicks bucket_join_date = 0;
 	auto flush_bucket = [&]() {
 		if (!bucket_cost) return;
-		DEBUG(linkgraph, 2, "LinkGraphJobGroup::ExecuteJobSet: Creating Job Group: jobs: " PRINTF_SIZE ", cost: %u, join after: %d",
-				bucket.size(), bucket_cost, bucket_join_date - ((_date * DAY_TICKS) + _date_fract));
+		DEBUG(linkgraph, 2, "LinkGraphJobGroup::ExecuteJobSet: Creating Job Group: jobs: " PRINTF_SIZE ", cost: %u, join after: %d, queue depth: %u",
+				bucket.size(), bucket_cost, bucket_join_date - ((_date * DAY_TICKS) + _date_fract), _linkgraph_worker_pool.GetQueueDepth());
 		auto group = std::make_shared<LinkGraphJobGroup>(constructor_token(), std::move(bucket));
-		group->SpawnThread();
+		group->Enqueue();
 		bucket_cost = 0;
 		bucket.clear();
 	};
 
 	for (JobInfo &it : jobs) {
-		if (bucket_cost && (bucket_join_date != it.job->JoinDateTicks() || (bucket_cost + it.cost_estimate > thread_budget))) flush_bucket();
+		if (bucket_cost && (bucket_join_date != it.job->JoinDateTicks() || (bucket_cost + it.cost_estimate > group_budget))) flush_bucket();
 		bucket_join_date = it.job->JoinDateTicks();
 		bucket.push_back(it.job);
 		bucket_cost += it.cost_estimate;
@@ -325,6 +330,7 @@ void StateGameLoop_LinkGraphPauseControl()
 
 		/* perform check one _date_fract tick before we would join */
 		if (LinkGraphSchedule::instance.IsJoinWithUnfinishedJobDue()) {
+			DEBUG(linkgraph, 1, "StateGameLoop_LinkGraphPauseControl: Pausing for unfinished job, queue depth: %u", _linkgraph_worker_pool.GetQueueDepth());
 			DoCommandP(0, PM_PAUSED_LINK_GRAPH, 1, CMD_PAUSE);
 		}
 	}
@@ -358,8 +364,10 @@ void OnTick_LinkGraph()
 		offset = ((_date * DAY_TICKS) + _date_fract - LinkGraphSchedule::SPAWN_JOIN_TICK) % interval;
 	}
 	if (offset == 0) {
+		TICK_PROFILE_SCOPE("LinkGraphSpawn");
 		LinkGraphSchedule::instance.SpawnNext();
 	} else if (offset == interval / 2) {
+		TICK_PROFILE_SCOPE("LinkGraphJoin");
 		if (!_networking || _network_server) {
 			PerformanceMeasurer::SetInactive(PFE_GL_LINKGRAPH);
 			LinkGraphSchedule::instance.JoinNext();
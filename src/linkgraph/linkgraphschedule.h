@@ -11,7 +11,9 @@
 #define LINKGRAPHSCHEDULE_H
 
 #include "../thread.h"
+#include "../worker_thread.h"
 #include "linkgraph.h"
+#include <chrono>
 #include <memory>
 
 class LinkGraphJob;
@@ -83,14 +85,17 @@ class LinkGraphJobGroup : public std::enable_shared_from_this<LinkGraphJobGroup>
 	friend LinkGraphJob;
 
 private:
-	std::thread thread;                      ///< Thread the job group is running in or nullptr if it's running in the main thread.
 	const std::vector<LinkGraphJob *> jobs;  ///< The set of jobs in this job set
+	std::chrono::steady_clock::time_point enqueue_time; ///< Time the job group was added to the link graph worker pool
+	std::mutex lock;                         ///< Lock for finished
+	std::condition_variable done_cv;         ///< Signalled when all jobs of the group have been run
+	bool finished = false;                   ///< Whether all jobs of the group have been run
 
 private:
 	struct constructor_token { };
-	static void Run(void *group);
-	void SpawnThread();
-	void JoinThread();
+	static void Run(void *group, void *, void *);
+	void Enqueue();
+	void Join();
 
 public:
 	LinkGraphJobGroup(constructor_token token, std::vector<LinkGraphJob *> jobs);
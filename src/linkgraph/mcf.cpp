@@ -3,6 +3,7 @@
 #include "../stdafx.h"
 #include "../core/math_func.hpp"
 #include "mcf.h"
+#include "../worker_thread.h"
 #include "../3rdparty/cpp-btree/btree_map.h"
 #include <set>
 
@@ -272,9 +273,10 @@ bool CapacityAnnotation::IsBetter(const CapacityAnnotation *base, uint cap,
  * @tparam Tedge_iterator Iterator to be used for getting outgoing edges.
  * @param source_node Node where the algorithm starts.
  * @param paths Container for the paths to be calculated.
+ * @param allocator Allocator for the paths.
  */
 template<class Tannotation, class Tedge_iterator>
-void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths)
+void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths, DynUniformArenaAllocator &allocator)
 {
 	typedef btree::btree_set<AnnoSetItem<Tannotation>, typename Tannotation::Comparator> AnnoSet;
 	AnnoSet annos = AnnoSet(typename Tannotation::Comparator());
@@ -282,10 +284,10 @@ void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths)
 	uint size = this->job.Size();
 	paths.resize(size, nullptr);
 
-	this->job.path_allocator.SetParameters(sizeof(Tannotation), (8192 - 32) / sizeof(Tannotation));
+	allocator.SetParameters(sizeof(Tannotation), (8192 - 32) / sizeof(Tannotation));
 
 	for (NodeID node = 0; node < size; ++node) {
-		Tannotation *anno = new (this->job.path_allocator.Allocate()) Tannotation(node, node == source_node);
+		Tannotation *anno = new (allocator.Allocate()) Tannotation(node, node == source_node);
 		anno->UpdateAnnotation();
 		if (node == source_node) {
 			annos.insert(AnnoSetItem<Tannotation>(anno)).first;
@@ -322,12 +324,33 @@ void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths)
 	}
 }
 
+/**
+ * Search the paths for a batch of sources, distributing the searches between the link graph worker threads.
+ * Each search only reads the job, and uses its own allocator.
+ * @tparam Tannotation Annotation to be used.
+ * @tparam Tedge_iterator Iterator to be used for getting outgoing edges.
+ * @param sources Source nodes.
+ * @param count Number of source nodes, at most LinkGraphJob::PATH_SEARCH_BATCH.
+ * @param paths Containers for the paths to be calculated, one for each source node.
+ */
+template<class Tannotation, class Tedge_iterator>
+void MultiCommodityFlow::SearchPaths(const NodeID *sources, uint count, PathVector *paths)
+{
+	assert(count <= LinkGraphJob::PATH_SEARCH_BATCH);
+	_linkgraph_worker_pool.ParallelFor(count, 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			this->Dijkstra<Tannotation, Tedge_iterator>(sources[i], paths[i], this->job.path_allocators[i]);
+		}
+	});
+}
+
 /**
  * Clean up paths that lead nowhere and the root path.
  * @param source_id ID of the root node.
  * @param paths Paths to be cleaned up.
+ * @param allocator Allocator the paths were allocated with.
  */
-void MultiCommodityFlow::CleanupPaths(NodeID source_id, PathVector &paths)
+void MultiCommodityFlow::CleanupPaths(NodeID source_id, PathVector &paths, DynUniformArenaAllocator &allocator)
 {
 	Path *source = paths[source_id];
 	paths[source_id] = nullptr;
@@ -340,12 +363,12 @@ void MultiCommodityFlow::CleanupPaths(NodeID source_id, PathVector &paths)
 			path->Detach();
 			if (path->GetNumChildren() == 0) {
 				paths[path->GetNode()] = nullptr;
-				this->job.path_allocator.Free(path);
+				allocator.Free(path);
 			}
 			path = parent;
 		}
 	}
-	this->job.path_allocator.Free(source);
+	allocator.Free(source);
 	paths.clear();
 }
 
@@ -519,7 +542,8 @@ bool MCF1stPass::EliminateCycles()
  */
 MCF1stPass::MCF1stPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 {
-	PathVector paths;
+	PathVector paths[LinkGraphJob::PATH_SEARCH_BATCH];
+	NodeID sources[LinkGraphJob::PATH_SEARCH_BATCH];
 	uint size = job.Size();
 	uint accuracy = job.Settings().accuracy;
 	bool more_loops;
@@ -527,35 +551,54 @@ MCF1stPass::MCF1stPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 
 	do {
 		more_loops = false;
-		for (NodeID source = 0; source < size; ++source) {
-			if (finished_sources[source]) continue;
+		NodeID next_source = 0;
+		for (;;) {
+			uint count = 0;
+			for (; next_source < size && count < this->search_batch; ++next_source) {
+				if (!finished_sources[next_source]) sources[count++] = next_source;
+			}
+			if (count == 0) break;
 
 			/* First saturate the shortest paths. */
-			this->Dijkstra<DistanceAnnotation, GraphEdgeIterator>(source, paths);
-
-			bool source_demand_left = false;
-			for (NodeID dest = 0; dest < size; ++dest) {
-				Edge edge = job[source][dest];
-				if (edge.UnsatisfiedDemand() > 0) {
-					Path *path = paths[dest];
-					assert(path != nullptr);
-					/* Generally only allow paths that don't exceed the
-					 * available capacity. But if no demand has been assigned
-					 * yet, make an exception and allow any valid path *once*. */
-					if (path->GetFreeCapacity() > 0 && this->PushFlow(edge, path,
-							accuracy, this->max_saturation) > 0) {
-						/* If a path has been found there is a chance we can
-						 * find more. */
-						more_loops = more_loops || (edge.UnsatisfiedDemand() > 0);
-					} else if (edge.UnsatisfiedDemand() == edge.Demand() &&
-							path->GetFreeCapacity() > INT_MIN) {
-						this->PushFlow(edge, path, accuracy, UINT_MAX);
+			this->SearchPaths<DistanceAnnotation, GraphEdgeIterator>(sources, count, paths);
+
+			for (uint i = 0; i < count; i++) {
+				NodeID source = sources[i];
+				DynUniformArenaAllocator &allocator = job.path_allocators[i];
+				/* The paths of all but the first source of the batch were searched before the flows of the previous ones were assigned. */
+				bool fresh = (i == 0);
+				bool source_demand_left = false;
+				for (NodeID dest = 0; dest < size; ++dest) {
+					Edge edge = job[source][dest];
+					if (edge.UnsatisfiedDemand() > 0) {
+						Path *path = paths[i][dest];
+						assert(path != nullptr);
+						/* Generally only allow paths that don't exceed the
+						 * available capacity. But if no demand has been assigned
+						 * yet, make an exception and allow any valid path *once*. */
+						bool pushed = path->GetFreeCapacity() > 0 && this->PushFlow(edge, path, accuracy, this->max_saturation) > 0;
+						if (!pushed && !fresh && path->GetFreeCapacity() > 0) {
+							/* The path may have been saturated by a previous source of the batch, search again. */
+							this->CleanupPaths(source, paths[i], allocator);
+							this->Dijkstra<DistanceAnnotation, GraphEdgeIterator>(source, paths[i], allocator);
+							fresh = true;
+							path = paths[i][dest];
+							pushed = path->GetFreeCapacity() > 0 && this->PushFlow(edge, path, accuracy, this->max_saturation) > 0;
+						}
+						if (pushed) {
+							/* If a path has been found there is a chance we can
+							 * find more. */
+							more_loops = more_loops || (edge.UnsatisfiedDemand() > 0);
+						} else if (edge.UnsatisfiedDemand() == edge.Demand() &&
+								path->GetFreeCapacity() > INT_MIN) {
+							this->PushFlow(edge, path, accuracy, UINT_MAX);
+						}
+						if (edge.UnsatisfiedDemand() > 0) source_demand_left = true;
 					}
-					if (edge.UnsatisfiedDemand() > 0) source_demand_left = true;
 				}
+				if (!source_demand_left) finished_sources[source] = true;
+				this->CleanupPaths(source, paths[i], allocator);
 			}
-			if (!source_demand_left) finished_sources[source] = true;
-			this->CleanupPaths(source, paths);
 		}
 	} while ((more_loops || this->EliminateCycles()) && !job.IsJobAborted());
 }
@@ -568,32 +611,42 @@ MCF1stPass::MCF1stPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 MCF2ndPass::MCF2ndPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 {
 	this->max_saturation = UINT_MAX; // disable artificial cap on saturation
-	PathVector paths;
+	PathVector paths[LinkGraphJob::PATH_SEARCH_BATCH];
+	NodeID sources[LinkGraphJob::PATH_SEARCH_BATCH];
 	uint size = job.Size();
 	uint accuracy = job.Settings().accuracy;
 	bool demand_left = true;
 	std::vector<bool> finished_sources(size);
 	while (demand_left && !job.IsJobAborted()) {
 		demand_left = false;
-		for (NodeID source = 0; source < size; ++source) {
-			if (finished_sources[source]) continue;
-
-			this->Dijkstra<CapacityAnnotation, FlowEdgeIterator>(source, paths);
-
-			bool source_demand_left = false;
-			for (NodeID dest = 0; dest < size; ++dest) {
-				Edge edge = this->job[source][dest];
-				Path *path = paths[dest];
-				if (edge.UnsatisfiedDemand() > 0 && path->GetFreeCapacity() > INT_MIN) {
-					this->PushFlow(edge, path, accuracy, UINT_MAX);
-					if (edge.UnsatisfiedDemand() > 0) {
-						demand_left = true;
-						source_demand_left = true;
+		NodeID next_source = 0;
+		for (;;) {
+			uint count = 0;
+			for (; next_source < size && count < this->search_batch; ++next_source) {
+				if (!finished_sources[next_source]) sources[count++] = next_source;
+			}
+			if (count == 0) break;
+
+			/* Flow is never refused without a saturation cap, so paths of a batch can't become unusable, only less than ideal. */
+			this->SearchPaths<CapacityAnnotation, FlowEdgeIterator>(sources, count, paths);
+
+			for (uint i = 0; i < count; i++) {
+				NodeID source = sources[i];
+				bool source_demand_left = false;
+				for (NodeID dest = 0; dest < size; ++dest) {
+					Edge edge = this->job[source][dest];
+					Path *path = paths[i][dest];
+					if (edge.UnsatisfiedDemand() > 0 && path->GetFreeCapacity() > INT_MIN) {
+						this->PushFlow(edge, path, accuracy, UINT_MAX);
+						if (edge.UnsatisfiedDemand() > 0) {
+							demand_left = true;
+							source_demand_left = true;
+						}
 					}
 				}
+				if (!source_demand_left) finished_sources[source] = true;
+				this->CleanupPaths(source, paths[i], job.path_allocators[i]);
 			}
-			if (!source_demand_left) finished_sources[source] = true;
-			this->CleanupPaths(source, paths);
 		}
 	}
 }
@@ -18,18 +18,30 @@ protected:
 	 * @param job Link graph job being executed.
 	 */
 	MultiCommodityFlow(LinkGraphJob &job) : job(job),
-			max_saturation(job.Settings().short_path_saturation)
+			max_saturation(job.Settings().short_path_saturation),
+			search_batch(job.Size() >= PARALLEL_SEARCH_MIN_NODES ? LinkGraphJob::PATH_SEARCH_BATCH : 1)
 	{}
 
+	/**
+	 * Minimum number of nodes for the path searches of a pass to be run in batches in parallel.
+	 * Paths of all but the first source of a batch are searched before the flows of the previous sources are assigned,
+	 * so this must not depend on the number of threads.
+	 */
+	static const uint PARALLEL_SEARCH_MIN_NODES = 64;
+
+	template<class Tannotation, class Tedge_iterator>
+	void Dijkstra(NodeID from, PathVector &paths, DynUniformArenaAllocator &allocator);
+
 	template<class Tannotation, class Tedge_iterator>
-	void Dijkstra(NodeID from, PathVector &paths);
+	void SearchPaths(const NodeID *sources, uint count, PathVector *paths);
 
 	uint PushFlow(Edge &edge, Path *path, uint accuracy, uint max_saturation);
 
-	void CleanupPaths(NodeID source, PathVector &paths);
+	void CleanupPaths(NodeID source, PathVector &paths, DynUniformArenaAllocator &allocator);
 
 	LinkGraphJob &job;   ///< Job we're working with.
 	uint max_saturation; ///< Maximum saturation for edges.
+	uint search_batch;   ///< Number of sources whose paths are searched at once.
 };
 
 /**
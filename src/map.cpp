@@ -16,6 +16,11 @@
 #include "tunnelbridge_map.h"
 #include "3rdparty/cpp-btree/btree_map.h"
 #include <array>
+#include <chrono>
+#include <functional>
+#if defined(WITH_SOA_MAP) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "safeguards.h"
 
@@ -31,9 +36,21 @@ uint _map_size_y;    ///< Size of the map along the Y
 uint _map_size;      ///< The number of tiles on the map
 uint _map_tile_mask; ///< _map_size - 1 (to mask the mapsize)
 
+#ifdef WITH_SOA_MAP
+TilePlanes _m;               ///< Tiles of the map
+TileExtendedPlanes _me;      ///< Extended Tiles of the map
+static byte *_map_planes = nullptr; ///< Allocation holding all planes of the map
+
+static const size_t MAP_BYTE_STRIDE = 1; ///< Distance in bytes between a byte member of a tile and the same member of the next tile
+#define MAP_BYTE_PLANE(member) ((const byte *) _m.member)
+#else
 Tile *_m = nullptr;          ///< Tiles of the map
 TileExtended *_me = nullptr; ///< Extended Tiles of the map
 
+static const size_t MAP_BYTE_STRIDE = sizeof(Tile); ///< Distance in bytes between a byte member of a tile and the same member of the next tile
+#define MAP_BYTE_PLANE(member) ((const byte *) &_m[0].member)
+#endif /* WITH_SOA_MAP */
+
 /**
  * Validates whether a map with the given dimension is valid
  * @param size_x the width of the map along the NE/SW edge
@@ -75,11 +92,155 @@ void AllocateMap(uint size_x, uint size_y)
 	_map_size = size_x * size_y;
 	_map_tile_mask = _map_size - 1;
 
+#ifdef WITH_SOA_MAP
+	free(_map_planes);
+
+	/* One allocation for all planes, the 16 bit planes go first to keep them aligned. */
+	_map_planes = CallocT<byte>((size_t)_map_size * (sizeof(Tile) + sizeof(TileExtended)));
+	byte *plane = _map_planes;
+	auto next_plane = [&](size_t member_size) -> byte * {
+		byte *result = plane;
+		plane += (size_t)_map_size * member_size;
+		return result;
+	};
+	_m.m2 = (uint16 *) next_plane(2);
+	_me.m8 = (uint16 *) next_plane(2);
+	_m.type = next_plane(1);
+	_m.height = next_plane(1);
+	_m.m1 = next_plane(1);
+	_m.m3 = next_plane(1);
+	_m.m4 = next_plane(1);
+	_m.m5 = next_plane(1);
+	_me.m6 = next_plane(1);
+	_me.m7 = next_plane(1);
+#else
 	free(_m);
 	free(_me);
 
 	_m = CallocT<Tile>(_map_size);
 	_me = CallocT<TileExtended>(_map_size);
+#endif /* WITH_SOA_MAP */
+}
+
+/**
+ * Reset all data of a range of tiles to zero.
+ * @param begin First tile to clear.
+ * @param count Number of tiles to clear.
+ * @param extended Whether to also clear the extended data (m6 to m8).
+ */
+void ClearMapTiles(TileIndex begin, uint count, bool extended)
+{
+	assert(begin + count <= MapSize());
+#ifdef WITH_SOA_MAP
+	MemSetT(_m.type + begin, 0, count);
+	MemSetT(_m.height + begin, 0, count);
+	MemSetT(_m.m2 + begin, 0, count);
+	MemSetT(_m.m1 + begin, 0, count);
+	MemSetT(_m.m3 + begin, 0, count);
+	MemSetT(_m.m4 + begin, 0, count);
+	MemSetT(_m.m5 + begin, 0, count);
+	if (extended) {
+		MemSetT(_me.m6 + begin, 0, count);
+		MemSetT(_me.m7 + begin, 0, count);
+		MemSetT(_me.m8 + begin, 0, count);
+	}
+#else
+	MemSetT(_m + begin, 0, count);
+	if (extended) MemSetT(_me + begin, 0, count);
+#endif /* WITH_SOA_MAP */
+}
+
+/**
+ * Count the tiles of each tile type on the map.
+ * @param[out] counts Array of 16 counters, indexed by #TileType.
+ */
+void CountMapTileTypes(uint *counts)
+{
+	/* Separate sets of counters, so runs of tiles of the same type do not wait on updating the same counter. */
+	uint partial[4][16] = {};
+	const byte *type = MAP_BYTE_PLANE(type);
+	const size_t size = MapSize();
+	for (size_t i = 0; i < size; i += 4) {
+		partial[0][type[(i + 0) * MAP_BYTE_STRIDE] >> 4]++;
+		partial[1][type[(i + 1) * MAP_BYTE_STRIDE] >> 4]++;
+		partial[2][type[(i + 2) * MAP_BYTE_STRIDE] >> 4]++;
+		partial[3][type[(i + 3) * MAP_BYTE_STRIDE] >> 4]++;
+	}
+	for (uint i = 0; i < 16; i++) {
+		counts[i] = partial[0][i] + partial[1][i] + partial[2][i] + partial[3][i];
+	}
+}
+
+/**
+ * Count the tiles of each height on the map.
+ * @param[out] histogram Array of 256 counters, indexed by tile height.
+ */
+void GetMapHeightHistogram(uint *histogram)
+{
+	/* Separate sets of counters, so runs of tiles of the same height do not wait on updating the same counter. */
+	std::array<std::array<uint, 256>, 4> partial = {};
+	const byte *height = MAP_BYTE_PLANE(height);
+	const size_t size = MapSize();
+	for (size_t i = 0; i < size; i += 4) {
+		partial[0][height[(i + 0) * MAP_BYTE_STRIDE]]++;
+		partial[1][height[(i + 1) * MAP_BYTE_STRIDE]]++;
+		partial[2][height[(i + 2) * MAP_BYTE_STRIDE]]++;
+		partial[3][height[(i + 3) * MAP_BYTE_STRIDE]]++;
+	}
+	for (uint i = 0; i < 256; i++) {
+		histogram[i] = partial[0][i] + partial[1][i] + partial[2][i] + partial[3][i];
+	}
+}
+
+/**
+ * Get the height of the highest tile on the map.
+ * @return The maximum tile height.
+ */
+uint GetMapMaxHeight()
+{
+	const byte *height = MAP_BYTE_PLANE(height);
+	const size_t size = MapSize();
+	size_t i = 0;
+	byte result = 0;
+#if defined(WITH_SOA_MAP) && defined(__SSE2__)
+	__m128i acc = _mm_setzero_si128();
+	for (; i + 16 <= size; i += 16) {
+		acc = _mm_max_epu8(acc, _mm_loadu_si128((const __m128i *) (height + i)));
+	}
+	byte lanes[16];
+	_mm_storeu_si128((__m128i *) lanes, acc);
+	for (byte lane : lanes) result = max(result, lane);
+#endif
+	for (; i < size; i++) result = max(result, height[i * MAP_BYTE_STRIDE]);
+	return result;
+}
+
+/**
+ * Find the tiles in a range of the map which a sweep over the tiles of an owner needs to look at.
+ * Tiles with a type in \a skip_types are never returned, tiles with a type in \a owner_types
+ * are only returned when their owner is \a owner, all other tiles are always returned.
+ * @param begin First tile of the range.
+ * @param count Number of tiles in the range.
+ * @param skip_types Bit mask of the tile types to skip.
+ * @param owner_types Bit mask of the tile types to only return when owned by \a owner.
+ * @param owner The owner.
+ * @param[out] result Buffer for the found tiles, with space for \a count tiles.
+ * @return Number of tiles written to \a result, in ascending order.
+ */
+uint FindOwnedMapTiles(TileIndex begin, uint count, uint16 skip_types, uint16 owner_types, Owner owner, TileIndex *result)
+{
+	assert(begin + count <= MapSize());
+	const byte *type = MAP_BYTE_PLANE(type);
+	const byte *m1 = MAP_BYTE_PLANE(m1);
+	uint found = 0;
+	for (TileIndex t = begin; t != begin + count; t++) {
+		const uint tt = type[t * MAP_BYTE_STRIDE] >> 4;
+		const bool owned = GB(m1[t * MAP_BYTE_STRIDE], 0, 5) == owner;
+		/* Always store the tile and only advance when it matches, so there is no hard to predict branch. */
+		result[found] = t;
+		found += (!HasBit(skip_types, tt) && (owned || !HasBit(owner_types, tt))) ? 1 : 0;
+	}
+	return found;
 }
 
 
@@ -451,7 +612,7 @@ char *DumpTileInfo(char *b, const char *last, TileIndex tile)
 	} else {
 		b += seprintf(b, last, "tile: %X (%u x %u)", tile, TileX(tile), TileY(tile));
 	}
-	if (!_m || !_me) {
+	if (!IsMapAllocated()) {
 		b += seprintf(b, last, ", NO MAP ALLOCATED");
 	} else {
 		if (tile >= MapSize()) {
@@ -486,9 +647,9 @@ void DumpMapStats(char *b, const char *last)
 	};
 	btree::btree_map<uint, uint> tunnel_bridge_stats;
 
-	for (TileIndex t = 0; t < MapSize(); t++) {
-		tile_types[GetTileType(t)]++;
+	CountMapTileTypes(tile_types.data());
 
+	for (TileIndex t = 0; t < MapSize(); t++) {
 		if (IsTileType(t, MP_RAILWAY)) {
 			if (GetRailTileType(t) == RAIL_TILE_SIGNALS) {
 				if (IsRestrictedSignal(t)) restricted_signals++;
@@ -552,3 +713,92 @@ void DumpMapStats(char *b, const char *last)
 		b += seprintf(b, last, ": %u\n", it.second);
 	}
 }
+
+/**
+ * Benchmark the whole map passes done with the per tile accessors against the bulk map kernels,
+ * for the map of the current game and the map layout this binary was built with.
+ * @param b Buffer to write to.
+ * @param last Last valid position in the buffer.
+ * @param iterations Number of passes of each kind.
+ */
+void DumpMapBenchmark(char *b, const char *last, uint iterations)
+{
+#ifdef WITH_SOA_MAP
+	const char *layout = "planes";
+#else
+	const char *layout = "tile structs";
+#endif
+	b += seprintf(b, last, "Map benchmark, %u x %u tiles, layout: %s, %u iteration(s)\n", MapSizeX(), MapSizeY(), layout, iterations);
+
+	/* Results are summed into here, so that the passes can not be optimised away. */
+	volatile uint sink = 0;
+	std::array<uint, 256> counts;
+
+	auto time_pass = [&](std::function<uint()> pass) -> double {
+		auto start = std::chrono::steady_clock::now();
+		uint result = 0;
+		for (uint i = 0; i < iterations; i++) result += pass();
+		sink = sink + result;
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+	};
+	auto report = [&](const char *name, double per_tile, double kernel) {
+		b += seprintf(b, last, "  %-16s per tile: %8.3f ms, kernel: %8.3f ms\n", name, per_tile, kernel);
+	};
+
+	report("tile types", time_pass([&]() -> uint {
+		counts.fill(0);
+		for (TileIndex t = 0; t < MapSize(); t++) counts[GetTileType(t)]++;
+		return counts[MP_CLEAR];
+	}), time_pass([&]() -> uint {
+		CountMapTileTypes(counts.data());
+		return counts[MP_CLEAR];
+	}));
+
+	report("height histogram", time_pass([&]() -> uint {
+		counts.fill(0);
+		for (TileIndex t = 0; t < MapSize(); t++) counts[TileHeight(t)]++;
+		return counts[0];
+	}), time_pass([&]() -> uint {
+		GetMapHeightHistogram(counts.data());
+		return counts[0];
+	}));
+
+	report("max height", time_pass([&]() -> uint {
+		uint result = 0;
+		for (TileIndex t = 0; t < MapSize(); t++) result = max(result, TileHeight(t));
+		return result;
+	}), time_pass([&]() -> uint {
+		return GetMapMaxHeight();
+	}));
+
+	/* The tile filter of the owner change when a company is removed, for the first company. */
+	const uint16 skip_types = (1 << MP_CLEAR) | (1 << MP_TREES) | (1 << MP_HOUSE) | (1 << MP_VOID);
+	const uint16 owner_types = (1 << MP_WATER) | (1 << MP_OBJECT);
+	report("owner sweep", time_pass([&]() -> uint {
+		uint found = 0;
+		for (TileIndex t = 0; t < MapSize(); t++) {
+			const TileType tt = GetTileType(t);
+			if (HasBit(skip_types, tt)) continue;
+			if (HasBit(owner_types, tt) && !IsTileOwner(t, COMPANY_FIRST)) continue;
+			found++;
+		}
+		return found;
+	}), time_pass([&]() -> uint {
+		uint found = 0;
+		TileIndex tiles[256];
+		for (TileIndex begin = 0; begin < MapSize(); begin += lengthof(tiles)) {
+			found += FindOwnedMapTiles(begin, lengthof(tiles), skip_types, owner_types, COMPANY_FIRST, tiles);
+		}
+		return found;
+	}));
+
+	/* A pass which needs every member of each tile, as the whole map savegame chunk does. */
+	const double all_members = time_pass([&]() -> uint {
+		uint result = 0;
+		for (TileIndex t = 0; t < MapSize(); t++) {
+			result += _m[t].type + _m[t].height + _m[t].m1 + _m[t].m2 + _m[t].m3 + _m[t].m4 + _m[t].m5 + _me[t].m6 + _me[t].m7 + _me[t].m8;
+		}
+		return result;
+	});
+	b += seprintf(b, last, "  %-16s per tile: %8.3f ms\n", "all members", all_members);
+}
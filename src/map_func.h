@@ -13,6 +13,7 @@
 #include "core/math_func.hpp"
 #include "tile_type.h"
 #include "map_type.h"
+#include "company_type.h"
 #include "direction_func.h"
 
 extern uint _map_tile_mask;
@@ -25,6 +26,20 @@ extern uint _map_tile_mask;
 
 #define TILE_MASK(x) ((x) & _map_tile_mask)
 
+#ifdef WITH_SOA_MAP
+/**
+ * The tile-array, stored as planes.
+ *
+ * Indexing this variable gives references to the data of a tile of
+ * the map, in the same way as the pointer of the default layout.
+ */
+extern TilePlanes _m;
+
+/**
+ * The extended tile-array, stored as planes.
+ */
+extern TileExtendedPlanes _me;
+#else
 /**
  * Pointer to the tile-array.
  *
@@ -40,9 +55,43 @@ extern Tile *_m;
  * of the map.
  */
 extern TileExtended *_me;
+#endif /* WITH_SOA_MAP */
 
 bool ValidateMapSize(uint size_x, uint size_y);
 void AllocateMap(uint size_x, uint size_y);
+void ClearMapTiles(TileIndex begin, uint count, bool extended = true);
+
+void CountMapTileTypes(uint *counts);
+void GetMapHeightHistogram(uint *histogram);
+uint GetMapMaxHeight();
+uint FindOwnedMapTiles(TileIndex begin, uint count, uint16 skip_types, uint16 owner_types, Owner owner, TileIndex *result);
+
+/**
+ * Check whether the map has been allocated.
+ * @return true if the tile-arrays exist.
+ */
+static inline bool IsMapAllocated()
+{
+#ifdef WITH_SOA_MAP
+	return _m.type != nullptr && _me.m6 != nullptr;
+#else
+	return _m != nullptr && _me != nullptr;
+#endif
+}
+
+/**
+ * Prefetch the data of a tile which is about to be used.
+ * With the planar layout only the type is prefetched, as that is what is nearly always looked at first.
+ * @param tile The tile to prefetch.
+ */
+static inline void PrefetchTile(TileIndex tile)
+{
+#ifdef WITH_SOA_MAP
+	PREFETCH_NTA(&_m.type[tile]);
+#else
+	PREFETCH_NTA(&_m[tile]);
+#endif
+}
 
 /**
  * Logarithm of the map size along the X side.
@@ -36,6 +36,63 @@ struct TileExtended {
 	uint16 m8; ///< General purpose
 };
 
+#ifdef WITH_SOA_MAP
+/**
+ * References to the data of a single tile, when the map is stored as planes.
+ * This has the same members as #Tile, so _m[tile].m5 etc. work with both layouts.
+ */
+struct TileRef {
+	byte   &type;
+	byte   &height;
+	uint16 &m2;
+	byte   &m1;
+	byte   &m3;
+	byte   &m4;
+	byte   &m5;
+};
+
+/**
+ * References to the extended data of a single tile, when the map is stored as planes.
+ * This has the same members as #TileExtended.
+ */
+struct TileExtendedRef {
+	byte   &m6;
+	byte   &m7;
+	uint16 &m8;
+};
+
+/**
+ * Tile-array stored as one contiguous plane per member of #Tile,
+ * so whole map passes only touch the members they actually use.
+ */
+struct TilePlanes {
+	byte   *type = nullptr;   ///< Plane of Tile::type
+	byte   *height = nullptr; ///< Plane of Tile::height
+	uint16 *m2 = nullptr;     ///< Plane of Tile::m2
+	byte   *m1 = nullptr;     ///< Plane of Tile::m1
+	byte   *m3 = nullptr;     ///< Plane of Tile::m3
+	byte   *m4 = nullptr;     ///< Plane of Tile::m4
+	byte   *m5 = nullptr;     ///< Plane of Tile::m5
+
+	inline TileRef operator[](uint tile) const
+	{
+		return { this->type[tile], this->height[tile], this->m2[tile], this->m1[tile], this->m3[tile], this->m4[tile], this->m5[tile] };
+	}
+};
+
+/** Extended tile-array stored as one contiguous plane per member of #TileExtended. */
+struct TileExtendedPlanes {
+	byte   *m6 = nullptr; ///< Plane of TileExtended::m6
+	byte   *m7 = nullptr; ///< Plane of TileExtended::m7
+	uint16 *m8 = nullptr; ///< Plane of TileExtended::m8
+
+	inline TileExtendedRef operator[](uint tile) const
+	{
+		return { this->m6[tile], this->m7[tile], this->m8[tile] };
+	}
+};
+#endif /* WITH_SOA_MAP */
+
 /**
  * An offset value between to tiles.
  *
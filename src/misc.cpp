@@ -26,6 +26,7 @@
 #include "core/pool_type.hpp"
 #include "game/game.hpp"
 #include "linkgraph/linkgraphschedule.h"
+#include "station_base.h"
 #include "station_kdtree.h"
 #include "town_kdtree.h"
 #include "viewport_kdtree.h"
@@ -106,6 +107,7 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	PoolBase::Clean(PT_NORMAL);
 
 	RebuildStationKdtree();
+	_station_catchment_index.clear();
 	RebuildTownKdtree();
 	RebuildViewportKdtree();
 
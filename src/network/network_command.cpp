@@ -130,6 +130,10 @@ void CommandQueue::Free()
 static CommandQueue _local_wait_queue;
 /** Local queue of packets waiting for execution. */
 static CommandQueue _local_execution_queue;
+/** Per company queues of local packets deferred by NetworkServerDeferLocalCommands. */
+static CommandQueue _local_deferred_queues[MAX_COMPANIES];
+/** Whether local packets are currently deferred. */
+static bool _local_defer_commands = false;
 
 /**
  * Prepare a DoCommand to be send over the network
@@ -175,6 +179,11 @@ void NetworkSendCommand(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd, Comman
 		c.frame = _frame_counter_max + 1;
 		c.my_cmd = true;
 
+		if (_local_defer_commands && company < MAX_COMPANIES) {
+			_local_deferred_queues[company].Append(std::move(c));
+			return;
+		}
+
 		_local_wait_queue.Append(std::move(c));
 		return;
 	}
@@ -185,6 +194,31 @@ void NetworkSendCommand(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd, Comman
 	MyClient::SendCommand(&c);
 }
 
+/**
+ * Queue the local commands of each company separately, instead of in the order in which they are sent.
+ * This is used when several companies send commands concurrently, see NetworkServerFlushDeferredLocalCommands.
+ */
+void NetworkServerDeferLocalCommands()
+{
+	assert(_network_server && !_local_defer_commands);
+	_local_defer_commands = true;
+}
+
+/**
+ * Move the deferred local commands to the local command queue in company order, and stop deferring commands.
+ */
+void NetworkServerFlushDeferredLocalCommands()
+{
+	assert(_local_defer_commands);
+	for (CompanyID company = COMPANY_FIRST; company < MAX_COMPANIES; company++) {
+		std::unique_ptr<CommandPacket> p;
+		while ((p = _local_deferred_queues[company].Pop()) != nullptr) {
+			_local_wait_queue.Append(std::move(*p));
+		}
+	}
+	_local_defer_commands = false;
+}
+
 /**
  * Sync our local command queue to the command queue of the given
  * socket. This is needed for the case where we receive a command
@@ -77,6 +77,8 @@ void NetworkServerSendRcon(ClientID client_id, TextColour colour_code, const cha
 void NetworkServerSendChat(NetworkAction action, DestType type, int dest, const char *msg, ClientID from_id, NetworkTextMessageData data = NetworkTextMessageData(), bool from_admin = false);
 
 void NetworkServerKickClient(ClientID client_id);
+void NetworkServerDeferLocalCommands();
+void NetworkServerFlushDeferredLocalCommands();
 uint NetworkServerKickOrBanIP(ClientID client_id, bool ban);
 uint NetworkServerKickOrBanIP(const char *ip, bool ban);
 
@@ -29,11 +29,11 @@
 #include "../core/random_func.hpp"
 #include "../rev.h"
 #include "../crashlog.h"
+#include <atomic>
 #include <mutex>
-#include <condition_variable>
+#include <vector>
 #if defined(__MINGW32__)
 #include "../3rdparty/mingw-std-threads/mingw.mutex.h"
-#include "../3rdparty/mingw-std-threads/mingw.condition_variable.h"
 #endif
 
 #include "../safeguards.h"
@@ -57,153 +57,125 @@ INSTANTIATE_POOL_METHODS(NetworkClientSocket)
 /** Instantiate the listen sockets. */
 template SocketList TCPListenHandler<ServerNetworkGameSocketHandler, PACKET_SERVER_FULL, PACKET_SERVER_BANNED>::sockets;
 
-/** Writing a savegame directly to a number of packets. */
-struct PacketWriter : SaveFilter {
-	ServerNetworkGameSocketHandler *cs; ///< Socket we are associated with.
-	Packet *current;                    ///< The packet we're currently writing to.
-	size_t total_size;                  ///< Total size of the compressed savegame.
-	Packet *packets;                    ///< Packet queue of the savegame; send these "slowly" to the client.
-	std::mutex mutex;                   ///< Mutex for making threaded saving safe.
-	std::condition_variable exit_sig;   ///< Signal for threaded destruction of this packet writer.
+/**
+ * Compressed savegame snapshot, shared by all clients that start downloading the map at the same time.
+ * The savegame is written by the saveload thread, and read by the main thread for every client it is sent to.
+ * It is freed once the last client holding a reference to it has finished or disconnected.
+ */
+struct NetworkMapSnapshot {
+	/** Maximum amount of savegame data in a single #PACKET_SERVER_MAP_DATA packet. */
+	static const size_t CHUNK_SIZE = SHRT_MAX - sizeof(PacketSize) - sizeof(PacketType);
+
+	std::mutex mutex;                      ///< Mutex for making threaded saving safe.
+	std::vector<std::vector<byte>> chunks; ///< Completely written chunks of the savegame; these do not change anymore once added.
+	size_t total_size;                     ///< Total size of the compressed savegame, only valid when finished.
+	std::atomic<uint> clients;             ///< Number of clients which are (still) interested in this snapshot.
+	std::atomic<bool> finished;            ///< Whether the savegame has been completely written.
+	std::atomic<bool> done;                ///< Whether the saving has ended, successfully or not.
+
+	NetworkMapSnapshot() : total_size(0), clients(0), finished(false), done(false) {}
 
 	/**
-	 * Create the packet writer.
-	 * @param cs The socket handler we're making the packets for.
+	 * Whether the saving of this snapshot failed or was cancelled.
+	 * @return True iff the saving ended without the savegame being completely written.
 	 */
-	PacketWriter(ServerNetworkGameSocketHandler *cs) : SaveFilter(nullptr), cs(cs), current(nullptr), total_size(0), packets(nullptr)
+	bool HasFailed() const
 	{
+		return this->done.load() && !this->finished.load();
 	}
 
-	/** Make sure everything is cleaned up. */
-	~PacketWriter()
+	/**
+	 * Get the number of chunks that are available for sending.
+	 * @return The number of chunks.
+	 */
+	size_t GetChunkCount()
 	{
-		std::unique_lock<std::mutex> lock(this->mutex);
-
-		if (this->cs != nullptr) this->exit_sig.wait(lock);
-
-		/* This must all wait until the Destroy function is called. */
-
-		while (this->packets != nullptr) {
-			Packet *p = this->packets->next;
-			delete this->packets;
-			this->packets = p;
-		}
-
-		delete this->current;
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return this->chunks.size();
 	}
 
 	/**
-	 * Begin the destruction of this packet writer. It can happen in two ways:
-	 * in the first case the client disconnected while saving the map. In this
-	 * case the saving has not finished and killed this PacketWriter. In that
-	 * case we simply set cs to nullptr, triggering the appending to fail due to
-	 * the connection problem and eventually triggering the destructor. In the
-	 * second case the destructor is already called, and it is waiting for our
-	 * signal which we will send. Only then the packets will be removed by the
-	 * destructor.
+	 * Create a map data packet for a chunk of the savegame.
+	 * @param index Index of the chunk.
+	 * @return The packet, or nullptr when the chunk has not been written yet.
 	 */
-	void Destroy()
+	Packet *MakeDataPacket(size_t index)
 	{
-		std::unique_lock<std::mutex> lock(this->mutex);
-
-		this->cs = nullptr;
-
-		this->exit_sig.notify_all();
-		lock.unlock();
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (index >= this->chunks.size()) return nullptr;
 
-		/* Make sure the saving is completely cancelled. Yes,
-		 * we need to handle the save finish as well as the
-		 * next connection might just be requesting a map. */
-		WaitTillSaved();
-		ProcessAsyncSaveFinish();
+		const std::vector<byte> &chunk = this->chunks[index];
+		Packet *p = new Packet(PACKET_SERVER_MAP_DATA);
+		memcpy(p->buffer + p->size, chunk.data(), chunk.size());
+		p->size += (PacketSize)chunk.size();
+		return p;
 	}
+};
+
+/** Writing a savegame directly to a shared snapshot. */
+struct NetworkMapSnapshotWriter : SaveFilter {
+	std::shared_ptr<NetworkMapSnapshot> snapshot; ///< The snapshot we are writing to.
+	std::vector<byte> current;                    ///< The chunk we're currently writing to.
 
 	/**
-	 * Checks whether there are packets.
-	 * It's not 100% threading safe, but this is only asked for when checking
-	 * whether there still is something to send. Then another call will be made
-	 * to actually get the Packet, which will be the only one popping packets
-	 * and thus eventually setting this on false.
+	 * Create the snapshot writer.
+	 * @param snapshot The snapshot to write the savegame to.
 	 */
-	bool HasPackets()
+	NetworkMapSnapshotWriter(std::shared_ptr<NetworkMapSnapshot> snapshot) : SaveFilter(nullptr), snapshot(std::move(snapshot))
 	{
-		return this->packets != nullptr;
+		this->current.reserve(NetworkMapSnapshot::CHUNK_SIZE);
 	}
 
-	/**
-	 * Pop a single created packet from the queue with packets.
-	 */
-	Packet *PopPacket()
+	/** Mark the end of the saving, regardless of whether it was successful. */
+	~NetworkMapSnapshotWriter()
 	{
-		std::lock_guard<std::mutex> lock(this->mutex);
-
-		Packet *p = this->packets;
-		this->packets = p->next;
-		p->next = nullptr;
-
-		return p;
+		this->snapshot->done.store(true);
 	}
 
-	/** Append the current packet to the queue. */
-	void AppendQueue()
+	/** Append the current chunk to the snapshot. */
+	void AppendChunk()
 	{
-		if (this->current == nullptr) return;
+		if (this->current.empty()) return;
 
-		Packet **p = &this->packets;
-		while (*p != nullptr) {
-			p = &(*p)->next;
-		}
-		*p = this->current;
-
-		this->current = nullptr;
+		std::lock_guard<std::mutex> lock(this->snapshot->mutex);
+		this->snapshot->chunks.emplace_back(std::move(this->current));
+		this->current = std::vector<byte>();
 	}
 
 	void Write(byte *buf, size_t size) override
 	{
-		/* We want to abort the saving when the socket is closed. */
-		if (this->cs == nullptr) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
-
-		if (this->current == nullptr) this->current = new Packet(PACKET_SERVER_MAP_DATA);
-
-		std::lock_guard<std::mutex> lock(this->mutex);
+		/* We want to abort the saving when all sockets are closed. */
+		if (this->snapshot->clients.load() == 0) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
 
 		byte *bufe = buf + size;
 		while (buf != bufe) {
-			size_t to_write = min(SHRT_MAX - this->current->size, bufe - buf);
-			memcpy(this->current->buffer + this->current->size, buf, to_write);
-			this->current->size += (PacketSize)to_write;
+			if (this->current.empty()) this->current.reserve(NetworkMapSnapshot::CHUNK_SIZE);
+
+			size_t to_write = min<size_t>(NetworkMapSnapshot::CHUNK_SIZE - this->current.size(), bufe - buf);
+			this->current.insert(this->current.end(), buf, buf + to_write);
 			buf += to_write;
 
-			if (this->current->size == SHRT_MAX) {
-				this->AppendQueue();
-				if (buf != bufe) this->current = new Packet(PACKET_SERVER_MAP_DATA);
-			}
+			if (this->current.size() == NetworkMapSnapshot::CHUNK_SIZE) this->AppendChunk();
 		}
 
-		this->total_size += size;
+		this->snapshot->total_size += size;
 	}
 
 	void Finish() override
 	{
-		/* We want to abort the saving when the socket is closed. */
-		if (this->cs == nullptr) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
+		/* We want to abort the saving when all sockets are closed. */
+		if (this->snapshot->clients.load() == 0) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
 
-		std::lock_guard<std::mutex> lock(this->mutex);
-
-		/* Make sure the last packet is flushed. */
-		this->AppendQueue();
-
-		/* Add a packet stating that this is the end to the queue. */
-		this->current = new Packet(PACKET_SERVER_MAP_DONE);
-		this->AppendQueue();
+		/* Make sure the last chunk is flushed. */
+		this->AppendChunk();
 
-		/* Fast-track the size to the client. */
-		Packet *p = new Packet(PACKET_SERVER_MAP_SIZE);
-		p->Send_uint32((uint32)this->total_size);
-		this->cs->NetworkTCPSocketHandler::SendPacket(p);
+		this->snapshot->finished.store(true);
 	}
 };
 
+/** The snapshot which is currently being saved, clients requesting the map in the meantime have to wait for the next one. */
+static std::shared_ptr<NetworkMapSnapshot> _network_map_snapshot;
+
 
 /**
  * Create a new socket for the server side of the game connection.
@@ -232,10 +204,7 @@ ServerNetworkGameSocketHandler::~ServerNetworkGameSocketHandler()
 	if (_redirect_console_to_client == this->client_id) _redirect_console_to_client = INVALID_CLIENT_ID;
 	OrderBackup::ResetUser(this->client_id);
 
-	if (this->savegame != nullptr) {
-		this->savegame->Destroy();
-		this->savegame = nullptr;
-	}
+	this->ReleaseMapSnapshot();
 }
 
 Packet *ServerNetworkGameSocketHandler::ReceivePacket()
@@ -317,6 +286,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::CloseConnection(NetworkRecvSta
 /** Send the packets for the server sockets. */
 /* static */ void ServerNetworkGameSocketHandler::Send()
 {
+	CheckMapSnapshot();
+
 	for (NetworkClientSocket *cs : NetworkClientSocket::Iterate()) {
 		if (cs->writable) {
 			if (cs->status == STATUS_CLOSE_PENDING) {
@@ -583,82 +554,134 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendWait()
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/**
+ * Attach this client to a map snapshot, and tell it the download is starting.
+ * @param snapshot The snapshot which will be sent to this client.
+ */
+void ServerNetworkGameSocketHandler::BeginMapTransfer(const std::shared_ptr<NetworkMapSnapshot> &snapshot)
+{
+	this->savegame = snapshot;
+	this->savegame->clients++;
+	this->savegame_chunk = 0;
+	this->savegame_size_sent = false;
+	this->savegame_send_window = 4; // We start with trying 4 packets
+
+	/* Now send the _frame_counter and how many packets are coming */
+	Packet *p = new Packet(PACKET_SERVER_MAP_BEGIN);
+	p->Send_uint32(_frame_counter);
+	this->SendPacket(p);
+
+	NetworkSyncCommandQueue(this);
+	this->status = STATUS_MAP;
+	/* Mark the start of download */
+	this->last_frame = _frame_counter;
+	this->last_frame_server = _frame_counter;
+}
+
+/** Drop the reference of this client to its map snapshot, if any. */
+void ServerNetworkGameSocketHandler::ReleaseMapSnapshot()
+{
+	if (this->savegame == nullptr) return;
+
+	this->savegame->clients--;
+	this->savegame.reset();
+}
+
+/**
+ * Make a snapshot of the game, and start sending it to the given client and all clients that are waiting for the map.
+ * @param cs The client which requested the map, or nullptr when only starting the waiting clients.
+ */
+/* static */ void ServerNetworkGameSocketHandler::StartMapSnapshot(ServerNetworkGameSocketHandler *cs)
+{
+	assert(_network_map_snapshot == nullptr);
+
+	/* Make sure the previous saving is completely cleaned up. */
+	WaitTillSaved();
+
+	std::shared_ptr<NetworkMapSnapshot> snapshot = std::make_shared<NetworkMapSnapshot>();
+	uint clients = 0;
+	for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
+		if (new_cs == cs || new_cs->status == STATUS_MAP_WAIT) {
+			new_cs->BeginMapTransfer(snapshot);
+			clients++;
+		}
+	}
+	if (clients == 0) return;
+
+	DEBUG(net, 3, "Making map snapshot at frame %u for %u client(s)", _frame_counter, clients);
+	_network_map_snapshot = snapshot;
+
+	/* Make a dump of the current game */
+	if (SaveWithFilter(new NetworkMapSnapshotWriter(std::move(snapshot)), true) != SL_OK) usererror("network savedump failed");
+}
+
+/**
+ * Check whether the saving of the current map snapshot has ended, and
+ * if so start a new snapshot for clients which requested the map meanwhile.
+ */
+/* static */ void ServerNetworkGameSocketHandler::CheckMapSnapshot()
+{
+	if (_network_map_snapshot != nullptr) {
+		if (!_network_map_snapshot->done.load()) return;
+		_network_map_snapshot.reset();
+	}
+
+	for (NetworkClientSocket *cs : NetworkClientSocket::Iterate()) {
+		if (cs->status == STATUS_MAP_WAIT) {
+			StartMapSnapshot(nullptr);
+			return;
+		}
+	}
+}
+
 /** This sends the map to the client */
 NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 {
-	static uint sent_packets; // How many packets we did send successfully last time
-
 	if (this->status < STATUS_AUTHORIZED) {
 		/* Illegal call, return error and ignore the packet */
 		return this->SendError(NETWORK_ERROR_NOT_AUTHORIZED);
 	}
 
 	if (this->status == STATUS_AUTHORIZED) {
-		this->savegame = new PacketWriter(this);
-
-		/* Now send the _frame_counter and how many packets are coming */
-		Packet *p = new Packet(PACKET_SERVER_MAP_BEGIN);
-		p->Send_uint32(_frame_counter);
-		this->SendPacket(p);
-
-		NetworkSyncCommandQueue(this);
-		this->status = STATUS_MAP;
-		/* Mark the start of download */
-		this->last_frame = _frame_counter;
-		this->last_frame_server = _frame_counter;
-
-		sent_packets = 4; // We start with trying 4 packets
-
-		/* Make a dump of the current game */
-		if (SaveWithFilter(this->savegame, true) != SL_OK) usererror("network savedump failed");
+		StartMapSnapshot(this);
 	}
 
 	if (this->status == STATUS_MAP) {
-		bool last_packet = false;
-		bool has_packets = false;
+		if (this->savegame->HasFailed()) {
+			/* Saving was cancelled or failed, there is nothing more to come. */
+			this->ReleaseMapSnapshot();
+			return this->SendError(NETWORK_ERROR_SAVEGAME_FAILED);
+		}
 
-		for (uint i = 0; (has_packets = this->savegame->HasPackets()) && i < sent_packets; i++) {
-			Packet *p = this->savegame->PopPacket();
-			last_packet = p->buffer[2] == PACKET_SERVER_MAP_DONE;
+		/* Check this before sending, so no chunk can be written between sending the last one and the done packet. */
+		const bool finished = this->savegame->finished.load();
 
+		if (finished && !this->savegame_size_sent) {
+			/* Fast-track the size to the client. */
+			Packet *p = new Packet(PACKET_SERVER_MAP_SIZE);
+			p->Send_uint32((uint32)this->savegame->total_size);
 			this->SendPacket(p);
+			this->savegame_size_sent = true;
+		}
 
-			if (last_packet) {
-				/* There is no more data, so break the for */
-				break;
-			}
+		for (uint i = 0; i < this->savegame_send_window; i++) {
+			Packet *p = this->savegame->MakeDataPacket(this->savegame_chunk);
+			if (p == nullptr) break;
+
+			this->SendPacket(p);
+			this->savegame_chunk++;
 		}
 
-		if (last_packet) {
-			/* Done reading, make sure saving is done as well */
-			this->savegame->Destroy();
-			this->savegame = nullptr;
+		const bool has_packets = this->savegame_chunk < this->savegame->GetChunkCount();
+
+		if (finished && !has_packets) {
+			/* There is no more data, so tell the client. */
+			this->SendPacket(new Packet(PACKET_SERVER_MAP_DONE));
+			this->ReleaseMapSnapshot();
 
 			/* Set the status to DONE_MAP, no we will wait for the client
 			 *  to send it is ready (maybe that happens like never ;)) */
 			this->status = STATUS_DONE_MAP;
-
-			/* Find the best candidate for joining, i.e. the first joiner. */
-			NetworkClientSocket *best = nullptr;
-			for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
-				if (new_cs->status == STATUS_MAP_WAIT) {
-					if (best == nullptr || best->GetInfo()->join_date > new_cs->GetInfo()->join_date || (best->GetInfo()->join_date == new_cs->GetInfo()->join_date && best->client_id > new_cs->client_id)) {
-						best = new_cs;
-					}
-				}
-			}
-
-			/* Is there someone else to join? */
-			if (best != nullptr) {
-				/* Let the first start joining. */
-				best->status = STATUS_AUTHORIZED;
-				best->SendMap();
-
-				/* And update the rest. */
-				for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
-					if (new_cs->status == STATUS_MAP_WAIT) new_cs->SendWait();
-				}
-			}
 		}
 
 		switch (this->SendPackets()) {
@@ -666,8 +689,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 				return NETWORK_RECV_STATUS_CONN_LOST;
 
 			case SPS_ALL_SENT:
-				/* All are sent, increase the sent_packets */
-				if (has_packets) sent_packets *= 2;
+				/* All are sent, increase the send window */
+				if (has_packets) this->savegame_send_window *= 2;
 				break;
 
 			case SPS_PARTLY_SENT:
@@ -675,8 +698,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 				break;
 
 			case SPS_NONE_SENT:
-				/* Not everything is sent, decrease the sent_packets */
-				if (sent_packets > 1) sent_packets /= 2;
+				/* Not everything is sent, decrease the send window */
+				if (this->savegame_send_window > 1) this->savegame_send_window /= 2;
 				break;
 		}
 	}
@@ -1067,13 +1090,11 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_GETMAP(Packet *
 		return this->SendError(NETWORK_ERROR_NOT_AUTHORIZED);
 	}
 
-	/* Check if someone else is receiving the map */
-	for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
-		if (new_cs->status == STATUS_MAP) {
-			/* Tell the new client to wait */
-			this->status = STATUS_MAP_WAIT;
-			return this->SendWait();
-		}
+	/* Check if a map snapshot is being made for other clients right now */
+	if (_network_map_snapshot != nullptr) {
+		/* Tell the new client to wait for the next snapshot */
+		this->status = STATUS_MAP_WAIT;
+		return this->SendWait();
 	}
 
 	/* We receive a request to upload the map.. give it to the client! */
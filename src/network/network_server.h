@@ -12,6 +12,7 @@
 
 #include "network_internal.h"
 #include "core/tcp_listen.h"
+#include <memory>
 
 class ServerNetworkGameSocketHandler;
 /** Make the code look slightly nicer/simpler. */
@@ -49,6 +50,11 @@ protected:
 	NetworkRecvStatus SendNeedGamePassword();
 	NetworkRecvStatus SendNeedCompanyPassword();
 
+	void BeginMapTransfer(const std::shared_ptr<struct NetworkMapSnapshot> &snapshot);
+	void ReleaseMapSnapshot();
+	static void StartMapSnapshot(ServerNetworkGameSocketHandler *cs);
+	static void CheckMapSnapshot();
+
 public:
 	/** Status of a client */
 	enum ClientStatus {
@@ -77,7 +83,10 @@ public:
 	uint32 settings_hash_bits;   ///< Settings password hash entropy bits
 	bool settings_authed = false;///< Authorised to control all game settings
 
-	struct PacketWriter *savegame; ///< Writer used to write the savegame.
+	std::shared_ptr<struct NetworkMapSnapshot> savegame; ///< Snapshot of the savegame which is being sent to the client.
+	size_t savegame_chunk = 0;       ///< Index of the next savegame chunk to send.
+	uint savegame_send_window = 0;   ///< Number of savegame packets to try to send at once.
+	bool savegame_size_sent = false; ///< Whether the size of the savegame has been sent.
 	NetworkAddress client_address; ///< IP-address of the client (so he can be banned)
 
 	std::string desync_log;
@@ -10307,6 +10307,9 @@ static void AfterLoadGRFs()
 
 	FinalisePriceBaseMultipliers();
 
+	/* Shorten the variational action 2 chains, now that all of them are loaded. */
+	OptimiseDeterministicSpriteGroups();
+
 	/* Deallocate temporary loading data */
 	free(_gted);
 	_grm_sprites.clear();
@@ -83,7 +83,7 @@ private:
 };
 
 StationGfx GetTranslatedAirportTileID(StationGfx gfx);
-void AnimateAirportTile(TileIndex tile);
+uint8 AnimateAirportTile(TileIndex tile);
 void AirportTileAnimationTrigger(Station *st, TileIndex tile, AirpAnimationTrigger trigger, CargoID cargo_type = CT_INVALID);
 void AirportAnimationTrigger(Station *st, AirpAnimationTrigger trigger, CargoID cargo_type = CT_INVALID);
 bool DrawNewAirportTile(TileInfo *ti, Station *st, StationGfx gfx, const AirportTileSpec *airts);
@@ -34,14 +34,18 @@ struct AnimationBase {
 	 * @param tile        Tile to animate changes for.
 	 * @param random_animation Whether to pass random bits to the "next frame" callback.
 	 * @param extra_data  Custom extra callback data.
+	 * @return The animation speed to schedule the tile with, see #AnimateTileProc.
 	 */
-	static void AnimateTile(const Tspec *spec, Tobj *obj, TileIndex tile, bool random_animation, Textra extra_data = 0)
+	static uint8 AnimateTile(const Tspec *spec, Tobj *obj, TileIndex tile, bool random_animation, Textra extra_data = 0)
 	{
 		assert(spec != nullptr);
 
 		/* Acquire the animation speed from the NewGRF. */
 		uint8 animation_speed = spec->animation.speed;
+		/* The speed from the callback can change from tick to tick, so the tile then has to be looked at each tick. */
+		uint8 schedule_speed = animation_speed;
 		if (HasBit(spec->callback_mask, Tbase::cbm_animation_speed)) {
+			schedule_speed = 0;
 			uint16 callback = GetCallback(Tbase::cb_animation_speed, 0, 0, spec, obj, tile, extra_data);
 			if (callback != CALLBACK_FAILED) {
 				if (callback >= 0x100 && spec->grf_prop.grffile->grf_version >= 8) ErrorUnknownCallbackResult(spec->grf_prop.grffile->grfid, Tbase::cb_animation_speed, callback);
@@ -53,7 +57,7 @@ struct AnimationBase {
 		 * increasing this value by one doubles the wait. 0 is the minimum value
 		 * allowed for animation_speed, which corresponds to 30ms, and 16 is the
 		 * maximum, corresponding to around 33 minutes. */
-		if (_scaled_tick_counter % (1 << animation_speed) != 0) return;
+		if (_scaled_tick_counter % (1 << animation_speed) != 0) return schedule_speed;
 
 		uint8 frame      = GetAnimationFrame(tile);
 		uint8 num_frames = spec->animation.frames;
@@ -100,6 +104,8 @@ struct AnimationBase {
 
 		SetAnimationFrame(tile, frame);
 		MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
+
+		return schedule_speed;
 	}
 
 	/**
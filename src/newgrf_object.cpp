@@ -521,13 +521,14 @@ struct ObjectAnimationBase : public AnimationBase<ObjectAnimationBase, ObjectSpe
 /**
  * Handle the animation of the object tile.
  * @param tile The tile to animate.
+ * @return The animation speed to schedule the tile with, see #AnimateTileProc.
  */
-void AnimateNewObjectTile(TileIndex tile)
+uint8 AnimateNewObjectTile(TileIndex tile)
 {
 	const ObjectSpec *spec = ObjectSpec::GetByTile(tile);
-	if (spec == nullptr || !(spec->flags & OBJECT_FLAG_ANIMATION)) return;
+	if (spec == nullptr || !(spec->flags & OBJECT_FLAG_ANIMATION)) return 0;
 
-	ObjectAnimationBase::AnimateTile(spec, Object::GetByTile(tile), tile, (spec->flags & OBJECT_FLAG_ANIM_RANDOM_BITS) != 0);
+	return ObjectAnimationBase::AnimateTile(spec, Object::GetByTile(tile), tile, (spec->flags & OBJECT_FLAG_ANIM_RANDOM_BITS) != 0);
 }
 
 /**
@@ -14,6 +14,8 @@
 #include "newgrf_profiling.h"
 #include "core/pool_func.hpp"
 #include "vehicle_type.h"
+#include <unordered_set>
+#include <vector>
 
 #include "safeguards.h"
 
@@ -65,6 +67,7 @@ DeterministicSpriteGroup::~DeterministicSpriteGroup()
 {
 	free(this->adjusts);
 	free(this->ranges);
+	free(this->jump_table);
 }
 
 RandomizedSpriteGroup::~RandomizedSpriteGroup()
@@ -199,6 +202,17 @@ static U EvalAdjustT(const DeterministicSpriteGroupAdjust *adjust, ScopeResolver
 	}
 }
 
+/* Evaluate an adjustment for the variable size of a deterministic sprite group. */
+static uint32 EvalAdjust(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust *adjust, ScopeResolver *scope, uint32 last_value, uint32 value)
+{
+	switch (size) {
+		case DSG_SIZE_BYTE:  return EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value);
+		case DSG_SIZE_WORD:  return EvalAdjustT<uint16, int16>(adjust, scope, last_value, value);
+		case DSG_SIZE_DWORD: return EvalAdjustT<uint32, int32>(adjust, scope, last_value, value);
+		default: NOT_REACHED();
+	}
+}
+
 bool _sprite_group_resolve_check_veh_check = false;
 VehicleType _sprite_group_resolve_check_veh_type;
 
@@ -290,12 +304,7 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 			return SpriteGroup::Resolve(this->error_group, object, false);
 		}
 
-		switch (this->size) {
-			case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value); break;
-			case DSG_SIZE_WORD:  value = EvalAdjustT<uint16, int16>(adjust, scope, last_value, value); break;
-			case DSG_SIZE_DWORD: value = EvalAdjustT<uint32, int32>(adjust, scope, last_value, value); break;
-			default: NOT_REACHED();
-		}
+		value = EvalAdjust(this->size, adjust, scope, last_value, value);
 		last_value = value;
 	}
 
@@ -309,23 +318,506 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 		return &nvarzero;
 	}
 
+	return SpriteGroup::Resolve(this->GetRangeGroup(value), object, false);
+}
+
+/**
+ * Get the group to continue with for a computed value, i.e.\ the group of the range holding the value, or the default group.
+ * @param value The computed value.
+ * @return The group to resolve next.
+ */
+const SpriteGroup *DeterministicSpriteGroup::GetRangeGroup(uint32 value) const
+{
+	if (this->jump_table != nullptr) {
+		const uint32 index = value - this->jump_table_base;
+		return index < this->jump_table_size ? this->jump_table[index] : this->default_group;
+	}
+
 	if (this->num_ranges > 4) {
-		DeterministicSpriteGroupRange *lower = std::lower_bound(this->ranges + 0, this->ranges + this->num_ranges, value, RangeHighComparator);
+		const DeterministicSpriteGroupRange *lower = std::lower_bound(this->ranges + 0, this->ranges + this->num_ranges, value, RangeHighComparator);
 		if (lower != this->ranges + this->num_ranges && lower->low <= value) {
 			assert(lower->low <= value && value <= lower->high);
-			return SpriteGroup::Resolve(lower->group, object, false);
+			return lower->group;
 		}
 	} else {
-		for (i = 0; i < this->num_ranges; i++) {
+		for (uint i = 0; i < this->num_ranges; i++) {
 			if (this->ranges[i].low <= value && value <= this->ranges[i].high) {
-				return SpriteGroup::Resolve(this->ranges[i].group, object, false);
+				return this->ranges[i].group;
 			}
 		}
 	}
 
-	return SpriteGroup::Resolve(this->default_group, object, false);
+	return this->default_group;
+}
+
+
+/** Maximum depth of nested subroutines followed while optimising deterministic sprite groups. */
+static const uint MAX_DSG_OPTIMISE_DEPTH = 256;
+/** Maximum number of entries of the jump table of a deterministic sprite group. */
+static const uint MAX_DSG_JUMP_TABLE_SIZE = 256;
+
+/**
+ * Check whether reading a variable never fails, i.e.\ an adjustment reading it never diverts the resolving to the error group.
+ * @param variable The variable.
+ * @return True if the variable is always available.
+ */
+static bool IsAlwaysAvailableDSGVariable(byte variable)
+{
+	switch (variable) {
+		case 0x0C:
+		case 0x10:
+		case 0x18:
+		case 0x1A:
+		case 0x1C:
+		case 0x5F:
+		case 0x7D:
+		case 0x7F:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Check whether an adjustment reads a value which does not depend on the resolved object.
+ * Variable 0x1A is a constant, and every variable which is always available is a constant when masked with zero.
+ * Variable 0x7F is not a constant: the parameters are those of the GRF the group is resolved for.
+ * @param adjust The adjustment.
+ * @return True if the read value is a constant.
+ */
+static bool IsConstantDSGVariable(const DeterministicSpriteGroupAdjust &adjust)
+{
+	return adjust.variable == 0x1A || (adjust.and_mask == 0 && IsAlwaysAvailableDSGVariable(adjust.variable));
+}
+
+/**
+ * Get the largest value a deterministic sprite group of the given variable size computes.
+ * @param size The variable size.
+ * @return The mask of the computed values.
+ */
+static uint32 GetDSGValueMask(DeterministicSpriteGroupSize size)
+{
+	switch (size) {
+		case DSG_SIZE_BYTE:  return 0xFF;
+		case DSG_SIZE_WORD:  return 0xFFFF;
+		case DSG_SIZE_DWORD: return 0xFFFFFFFF;
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Interpret a value as the signed type of the given variable size.
+ * @param size The variable size.
+ * @param value The value.
+ * @return The sign extended value.
+ */
+static int32 GetSignedDSGValue(DeterministicSpriteGroupSize size, uint32 value)
+{
+	switch (size) {
+		case DSG_SIZE_BYTE:  return (int8)value;
+		case DSG_SIZE_WORD:  return (int16)value;
+		case DSG_SIZE_DWORD: return (int32)value;
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Evaluate an adjustment reading a constant variable.
+ * @param size The variable size of the group.
+ * @param adjust The adjustment.
+ * @param last_value The value computed by the previous adjustments.
+ * @return The value computed by the adjustment.
+ */
+static uint32 EvalConstantDSGAdjust(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust, uint32 last_value)
+{
+	return EvalAdjust(size, &adjust, nullptr, last_value, adjust.variable == 0x1A ? UINT_MAX : 0);
+}
+
+/**
+ * Get the operand of the operation of an adjustment reading a constant variable, i.e.\ the read value after shifting, masking, and the optional division or modulo.
+ * @param size The variable size of the group.
+ * @param adjust The adjustment.
+ * @param[out] operand The operand.
+ * @return False if the operand can not be computed beforehand, as it divides by zero or may overflow.
+ */
+static bool GetConstantDSGOperand(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust, uint32 &operand)
+{
+	if (adjust.type != DSGA_TYPE_NONE) {
+		const int32 divisor = GetSignedDSGValue(size, adjust.divmod_val);
+		if (divisor == 0 || divisor == -1) return false;
+	}
+
+	DeterministicSpriteGroupAdjust load = adjust;
+	load.operation = DSGA_OP_RST;
+	operand = EvalConstantDSGAdjust(size, load, 0);
+	return true;
+}
+
+/**
+ * Check whether an adjustment only computes a new value from the previous value and a constant, so it can be evaluated beforehand.
+ * @param size The variable size of the group.
+ * @param adjust The adjustment.
+ * @return True if the adjustment can be evaluated beforehand.
+ */
+static bool IsFoldableDSGAdjust(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust)
+{
+	if (adjust.operation == DSGA_OP_STO || adjust.operation == DSGA_OP_STOP) return false;
+	if (!IsConstantDSGVariable(adjust)) return false;
+
+	uint32 operand;
+	if (!GetConstantDSGOperand(size, adjust, operand)) return false;
+
+	switch (adjust.operation) {
+		/* The division by zero check is done before truncating the operand to the variable size. */
+		case DSGA_OP_UDIV:
+		case DSGA_OP_UMOD:
+			return operand != 0;
+
+		case DSGA_OP_SDIV:
+		case DSGA_OP_SMOD:
+			return operand != 0 && GetSignedDSGValue(size, operand) != -1;
+
+		default:
+			return true;
+	}
+}
+
+/**
+ * Check whether an adjustment has no effect other than computing a new value, so it can be left out when that value is unused.
+ * @param adjust The adjustment.
+ * @return True if the adjustment has no side effects.
+ */
+static bool IsPureDSGAdjust(const DeterministicSpriteGroupAdjust &adjust)
+{
+	return adjust.operation != DSGA_OP_STO && adjust.operation != DSGA_OP_STOP && IsAlwaysAvailableDSGVariable(adjust.variable);
+}
+
+/**
+ * Check whether an adjustment never changes the value computed by the previous adjustments.
+ * @param size The variable size of the group.
+ * @param adjust The adjustment.
+ * @return True if the adjustment can be left out.
+ */
+static bool IsIdentityDSGAdjust(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust)
+{
+	if (!IsFoldableDSGAdjust(size, adjust)) return false;
+
+	uint32 operand;
+	GetConstantDSGOperand(size, adjust, operand);
+
+	switch (adjust.operation) {
+		case DSGA_OP_ADD:
+		case DSGA_OP_SUB:
+		case DSGA_OP_OR:
+		case DSGA_OP_XOR:
+		case DSGA_OP_UMAX:
+			return operand == 0;
+
+		case DSGA_OP_SHL:
+		case DSGA_OP_SHR:
+		case DSGA_OP_SAR:
+		case DSGA_OP_ROR:
+			return (operand & 0x1F) == 0;
+
+		case DSGA_OP_MUL:
+		case DSGA_OP_UDIV:
+		case DSGA_OP_SDIV:
+			return operand == 1;
+
+		case DSGA_OP_AND:
+		case DSGA_OP_UMIN:
+			return operand == GetDSGValueMask(size);
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Make an adjustment which loads a constant value.
+ * @param value The value.
+ * @return The adjustment.
+ */
+static DeterministicSpriteGroupAdjust MakeConstantDSGAdjust(uint32 value)
+{
+	DeterministicSpriteGroupAdjust adjust;
+	adjust.operation = DSGA_OP_RST;
+	adjust.type = DSGA_TYPE_NONE;
+	adjust.variable = 0x1A;
+	adjust.shift_num = 0;
+	adjust.parameter = 0;
+	adjust.and_mask = value;
+	adjust.add_val = 0;
+	adjust.divmod_val = 0;
+	adjust.subroutine = nullptr;
+	return adjust;
+}
+
+/**
+ * Evaluate the runs of foldable adjustments whose start value is known beforehand, and replace each run by a single adjustment loading its result.
+ * @param size The variable size of the group.
+ * @param[in,out] adjusts The adjustments of the group.
+ */
+static void FoldDSGAdjusts(DeterministicSpriteGroupSize size, std::vector<DeterministicSpriteGroupAdjust> &adjusts)
+{
+	std::vector<DeterministicSpriteGroupAdjust> result;
+	bool known = true;        // The value computed so far is known beforehand.
+	bool materialised = true; // The known value is also the value computed by the adjustments in the result.
+	uint32 value = 0;
+
+	for (const DeterministicSpriteGroupAdjust &adjust : adjusts) {
+		if ((known || adjust.operation == DSGA_OP_RST) && IsFoldableDSGAdjust(size, adjust)) {
+			value = EvalConstantDSGAdjust(size, adjust, value);
+			known = true;
+			materialised = false;
+			continue;
+		}
+
+		/* The computed value starts at zero, so there is nothing to load at the start of the chain. */
+		if (known && !materialised && (value != 0 || !result.empty())) result.push_back(MakeConstantDSGAdjust(value));
+		materialised = true;
+		result.push_back(adjust);
+
+		/* Storing to a register does not change the computed value. */
+		if (adjust.operation != DSGA_OP_STO && adjust.operation != DSGA_OP_STOP) known = false;
+	}
+	if (known && !materialised && (value != 0 || !result.empty())) result.push_back(MakeConstantDSGAdjust(value));
+
+	adjusts.swap(result);
 }
 
+/**
+ * Remove the adjustments without side effects whose computed value is never used, or which do not change the computed value.
+ * @param size The variable size of the group.
+ * @param[in,out] adjusts The adjustments of the group.
+ */
+static void RemoveUnusedDSGAdjusts(DeterministicSpriteGroupSize size, std::vector<DeterministicSpriteGroupAdjust> &adjusts)
+{
+	std::vector<DeterministicSpriteGroupAdjust> result;
+	bool used = true; // The value computed by the current adjustment is used by the next ones, or is the result.
+
+	for (auto it = adjusts.rbegin(); it != adjusts.rend(); ++it) {
+		const DeterministicSpriteGroupAdjust &adjust = *it;
+		if (IsPureDSGAdjust(adjust) && (!used || IsIdentityDSGAdjust(size, adjust))) continue;
+
+		result.push_back(adjust);
+		/* Variable 0x7B takes the computed value as parameter. */
+		used = adjust.operation != DSGA_OP_RST || adjust.variable == 0x7B;
+	}
+
+	std::reverse(result.begin(), result.end());
+	adjusts.swap(result);
+}
+
+/**
+ * Check whether the adjustments from some position on never see object.last_value, i.e.\ the result of the last resolved deterministic sprite group.
+ * That value is replaced by the own result of the group when it has been computed.
+ * @param adjusts The adjustments of the group.
+ * @param first The first adjustment to check.
+ * @return True if the value is not read, and the adjustments can not divert the resolving to the error group before it is replaced.
+ */
+static bool IsDSGLastValueUnused(const std::vector<DeterministicSpriteGroupAdjust> &adjusts, size_t first)
+{
+	for (size_t i = first; i < adjusts.size(); i++) {
+		/* This also rules out variables 0x7B and 0x7E. */
+		if (adjusts[i].variable == 0x1C || !IsAlwaysAvailableDSGVariable(adjusts[i].variable)) return false;
+	}
+	return true;
+}
+
+/** Optimiser of the deterministic sprite groups, keeping track of the optimised groups and the totals of the changes. */
+struct DeterministicSpriteGroupOptimiser {
+	/** Outcome of resolving a sprite group which does not depend on the resolved object. */
+	struct ConstantResult {
+		uint16 callback_result; ///< Callback result of the resolved group.
+		bool sets_last_value;   ///< Whether resolving sets object.last_value.
+		uint32 last_value;      ///< The set value of object.last_value.
+	};
+
+	std::unordered_set<const DeterministicSpriteGroup *> done; ///< The groups which have been optimised, or are being optimised.
+
+	uint groups = 0;         ///< Number of optimised groups.
+	uint adjusts_before = 0; ///< Number of adjustments before optimising.
+	uint adjusts_after = 0;  ///< Number of adjustments after optimising.
+	uint folded = 0;         ///< Number of adjustments removed by evaluating them beforehand.
+	uint removed = 0;        ///< Number of removed unused adjustments.
+	uint inlined = 0;        ///< Number of subroutine calls replaced by their result.
+	uint jump_tables = 0;    ///< Number of groups with a jump table.
+
+	/**
+	 * Get the outcome of resolving a sprite group, if it does not depend on the resolved object.
+	 * @param group The group.
+	 * @param[out] result The outcome.
+	 * @param depth Nesting depth of the group.
+	 * @return True if the outcome is a constant.
+	 */
+	bool GetConstantResult(const SpriteGroup *group, ConstantResult &result, uint depth)
+	{
+		result.sets_last_value = false;
+		result.last_value = 0;
+
+		if (group == nullptr) {
+			result.callback_result = CALLBACK_FAILED;
+			return true;
+		}
+
+		switch (group->type) {
+			case SGT_CALLBACK:
+			case SGT_RESULT:
+			case SGT_TILELAYOUT:
+			case SGT_INDUSTRY_PRODUCTION:
+				result.callback_result = group->GetCallbackResult();
+				return true;
+
+			case SGT_DETERMINISTIC: {
+				if (depth >= MAX_DSG_OPTIMISE_DEPTH) return false;
+
+				DeterministicSpriteGroup *dsg = const_cast<DeterministicSpriteGroup *>(static_cast<const DeterministicSpriteGroup *>(group));
+				this->Optimise(dsg, depth);
+
+				uint32 value = 0;
+				for (uint i = 0; i < dsg->num_adjusts; i++) {
+					if (!IsFoldableDSGAdjust(dsg->size, dsg->adjusts[i])) return false;
+					value = EvalConstantDSGAdjust(dsg->size, dsg->adjusts[i], value);
+				}
+
+				if (dsg->calculated_result) {
+					result.callback_result = value != CALLBACK_FAILED ? GB(value, 0, 15) : CALLBACK_FAILED;
+					result.sets_last_value = true;
+					result.last_value = value;
+					return true;
+				}
+
+				ConstantResult next;
+				if (!this->GetConstantResult(dsg->GetRangeGroup(value), next, depth + 1)) return false;
+				result.callback_result = next.callback_result;
+				result.sets_last_value = true;
+				result.last_value = next.sets_last_value ? next.last_value : value;
+				return true;
+			}
+
+			default:
+				return false;
+		}
+	}
+
+	/**
+	 * Optimise a deterministic sprite group, and the subroutines it calls.
+	 * @param group The group.
+	 * @param depth Nesting depth of the group.
+	 */
+	void Optimise(DeterministicSpriteGroup *group, uint depth)
+	{
+		if (!this->done.insert(group).second) return;
+
+		std::vector<DeterministicSpriteGroupAdjust> adjusts(group->adjusts, group->adjusts + group->num_adjusts);
+
+		/* Replace the calls of subroutines with a constant outcome by their result. */
+		for (size_t i = 0; i < adjusts.size(); i++) {
+			DeterministicSpriteGroupAdjust &adjust = adjusts[i];
+			if (adjust.variable != 0x7E) continue;
+
+			ConstantResult result;
+			if (!this->GetConstantResult(adjust.subroutine, result, depth + 1)) continue;
+			if (result.sets_last_value && !IsDSGLastValueUnused(adjusts, i + 1)) continue;
+
+			adjust.variable = 0x1A;
+			adjust.and_mask &= (uint32)result.callback_result >> adjust.shift_num;
+			adjust.shift_num = 0;
+			adjust.subroutine = nullptr;
+			this->inlined++;
+		}
+
+		size_t count;
+		do {
+			count = adjusts.size();
+			FoldDSGAdjusts(group->size, adjusts);
+			this->folded += (uint)(count - adjusts.size());
+
+			const size_t folded_count = adjusts.size();
+			RemoveUnusedDSGAdjusts(group->size, adjusts);
+			this->removed += (uint)(folded_count - adjusts.size());
+		} while (adjusts.size() < count);
+
+		if (adjusts.size() != group->num_adjusts) {
+			DEBUG(grf, 3, "OptimiseDeterministicSpriteGroups: Shortened group of line %u from %u to %u adjustments", group->nfo_line, group->num_adjusts, (uint)adjusts.size());
+		}
+		this->groups++;
+		this->adjusts_before += group->num_adjusts;
+		this->adjusts_after += (uint)adjusts.size();
+
+		/* The optimised chain is never longer, so it fits in the array of the group. */
+		MemCpyT(group->adjusts, adjusts.data(), adjusts.size());
+		group->num_adjusts = (uint)adjusts.size();
+
+		this->MakeJumpTable(group);
+	}
+
+	/**
+	 * Replace the search of the ranges of a deterministic sprite group by a jump table, if its ranges cover few values.
+	 * @param group The group.
+	 */
+	void MakeJumpTable(DeterministicSpriteGroup *group)
+	{
+		if (group->calculated_result || group->num_ranges == 0) return;
+
+		bool constant = true;
+		uint32 value = 0;
+		for (uint i = 0; i < group->num_adjusts; i++) {
+			if (!IsFoldableDSGAdjust(group->size, group->adjusts[i])) {
+				constant = false;
+				break;
+			}
+			value = EvalConstantDSGAdjust(group->size, group->adjusts[i], value);
+		}
+
+		uint32 first = value;
+		uint32 last = value;
+		if (!constant) {
+			/* The computed value never exceeds the variable size, whatever the ranges say. */
+			first = group->ranges[0].low;
+			last = min(group->ranges[group->num_ranges - 1].high, GetDSGValueMask(group->size));
+			if (first > last) return;
+
+			const uint64 size = (uint64)last - first + 1;
+			if (size > MAX_DSG_JUMP_TABLE_SIZE || size > max<uint64>(16, 4 * group->num_ranges)) return;
+		}
+
+		const uint size = last - first + 1;
+		const SpriteGroup **jump_table = MallocT<const SpriteGroup *>(size);
+		for (uint i = 0; i < size; i++) {
+			jump_table[i] = group->GetRangeGroup(first + i);
+		}
+
+		group->jump_table_base = first;
+		group->jump_table_size = size;
+		group->jump_table = jump_table;
+		this->jump_tables++;
+	}
+};
+
+/**
+ * Optimise the deterministic sprite groups of the loaded NewGRFs, after all of them have been loaded.
+ * Constant adjustments are evaluated beforehand, unused adjustments are removed, calls of subroutines
+ * with a constant outcome are replaced by their result, and ranges covering few values are replaced by a jump table.
+ * The resolved result of every group stays the same.
+ */
+void OptimiseDeterministicSpriteGroups()
+{
+	DeterministicSpriteGroupOptimiser optimiser;
+
+	for (SpriteGroup *group : SpriteGroup::Iterate()) {
+		if (group->type == SGT_DETERMINISTIC) optimiser.Optimise(static_cast<DeterministicSpriteGroup *>(group), 0);
+	}
+
+	if (optimiser.groups == 0) return;
+
+	DEBUG(grf, 1, "OptimiseDeterministicSpriteGroups: %u groups, %u -> %u adjustments, %.2f -> %.2f per group (%u folded, %u unused, %u subroutine calls inlined), %u jump tables",
+			optimiser.groups, optimiser.adjusts_before, optimiser.adjusts_after,
+			(double)optimiser.adjusts_before / optimiser.groups, (double)optimiser.adjusts_after / optimiser.groups,
+			optimiser.folded, optimiser.removed, optimiser.inlined, optimiser.jump_tables);
+}
 
 const SpriteGroup *RandomizedSpriteGroup::Resolve(ResolverObject &object) const
 {
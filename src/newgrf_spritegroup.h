@@ -19,6 +19,7 @@
 #include "newgrf_generic.h"
 #include "newgrf_storage.h"
 #include "newgrf_commons.h"
+#include "framerate_type.h"
 
 /**
  * Gets the value of a so-called newgrf "register".
@@ -184,6 +185,12 @@ struct DeterministicSpriteGroup : SpriteGroup {
 
 	const SpriteGroup *error_group; // was first range, before sorting ranges
 
+	uint32 jump_table_base;         ///< Computed value of the first entry of #jump_table.
+	uint jump_table_size;           ///< Number of entries of #jump_table.
+	const SpriteGroup **jump_table; ///< Group of each computed value from #jump_table_base on, replacing the search of the ranges; nullptr when there is no jump table. Dynamically allocated.
+
+	const SpriteGroup *GetRangeGroup(uint32 value) const;
+
 protected:
 	const SpriteGroup *Resolve(ResolverObject &object) const;
 };
@@ -349,6 +356,7 @@ struct ResolverObject {
 	 */
 	const SpriteGroup *Resolve()
 	{
+		TICK_PROFILE_SCOPE("NewGRFResolve");
 		return SpriteGroup::Resolve(this->root_spritegroup, *this);
 	}
 
@@ -413,4 +421,6 @@ struct ResolverObject {
 	virtual uint32 GetDebugID() const { return 0; }
 };
 
+void OptimiseDeterministicSpriteGroups();
+
 #endif /* NEWGRF_SPRITEGROUP_H */
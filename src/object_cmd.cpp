@@ -697,9 +697,9 @@ static bool ClickTile_Object(TileIndex tile)
 	return true;
 }
 
-void AnimateTile_Object(TileIndex tile)
+uint8 AnimateTile_Object(TileIndex tile)
 {
-	AnimateNewObjectTile(tile);
+	return AnimateNewObjectTile(tile);
 }
 
 /**
@@ -910,6 +910,7 @@ extern const TileTypeProcs _tile_type_object_procs = {
 	ClickTile_Object,            // click_tile_proc
 	AnimateTile_Object,          // animate_tile_proc
 	TileLoop_Object,             // tile_loop_proc
+	nullptr,                     // tile_loop_parallel_proc
 	ChangeTileOwner_Object,      // change_tile_owner_proc
 	AddProducedCargo_Object,     // add_produced_cargo_proc
 	nullptr,                        // vehicle_enter_tile_proc
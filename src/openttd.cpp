@@ -65,10 +65,12 @@
 #include "viewport_func.h"
 #include "viewport_sprite_sorter.h"
 #include "framerate_type.h"
+#include "scope.h"
 #include "programmable_signals.h"
 #include "smallmap_gui.h"
 #include "viewport_func.h"
 #include "thread.h"
+#include "worker_thread.h"
 #include "bridge_signal_map.h"
 #include "zoning.h"
 #include "cargopacket.h"
@@ -80,6 +82,7 @@
 
 #include "linkgraph/linkgraphschedule.h"
 #include "tracerestrict.h"
+#include "subsidy_base.h"
 
 #include <stdarg.h>
 #include <system_error>
@@ -394,12 +397,16 @@ static void ShutdownGame()
 	AI::Uninitialize(false);
 	Game::Uninitialize(false);
 
+	_general_worker_pool.Stop();
+	_saveload_worker_pool.Stop();
+
 	/* Uninitialize variables that are allocated dynamically */
 	GamelogReset();
 
 	free(_config_file);
 
 	LinkGraphSchedule::Clear();
+	_linkgraph_worker_pool.Stop();
 	ClearTraceRestrictMapping();
 	ClearBridgeSimulatedSignalMapping();
 	ClearCargoPacketDeferredPayments();
@@ -551,6 +558,10 @@ struct AfterNewGRFScan : NewGRFScanCallback {
 		uint last_newgrf_count = _settings_client.gui.last_newgrf_count;
 		LoadFromConfig();
 		_settings_client.gui.last_newgrf_count = last_newgrf_count;
+		/* The worker thread settings are only known once the full configuration has been loaded. */
+		StartGeneralWorkerPool();
+		StartSaveLoadWorkerPool();
+		StartLinkGraphWorkerPool();
 		/* Since the default for the palette might have changed due to
 		 * reading the configuration file, recalculate that now. */
 		UpdateNewGRFConfigPalette();
@@ -1349,59 +1360,102 @@ void SwitchToMode(SwitchMode new_mode)
 	SmallMapWindow::RebuildColourIndexIfNecessary();
 }
 
-/**
- * Check the validity of some of the caches.
- * Especially in the sense of desyncs between
- * the cached value and what the value would
- * be when calculated from the 'base' data.
- */
-void CheckCaches(bool force_check, std::function<void(const char *)> log)
-{
-	if (!force_check) {
-		/* Return here so it is easy to add checks that are run
-		 * always to aid testing of caches. */
-		if (_debug_desync_level < 1) return;
+/** Output of the cache checks, see #CheckCaches. */
+struct CheckCachesOutput {
+	std::function<void(const char *)> log; ///< Function to log to, or \c nullptr to log to the desync log.
+	char buffer[1024];                     ///< Message to log.
 
-		if (_debug_desync_level == 1 && _scaled_date_ticks % 500 != 0) return;
+	CheckCachesOutput(std::function<void(const char *)> log) : log(std::move(log)) {}
+
+	/** Log the message in #buffer. */
+	void Emit()
+	{
+		DEBUG(desync, 0, "%s", this->buffer);
+		if (this->log) {
+			this->log(this->buffer);
+		} else {
+			LogDesyncMsg(this->buffer);
+		}
 	}
 
-	char cclog_buffer[1024];
+	/**
+	 * Get the function to log to for checks which write their own debug output.
+	 * @return Function logging to #log, or to the desync log.
+	 */
+	std::function<void(const char *)> GetLog() const
+	{
+		if (this->log) return this->log;
+		return [](const char *msg) { LogDesyncMsg(msg); };
+	}
+};
+
 #define CCLOG(...) { \
-	seprintf(cclog_buffer, lastof(cclog_buffer), __VA_ARGS__); \
-	DEBUG(desync, 0, "%s", cclog_buffer); \
-	if (log) { \
-		log(cclog_buffer); \
-	} else { \
-		LogDesyncMsg(cclog_buffer); \
-	} \
+	seprintf(out.buffer, lastof(out.buffer), __VA_ARGS__); \
+	out.Emit(); \
 }
 
-	auto output_veh_info = [&](char *&p, const Vehicle *u, const Vehicle *v, uint length) {
-		p += seprintf(p, lastof(cclog_buffer), ": type %i, vehicle %i (%i), company %i, unit number %i, wagon %i, engine: ",
-				(int)u->type, u->index, v->index, (int)u->owner, v->unitnumber, length);
-		SetDParam(0, u->engine_type);
-		p = GetString(p, STR_ENGINE_NAME, lastof(cclog_buffer));
-		uint32 grfid = u->GetGRFID();
-		if (grfid) {
-			p += seprintf(p, lastof(cclog_buffer), ", GRF: %08X", BSWAP32(grfid));
-			GRFConfig *grfconfig = GetGRFConfig(grfid);
-			if (grfconfig) {
-				p += seprintf(p, lastof(cclog_buffer), ", %s, %s", grfconfig->GetName(), grfconfig->filename);
-			}
+#define CCLOGV(...) { \
+	char *p = out.buffer + seprintf(out.buffer, lastof(out.buffer), __VA_ARGS__); \
+	CheckCachesVehicleInfo(p, lastof(out.buffer), u, v, length); \
+	out.Emit(); \
+}
+
+/**
+ * Append the details of a vehicle with a cache mismatch to a log message.
+ * @param p End of the message.
+ * @param last Last valid position in the message buffer.
+ * @param u The vehicle.
+ * @param v The first vehicle of the consist.
+ * @param length Position of \a u in the consist.
+ */
+static void CheckCachesVehicleInfo(char *&p, const char *last, const Vehicle *u, const Vehicle *v, uint length)
+{
+	p += seprintf(p, last, ": type %i, vehicle %i (%i), company %i, unit number %i, wagon %i, engine: ",
+			(int)u->type, u->index, v->index, (int)u->owner, v->unitnumber, length);
+	SetDParam(0, u->engine_type);
+	p = GetString(p, STR_ENGINE_NAME, last);
+	uint32 grfid = u->GetGRFID();
+	if (grfid) {
+		p += seprintf(p, last, ", GRF: %08X", BSWAP32(grfid));
+		GRFConfig *grfconfig = GetGRFConfig(grfid);
+		if (grfconfig) {
+			p += seprintf(p, last, ", %s, %s", grfconfig->GetName(), grfconfig->filename);
 		}
-	};
+	}
+}
 
-#define CCLOGV(...) { \
-	char *p = cclog_buffer + seprintf(cclog_buffer, lastof(cclog_buffer), __VA_ARGS__); \
-	output_veh_info(p, u, v, length); \
-	DEBUG(desync, 0, "%s", cclog_buffer); \
-	if (log) { \
-		log(cclog_buffer); \
-	} else { \
-		LogDesyncMsg(cclog_buffer); \
-	} \
+/**
+ * Check the nearby station lists of the industries in a range of the industry pool.
+ * @param out Output of the checks.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ */
+static void CheckIndustryCatchmentCaches(CheckCachesOutput &out, size_t first, size_t last)
+{
+	for (Industry *ind : Industry::Iterate(first)) {
+		if (ind->index >= last) break;
+
+		StationList stlist;
+		if (ind->neutral_station != nullptr && !_settings_game.station.serve_neutral_industries) {
+			stlist.insert(ind->neutral_station);
+			if (ind->stations_near != stlist) {
+				CCLOG("industry neutral station stations_near mismatch: ind %i, (recalc size: %u, neutral size: %u)", (int)ind->index, (uint)ind->stations_near.size(), (uint)stlist.size());
+			}
+		} else {
+			FindStationsAroundTiles(ind->location, &stlist, false, ind->index);
+			if (ind->stations_near != stlist) {
+				CCLOG("industry FindStationsAroundTiles mismatch: ind %i, (recalc size: %u, find size: %u)", (int)ind->index, (uint)ind->stations_near.size(), (uint)stlist.size());
+			}
+		}
+	}
 }
 
+/**
+ * Check the town caches, and the catchment caches of stations and industries.
+ * @param out Output of the checks.
+ */
+static void CheckTownAndCatchmentCaches(CheckCachesOutput &out)
+{
 	/* Check the town caches. */
 	std::vector<TownCache> old_town_caches;
 	std::vector<CargoTypes> old_town_cargo_accepted_totals;
@@ -1427,6 +1481,7 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 	}
 
 	const CargoTypes old_town_cargoes_accepted = _town_cargoes_accepted;
+	const StationCatchmentIndex old_station_catchment_index = _station_catchment_index;
 
 	extern void RebuildTownCaches(bool cargo_update_required);
 	RebuildTownCaches(false);
@@ -1463,62 +1518,359 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 		}
 		i++;
 	}
+	if (old_station_catchment_index != _station_catchment_index) {
+		CCLOG("station catchment index mismatch: (old size: %u, new size: %u)", (uint)old_station_catchment_index.size(), (uint)_station_catchment_index.size());
+	}
 	i = 0;
 	for (Industry *ind : Industry::Iterate()) {
 		if (old_industry_stations_nears[i] != ind->stations_near) {
 			CCLOG("industry stations_near mismatch: ind %i, (old size: %u, new size: %u)", (int)ind->index, (uint)old_industry_stations_nears[i].size(), (uint)ind->stations_near.size());
 		}
-		StationList stlist;
-		if (ind->neutral_station != nullptr && !_settings_game.station.serve_neutral_industries) {
-			stlist.insert(ind->neutral_station);
-			if (ind->stations_near != stlist) {
-				CCLOG("industry neutral station stations_near mismatch: ind %i, (recalc size: %u, neutral size: %u)", (int)ind->index, (uint)ind->stations_near.size(), (uint)stlist.size());
+		i++;
+	}
+	CheckIndustryCatchmentCaches(out, 0, Industry::GetPoolSize());
+}
+
+/**
+ * Check the caches of the towns in a range of the town pool.
+ * The caches depending on the houses of the towns are checked by #CheckTownHouseCountsSlice.
+ * @param out Output of the checks.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ */
+static void CheckTownCaches(CheckCachesOutput &out, size_t first, size_t last)
+{
+	for (Town *t : Town::Iterate(first)) {
+		if (t->index >= last) break;
+
+		uint32 old_squared_town_zone_radius[HZB_END];
+		MemCpyT(old_squared_town_zone_radius, t->cache.squared_town_zone_radius, HZB_END);
+		UpdateTownRadius(t);
+		if (MemCmpT(old_squared_town_zone_radius, t->cache.squared_town_zone_radius, HZB_END) != 0) {
+			CCLOG("town cache mismatch: town %i, squared_town_zone_radius", (int)t->index);
+			MemCpyT(t->cache.squared_town_zone_radius, old_squared_town_zone_radius, HZB_END);
+		}
+
+		PartOfSubsidy part_of_subsidy = POS_NONE;
+		for (const Subsidy *s : Subsidy::Iterate()) {
+			if (s->src_type == ST_TOWN && s->src == t->index) part_of_subsidy |= POS_SRC;
+			if (s->dst_type == ST_TOWN && s->dst == t->index) part_of_subsidy |= POS_DST;
+		}
+		if (part_of_subsidy != t->cache.part_of_subsidy) {
+			CCLOG("town cache mismatch: town %i, part_of_subsidy: %X, recalc: %X", (int)t->index, (uint)t->cache.part_of_subsidy, (uint)part_of_subsidy);
+		}
+
+		const CargoTypes old_cargo_accepted_total = t->cargo_accepted_total;
+		UpdateTownCargoTotal(t);
+		if (old_cargo_accepted_total != t->cargo_accepted_total) {
+			CCLOG("town cargo_accepted_total mismatch: town %i, old: " OTTD_PRINTFHEX64 ". new: " OTTD_PRINTFHEX64, (int)t->index, old_cargo_accepted_total, t->cargo_accepted_total);
+			t->cargo_accepted_total = old_cargo_accepted_total;
+		}
+
+		for (const Station *st : t->stations_near) {
+			if (st->catchment_tiles.tile == INVALID_TILE || !st->CatchmentCoversTown(t->index)) {
+				CCLOG("town stations_near mismatch: town %i, st %i does not cover the town", (int)t->index, (int)st->index);
 			}
-		} else {
-			FindStationsAroundTiles(ind->location, &stlist, false, ind->index);
-			if (ind->stations_near != stlist) {
-				CCLOG("industry FindStationsAroundTiles mismatch: ind %i, (recalc size: %u, find size: %u)", (int)ind->index, (uint)ind->stations_near.size(), (uint)stlist.size());
+		}
+	}
+}
+
+/**
+ * Check the house counts, populations and building counts of the towns.
+ * The houses are counted in a range of map rows per call, until the whole map is counted.
+ * Towns whose houses or population changed since the count started are not checked.
+ * @param out Output of the checks.
+ * @param rows Number of map rows to count the houses of.
+ */
+static void CheckTownHouseCountsSlice(CheckCachesOutput &out, uint rows)
+{
+	struct HouseCount {
+		uint32 num_houses;
+		uint32 population;
+	};
+	static std::vector<HouseCount> house_counts;
+	static std::vector<BuildingCounts<uint16>> building_counts;
+	static uint32 start_serial = 0;
+	static uint next_row = 0;
+
+	if (next_row == 0 || next_row >= MapSizeY()) {
+		house_counts.assign(Town::GetPoolSize(), HouseCount{ 0, 0 });
+		building_counts.assign(_loaded_newgrf_features.has_newhouses ? Town::GetPoolSize() : 0, BuildingCounts<uint16>{});
+		start_serial = _town_house_change_serial;
+		next_row = 0;
+	}
+
+	const uint last_row = min<uint>(MapSizeY(), next_row + rows);
+	const TileIndex end = TileXY(0, last_row);
+	for (TileIndex tile = TileXY(0, next_row); tile < end; tile++) {
+		if (!IsTileType(tile, MP_HOUSE)) continue;
+
+		const TownID town = GetTownIndex(tile);
+		if (town >= house_counts.size()) continue;
+
+		HouseID house_id = GetHouseType(tile);
+		const HouseSpec *hs = HouseSpec::Get(house_id);
+		if (IsHouseCompleted(tile)) house_counts[town].population += hs->population;
+		if (town < building_counts.size()) {
+			building_counts[town].id_count[house_id]++;
+			if (hs->class_id != HOUSE_NO_CLASS) building_counts[town].class_count[hs->class_id]++;
+		}
+
+		/* Count every house once. */
+		if (GetHouseNorthPart(house_id) == 0) house_counts[town].num_houses++;
+	}
+	next_row = last_row;
+	if (next_row < MapSizeY()) return;
+	next_row = 0;
+
+	for (const Town *t : Town::Iterate()) {
+		if (t->index >= house_counts.size() || t->house_change_serial > start_serial) continue;
+
+		const HouseCount &count = house_counts[t->index];
+		if (count.num_houses != t->cache.num_houses) {
+			CCLOG("town cache mismatch: town %i, num_houses: %u, recalc: %u", (int)t->index, t->cache.num_houses, count.num_houses);
+		}
+		if (count.population != t->cache.population) {
+			CCLOG("town cache mismatch: town %i, population: %u, recalc: %u", (int)t->index, t->cache.population, count.population);
+		}
+		if (t->index < building_counts.size() && MemCmpT(&building_counts[t->index], &t->cache.building_counts) != 0) {
+			CCLOG("town cache mismatch: town %i, building_counts", (int)t->index);
+		}
+	}
+}
+
+/**
+ * Check the bitmap of all cargoes accepted by houses.
+ * @param out Output of the checks.
+ */
+static void CheckTownCargoBitmap(CheckCachesOutput &out)
+{
+	const CargoTypes old_town_cargoes_accepted = _town_cargoes_accepted;
+	UpdateTownCargoBitmap();
+	if (old_town_cargoes_accepted != _town_cargoes_accepted) {
+		CCLOG("_town_cargoes_accepted mismatch: old: " OTTD_PRINTFHEX64 ". new: " OTTD_PRINTFHEX64, old_town_cargoes_accepted, _town_cargoes_accepted);
+		_town_cargoes_accepted = old_town_cargoes_accepted;
+	}
+}
+
+/**
+ * Check the catchment caches of the stations in a range of the station pool,
+ * and whether the towns and industries in their catchment list them as nearby.
+ * @param out Output of the checks.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ */
+static void CheckStationCatchmentCaches(CheckCachesOutput &out, size_t first, size_t last)
+{
+	BitmapTileArea catchment_tiles;
+	for (Station *st : Station::Iterate(first)) {
+		if (st->index >= last) break;
+
+		st->ComputeCatchmentTiles(catchment_tiles);
+		if (!(catchment_tiles == st->catchment_tiles)) {
+			CCLOG("station catchment_tiles mismatch: st %i", (int)st->index);
+		}
+
+		const bool neutral = !_settings_game.station.serve_neutral_industries && st->industry != nullptr;
+		IndustryList industries_near;
+		btree::btree_set<TownID> towns_near;
+		btree::btree_set<IndustryID> industries_serving;
+		if (neutral && !st->rect.IsEmpty()) industries_near.insert(st->industry);
+
+		bool index_valid = true;
+		if (catchment_tiles.tile != INVALID_TILE) {
+			BitmapTileIterator it(catchment_tiles);
+			for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
+				if (index_valid && _station_catchment_index.count(std::make_pair(tile, st->index)) == 0) {
+					CCLOG("station catchment index mismatch: st %i, tile 0x%X is missing", (int)st->index, tile);
+					index_valid = false;
+				}
+				if (neutral) continue;
+
+				if (IsTileType(tile, MP_HOUSE)) towns_near.insert(GetTownIndex(tile));
+				if (IsTileType(tile, MP_INDUSTRY)) {
+					Industry *i = Industry::GetByTile(tile);
+					if (!_settings_game.station.serve_neutral_industries && i->neutral_station != nullptr) continue;
+
+					industries_serving.insert(i->index);
+					if (std::any_of(std::begin(i->accepts_cargo), std::end(i->accepts_cargo), [](CargoID c) { return c != CT_INVALID; })) {
+						industries_near.insert(i);
+					}
+				}
+			}
+		}
+
+		if (industries_near != st->industries_near) {
+			CCLOG("station industries_near mismatch: st %i, (old size: %u, new size: %u)", (int)st->index, (uint)st->industries_near.size(), (uint)industries_near.size());
+		}
+		for (TownID town : towns_near) {
+			if (Town::Get(town)->stations_near.count(st) == 0) {
+				CCLOG("town stations_near mismatch: town %i, st %i is missing", (int)town, (int)st->index);
+			}
+		}
+		for (IndustryID ind : industries_serving) {
+			if (Industry::Get(ind)->stations_near.count(st) == 0) {
+				CCLOG("industry stations_near mismatch: ind %i, st %i is missing", (int)ind, (int)st->index);
 			}
 		}
-		i++;
 	}
+}
 
-	/* Check company infrastructure cache. */
+/**
+ * Check the entries of the station catchment index for the tiles in a range of map rows.
+ * The missing entries are checked by #CheckStationCatchmentCaches.
+ * @param out Output of the checks.
+ * @param first_row First map row of the range.
+ * @param last_row Map row after the range.
+ */
+static void CheckStationCatchmentIndex(CheckCachesOutput &out, uint first_row, uint last_row)
+{
+	const TileIndex end = TileXY(0, last_row);
+	for (auto it = _station_catchment_index.lower_bound(std::make_pair(TileXY(0, first_row), (StationID)0)); it != _station_catchment_index.end() && it->first < end; ++it) {
+		const Station *st = Station::GetIfValid(it->second);
+		if (st == nullptr || !st->catchment_tiles.HasTile(it->first)) {
+			CCLOG("station catchment index mismatch: tile 0x%X, st %i does not cover it", it->first, (int)it->second);
+		}
+	}
+}
+
+/**
+ * Log the difference between the cached and the recalculated infrastructure of a company.
+ * @param out Output of the checks.
+ * @param company The company.
+ * @param cached The cached infrastructure.
+ * @param recalc The recalculated infrastructure.
+ */
+static void LogCompanyInfrastructureMismatch(CheckCachesOutput &out, CompanyID company, const CompanyInfrastructure &cached, const CompanyInfrastructure &recalc)
+{
+	CCLOG("infrastructure cache mismatch: company %i", (int)company);
+	char buffer[4096];
+	cached.Dump(buffer, lastof(buffer));
+	CCLOG("Previous:");
+	ProcessLineByLine(buffer, [&](const char *line) {
+		CCLOG("  %s", line);
+	});
+	recalc.Dump(buffer, lastof(buffer));
+	CCLOG("Recalculated:");
+	ProcessLineByLine(buffer, [&](const char *line) {
+		CCLOG("  %s", line);
+	});
+}
+
+/**
+ * Check the infrastructure caches of the companies.
+ * @param out Output of the checks.
+ */
+static void CheckCompanyInfrastructureCaches(CheckCachesOutput &out)
+{
 	std::vector<CompanyInfrastructure> old_infrastructure;
 	for (const Company *c : Company::Iterate()) old_infrastructure.push_back(c->infrastructure);
 
 	extern void AfterLoadCompanyStats();
 	AfterLoadCompanyStats();
 
-	i = 0;
-	for (const Company *c : Company::Iterate()) {
+	uint i = 0;
+	for (Company *c : Company::Iterate()) {
 		if (MemCmpT(old_infrastructure.data() + i, &c->infrastructure) != 0) {
-			CCLOG("infrastructure cache mismatch: company %i", (int)c->index);
-			char buffer[4096];
-			old_infrastructure[i].Dump(buffer, lastof(buffer));
-			CCLOG("Previous:");
-			ProcessLineByLine(buffer, [&](const char *line) {
-				CCLOG("  %s", line);
-			});
-			c->infrastructure.Dump(buffer, lastof(buffer));
-			CCLOG("Recalculated:");
-			ProcessLineByLine(buffer, [&](const char *line) {
-				CCLOG("  %s", line);
-			});
+			LogCompanyInfrastructureMismatch(out, c->index, old_infrastructure[i], c->infrastructure);
 		}
+		c->infrastructure = old_infrastructure[i];
 		i++;
 	}
+}
+
+/**
+ * Check the infrastructure caches of the companies.
+ * The infrastructure is counted in a range of map rows per call, until the whole map is counted.
+ * Companies whose infrastructure changed since the count started are not checked.
+ * @param out Output of the checks.
+ * @param rows Number of map rows to count the infrastructure of.
+ */
+static void CheckCompanyInfrastructureCachesSlice(CheckCachesOutput &out, uint rows)
+{
+	static CompanyInfrastructure counts[MAX_COMPANIES];
+	static CompanyInfrastructure last_seen[MAX_COMPANIES];
+	static CompanyMask changed = 0;
+	static uint next_row = 0;
+
+	if (next_row == 0 || next_row >= MapSizeY()) {
+		MemSetT(counts, 0, MAX_COMPANIES);
+		for (const Company *c : Company::Iterate()) last_seen[c->index] = c->infrastructure;
+		changed = 0;
+		next_row = 0;
+	} else {
+		for (const Company *c : Company::Iterate()) {
+			if (MemCmpT(&last_seen[c->index], &c->infrastructure) != 0) {
+				last_seen[c->index] = c->infrastructure;
+				SetBit(changed, c->index);
+			}
+		}
+	}
+
+	/* Count into the companies, as the infrastructure is counted by the same functions as after loading a game. */
+	auto swap_counts = [&]() {
+		for (Company *c : Company::Iterate()) std::swap(c->infrastructure, counts[c->index]);
+	};
 
-	/* Strict checking of the road stop cache entries */
-	for (const RoadStop *rs : RoadStop::Iterate()) {
+	extern void AddCompanyTileInfrastructure(TileIndex begin, TileIndex end);
+	const uint last_row = min<uint>(MapSizeY(), next_row + rows);
+	swap_counts();
+	AddCompanyTileInfrastructure(TileXY(0, next_row), TileXY(0, last_row));
+	swap_counts();
+	next_row = last_row;
+	if (next_row < MapSizeY()) return;
+	next_row = 0;
+
+	extern void AddCompanyAirportInfrastructure();
+	swap_counts();
+	AddCompanyAirportInfrastructure();
+	swap_counts();
+
+	for (const Company *c : Company::Iterate()) {
+		if (HasBit(changed, c->index)) continue;
+		if (MemCmpT(&counts[c->index], &c->infrastructure) != 0) {
+			LogCompanyInfrastructureMismatch(out, c->index, c->infrastructure, counts[c->index]);
+		}
+	}
+}
+
+/**
+ * Strict checking of the cache entries of the road stops in a range of the road stop pool.
+ * @param out Output of the checks.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ */
+static void CheckRoadStopCaches(CheckCachesOutput &out, size_t first, size_t last)
+{
+	for (const RoadStop *rs : RoadStop::Iterate(first)) {
+		if (rs->index >= last) break;
 		if (IsStandardRoadStopTile(rs->xy)) continue;
 
-		assert(rs->GetEntry(DIAGDIR_NE) != rs->GetEntry(DIAGDIR_NW));
-		rs->GetEntry(DIAGDIR_NE)->CheckIntegrity(rs);
-		rs->GetEntry(DIAGDIR_NW)->CheckIntegrity(rs);
+		if (rs->GetEntry(DIAGDIR_NE) == rs->GetEntry(DIAGDIR_NW)) {
+			CCLOG("road stop entry mismatch: road stop %i, tile 0x%X, the entries are the same", (int)rs->index, rs->xy);
+			continue;
+		}
+		if (!rs->GetEntry(DIAGDIR_NE)->CheckIntegrity(rs)) {
+			CCLOG("road stop entry mismatch: road stop %i, tile 0x%X, direction NE", (int)rs->index, rs->xy);
+		}
+		if (!rs->GetEntry(DIAGDIR_NW)->CheckIntegrity(rs)) {
+			CCLOG("road stop entry mismatch: road stop %i, tile 0x%X, direction NW", (int)rs->index, rs->xy);
+		}
 	}
+}
+
+/**
+ * Check the caches of the vehicles in a range of the vehicle pool.
+ * The caches of a consist are checked when its first vehicle is in the range.
+ * @param out Output of the checks.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ */
+static void CheckVehicleCaches(CheckCachesOutput &out, size_t first, size_t last)
+{
+	for (Vehicle *v : Vehicle::Iterate(first)) {
+		if (v->index >= last) break;
 
-	for (Vehicle *v : Vehicle::Iterate()) {
 		extern bool ValidateVehicleTileHash(const Vehicle *v);
 		if (!ValidateVehicleTileHash(v)) {
 			CCLOG("vehicle tile hash mismatch: type %i, vehicle %i, company %i, unit number %i", (int)v->type, v->index, (int)v->owner, v->unitnumber);
@@ -1550,8 +1902,6 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 
 		length = 0;
 		for (const Vehicle *u = v; u != nullptr; u = u->Next()) {
-			FillNewGRFVehicleCache(u);
-			grf_cache[length] = u->grf_cache;
 			veh_cache[length] = u->vcache;
 			switch (u->type) {
 				case VEH_TRAIN:
@@ -1575,6 +1925,9 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 					memcpy((void *) veh_old[length], (const void *) u, sizeof(Vehicle));
 					break;
 			}
+			/* The copy of the vehicle is taken before filling the NewGRF cache, to restore the vehicle as it was after the checks. */
+			FillNewGRFVehicleCache(u);
+			grf_cache[length] = u->grf_cache;
 			length++;
 		}
 
@@ -1587,7 +1940,7 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 		}
 
 		length = 0;
-		for (const Vehicle *u = v; u != nullptr; u = u->Next()) {
+		for (Vehicle *u = v; u != nullptr; u = u->Next()) {
 			FillNewGRFVehicleCache(u);
 			if (memcmp(&grf_cache[length], &u->grf_cache, sizeof(NewGRFCache)) != 0) {
 				CCLOGV("newgrf cache mismatch");
@@ -1658,6 +2011,12 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 				default:
 					break;
 			}
+			switch (u->type) {
+				case VEH_TRAIN:    memcpy((void *) Train::From(u), (const void *) veh_old[length], sizeof(Train)); break;
+				case VEH_ROAD:     memcpy((void *) RoadVehicle::From(u), (const void *) veh_old[length], sizeof(RoadVehicle)); break;
+				case VEH_AIRCRAFT: memcpy((void *) Aircraft::From(u), (const void *) veh_old[length], sizeof(Aircraft)); break;
+				default:           memcpy((void *) u, (const void *) veh_old[length], sizeof(Vehicle)); break;
+			}
 			free(veh_old[length]);
 			length++;
 		}
@@ -1671,61 +2030,257 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 	}
 
 	/* Check whether the caches are still valid */
-	for (Vehicle *v : Vehicle::Iterate()) {
+	for (Vehicle *v : Vehicle::Iterate(first)) {
+		if (v->index >= last) break;
 		byte buff[sizeof(VehicleCargoList)];
 		memcpy(buff, &v->cargo, sizeof(VehicleCargoList));
 		v->cargo.InvalidateCache();
-		assert(memcmp(&v->cargo, buff, sizeof(VehicleCargoList)) == 0);
+		if (memcmp(&v->cargo, buff, sizeof(VehicleCargoList)) != 0) {
+			CCLOG("vehicle cargo cache mismatch: type %i, vehicle %i, company %i, unit number %i", (int)v->type, v->index, (int)v->owner, v->unitnumber);
+		}
+		memcpy((void *) &v->cargo, buff, sizeof(VehicleCargoList));
 	}
 
-	for (Station *st : Station::Iterate()) {
+	for (Vehicle *v : Vehicle::Iterate(first)) {
+		if (v->index >= last) break;
+		if (v->Previous() && v->Previous()->Next() != v) {
+			CCLOG("vehicle chain mismatch: vehicle %i is not the next vehicle of its previous vehicle %i", v->index, v->Previous()->index);
+		}
+		if (v->Next() && v->Next()->Previous() != v) {
+			CCLOG("vehicle chain mismatch: vehicle %i is not the previous vehicle of its next vehicle %i", v->index, v->Next()->index);
+		}
+	}
+}
+
+/**
+ * Check the cargo list caches of the stations in a range of the station pool.
+ * @param out Output of the checks.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ */
+static void CheckStationCaches(CheckCachesOutput &out, size_t first, size_t last)
+{
+	for (Station *st : Station::Iterate(first)) {
+		if (st->index >= last) break;
 		for (CargoID c = 0; c < NUM_CARGO; c++) {
 			byte buff[sizeof(StationCargoList)];
 			memcpy(buff, &st->goods[c].cargo, sizeof(StationCargoList));
 			st->goods[c].cargo.InvalidateCache();
-			assert(memcmp(&st->goods[c].cargo, buff, sizeof(StationCargoList)) == 0);
+			if (memcmp(&st->goods[c].cargo, buff, sizeof(StationCargoList)) != 0) {
+				CCLOG("station cargo cache mismatch: st %i, cargo %i", (int)st->index, (int)c);
+			}
+			memcpy((void *) &st->goods[c].cargo, buff, sizeof(StationCargoList));
 		}
 	}
+}
 
-	for (OrderList *order_list : OrderList::Iterate()) {
-		order_list->DebugCheckSanity();
+/**
+ * Check the order lists in a range of the order list pool.
+ * @param out Output of the checks.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ */
+static void CheckOrderListCaches(CheckCachesOutput &out, size_t first, size_t last)
+{
+	for (const OrderList *order_list : OrderList::Iterate(first)) {
+		if (order_list->index >= last) break;
+		order_list->DebugCheckSanity(out.GetLog());
 	}
+}
 
-	extern void ValidateVehicleTickCaches();
-	ValidateVehicleTickCaches();
+/**
+ * Check the chains of the template vehicles in a range of the template vehicle pool.
+ * @param out Output of the checks.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ */
+static void CheckTemplateVehicleCaches(CheckCachesOutput &out, size_t first, size_t last)
+{
+	for (const TemplateVehicle *tv : TemplateVehicle::Iterate(first)) {
+		if (tv->index >= last) break;
+		if (tv->Prev() && tv->Prev()->Next() != tv) {
+			CCLOG("template vehicle chain mismatch: template %i is not the next template of its previous template %i", tv->index, tv->Prev()->index);
+		}
+		if (tv->Next() && tv->Next()->Prev() != tv) {
+			CCLOG("template vehicle chain mismatch: template %i is not the previous template of its next template %i", tv->index, tv->Next()->index);
+		}
+	}
+}
 
-	for (Vehicle *v : Vehicle::Iterate()) {
-		if (v->Previous()) assert_msg(v->Previous()->Next() == v, "%u", v->index);
-		if (v->Next()) assert_msg(v->Next()->Previous() == v, "%u", v->index);
+/**
+ * Check the order destination refcounts.
+ * The orders are counted in a range of the order list pool per call, until all order lists are counted.
+ * The refcounts are not checked when they changed since the count started.
+ * @param out Output of the checks.
+ * @param count Number of order list pool entries to count the orders of.
+ */
+static void CheckOrderDestinationRefcountsSlice(CheckCachesOutput &out, size_t count)
+{
+	static btree::btree_map<uint32, uint32> refcounts;
+	static uint32 start_serial = 0;
+	static size_t next_index = 0;
+
+	if (next_index == 0 || next_index >= OrderList::GetPoolSize()) {
+		refcounts.clear();
+		start_serial = _order_destination_refcount_map_serial;
+		next_index = 0;
+	}
+
+	const size_t last = min<size_t>(OrderList::GetPoolSize(), next_index + count);
+	for (const OrderList *order_list : OrderList::Iterate(next_index)) {
+		if (order_list->index >= last) break;
+		const Vehicle *v = order_list->GetFirstSharedVehicle();
+		if (v == nullptr) continue;
+		for (const Order *order = order_list->GetFirstOrder(); order != nullptr; order = order->next) {
+			if (order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT) || order->IsType(OT_IMPLICIT)) {
+				refcounts[OrderDestinationRefcountMapKey(order->GetDestination(), v->owner, order->GetType(), v->type)]++;
+			}
+		}
 	}
-	for (const TemplateVehicle *tv : TemplateVehicle::Iterate()) {
-		if (tv->Prev()) assert_msg(tv->Prev()->Next() == tv, "%u", tv->index);
-		if (tv->Next()) assert_msg(tv->Next()->Prev() == tv, "%u", tv->index);
+	next_index = last;
+	if (next_index < OrderList::GetPoolSize()) return;
+	next_index = 0;
+
+	if (!_order_destination_refcount_map_valid) {
+		CCLOG("Order destination refcount map not valid");
+		return;
 	}
+	if (start_serial != _order_destination_refcount_map_serial) return;
+
+	btree::btree_map<uint32, uint32> used_order_destination_refcount_map;
+	for (const auto &it : _order_destination_refcount_map) {
+		if (it.second != 0) used_order_destination_refcount_map.insert(it);
+	}
+	if (used_order_destination_refcount_map != refcounts) CCLOG("Order destination refcount map mismatch");
+}
+
+/**
+ * Check the order lists, the vehicle tick caches and the other global caches.
+ * @param out Output of the checks.
+ */
+static void CheckOtherCaches(CheckCachesOutput &out)
+{
+	CheckOrderListCaches(out, 0, OrderList::GetPoolSize());
+
+	extern void ValidateVehicleTickCaches(std::function<void(const char *)> log);
+	ValidateVehicleTickCaches(out.GetLog());
+
+	CheckTemplateVehicleCaches(out, 0, TemplateVehicle::GetPoolSize());
 
 	if (!TraceRestrictSlot::ValidateVehicleIndex()) CCLOG("Trace restrict slot vehicle index validation failed");
-	TraceRestrictSlot::ValidateSlotOccupants(log);
+	TraceRestrictSlot::ValidateSlotOccupants(out.GetLog());
 
 	if (!CargoPacket::ValidateDeferredCargoPayments()) CCLOG("Cargo packets deferred payments validation failed");
 
 	if (_order_destination_refcount_map_valid) {
 		btree::btree_map<uint32, uint32> saved_order_destination_refcount_map = std::move(_order_destination_refcount_map);
-		for (auto iter = saved_order_destination_refcount_map.begin(); iter != saved_order_destination_refcount_map.end();) {
+		btree::btree_map<uint32, uint32> used_order_destination_refcount_map = saved_order_destination_refcount_map;
+		for (auto iter = used_order_destination_refcount_map.begin(); iter != used_order_destination_refcount_map.end();) {
 			if (iter->second == 0) {
-				iter = saved_order_destination_refcount_map.erase(iter);
+				iter = used_order_destination_refcount_map.erase(iter);
 			} else {
 				++iter;
 			}
 		}
 		IntialiseOrderDestinationRefcountMap();
-		if (saved_order_destination_refcount_map != _order_destination_refcount_map) CCLOG("Order destination refcount map mismatch");
+		if (used_order_destination_refcount_map != _order_destination_refcount_map) CCLOG("Order destination refcount map mismatch");
+		_order_destination_refcount_map = std::move(saved_order_destination_refcount_map);
 	} else {
 		CCLOG("Order destination refcount map not valid");
 	}
+}
+
+/**
+ * Check a slice of the caches, such that all of them are checked once every \a period calls.
+ * The caches are checked in slices of their pools, the caches depending on the map in slices of the map rows.
+ * Only the bitmap of the cargoes accepted by towns is checked as a whole, at the start of the period.
+ * Only this client checks its caches, so the recalculated values are never taken over.
+ * @param period Number of calls over which the check of all caches is spread.
+ */
+static void CheckCachesSlice(uint period)
+{
+	static uint step = 0;
+
+	if (step >= period) step = 0;
+	CheckCachesOutput out(nullptr);
+
+	auto slice = [&](size_t pool_size, size_t *first, size_t *last) {
+		const size_t per_step = CeilDivT<size_t>(pool_size, period);
+		*first = min<size_t>(pool_size, step * per_step);
+		*last = min<size_t>(pool_size, *first + per_step);
+	};
+
+	size_t first, last;
+	slice(Vehicle::GetPoolSize(), &first, &last);
+	if (first != last) {
+		CheckVehicleCaches(out, first, last);
+		extern void ValidateVehicleTickCaches(std::function<void(const char *)> log, size_t first, size_t last);
+		ValidateVehicleTickCaches(out.GetLog(), first, last);
+		if (!TraceRestrictSlot::ValidateVehicleIndex(first, last)) CCLOG("Trace restrict slot vehicle index validation failed: vehicles %u - %u", (uint)first, (uint)last - 1);
+	}
+	slice(Station::GetPoolSize(), &first, &last);
+	if (first != last) {
+		CheckStationCaches(out, first, last);
+		CheckStationCatchmentCaches(out, first, last);
+	}
+	slice(Town::GetPoolSize(), &first, &last);
+	if (first != last) CheckTownCaches(out, first, last);
+	slice(Industry::GetPoolSize(), &first, &last);
+	if (first != last) CheckIndustryCatchmentCaches(out, first, last);
+	slice(RoadStop::GetPoolSize(), &first, &last);
+	if (first != last) CheckRoadStopCaches(out, first, last);
+	slice(MapSizeY(), &first, &last);
+	if (first != last) CheckStationCatchmentIndex(out, (uint)first, (uint)last);
+	slice(OrderList::GetPoolSize(), &first, &last);
+	if (first != last) CheckOrderListCaches(out, first, last);
+	slice(TemplateVehicle::GetPoolSize(), &first, &last);
+	if (first != last) CheckTemplateVehicleCaches(out, first, last);
+	slice(TraceRestrictSlot::GetPoolSize(), &first, &last);
+	if (first != last) TraceRestrictSlot::ValidateSlotOccupants(out.GetLog(), first, last);
+	slice(CargoPacket::GetPoolSize(), &first, &last);
+	if (first != last && !CargoPacket::ValidateDeferredCargoPayments(first, last)) {
+		CCLOG("Cargo packets deferred payments validation failed: cargo packets %u - %u", (uint)first, (uint)last - 1);
+	}
+	CheckTownHouseCountsSlice(out, CeilDivT<uint>(MapSizeY(), period));
+	CheckCompanyInfrastructureCachesSlice(out, CeilDivT<uint>(MapSizeY(), period));
+	CheckOrderDestinationRefcountsSlice(out, CeilDivT<size_t>(OrderList::GetPoolSize(), period));
+	if (step == 0) CheckTownCargoBitmap(out);
+
+	step++;
+}
+
+/**
+ * Check the validity of some of the caches.
+ * Especially in the sense of desyncs between
+ * the cached value and what the value would
+ * be when calculated from the 'base' data.
+ * @param force_check Check all caches, regardless of the desync debug level.
+ * @param log Function to log mismatches to, or \c nullptr to log them to the desync log.
+ */
+void CheckCaches(bool force_check, std::function<void(const char *)> log)
+{
+	if (!force_check) {
+		/* Return here so it is easy to add checks that are run
+		 * always to aid testing of caches. */
+		if (_debug_desync_level < 1) {
+			if (_settings_client.gui.rolling_cache_check_period != 0) CheckCachesSlice(_settings_client.gui.rolling_cache_check_period);
+			return;
+		}
+
+		if (_debug_desync_level == 1 && _scaled_date_ticks % 500 != 0) return;
+	}
+
+	CheckCachesOutput out(std::move(log));
+	CheckTownAndCatchmentCaches(out);
+	CheckCompanyInfrastructureCaches(out);
+	CheckRoadStopCaches(out, 0, RoadStop::GetPoolSize());
+	CheckVehicleCaches(out, 0, Vehicle::GetPoolSize());
+	CheckStationCaches(out, 0, Station::GetPoolSize());
+	CheckOtherCaches(out);
+}
 
 #undef CCLOGV
 #undef CCLOG
-}
 
 /**
  * Network-safe forced desync check.
@@ -1778,6 +2333,11 @@ void StateGameLoop()
 	PerformanceAccumulator::Reset(PFE_GL_LANDSCAPE);
 	if (HasModalProgress()) return;
 
+	TickProfilerBeginTick();
+	auto tick_profiler_guard = scope_guard([]() {
+		TickProfilerEndTick();
+	});
+
 	Layouter::ReduceLineCache();
 
 	if (_game_mode == GM_EDITOR) {
@@ -1798,7 +2358,10 @@ void StateGameLoop()
 			SaveOrLoad(name, SLO_SAVE, DFT_GAME_FILE, AUTOSAVE_DIR, false);
 		}
 
-		CheckCaches(false, nullptr);
+		{
+			TICK_PROFILE_SCOPE("CheckCaches");
+			CheckCaches(false, nullptr);
+		}
 
 		/* All these actions has to be done from OWNER_NONE
 		 *  for multiplayer compatibility */
@@ -1824,14 +2387,18 @@ void StateGameLoop()
 #ifndef DEBUG_DUMP_COMMANDS
 		{
 			PerformanceMeasurer framerate(PFE_ALLSCRIPTS);
+			TICK_PROFILE_SCOPE("Scripts");
 			AI::GameLoop();
 			Game::GameLoop();
 		}
 #endif
 		UpdateLandscapingLimits();
 
-		CallWindowGameTickEvent();
-		NewsLoop();
+		{
+			TICK_PROFILE_SCOPE("WindowGameTick");
+			CallWindowGameTickEvent();
+			NewsLoop();
+		}
 		cur_company.Restore();
 
 		for (Company *c : Company::Iterate()) {
@@ -1892,7 +2459,7 @@ void GameLoop()
 		_switch_mode = SM_NONE;
 	}
 
-	IncreaseSpriteLRU();
+	UpdateSpriteCache();
 	InteractiveRandom();
 
 	/* Check for UDP stuff */
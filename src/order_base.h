@@ -20,6 +20,7 @@
 #include "date_type.h"
 #include "schdispatch.h"
 
+#include <functional>
 #include <memory>
 #include <vector>
 #include "3rdparty/cpp-btree/btree_map.h"
@@ -30,6 +31,7 @@ extern OrderPool _order_pool;
 extern OrderListPool _orderlist_pool;
 extern btree::btree_map<uint32, uint32> _order_destination_refcount_map;
 extern bool _order_destination_refcount_map_valid;
+extern uint32 _order_destination_refcount_map_serial;
 
 inline uint32 OrderDestinationRefcountMapKey(DestinationID dest, CompanyID cid, OrderType order_type, VehicleType veh_type)
 {
@@ -721,7 +723,7 @@ public:
 
 	void FreeChain(bool keep_orderlist = false);
 
-	void DebugCheckSanity() const;
+	void DebugCheckSanity(std::function<void(const char *)> log = nullptr) const;
 	bool CheckOrderListIndexing() const;
 
 	/**
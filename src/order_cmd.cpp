@@ -37,6 +37,7 @@
 #include "order_cmd.h"
 #include "vehiclelist.h"
 #include "tracerestrict.h"
+#include "string_func.h"
 
 #include "table/strings.h"
 
@@ -55,6 +56,7 @@ INSTANTIATE_POOL_METHODS(OrderList)
 
 btree::btree_map<uint32, uint32> _order_destination_refcount_map;
 bool _order_destination_refcount_map_valid = false;
+uint32 _order_destination_refcount_map_serial = 0; ///< Incremented whenever the order destination refcount map changes.
 
 CommandCost CmdInsertOrderIntl(DoCommandFlag flags, Vehicle *v, VehicleOrderID sel_ord, const Order &new_order, bool allow_load_by_cargo_type);
 
@@ -71,18 +73,21 @@ void IntialiseOrderDestinationRefcountMap()
 		}
 	}
 	_order_destination_refcount_map_valid = true;
+	_order_destination_refcount_map_serial++;
 }
 
 void ClearOrderDestinationRefcountMap()
 {
 	_order_destination_refcount_map.clear();
 	_order_destination_refcount_map_valid = false;
+	_order_destination_refcount_map_serial++;
 }
 
 void UpdateOrderDestinationRefcount(const Order *order, VehicleType type, Owner owner, int delta)
 {
 	if (order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT) || order->IsType(OT_IMPLICIT)) {
 		_order_destination_refcount_map[OrderDestinationRefcountMapKey(order->GetDestination(), owner, order->GetType(), type)] += delta;
+		_order_destination_refcount_map_serial++;
 	}
 }
 
@@ -805,21 +810,36 @@ bool OrderList::IsCompleteTimetable() const
 }
 
 /**
- * Checks for internal consistency of order list. Triggers assertion if something is wrong.
+ * Checks for internal consistency of order list.
+ * @param log Function to log inconsistencies to, or \c nullptr to trigger an assertion if something is wrong.
  */
-void OrderList::DebugCheckSanity() const
+void OrderList::DebugCheckSanity(std::function<void(const char *)> log) const
 {
+	char cclog_buffer[1024];
+#define CCLOG(...) { \
+	seprintf(cclog_buffer, lastof(cclog_buffer), __VA_ARGS__); \
+	if (log) { \
+		DEBUG(desync, 0, "%s", cclog_buffer); \
+		log(cclog_buffer); \
+	} else { \
+		assert_msg(false, "%s", cclog_buffer); \
+	} \
+}
+
 	VehicleOrderID check_num_orders = 0;
 	VehicleOrderID check_num_manual_orders = 0;
 	uint check_num_vehicles = 0;
 	Ticks check_timetable_duration = 0;
 	Ticks check_total_duration = 0;
+	bool index_valid = true;
 
 	DEBUG(misc, 6, "Checking OrderList %hu for sanity...", this->index);
 
 	for (const Order *o = this->first; o != nullptr; o = o->next) {
-		assert(this->order_index.size() > check_num_orders);
-		assert(o == this->order_index[check_num_orders]);
+		if (index_valid && (this->order_index.size() <= check_num_orders || o != this->order_index[check_num_orders])) {
+			CCLOG("Order list %u: order index mismatch at order %u", this->index, check_num_orders);
+			index_valid = false;
+		}
 		++check_num_orders;
 		if (!o->IsType(OT_IMPLICIT)) ++check_num_manual_orders;
 		if (!o->IsType(OT_CONDITIONAL)) {
@@ -827,20 +847,33 @@ void OrderList::DebugCheckSanity() const
 			check_total_duration += o->GetWaitTime() + o->GetTravelTime();
 		}
 	}
-	assert_msg(this->GetNumOrders() == check_num_orders, "%u, %u", (uint) this->GetNumOrders(), check_num_orders);
-	assert_msg(this->num_manual_orders == check_num_manual_orders, "%u, %u", this->num_manual_orders, check_num_manual_orders);
-	assert_msg(this->timetable_duration == check_timetable_duration, "%u, %u", this->timetable_duration, check_timetable_duration);
-	assert_msg(this->total_duration == check_total_duration, "%u, %u", this->total_duration, check_total_duration);
+	if (this->GetNumOrders() != check_num_orders) {
+		CCLOG("Order list %u: num_orders mismatch: %u, %u", this->index, (uint) this->GetNumOrders(), check_num_orders);
+	}
+	if (this->num_manual_orders != check_num_manual_orders) {
+		CCLOG("Order list %u: num_manual_orders mismatch: %u, %u", this->index, this->num_manual_orders, check_num_manual_orders);
+	}
+	if (this->timetable_duration != check_timetable_duration) {
+		CCLOG("Order list %u: timetable_duration mismatch: %i, %i", this->index, this->timetable_duration, check_timetable_duration);
+	}
+	if (this->total_duration != check_total_duration) {
+		CCLOG("Order list %u: total_duration mismatch: %i, %i", this->index, this->total_duration, check_total_duration);
+	}
 
 	for (const Vehicle *v = this->first_shared; v != nullptr; v = v->NextShared()) {
 		++check_num_vehicles;
-		assert_msg(v->orders.list == this, "%p, %p", v->orders.list, this);
+		if (v->orders.list != this) {
+			CCLOG("Order list %u: vehicle %u has order list %p, expected %p", this->index, v->index, v->orders.list, this);
+		}
+	}
+	if (this->num_vehicles != check_num_vehicles) {
+		CCLOG("Order list %u: num_vehicles mismatch: %u, %u", this->index, this->num_vehicles, check_num_vehicles);
 	}
-	assert_msg(this->num_vehicles == check_num_vehicles, "%u, %u", this->num_vehicles, check_num_vehicles);
 	DEBUG(misc, 6, "... detected %u orders (%u manual), %u vehicles, %i timetabled, %i total",
 			(uint)this->GetNumOrders(), (uint)this->num_manual_orders,
 			this->num_vehicles, this->timetable_duration, this->total_duration);
-	assert(this->CheckOrderListIndexing());
+	if (!this->CheckOrderListIndexing()) CCLOG("Order list %u: order list indexing mismatch", this->index);
+#undef CCLOG
 }
 
 /**
@@ -12,6 +12,7 @@
 
 #include "../../debug.h"
 #include "../../settings_type.h"
+#include "../../framerate_type.h"
 
 extern int _total_pf_time_us;
 
@@ -116,6 +117,7 @@ public:
 	 */
 	inline bool FindPath(const VehicleType *v)
 	{
+		TICK_PROFILE_SCOPE("YAPF");
 		m_veh = v;
 
 		CPerformanceTimer perf;
@@ -256,9 +258,7 @@ public:
 
 		bool bValid = Yapf().PfCalcCost(n, &tf);
 
-		if (bCached) {
-			Yapf().PfNodeCacheFlush(n);
-		}
+		Yapf().PfNodeCacheFlush(n);
 
 		if (bValid) bValid = Yapf().PfCalcEstimate(n);
 
@@ -11,6 +11,7 @@
 #define YAPF_CACHE_H
 
 #include "../../track_type.h"
+#include "../../tilearea_type.h"
 
 /**
  * Use this function to notify YAPF that track layout (or signal configuration) has change.
@@ -19,4 +20,10 @@
  */
 void YapfNotifyTrackLayoutChange(TileIndex tile, Track track);
 
+/**
+ * Use this function to notify YAPF that the track layout of all tiles in an area has changed.
+ * @param area the changed tiles
+ */
+void YapfNotifyTrackLayoutChange(const TileArea &area);
+
 #endif /* YAPF_CACHE_H */
@@ -11,6 +11,10 @@
 #define YAPF_COSTCACHE_HPP
 
 #include "../../date_func.h"
+#include "../../tilearea_type.h"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 /**
  * CYapfSegmentCostCacheNoneT - the formal only yapf cost cache provider that implements
@@ -91,19 +95,65 @@ public:
 
 
 /**
- * Base class for segment cost cache providers. Contains global counter
- *  of track layout changes and static notification function called whenever
- *  the track layout changes. It is implemented as base class because it needs
- *  to be shared between all rail YAPF types (one shared counter, one notification
- *  function.
+ * Base class for segment cost cache providers. Keeps track of all global
+ *  segment cost caches, and contains the static notification functions called
+ *  whenever the track layout changes. It is implemented as base class because
+ *  it needs to be shared between all rail YAPF types (one list of caches, one
+ *  notification function).
  */
 struct CSegmentCostCacheBase
 {
-	static int   s_rail_change_counter;
+	static uint64 s_stats_hits;      ///< stats - number of segments which were reused from a global cache
+	static uint64 s_stats_misses;    ///< stats - number of segments which had to be calculated for a global cache
+	static uint64 s_stats_evictions; ///< stats - number of segments evicted because of a track layout change
+	static uint64 s_stats_flushes;   ///< stats - number of times a whole cache was flushed
+
+	CSegmentCostCacheBase()
+	{
+		GetCaches().push_back(this);
+	}
+
+	virtual ~CSegmentCostCacheBase()
+	{
+		std::vector<CSegmentCostCacheBase *> &caches = GetCaches();
+		caches.erase(std::find(caches.begin(), caches.end(), this));
+	}
+
+	/** Evict all segments depending on any tile of the given area. */
+	virtual void InvalidateArea(const TileArea &area) = 0;
+
+	/** Flush (clear) the whole cache. */
+	virtual void Flush() = 0;
+
+	/** Get the number of segments in the cache. */
+	virtual uint GetSegmentCount() const = 0;
+
+	/** Get all global segment cost caches which currently exist. */
+	static std::vector<CSegmentCostCacheBase *> &GetCaches()
+	{
+		static std::vector<CSegmentCostCacheBase *> caches;
+		return caches;
+	}
 
 	static void NotifyTrackLayoutChange(TileIndex tile, Track track)
 	{
-		s_rail_change_counter++;
+		if (tile == INVALID_TILE) {
+			for (CSegmentCostCacheBase *cache : GetCaches()) {
+				cache->Flush();
+				s_stats_flushes++;
+			}
+		} else {
+			NotifyTrackLayoutChange(TileArea(tile, 1, 1));
+		}
+	}
+
+	static void NotifyTrackLayoutChange(const TileArea &area)
+	{
+		if (area.w == 0) return;
+
+		for (CSegmentCostCacheBase *cache : GetCaches()) {
+			cache->InvalidateArea(area);
+		}
 	}
 };
 
@@ -117,25 +167,42 @@ struct CSegmentCostCacheBase
  *  of the segment (origin tile and exit-dir from this tile).
  *  Different CYapfCachedCostT types can share the same type of CSegmentCostCacheT.
  *  Look at CYapfRailSegment (yapf_node_rail.hpp) for the segment example
+ *
+ *  Calculated segments are indexed by the map regions covered by the area of
+ *  tiles they depend on, so a track layout change only evicts the segments
+ *  close to the changed tile instead of flushing the whole cache.
  */
 template <class Tsegment>
 struct CSegmentCostCacheT : public CSegmentCostCacheBase {
 	static const int C_HASH_BITS = 14;
+	static const uint C_REGION_SHIFT = 4;          ///< log2 of the width/height in tiles of a region of the segment index
+	static const uint C_MAX_SEGMENT_REGIONS = 16;  ///< segments covering more regions than this are not indexed by region
+	static const uint C_MAX_SEGMENTS = 1 << 18;    ///< flush the whole cache when it holds this many segments
 
 	typedef CHashTableT<Tsegment, C_HASH_BITS> HashTable;
 	typedef SmallArray<Tsegment> Heap;
 	typedef typename Tsegment::Key Key;    ///< key to hash table
+	typedef std::vector<Tsegment *> SegmentList;
 
 	HashTable    m_map;
 	Heap         m_heap;
+	std::unordered_map<uint32, SegmentList> m_region_index; ///< calculated segments by index region
+	SegmentList  m_large_segments;                          ///< calculated segments covering too many regions to be indexed by region
 
 	inline CSegmentCostCacheT() {}
 
 	/** flush (clear) the cache */
-	inline void Flush()
+	void Flush() override
 	{
 		m_map.Clear();
 		m_heap.Clear();
+		m_region_index.clear();
+		m_large_segments.clear();
+	}
+
+	uint GetSegmentCount() const override
+	{
+		return m_map.Count();
 	}
 
 	inline Tsegment& Get(Key &key, bool *found)
@@ -150,6 +217,106 @@ struct CSegmentCostCacheT : public CSegmentCostCacheBase {
 		}
 		return *item;
 	}
+
+	/**
+	 * Add a calculated segment to the region index, if it isn't already.
+	 * @param segment The segment.
+	 */
+	void IndexSegment(Tsegment &segment)
+	{
+		if (segment.m_indexed || segment.m_cost < 0) return;
+		segment.m_indexed = true;
+
+		uint x0, y0, x1, y1;
+		if (!GetRegionRange(segment.m_area, x0, y0, x1, y1, true)) {
+			m_large_segments.push_back(&segment);
+			return;
+		}
+		for (uint y = y0; y <= y1; y++) {
+			for (uint x = x0; x <= x1; x++) {
+				m_region_index[GetRegionKey(x, y)].push_back(&segment);
+			}
+		}
+	}
+
+	void InvalidateArea(const TileArea &area) override
+	{
+		SegmentList victims;
+
+		uint x0, y0, x1, y1;
+		GetRegionRange(area, x0, y0, x1, y1, false);
+		for (uint y = y0; y <= y1; y++) {
+			for (uint x = x0; x <= x1; x++) {
+				auto iter = m_region_index.find(GetRegionKey(x, y));
+				if (iter == m_region_index.end()) continue;
+				for (Tsegment *segment : iter->second) {
+					if (segment->m_area.Intersects(area)) victims.push_back(segment);
+				}
+			}
+		}
+		for (Tsegment *segment : m_large_segments) {
+			if (segment->m_area.Intersects(area)) victims.push_back(segment);
+		}
+
+		for (Tsegment *segment : victims) {
+			/* A segment covering multiple regions may be found more than once. */
+			if (!segment->m_indexed) continue;
+			UnindexSegment(*segment);
+			segment->Invalidate();
+			s_stats_evictions++;
+		}
+	}
+
+private:
+	static inline uint32 GetRegionKey(uint x, uint y)
+	{
+		return x | (y << 16);
+	}
+
+	/**
+	 * Get the range of index regions covered by an area.
+	 * @param area The area.
+	 * @param[out] x0 First region column.
+	 * @param[out] y0 First region row.
+	 * @param[out] x1 Last region column.
+	 * @param[out] y1 Last region row.
+	 * @param limit Whether to fail when more than #C_MAX_SEGMENT_REGIONS are covered.
+	 * @return false if the limit was exceeded.
+	 */
+	static bool GetRegionRange(const TileArea &area, uint &x0, uint &y0, uint &x1, uint &y1, bool limit)
+	{
+		x0 = TileX(area.tile) >> C_REGION_SHIFT;
+		y0 = TileY(area.tile) >> C_REGION_SHIFT;
+		x1 = (TileX(area.tile) + area.w - 1) >> C_REGION_SHIFT;
+		y1 = (TileY(area.tile) + area.h - 1) >> C_REGION_SHIFT;
+		return !limit || (x1 - x0 + 1) * (y1 - y0 + 1) <= C_MAX_SEGMENT_REGIONS;
+	}
+
+	static void RemoveFromList(SegmentList &list, Tsegment *segment)
+	{
+		auto iter = std::find(list.begin(), list.end(), segment);
+		assert(iter != list.end());
+		*iter = list.back();
+		list.pop_back();
+	}
+
+	/** Remove a segment from the region index. */
+	void UnindexSegment(Tsegment &segment)
+	{
+		uint x0, y0, x1, y1;
+		if (!GetRegionRange(segment.m_area, x0, y0, x1, y1, true)) {
+			RemoveFromList(m_large_segments, &segment);
+			return;
+		}
+		for (uint y = y0; y <= y1; y++) {
+			for (uint x = x0; x <= x1; x++) {
+				auto iter = m_region_index.find(GetRegionKey(x, y));
+				assert(iter != m_region_index.end());
+				RemoveFromList(iter->second, &segment);
+				if (iter->second.empty()) m_region_index.erase(iter);
+			}
+		}
+	}
 };
 
 /**
@@ -181,7 +348,6 @@ protected:
 
 	inline static Cache& stGetGlobalCache()
 	{
-		static int last_rail_change_counter = 0;
 		static Date last_date = 0;
 		static Cache C;
 
@@ -192,10 +358,10 @@ protected:
 			_total_pf_time_us = 0;
 		}
 
-		/* delete the cache sometimes... */
-		if (last_rail_change_counter != Cache::s_rail_change_counter) {
-			last_rail_change_counter = Cache::s_rail_change_counter;
+		/* delete the cache when it grows too large... */
+		if (C.GetSegmentCount() >= Cache::C_MAX_SEGMENTS) {
 			C.Flush();
+			Cache::s_stats_flushes++;
 		}
 		return C;
 	}
@@ -213,16 +379,23 @@ public:
 		CacheKey key(n.GetKey());
 		bool found;
 		CachedData &item = m_global_cache.Get(key, &found);
+		if (item.m_cost >= 0) {
+			Cache::s_stats_hits++;
+		} else {
+			Cache::s_stats_misses++;
+		}
 		Yapf().ConnectNodeToCachedData(n, item);
 		return found;
 	}
 
 	/**
 	 * Called by YAPF to flush the cached segment cost data back into cache storage.
-	 *  Current cache implementation doesn't use that.
+	 *  Newly calculated segments are added to the region index of the cache.
 	 */
 	inline void PfNodeCacheFlush(Node &n)
 	{
+		if (!Yapf().CanUseGlobalCache(n)) return;
+		m_global_cache.IndexSegment(*n.m_segment);
 	}
 };
 
@@ -56,6 +56,7 @@ protected:
 	int           m_max_cost;
 	CBlobT<int>   m_sig_look_ahead_costs;
 	bool          m_disable_cache;
+	std::unordered_map<TraceRestrictProgramID, TraceRestrictProgramResult> m_trace_restrict_results; ///< results of programs which only depend on the train, for this pathfinder run
 
 public:
 	bool          m_stopped_on_first_two_way_signal;
@@ -269,7 +270,18 @@ private:
 			flags_to_check |= TRPAUF_REVERSE;
 		}
 		if (prog && prog->actions_used_flags & flags_to_check) {
-			prog->Execute(Yapf().GetVehicle(), TraceRestrictProgramInput(tile, trackdir, &TraceRestrictPreviousSignalCallback, &n), out);
+			if (prog->input_dependent) {
+				prog->Execute(Yapf().GetVehicle(), TraceRestrictProgramInput(tile, trackdir, &TraceRestrictPreviousSignalCallback, &n), out);
+			} else {
+				/* The train and slots do not change during the pathfinder run, so neither does the result */
+				auto iter = m_trace_restrict_results.find(prog->index);
+				if (iter != m_trace_restrict_results.end()) {
+					out = iter->second;
+				} else {
+					prog->Execute(Yapf().GetVehicle(), TraceRestrictProgramInput(tile, trackdir, &TraceRestrictPreviousSignalCallback, &n), out);
+					m_trace_restrict_results[prog->index] = out;
+				}
+			}
 			if (out.flags & TRPRF_RESERVE_THROUGH && is_res_through != nullptr) {
 				*is_res_through = true;
 			}
@@ -402,6 +414,34 @@ public:
 		return cost;
 	}
 
+	/**
+	 * Recalculate a segment taken from the global cache and compare it with the cached data.
+	 * Used when debugging desyncs to find track layout changes which did not invalidate the cache.
+	 */
+	void CheckCachedSegment(const Node &n, const TrackFollower *tf)
+	{
+		/* The first red two-way signal prunes the branch, this cannot happen for cached segments unless look-ahead is off. */
+		if (m_sig_look_ahead_costs.Size() == 0) return;
+
+		const CachedData &cached = *n.m_segment;
+		CachedData fresh(cached.m_key);
+		Node check = n;
+		Yapf().ConnectNodeToCachedData(check, fresh);
+		bool stopped_on_first_two_way_signal = m_stopped_on_first_two_way_signal;
+		PfCalcCost(check, tf);
+		m_stopped_on_first_two_way_signal = stopped_on_first_two_way_signal;
+
+		if (fresh.m_cost != cached.m_cost || fresh.m_last_tile != cached.m_last_tile || fresh.m_last_td != cached.m_last_td ||
+				fresh.m_end_segment_reason != cached.m_end_segment_reason ||
+				fresh.m_last_signal_tile != cached.m_last_signal_tile || fresh.m_last_signal_td != cached.m_last_signal_td) {
+			DEBUG(desync, 0, "CACHE ERROR: segment at %X, td %d: cost %d/%d, end %X:%d/%X:%d, reason %X/%X, signal %X:%d/%X:%d (cached/fresh)",
+					cached.m_key.GetTile(), cached.m_key.GetTrackdir(), cached.m_cost, fresh.m_cost,
+					cached.m_last_tile, cached.m_last_td, fresh.m_last_tile, fresh.m_last_td,
+					cached.m_end_segment_reason, fresh.m_end_segment_reason,
+					cached.m_last_signal_tile, cached.m_last_signal_td, fresh.m_last_signal_tile, fresh.m_last_signal_td);
+		}
+	}
+
 public:
 	inline void SetMaxCost(int max_cost)
 	{
@@ -427,6 +467,7 @@ public:
 		/* Do we already have a cached segment? */
 		CachedData &segment = *n.m_segment;
 		bool is_cached_segment = (segment.m_cost >= 0);
+		if (is_cached_segment && (_debug_yapfdesync_level > 0 || _debug_desync_level >= 2)) CheckCachedSegment(n, tf);
 
 		int parent_cost = has_parent ? n.m_parent->m_cost : 0;
 
@@ -472,6 +513,9 @@ public:
 
 		TrackFollower tf_local(v, Yapf().GetCompatibleRailTypes(), &Yapf().m_perf_ts_cost);
 
+		/* Collect the area of all tiles the segment cost depends on, for invalidating the cached segment. */
+		if (!is_cached_segment) segment.m_area = TileArea();
+
 		if (!has_parent) {
 			/* We will jump to the middle of the cost calculator assuming that segment cache is not used. */
 			assert(!is_cached_segment);
@@ -529,6 +573,8 @@ public:
 
 no_entry_cost: // jump here at the beginning if the node has no parent (it is the first node)
 
+			segment.m_area.Add(cur.tile);
+
 			/* All other tile costs will be calculated here. */
 			segment_cost += Yapf().OneTileCost(cur.tile, cur.td);
 
@@ -656,6 +702,8 @@ no_entry_cost: // jump here at the beginning if the node has no parent (it is th
 				break;
 			}
 
+			segment.m_area.Add(tf_local.m_new_tile);
+
 			/* Check if the next tile is not a choice. */
 			if (KillFirstBit(tf_local.m_new_td_bits) != TRACKDIR_BIT_NONE) {
 				/* More than one segment will follow. Close this one. */
@@ -727,6 +775,8 @@ no_entry_cost: // jump here at the beginning if the node has no parent (it is th
 			/* Write back the segment information so it can be reused the next time. */
 			segment.m_cost = segment_cost;
 			segment.m_end_segment_reason = end_segment_reason & ESRB_CACHED_MASK;
+			/* The track layout of adjacent tiles determines where the segment ends. */
+			segment.m_area.Expand(1);
 			/* Save end of segment back to the node. */
 			n.SetLastTileTrackdir(cur.tile, cur.td);
 		}
@@ -71,6 +71,8 @@ struct CYapfRailSegment
 	TileIndex              m_last_signal_tile;
 	Trackdir               m_last_signal_td;
 	EndSegmentReasonBits   m_end_segment_reason;
+	TileArea               m_area;       ///< area containing all tiles the segment cost depends on
+	bool                   m_indexed;    ///< whether this segment is in the region index of the global cache
 	CYapfRailSegment      *m_hash_next;
 
 	inline CYapfRailSegment(const CYapfRailSegmentKey &key)
@@ -81,9 +83,23 @@ struct CYapfRailSegment
 		, m_last_signal_tile(INVALID_TILE)
 		, m_last_signal_td(INVALID_TRACKDIR)
 		, m_end_segment_reason(ESRB_NONE)
+		, m_indexed(false)
 		, m_hash_next(nullptr)
 	{}
 
+	/** Forget the calculated segment cost, so it will be recalculated when used next time. */
+	inline void Invalidate()
+	{
+		m_last_tile = INVALID_TILE;
+		m_last_td = INVALID_TRACKDIR;
+		m_cost = -1;
+		m_last_signal_tile = INVALID_TILE;
+		m_last_signal_td = INVALID_TRACKDIR;
+		m_end_segment_reason = ESRB_NONE;
+		m_area = TileArea();
+		m_indexed = false;
+	}
+
 	inline const Key& GetKey() const
 	{
 		return m_key;
@@ -225,7 +225,15 @@ public:
 		if (target != nullptr) target->okay = true;
 
 		if (Yapf().CanUseGlobalCache(*m_res_node)) {
-			YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+			/* Only evict the cached segments around the reserved path, collect
+			 * the areas first as evicting also clears the area of a segment. */
+			std::vector<TileArea> areas;
+			for (Node *node = m_res_node; node->m_parent != nullptr; node = node->m_parent) {
+				areas.push_back(node->m_segment->m_area);
+			}
+			for (const TileArea &area : areas) {
+				CSegmentCostCacheBase::NotifyTrackLayoutChange(area);
+			}
 		}
 
 		return true;
@@ -756,14 +764,42 @@ bool YapfTrainFindNearestSafeTile(const Train *v, TileIndex tile, Trackdir td, b
 	return pfnFindNearestSafeTile(v, tile, td, override_railtype);
 }
 
-/** if any track changes, this counter is incremented - that will invalidate segment cost cache */
-int CSegmentCostCacheBase::s_rail_change_counter = 0;
+uint64 CSegmentCostCacheBase::s_stats_hits = 0;
+uint64 CSegmentCostCacheBase::s_stats_misses = 0;
+uint64 CSegmentCostCacheBase::s_stats_evictions = 0;
+uint64 CSegmentCostCacheBase::s_stats_flushes = 0;
 
 void YapfNotifyTrackLayoutChange(TileIndex tile, Track track)
 {
 	CSegmentCostCacheBase::NotifyTrackLayoutChange(tile, track);
 }
 
+void YapfNotifyTrackLayoutChange(const TileArea &area)
+{
+	CSegmentCostCacheBase::NotifyTrackLayoutChange(area);
+}
+
+/**
+ * Dump the statistics of the rail segment cost caches.
+ * @param b Buffer to write to.
+ * @param last Last valid position in the buffer.
+ */
+void DumpYapfCacheStats(char *b, const char *last)
+{
+	uint segments = 0;
+	for (const CSegmentCostCacheBase *cache : CSegmentCostCacheBase::GetCaches()) {
+		segments += cache->GetSegmentCount();
+	}
+	uint64 lookups = CSegmentCostCacheBase::s_stats_hits + CSegmentCostCacheBase::s_stats_misses;
+
+	b += seprintf(b, last, "Rail segment cost caches: %u, cached segments: %u\n", (uint)CSegmentCostCacheBase::GetCaches().size(), segments);
+	b += seprintf(b, last, "  Hits:      " OTTD_PRINTF64U " (%.1f%%)\n", CSegmentCostCacheBase::s_stats_hits,
+			lookups > 0 ? (100.0 * CSegmentCostCacheBase::s_stats_hits) / lookups : 0.0);
+	b += seprintf(b, last, "  Misses:    " OTTD_PRINTF64U "\n", CSegmentCostCacheBase::s_stats_misses);
+	b += seprintf(b, last, "  Evictions: " OTTD_PRINTF64U "\n", CSegmentCostCacheBase::s_stats_evictions);
+	b += seprintf(b, last, "  Flushes:   " OTTD_PRINTF64U "\n", CSegmentCostCacheBase::s_stats_flushes);
+}
+
 void YapfCheckRailSignalPenalties()
 {
 	bool negative = false;
@@ -267,8 +267,8 @@ public:
 	static Vehicle *CountShipProc(Vehicle *v, void *data)
 	{
 		uint *count = (uint *)data;
-		/* Ignore other vehicles (aircraft) and ships inside depot. */
-		if (v->type == VEH_SHIP && (v->vehstatus & VS_HIDDEN) == 0) (*count)++;
+		/* Ignore ships inside depot. */
+		if ((v->vehstatus & VS_HIDDEN) == 0) (*count)++;
 
 		return nullptr;
 	}
@@ -288,7 +288,7 @@ public:
 		if (IsDockingTile(n.GetTile())) {
 			/* Check docking tile for occupancy */
 			uint count = 1;
-			HasVehicleOnPos(n.GetTile(), &count, &CountShipProc);
+			HasVehicleOnPos(n.GetTile(), VEH_SHIP, &count, &CountShipProc);
 			c += count * 3 * YAPF_TILE_LENGTH;
 		}
 
@@ -328,8 +328,8 @@ struct RoadStopEntryRebuilderHelper {
 Vehicle *FindVehiclesInRoadStop(Vehicle *v, void *data)
 {
 	RoadStopEntryRebuilderHelper *rserh = (RoadStopEntryRebuilderHelper*)data;
-	/* Not a RV or not in the right direction or crashed :( */
-	if (v->type != VEH_ROAD || DirToDiagDir(v->direction) != rserh->dir || !v->IsPrimaryVehicle() || (v->vehstatus & VS_CRASHED) != 0) return nullptr;
+	/* Not in the right direction or crashed :( */
+	if (DirToDiagDir(v->direction) != rserh->dir || !v->IsPrimaryVehicle() || (v->vehstatus & VS_CRASHED) != 0) return nullptr;
 
 	RoadVehicle *rv = RoadVehicle::From(v);
 	/* Don't add ones not in a road stop */
@@ -363,7 +363,7 @@ void RoadStop::Entry::Rebuild(const RoadStop *rs, int side)
 	TileIndexDiff offset = abs(TileOffsByDiagDir(dir));
 	for (TileIndex tile = rs->xy; IsDriveThroughRoadStopContinuation(rs->xy, tile); tile += offset) {
 		this->length += TILE_SIZE;
-		FindVehicleOnPos(tile, &rserh, FindVehiclesInRoadStop);
+		FindVehicleOnPos(tile, VEH_ROAD, &rserh, FindVehiclesInRoadStop);
 	}
 
 	this->occupied = 0;
@@ -376,15 +376,16 @@ void RoadStop::Entry::Rebuild(const RoadStop *rs, int side)
 /**
  * Check the integrity of the data in this struct.
  * @param rs the roadstop this entry is part of
+ * @return true if the data is consistent.
  */
-void RoadStop::Entry::CheckIntegrity(const RoadStop *rs) const
+bool RoadStop::Entry::CheckIntegrity(const RoadStop *rs) const
 {
-	if (!HasBit(rs->status, RSSFB_BASE_ENTRY)) return;
+	if (!HasBit(rs->status, RSSFB_BASE_ENTRY)) return true;
 
 	/* The tile 'before' the road stop must not be part of this 'line' */
-	assert(!IsDriveThroughRoadStopContinuation(rs->xy, rs->xy - abs(TileOffsByDiagDir(GetRoadStopDir(rs->xy)))));
+	if (IsDriveThroughRoadStopContinuation(rs->xy, rs->xy - abs(TileOffsByDiagDir(GetRoadStopDir(rs->xy))))) return false;
 
 	Entry temp;
 	temp.Rebuild(rs, rs->east == this);
-	if (temp.length != this->length || temp.occupied != this->occupied) NOT_REACHED();
+	return temp.length == this->length && temp.occupied == this->occupied;
 }
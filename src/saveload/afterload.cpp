@@ -2444,24 +2444,13 @@ bool AfterLoadGame()
 
 	if (IsSavegameVersionBefore(SLV_122)) {
 		/* Animated tiles would sometimes not be actually animated or
-		 * in case of old savegames duplicate. */
+		 * in case of old savegames duplicate; duplicates are already skipped when loading. */
+		std::vector<TileIndex> animated_tiles;
+		GetAnimatedTiles(animated_tiles);
 
-		extern std::vector<TileIndex> _animated_tiles;
-
-		for (auto tile = _animated_tiles.begin(); tile < _animated_tiles.end(); /* Nothing */) {
+		for (TileIndex tile : animated_tiles) {
 			/* Remove if tile is not animated */
-			bool remove = _tile_type_procs[GetTileType(*tile)]->animate_tile_proc == nullptr;
-
-			/* and remove if duplicate */
-			for (auto j = _animated_tiles.begin(); !remove && j < tile; j++) {
-				remove = *tile == *j;
-			}
-
-			if (remove) {
-				DeleteAnimatedTile(*tile);
-			} else {
-				tile++;
-			}
+			if (_tile_type_procs[GetTileType(tile)]->animate_tile_proc == nullptr) DeleteAnimatedTile(tile);
 		}
 	}
 
@@ -9,29 +9,33 @@
 
 #include "../stdafx.h"
 #include "../tile_type.h"
+#include "../animated_tile_func.h"
 #include "../core/alloc_func.hpp"
-#include "../core/smallvec_type.hpp"
 
 #include "saveload.h"
 
 #include "../safeguards.h"
 
-extern std::vector<TileIndex> _animated_tiles;
-
 /**
  * Save the ANIT chunk.
  */
 static void Save_ANIT()
 {
-	SlSetLength(_animated_tiles.size() * sizeof(_animated_tiles.front()));
-	SlArray(_animated_tiles.data(), _animated_tiles.size(), SLE_UINT32);
+	std::vector<TileIndex> tiles;
+	GetAnimatedTiles(tiles);
+
+	SlSetLength(tiles.size() * sizeof(tiles.front()));
+	SlArray(tiles.data(), tiles.size(), SLE_UINT32);
 }
 
 /**
  * Load the ANIT chunk; the chunk containing the animated tiles.
+ * Their animation speed is not known yet, so all of them are animated in the first tick.
  */
 static void Load_ANIT()
 {
+	InitializeAnimatedTiles();
+
 	/* Before version 80 we did NOT have a variable length animated tile table */
 	if (IsSavegameVersionBefore(SLV_80)) {
 		/* In pre version 6, we has 16bit per tile, now we have 32bit per tile, convert it ;) */
@@ -40,15 +44,45 @@ static void Load_ANIT()
 
 		for (int i = 0; i < 256; i++) {
 			if (anim_list[i] == 0) break;
-			_animated_tiles.push_back(anim_list[i]);
+			LoadAnimatedTile(anim_list[i], 0);
 		}
 		return;
 	}
 
-	uint count = (uint)SlGetFieldLength() / sizeof(_animated_tiles.front());
-	_animated_tiles.clear();
-	_animated_tiles.resize(_animated_tiles.size() + count);
-	SlArray(_animated_tiles.data(), count, SLE_UINT32);
+	uint count = (uint)SlGetFieldLength() / sizeof(TileIndex);
+	std::vector<TileIndex> tiles(count);
+	SlArray(tiles.data(), count, SLE_UINT32);
+	for (TileIndex tile : tiles) LoadAnimatedTile(tile, 0);
+}
+
+/**
+ * Save the ANIS chunk; the animation speed of each tile of the ANIT chunk.
+ */
+static void Save_ANIS()
+{
+	std::vector<TileIndex> tiles;
+	std::vector<uint8> speeds;
+	GetAnimatedTiles(tiles, &speeds);
+
+	SlSetLength(speeds.size());
+	SlArray(speeds.data(), speeds.size(), SLE_UINT8);
+}
+
+/**
+ * Load the ANIS chunk, and schedule the animated tiles by their animation speed.
+ */
+static void Load_ANIS()
+{
+	std::vector<TileIndex> tiles;
+	GetAnimatedTiles(tiles);
+
+	uint count = (uint)SlGetFieldLength();
+	if (count != tiles.size()) SlErrorCorrupt("Number of animated tile speeds does not match number of animated tiles");
+	std::vector<uint8> speeds(count);
+	SlArray(speeds.data(), count, SLE_UINT8);
+
+	InitializeAnimatedTiles();
+	for (uint i = 0; i < count; i++) LoadAnimatedTile(tiles[i], speeds[i]);
 }
 
 /**
@@ -56,5 +90,6 @@ static void Load_ANIT()
  * the animated tile table.
  */
 extern const ChunkHandler _animated_tile_chunk_handlers[] = {
-	{ 'ANIT', Save_ANIT, Load_ANIT, nullptr, nullptr, CH_RIFF | CH_LAST},
+	{ 'ANIT', Save_ANIT, Load_ANIT, nullptr, nullptr, CH_RIFF},
+	{ 'ANIS', Save_ANIS, Load_ANIS, nullptr, nullptr, CH_RIFF | CH_LAST},
 };
@@ -133,6 +133,9 @@ const SaveLoad *GetCargoPacketDesc()
  */
 static void Save_CAPA()
 {
+	/* Cargo in vehicles is aged lazily, bring it up to date so the saved days in transit are correct. */
+	for (Vehicle *v : Vehicle::Iterate()) v->cargo.UpdatePacketAges();
+
 	std::vector<SaveLoad> filtered_packet_desc = SlFilterObject(GetCargoPacketDesc());
 	for (CargoPacket *cp : CargoPacket::Iterate()) {
 		SlSetArrayIndex(cp->index);
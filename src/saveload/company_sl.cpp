@@ -91,21 +91,26 @@ CompanyManagerFace ConvertFromOldCompanyManagerFace(uint32 face)
 	return cmf;
 }
 
-/** Rebuilding of company statistics after loading a savegame. */
-void AfterLoadCompanyStats()
+/** Add the airports to the infrastructure statistics of their owners. */
+void AddCompanyAirportInfrastructure()
 {
-	/* Reset infrastructure statistics to zero. */
-	for (Company *c : Company::Iterate()) MemSetT(&c->infrastructure, 0);
-
-	/* Collect airport count. */
 	for (const Station *st : Station::Iterate()) {
 		if ((st->facilities & FACIL_AIRPORT) && Company::IsValidID(st->owner)) {
 			Company::Get(st->owner)->infrastructure.airport++;
 		}
 	}
+}
 
+/**
+ * Add the infrastructure on a range of tiles to the infrastructure statistics of their owners.
+ * Tunnels and bridges are added with their northern end.
+ * @param begin First tile of the range.
+ * @param end Tile after the range.
+ */
+void AddCompanyTileInfrastructure(TileIndex begin, TileIndex end)
+{
 	Company *c;
-	for (TileIndex tile = 0; tile < MapSize(); tile++) {
+	for (TileIndex tile = begin; tile < end; tile++) {
 		switch (GetTileType(tile)) {
 			case MP_RAILWAY:
 				c = Company::GetIfValid(GetTileOwner(tile));
@@ -234,6 +239,16 @@ void AfterLoadCompanyStats()
 	}
 }
 
+/** Rebuilding of company statistics after loading a savegame. */
+void AfterLoadCompanyStats()
+{
+	/* Reset infrastructure statistics to zero. */
+	for (Company *c : Company::Iterate()) MemSetT(&c->infrastructure, 0);
+
+	AddCompanyAirportInfrastructure();
+	AddCompanyTileInfrastructure(0, MapSize());
+}
+
 
 
 /* Save/load of companies */
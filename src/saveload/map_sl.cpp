@@ -221,7 +221,21 @@ static void Load_WMAP()
 	ReadBuffer *reader = ReadBuffer::GetCurrent();
 	const TileIndex size = MapSize();
 
-#if TTD_ENDIAN == TTD_LITTLE_ENDIAN
+#if TTD_ENDIAN == TTD_LITTLE_ENDIAN && defined(WITH_SOA_MAP)
+	std::array<Tile, MAP_SL_BUF_SIZE> buf;
+	for (TileIndex i = 0; i != size; i += MAP_SL_BUF_SIZE) {
+		reader->CopyBytes((byte *) buf.data(), MAP_SL_BUF_SIZE * 8);
+		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) {
+			_m.type[i + j] = buf[j].type;
+			_m.height[i + j] = buf[j].height;
+			_m.m2[i + j] = buf[j].m2;
+			_m.m1[i + j] = buf[j].m1;
+			_m.m3[i + j] = buf[j].m3;
+			_m.m4[i + j] = buf[j].m4;
+			_m.m5[i + j] = buf[j].m5;
+		}
+	}
+#elif TTD_ENDIAN == TTD_LITTLE_ENDIAN
 	reader->CopyBytes((byte *) _m, size * 8);
 #else
 	for (TileIndex i = 0; i != size; i++) {
@@ -245,7 +259,17 @@ static void Load_WMAP()
 			_me[i].m7 = reader->RawReadByte();
 		}
 	} else if (_sl_xv_feature_versions[XSLFI_WHOLE_MAP_CHUNK] == 2) {
-#if TTD_ENDIAN == TTD_LITTLE_ENDIAN
+#if TTD_ENDIAN == TTD_LITTLE_ENDIAN && defined(WITH_SOA_MAP)
+		std::array<TileExtended, MAP_SL_BUF_SIZE> buf;
+		for (TileIndex i = 0; i != size; i += MAP_SL_BUF_SIZE) {
+			reader->CopyBytes((byte *) buf.data(), MAP_SL_BUF_SIZE * 4);
+			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) {
+				_me.m6[i + j] = buf[j].m6;
+				_me.m7[i + j] = buf[j].m7;
+				_me.m8[i + j] = buf[j].m8;
+			}
+		}
+#elif TTD_ENDIAN == TTD_LITTLE_ENDIAN
 		reader->CopyBytes((byte *) _me, size * 4);
 #else
 		for (TileIndex i = 0; i != size; i++) {
@@ -272,7 +296,22 @@ static void Save_WMAP()
 	const TileIndex size = MapSize();
 	SlSetLength(size * 12);
 
-#if TTD_ENDIAN == TTD_LITTLE_ENDIAN
+#if TTD_ENDIAN == TTD_LITTLE_ENDIAN && defined(WITH_SOA_MAP)
+	std::array<Tile, MAP_SL_BUF_SIZE> buf;
+	for (TileIndex i = 0; i != size; i += MAP_SL_BUF_SIZE) {
+		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) {
+			buf[j] = { _m.type[i + j], _m.height[i + j], _m.m2[i + j], _m.m1[i + j], _m.m3[i + j], _m.m4[i + j], _m.m5[i + j] };
+		}
+		dumper->CopyBytes((byte *) buf.data(), MAP_SL_BUF_SIZE * 8);
+	}
+	std::array<TileExtended, MAP_SL_BUF_SIZE> ext_buf;
+	for (TileIndex i = 0; i != size; i += MAP_SL_BUF_SIZE) {
+		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) {
+			ext_buf[j] = { _me.m6[i + j], _me.m7[i + j], _me.m8[i + j] };
+		}
+		dumper->CopyBytes((byte *) ext_buf.data(), MAP_SL_BUF_SIZE * 4);
+	}
+#elif TTD_ENDIAN == TTD_LITTLE_ENDIAN
 	dumper->CopyBytes((byte *) _m, size * 8);
 	dumper->CopyBytes((byte *) _me, size * 4);
 #else
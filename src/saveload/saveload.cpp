@@ -54,10 +54,14 @@
 #include "saveload_buffer.h"
 #include "extended_ver_sl.h"
 
+#include <chrono>
 #include <deque>
+#include <exception>
 #include <vector>
 
 #include "../thread.h"
+#include "../worker_thread.h"
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #if defined(__MINGW32__)
@@ -2739,10 +2743,6 @@ struct LZMASaveFilter : SaveFilter {
 
 #endif /* WITH_LIBLZMA */
 
-/*******************************************
- ************* END OF CODE *****************
- *******************************************/
-
 /** The format for a reader/writer type of a savegame */
 struct SaveLoadFormat {
 	const char *name;                     ///< name of the compressor/decompressor (debug-only)
@@ -2757,6 +2757,377 @@ struct SaveLoadFormat {
 	bool no_threaded_load;                ///< unsuitable for threaded loading
 };
 
+/********************************************
+ ********** START OF MEMORY CODE ************
+ ********************************************/
+
+/** Filter writing the savegame to a memory buffer. */
+struct MemorySaveFilter : SaveFilter {
+	std::vector<byte> &buffer; ///< The buffer to write to.
+
+	/**
+	 * Initialise this filter.
+	 * @param buffer The buffer to append the savegame to.
+	 */
+	MemorySaveFilter(std::vector<byte> &buffer) : SaveFilter(nullptr), buffer(buffer)
+	{
+	}
+
+	void Write(byte *buf, size_t size) override
+	{
+		this->buffer.insert(this->buffer.end(), buf, buf + size);
+	}
+};
+
+/** Filter reading the savegame from a memory buffer. */
+struct MemoryLoadFilter : LoadFilter {
+	const byte *data; ///< The data to read from.
+	size_t size;      ///< The size of the data.
+	size_t pos;       ///< The current read position.
+
+	/**
+	 * Initialise this filter.
+	 * @param data The data to read from, must stay valid during the lifetime of the filter.
+	 * @param size The size of the data.
+	 */
+	MemoryLoadFilter(const byte *data, size_t size) : LoadFilter(nullptr), data(data), size(size), pos(0)
+	{
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		size_t to_read = min<size_t>(size, this->size - this->pos);
+		memcpy(buf, this->data + this->pos, to_read);
+		this->pos += to_read;
+		return to_read;
+	}
+
+	void Reset() override
+	{
+		this->pos = 0;
+	}
+};
+
+/********************************************
+ ********** START OF PARALLEL CODE **********
+ ********************************************/
+
+/*
+ * The parallel savegame format splits the savegame into independently
+ * compressed blocks, so they can be compressed and decompressed by the
+ * worker thread pool. After the savegame header (which uses the 'OTTM' tag),
+ * the tag of the format used to compress the blocks follows, and then the
+ * blocks themselves. Each block consists of the size of the compressed data,
+ * the size of the uncompressed data (both big endian uint32) and the
+ * compressed data. A block with a compressed size of 0 marks the end.
+ */
+
+static const uint32 PARALLEL_SAVEGAME_TAG = TO_BE32X('OTTM');   ///< Tag of the parallel savegame format.
+static const size_t PARALLEL_BLOCK_SIZE = 4 * 1024 * 1024;      ///< Uncompressed size of a block of the parallel savegame format.
+
+/** Block of a savegame in the parallel format. */
+struct ParallelBlock {
+	std::vector<byte> input;                  ///< The data to (de)compress.
+	std::vector<byte> output;                 ///< The (de)compressed data.
+	bool done = false;                        ///< Whether the job (de)compressing this block has finished.
+	bool have_exception = false;              ///< Whether the job (de)compressing this block failed on a worker thread.
+	ThreadSlErrorException caught_exception;  ///< The error of the job which failed on a worker thread.
+	std::exception_ptr other_exception;       ///< Any other error of the job, e.g.\ of SlError when the job ran on the main thread.
+};
+
+/**
+ * Queue of blocks which are (de)compressed by the worker thread pool, and
+ * handed back in order. This is used by a single thread, the job functions
+ * are run by the worker threads.
+ */
+struct ParallelBlockQueue {
+	std::deque<std::unique_ptr<ParallelBlock>> blocks; ///< Queued blocks, in order.
+	std::mutex mutex;                                  ///< Mutex for the done state of the blocks.
+	std::condition_variable done_cv;                   ///< Signalled when a block is done.
+
+	/** Make sure no job uses a block anymore. */
+	~ParallelBlockQueue()
+	{
+		std::unique_lock<std::mutex> lk(this->mutex);
+		for (const auto &block : this->blocks) {
+			while (!block->done) this->done_cv.wait(lk);
+		}
+	}
+
+	/**
+	 * Get the maximum number of blocks to keep queued.
+	 * @return Number of blocks.
+	 */
+	static size_t GetMaxQueued()
+	{
+		return _saveload_worker_pool.GetWorkerCount() + 1;
+	}
+
+	/**
+	 * Queue a block, and start the job for it.
+	 * @param block The block.
+	 * @param job The job to (de)compress the block.
+	 * @param data Extra data passed to the job.
+	 */
+	void Enqueue(std::unique_ptr<ParallelBlock> block, WorkerJobFunc *job, const void *data)
+	{
+		ParallelBlock *b = block.get();
+		this->blocks.push_back(std::move(block));
+		_saveload_worker_pool.EnqueueJob(job, this, b, const_cast<void *>(data));
+	}
+
+	/**
+	 * Wait until the first block is done.
+	 * @return The first block, which stays queued.
+	 */
+	ParallelBlock *WaitFront()
+	{
+		ParallelBlock *block = this->blocks.front().get();
+		std::unique_lock<std::mutex> lk(this->mutex);
+		while (!block->done) this->done_cv.wait(lk);
+		lk.unlock();
+		if (block->have_exception) SlError(block->caught_exception.string, block->caught_exception.extra_msg);
+		if (block->other_exception) std::rethrow_exception(block->other_exception);
+		return block;
+	}
+
+	/**
+	 * Check whether the first block is done, without waiting.
+	 * @return True if the first block is done.
+	 */
+	bool IsFrontDone()
+	{
+		std::lock_guard<std::mutex> lk(this->mutex);
+		return this->blocks.front()->done;
+	}
+
+	/**
+	 * Mark a block as done, to be called by the jobs.
+	 * @param block The block.
+	 */
+	void MarkDone(ParallelBlock *block)
+	{
+		std::lock_guard<std::mutex> lk(this->mutex);
+		block->done = true;
+		this->done_cv.notify_all();
+	}
+};
+
+/** Filter using one of the other formats to compress independent blocks in parallel. */
+struct ParallelSaveFilter : SaveFilter {
+	const SaveLoadFormat *format;          ///< The format to compress the blocks with.
+	byte compression_level;                ///< The compression level of the format.
+	std::unique_ptr<ParallelBlock> current; ///< The block being filled.
+	bool tag_written = false;              ///< Whether the tag of the block format has been written.
+	ParallelBlockQueue queue;              ///< The blocks being compressed.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain             The next filter in this chain.
+	 * @param format            The format to compress the blocks with.
+	 * @param compression_level The requested level of compression.
+	 */
+	ParallelSaveFilter(SaveFilter *chain, const SaveLoadFormat *format, byte compression_level) : SaveFilter(chain), format(format), compression_level(compression_level)
+	{
+	}
+
+	static void CompressBlockJob(void *queue_ptr, void *block_ptr, void *filter_ptr)
+	{
+		ParallelBlockQueue *queue = static_cast<ParallelBlockQueue *>(queue_ptr);
+		ParallelBlock *block = static_cast<ParallelBlock *>(block_ptr);
+		const ParallelSaveFilter *self = static_cast<const ParallelSaveFilter *>(filter_ptr);
+		try {
+			std::unique_ptr<SaveFilter> sf(self->format->init_write(new MemorySaveFilter(block->output), self->compression_level));
+			sf->Write(block->input.data(), block->input.size());
+			sf->Finish();
+		} catch (const ThreadSlErrorException &ex) {
+			block->caught_exception = ex;
+			block->have_exception = true;
+		} catch (...) {
+			/* Without worker threads the job runs on the calling thread, where SlError has already set the error before throwing. */
+			block->other_exception = std::current_exception();
+		}
+		queue->MarkDone(block);
+	}
+
+	/**
+	 * Write the compressed blocks which are done to the next filter, in order.
+	 * @param max_queued Wait for blocks while more than this number of blocks is queued.
+	 */
+	void WriteBlocks(size_t max_queued)
+	{
+		if (!this->tag_written) {
+			uint32 tag = this->format->tag;
+			this->chain->Write((byte *)&tag, sizeof(tag));
+			this->tag_written = true;
+		}
+
+		while (!this->queue.blocks.empty()) {
+			if (this->queue.blocks.size() <= max_queued && !this->queue.IsFrontDone()) break;
+
+			ParallelBlock *block = this->queue.WaitFront();
+			uint32 header[2] = { TO_BE32((uint32)block->output.size()), TO_BE32((uint32)block->input.size()) };
+			this->chain->Write((byte *)header, sizeof(header));
+			this->chain->Write(block->output.data(), block->output.size());
+			this->queue.blocks.pop_front();
+		}
+	}
+
+	/** Start compressing the current block. */
+	void SubmitBlock()
+	{
+		this->queue.Enqueue(std::move(this->current), &ParallelSaveFilter::CompressBlockJob, this);
+		this->WriteBlocks(ParallelBlockQueue::GetMaxQueued());
+	}
+
+	void Write(byte *buf, size_t size) override
+	{
+		while (size > 0) {
+			if (this->current == nullptr) {
+				this->current.reset(new ParallelBlock());
+				this->current->input.reserve(PARALLEL_BLOCK_SIZE);
+			}
+
+			size_t to_write = min<size_t>(PARALLEL_BLOCK_SIZE - this->current->input.size(), size);
+			this->current->input.insert(this->current->input.end(), buf, buf + to_write);
+			buf += to_write;
+			size -= to_write;
+
+			if (this->current->input.size() == PARALLEL_BLOCK_SIZE) this->SubmitBlock();
+		}
+	}
+
+	void Finish() override
+	{
+		if (this->current != nullptr) this->SubmitBlock();
+		this->WriteBlocks(0);
+
+		uint32 end[2] = { 0, 0 };
+		this->chain->Write((byte *)end, sizeof(end));
+		this->chain->Finish();
+	}
+};
+
+static const SaveLoadFormat *GetSavegameFormatByTag(uint32 tag);
+
+/** Filter decompressing the independent blocks of the parallel format in parallel. */
+struct ParallelLoadFilter : LoadFilter {
+	const SaveLoadFormat *format = nullptr; ///< The format the blocks are compressed with, nullptr until it has been read.
+	ParallelBlockQueue queue;               ///< The blocks being decompressed.
+	size_t read_pos = 0;                    ///< Read position in the first block.
+	bool end_seen = false;                  ///< Whether the end of the blocks has been read.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain The next filter in this chain.
+	 */
+	ParallelLoadFilter(LoadFilter *chain) : LoadFilter(chain)
+	{
+	}
+
+	/** Read the format the blocks are compressed with. */
+	void ReadFormat()
+	{
+		uint32 tag;
+		if (this->ReadChain((byte *)&tag, sizeof(tag)) != sizeof(tag)) SlErrorCorrupt("Unexpected end of parallel savegame");
+		const SaveLoadFormat *fmt = GetSavegameFormatByTag(tag);
+		if (fmt == nullptr || fmt->init_load == nullptr || fmt->tag == PARALLEL_SAVEGAME_TAG) {
+			SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "Loader for parallel savegame blocks is not available.");
+		}
+		this->format = fmt;
+	}
+
+	/**
+	 * Read exactly the given number of bytes from the next filter, unless the end is reached.
+	 * @param buf The bytes to read.
+	 * @param size The number of bytes to read.
+	 * @return The number of actually read bytes.
+	 */
+	size_t ReadChain(byte *buf, size_t size)
+	{
+		size_t read = 0;
+		while (read < size) {
+			size_t r = this->chain->Read(buf + read, size - read);
+			if (r == 0) break;
+			read += r;
+		}
+		return read;
+	}
+
+	static void DecompressBlockJob(void *queue_ptr, void *block_ptr, void *filter_ptr)
+	{
+		ParallelBlockQueue *queue = static_cast<ParallelBlockQueue *>(queue_ptr);
+		ParallelBlock *block = static_cast<ParallelBlock *>(block_ptr);
+		const ParallelLoadFilter *self = static_cast<const ParallelLoadFilter *>(filter_ptr);
+		try {
+			std::unique_ptr<LoadFilter> lf(self->format->init_load(new MemoryLoadFilter(block->input.data(), block->input.size())));
+			size_t read = 0;
+			while (read < block->output.size()) {
+				size_t r = lf->Read(block->output.data() + read, block->output.size() - read);
+				if (r == 0) SlErrorCorrupt("Parallel savegame block is too short");
+				read += r;
+			}
+		} catch (const ThreadSlErrorException &ex) {
+			block->caught_exception = ex;
+			block->have_exception = true;
+		} catch (...) {
+			/* Without worker threads the job runs on the calling thread, where SlError has already set the error before throwing. */
+			block->other_exception = std::current_exception();
+		}
+		block->input = std::vector<byte>();
+		queue->MarkDone(block);
+	}
+
+	/** Read blocks from the next filter and start decompressing them, until enough are queued. */
+	void FillQueue()
+	{
+		while (!this->end_seen && this->queue.blocks.size() < ParallelBlockQueue::GetMaxQueued()) {
+			uint32 header[2];
+			if (this->ReadChain((byte *)header, sizeof(header)) != sizeof(header)) SlErrorCorrupt("Unexpected end of parallel savegame");
+			uint32 compressed_size = FROM_BE32(header[0]);
+			uint32 uncompressed_size = FROM_BE32(header[1]);
+			if (compressed_size == 0) {
+				this->end_seen = true;
+				break;
+			}
+			if (uncompressed_size > PARALLEL_BLOCK_SIZE) SlErrorCorrupt("Parallel savegame block is too large");
+
+			std::unique_ptr<ParallelBlock> block(new ParallelBlock());
+			block->input.resize(compressed_size);
+			block->output.resize(uncompressed_size);
+			if (this->ReadChain(block->input.data(), compressed_size) != compressed_size) SlErrorCorrupt("Unexpected end of parallel savegame");
+			this->queue.Enqueue(std::move(block), &ParallelLoadFilter::DecompressBlockJob, this);
+		}
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		if (this->format == nullptr) this->ReadFormat();
+
+		size_t read = 0;
+		while (read < size) {
+			this->FillQueue();
+			if (this->queue.blocks.empty()) break;
+
+			ParallelBlock *block = this->queue.WaitFront();
+			size_t to_read = min<size_t>(size - read, block->output.size() - this->read_pos);
+			memcpy(buf + read, block->output.data() + this->read_pos, to_read);
+			read += to_read;
+			this->read_pos += to_read;
+			if (this->read_pos == block->output.size()) {
+				this->queue.blocks.pop_front();
+				this->read_pos = 0;
+			}
+		}
+		return read;
+	}
+};
+
+/*******************************************
+ ************* END OF CODE *****************
+ *******************************************/
+
+
 /** The different saveload formats known/understood by OpenTTD. */
 static const SaveLoadFormat _saveload_formats[] = {
 #if defined(WITH_LZO)
@@ -2785,8 +3156,23 @@ static const SaveLoadFormat _saveload_formats[] = {
 #else
 	{"lzma",   TO_BE32X('OTTX'), nullptr,                            nullptr,                            0, 0, 0, false},
 #endif
+	/* Blocks compressed with one of the formats above; selected using the parallel_savegame_compression setting. */
+	{"parallel", PARALLEL_SAVEGAME_TAG, CreateLoadFilter<ParallelLoadFilter>, nullptr,                        0, 0, 0, false},
 };
 
+/**
+ * Find a savegame format by its tag.
+ * @param tag The tag of the format.
+ * @return The format, or nullptr if there is none with the tag.
+ */
+static const SaveLoadFormat *GetSavegameFormatByTag(uint32 tag)
+{
+	for (const SaveLoadFormat *slf = &_saveload_formats[0]; slf != endof(_saveload_formats); slf++) {
+		if (slf->tag == tag) return slf;
+	}
+	return nullptr;
+}
+
 /**
  * Return the savegameformat of the game. Whether it was created with ZLIB compression
  * uncompressed, or another type
@@ -2937,11 +3323,14 @@ static SaveOrLoadResult SaveFileToDisk(bool threaded)
 		byte compression;
 		const SaveLoadFormat *fmt = GetSavegameFormat(_savegame_format, &compression);
 
+		/* Compressing independent blocks in parallel is pointless without compression. */
+		const bool parallel = _settings_client.gui.parallel_savegame_compression && fmt->tag != TO_BE32X('OTTN');
+
 		/* We have written our stuff to memory, now write it to file! */
-		uint32 hdr[2] = { fmt->tag, TO_BE32((uint32) (SAVEGAME_VERSION | SAVEGAME_VERSION_EXT) << 16) };
+		uint32 hdr[2] = { parallel ? PARALLEL_SAVEGAME_TAG : fmt->tag, TO_BE32((uint32) (SAVEGAME_VERSION | SAVEGAME_VERSION_EXT) << 16) };
 		_sl.sf->Write((byte*)hdr, sizeof(hdr));
 
-		_sl.sf = fmt->init_write(_sl.sf, compression);
+		_sl.sf = parallel ? new ParallelSaveFilter(_sl.sf, fmt, compression) : fmt->init_write(_sl.sf, compression);
 		_sl.dumper->Flush(_sl.sf);
 
 		ClearSaveLoadState();
@@ -3268,8 +3657,10 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 		SlLoadCheckChunks();
 	} else {
 		/* Load chunks and resolve references */
+		auto start = std::chrono::steady_clock::now();
 		SlLoadChunks();
 		SlFixPointers();
+		DEBUG(sl, 1, "Loaded chunks in %u ms", (uint)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
 	}
 
 	ClearSaveLoadState();
@@ -3284,10 +3675,12 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 
 		/* After loading fix up savegame for any internal changes that
 		 * might have occurred since then. If it fails, load back the old game. */
+		auto start = std::chrono::steady_clock::now();
 		if (!AfterLoadGame()) {
 			GamelogStopAction();
 			return SL_REINIT;
 		}
+		DEBUG(sl, 1, "AfterLoadGame took %u ms", (uint)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
 
 		GamelogStopAction();
 		SlXvSetCurrentState();
@@ -3409,6 +3802,79 @@ SaveOrLoadResult SaveOrLoad(const char *filename, SaveLoadOperation fop, Detaile
 	}
 }
 
+/**
+ * Load check a savegame from memory.
+ * @param buffer The savegame.
+ * @return Whether loading succeeded.
+ */
+static bool LoadCheckFromMemory(const std::vector<byte> &buffer)
+{
+	try {
+		_sl.action = SLA_LOAD_CHECK;
+		return DoLoad(new MemoryLoadFilter(buffer.data(), buffer.size()), true) == SL_OK && !_load_check_data.HasErrors();
+	} catch (...) {
+		ClearSaveLoadState();
+		return false;
+	}
+}
+
+/**
+ * Benchmark saving the current game to memory and loading it back with
+ * every available savegame format, both with and without parallel compression.
+ * The time to load includes decompressing all chunks, but not actually loading them.
+ * @param b Buffer to write the results to.
+ * @param last Last valid position in the buffer.
+ * @param iterations Number of times to save and load the game with each format.
+ */
+void DumpSavegameBenchmark(char *b, const char *last, uint iterations)
+{
+	WaitTillSaved();
+
+	char saved_format[lengthof(_savegame_format)];
+	strecpy(saved_format, _savegame_format, lastof(saved_format));
+	const bool saved_parallel = _settings_client.gui.parallel_savegame_compression;
+
+	b += seprintf(b, last, "Savegame benchmark, %u iteration(s), %u worker thread(s)\n", iterations, _saveload_worker_pool.GetWorkerCount());
+	for (const SaveLoadFormat *slf = &_saveload_formats[0]; slf != endof(_saveload_formats); slf++) {
+		if (slf->init_write == nullptr) continue;
+
+		for (int parallel = 0; parallel < 2; parallel++) {
+			if (parallel && slf->tag == TO_BE32X('OTTN')) continue;
+
+			seprintf(_savegame_format, lastof(_savegame_format), "%s:%u", slf->name, slf->default_compression);
+			_settings_client.gui.parallel_savegame_compression = (parallel != 0);
+
+			std::vector<byte> buffer;
+			std::chrono::steady_clock::duration save_time(0);
+			std::chrono::steady_clock::duration load_time(0);
+			bool ok = true;
+			for (uint i = 0; i < iterations && ok; i++) {
+				buffer.clear();
+				auto start = std::chrono::steady_clock::now();
+				ok = SaveWithFilter(new MemorySaveFilter(buffer), false) == SL_OK;
+				auto saved = std::chrono::steady_clock::now();
+				ok = ok && LoadCheckFromMemory(buffer);
+				auto loaded = std::chrono::steady_clock::now();
+				_load_check_data.Clear();
+				save_time += saved - start;
+				load_time += loaded - saved;
+			}
+
+			b += seprintf(b, last, "  %-5s %-8s level %u: ", slf->name, parallel ? "parallel" : "serial", slf->default_compression);
+			if (ok) {
+				b += seprintf(b, last, "size: %6u KiB, save: %5u ms, load: %5u ms\n", (uint)(buffer.size() / 1024),
+						(uint)(std::chrono::duration_cast<std::chrono::milliseconds>(save_time).count() / iterations),
+						(uint)(std::chrono::duration_cast<std::chrono::milliseconds>(load_time).count() / iterations));
+			} else {
+				b += seprintf(b, last, "failed\n");
+			}
+		}
+	}
+
+	strecpy(_savegame_format, saved_format, lastof(_savegame_format));
+	_settings_client.gui.parallel_savegame_compression = saved_parallel;
+}
+
 /** Do a save when exiting the game (_settings_client.gui.autosave_on_exit) */
 void DoExitSave()
 {
@@ -31,6 +31,7 @@ void RebuildTownCaches(bool cargo_update_required)
 	for (Town *town : Town::Iterate()) {
 		town->cache.population = 0;
 		town->cache.num_houses = 0;
+		town->HousesChanged();
 	}
 
 	for (TileIndex t = 0; t < MapSize(); t++) {
@@ -13,6 +13,7 @@
 #include "date_func.h"
 #include "date_type.h"
 #include "window_func.h"
+#include "departures_func.h"
 #include "vehicle_base.h"
 #include "settings_type.h"
 #include "cmd_helper.h"
@@ -61,6 +62,7 @@ CommandCost CmdScheduledDispatch(TileIndex tile, DoCommandFlag flags, uint32 p1,
 			}
 			SetWindowDirty(WC_VEHICLE_TIMETABLE, v2->index);
 			SetWindowDirty(WC_SCHDISPATCH_SLOTS, v2->index);
+			InvalidateDepartureLists(false);
 		}
 	}
 
@@ -91,6 +93,7 @@ CommandCost CmdScheduledDispatchAdd(TileIndex tile, DoCommandFlag flags, uint32
 	if (flags & DC_EXEC) {
 		v->orders.list->AddScheduledDispatch(p2);
 		SetWindowDirty(WC_SCHDISPATCH_SLOTS, v->index);
+		InvalidateDepartureLists(false);
 	}
 
 	return CommandCost();
@@ -120,6 +123,7 @@ CommandCost CmdScheduledDispatchRemove(TileIndex tile, DoCommandFlag flags, uint
 	if (flags & DC_EXEC) {
 		v->orders.list->RemoveScheduledDispatch(p2);
 		SetWindowDirty(WC_SCHDISPATCH_SLOTS, v->index);
+		InvalidateDepartureLists(false);
 	}
 
 	return CommandCost();
@@ -151,6 +155,7 @@ CommandCost CmdScheduledDispatchSetDuration(TileIndex tile, DoCommandFlag flags,
 		v->orders.list->SetScheduledDispatchDuration(p2);
 		v->orders.list->UpdateScheduledDispatch();
 		SetWindowDirty(WC_SCHDISPATCH_SLOTS, v->index);
+		InvalidateDepartureLists(false);
 	}
 
 	return CommandCost();
@@ -194,6 +199,7 @@ CommandCost CmdScheduledDispatchSetStartDate(TileIndex tile, DoCommandFlag flags
 		v->orders.list->SetScheduledDispatchStartDate(date, full_date_fract);
 		v->orders.list->UpdateScheduledDispatch();
 		SetWindowDirty(WC_SCHDISPATCH_SLOTS, v->index);
+		InvalidateDepartureLists(false);
 	}
 
 	return CommandCost();
@@ -224,6 +230,7 @@ CommandCost CmdScheduledDispatchSetDelay(TileIndex tile, DoCommandFlag flags, ui
 	if (flags & DC_EXEC) {
 		v->orders.list->SetScheduledDispatchDelay(p2);
 		SetWindowDirty(WC_SCHDISPATCH_SLOTS, v->index);
+		InvalidateDepartureLists(false);
 	}
 
 	return CommandCost();
@@ -259,6 +266,7 @@ CommandCost CmdScheduledDispatchResetLastDispatch(TileIndex tile, DoCommandFlag
 	if (flags & DC_EXEC) {
 		v->orders.list->SetScheduledDispatchLastDispatch(0);
 		SetWindowDirty(WC_SCHDISPATCH_SLOTS, v->index);
+		InvalidateDepartureLists(false);
 	}
 
 	return CommandCost();
@@ -22,7 +22,7 @@
 
 #ifdef USE_SCOPE_INFO
 
-std::vector<std::function<int(char *, const char *)>> _scope_stack;
+thread_local std::vector<std::function<int(char *, const char *)>> _scope_stack;
 
 int WriteScopeLog(char *buf, const char *last)
 {
@@ -20,7 +20,8 @@ struct BaseStation;
 
 #ifdef USE_SCOPE_INFO
 
-extern std::vector<std::function<int(char *, const char *)>> _scope_stack;
+/* Each thread has its own scope stack, the crash log shows the one of the crashing thread. */
+extern thread_local std::vector<std::function<int(char *, const char *)>> _scope_stack;
 
 struct scope_info_func_obj {
 	scope_info_func_obj(std::function<int(char *, const char *)> func)
@@ -26,13 +26,22 @@
 #include "landscape.h"
 #include "smallmap_colours.h"
 #include "smallmap_gui.h"
+#include "thread.h"
+#include "worker_thread.h"
 
 #include "table/strings.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
 #include "safeguards.h"
 
 static const char * const SCREENSHOT_NAME = "screenshot"; ///< Default filename of a saved screenshot.
 static const char * const HEIGHTMAP_NAME  = "heightmap";  ///< Default filename of a saved heightmap.
+static const uint WORLD_TILES_TILE_SIZE  = 256;            ///< Width and height in pixels of an image tile of a tiled world screenshot.
+static const uint WORLD_TILES_BLOCK_SIZE = 16;             ///< Maximum number of image tiles of a tiled world screenshot rendered at once.
 
 char _screenshot_format_name[8];      ///< Extension of the current screenshot format (corresponds with #_cur_screenshot_format).
 uint _num_screenshot_formats;         ///< Number of available screenshot formats.
@@ -76,6 +85,7 @@ typedef bool ScreenshotHandlerProc(const char *name, ScreenshotCallback *callb,
 struct ScreenshotFormat {
 	const char *extension;       ///< File extension.
 	ScreenshotHandlerProc *proc; ///< Function for writing the screenshot.
+	bool top_down;               ///< Whether \a proc requests the lines from the top of the image to the bottom.
 };
 
 #define MKCOLOUR(x) TO_LE32X(x)
@@ -581,10 +591,10 @@ static bool MakePCXImage(const char *name, ScreenshotCallback *callb, void *user
 /** Available screenshot formats. */
 static const ScreenshotFormat _screenshot_formats[] = {
 #if defined(WITH_PNG)
-	{"png", &MakePNGImage},
+	{"png", &MakePNGImage, true},
 #endif
-	{"bmp", &MakeBMPImage},
-	{"pcx", &MakePCXImage},
+	{"bmp", &MakeBMPImage, false},
+	{"pcx", &MakePCXImage, true},
 };
 
 /** Get filename extension of current screenshot file format. */
@@ -619,18 +629,19 @@ static void CurrentScreenCallback(void *userdata, void *buf, uint y, uint pitch,
 }
 
 /**
- * generate a large piece of the world
- * @param userdata Viewport area to draw
- * @param buf Videobuffer with same bitdepth as current blitter
- * @param y First line to render
+ * Render a part of a large screenshot of the world.
+ * @param vp Viewport area to draw
+ * @param buf Videobuffer with same bitdepth as current blitter, starting at (\a left, \a top)
+ * @param left First column to render
+ * @param top First line to render
+ * @param width Number of columns to render
+ * @param height Number of lines to render
  * @param pitch Pitch of the videobuffer
- * @param n Number of lines to render
  */
-static void LargeWorldCallback(void *userdata, void *buf, uint y, uint pitch, uint n)
+static void LargeWorldRender(const ViewPort *vp, void *buf, int left, int top, int width, int height, uint pitch)
 {
-	ViewPort *vp = (ViewPort *)userdata;
 	DrawPixelInfo dpi, *old_dpi;
-	int wx, left;
+	int wx, x;
 
 	/* We are no longer rendering to the screen */
 	DrawPixelInfo old_screen = _screen;
@@ -638,7 +649,7 @@ static void LargeWorldCallback(void *userdata, void *buf, uint y, uint pitch, ui
 
 	_screen.dst_ptr = buf;
 	_screen.width = pitch;
-	_screen.height = n;
+	_screen.height = height;
 	_screen.pitch = pitch;
 	_screen_disable_anim = true;
 
@@ -646,24 +657,24 @@ static void LargeWorldCallback(void *userdata, void *buf, uint y, uint pitch, ui
 	_cur_dpi = &dpi;
 
 	dpi.dst_ptr = buf;
-	dpi.height = n;
-	dpi.width = vp->width;
+	dpi.height = height;
+	dpi.width = width;
 	dpi.pitch = pitch;
 	dpi.zoom = ZOOM_LVL_WORLD_SCREENSHOT;
-	dpi.left = 0;
-	dpi.top = y;
+	dpi.left = left;
+	dpi.top = top;
 
 	/* Render viewport in blocks of 1600 pixels width */
-	left = 0;
-	while (vp->width - left != 0) {
-		wx = min(vp->width - left, 1600);
-		left += wx;
+	x = left;
+	while (left + width - x != 0) {
+		wx = min(left + width - x, 1600);
+		x += wx;
 
 		ViewportDoDraw(vp,
-			ScaleByZoom(left - wx - vp->left, vp->zoom) + vp->virtual_left,
-			ScaleByZoom(y - vp->top, vp->zoom) + vp->virtual_top,
-			ScaleByZoom(left - vp->left, vp->zoom) + vp->virtual_left,
-			ScaleByZoom((y + n) - vp->top, vp->zoom) + vp->virtual_top
+			ScaleByZoom(x - wx - vp->left, vp->zoom) + vp->virtual_left,
+			ScaleByZoom(top - vp->top, vp->zoom) + vp->virtual_top,
+			ScaleByZoom(x - vp->left, vp->zoom) + vp->virtual_left,
+			ScaleByZoom((top + height) - vp->top, vp->zoom) + vp->virtual_top
 		);
 	}
 
@@ -674,6 +685,140 @@ static void LargeWorldCallback(void *userdata, void *buf, uint y, uint pitch, ui
 	_screen_disable_anim = old_disable_anim;
 }
 
+/**
+ * generate a large piece of the world
+ * @param userdata Viewport area to draw
+ * @param buf Videobuffer with same bitdepth as current blitter
+ * @param y First line to render
+ * @param pitch Pitch of the videobuffer
+ * @param n Number of lines to render
+ */
+static void LargeWorldCallback(void *userdata, void *buf, uint y, uint pitch, uint n)
+{
+	const ViewPort *vp = (const ViewPort *)userdata;
+	LargeWorldRender(vp, buf, 0, y, vp->width, n, pitch);
+}
+
+/**
+ * State of writing a large screenshot of the world, while rendering it.
+ * The main thread renders bands of lines ahead, while the image writer encodes and compresses
+ * the earlier bands on its own thread. At most #MAX_BANDS bands are kept in memory.
+ */
+struct LargeWorldPipeline {
+	static const uint MAX_BANDS = 4;           ///< Number of bands which can be rendered ahead of the writer.
+	static const uint BAND_PIXELS = 1 << 18;   ///< Preferred number of pixels of a band.
+
+	const ScreenshotFormat *sf;                ///< Format of the image.
+	const char *name;                          ///< Filename of the image.
+	const ViewPort *vp;                        ///< Viewport area to draw.
+	uint band_height;                          ///< Number of lines of a band.
+	size_t line_size;                          ///< Size of a line in bytes.
+	std::vector<uint8> buffer;                 ///< Bands in memory, band \c i is stored in slot \c i % #MAX_BANDS.
+
+	std::mutex lock;                           ///< Lock for the below.
+	std::condition_variable cv;                ///< Signalled when a band has been rendered, lines have been written or the writer has finished.
+	uint rendered_bands = 0;                   ///< Number of bands rendered.
+	uint written_lines = 0;                    ///< Number of lines taken by the writer.
+	bool writer_done = false;                  ///< Whether the writer has finished.
+	bool result = false;                       ///< Whether the writer succeeded.
+};
+
+/**
+ * Image writer callback which takes the lines from the bands rendered by the main thread.
+ * @param userdata The #LargeWorldPipeline.
+ * @param buf Destination buffer.
+ * @param y First line to write.
+ * @param pitch Pitch of the buffer, the width of the image.
+ * @param n Number of lines to write.
+ * @see ScreenshotCallback
+ */
+static void LargeWorldPipelineCallback(void *userdata, void *buf, uint y, uint pitch, uint n)
+{
+	LargeWorldPipeline *p = (LargeWorldPipeline *)userdata;
+	uint8 *dst = (uint8 *)buf;
+
+	for (uint line = y; line != y + n;) {
+		const uint band = line / p->band_height;
+		{
+			std::unique_lock<std::mutex> lk(p->lock);
+			p->cv.wait(lk, [&]() { return p->rendered_bands > band; });
+		}
+
+		/* The band can not be overwritten before #written_lines passes it. */
+		const uint lines = min(y + n, (band + 1) * p->band_height) - line;
+		const size_t offset = ((band % LargeWorldPipeline::MAX_BANDS) * p->band_height + line - band * p->band_height) * p->line_size;
+		memcpy(dst, p->buffer.data() + offset, lines * p->line_size);
+		dst += lines * p->line_size;
+		line += lines;
+	}
+
+	std::lock_guard<std::mutex> lk(p->lock);
+	p->written_lines = y + n;
+	p->cv.notify_all();
+}
+
+/**
+ * Thread running the image writer of a #LargeWorldPipeline.
+ * @param p The pipeline.
+ */
+static void LargeWorldPipelineWriter(LargeWorldPipeline *p)
+{
+	bool result = p->sf->proc(p->name, LargeWorldPipelineCallback, p, p->vp->width, p->vp->height,
+			BlitterFactory::GetCurrentBlitter()->GetScreenDepth(), _cur_palette.palette);
+
+	std::lock_guard<std::mutex> lk(p->lock);
+	p->result = result;
+	p->writer_done = true;
+	p->cv.notify_all();
+}
+
+/**
+ * Write a large screenshot of the world, encoding the image on a separate thread while it is being rendered.
+ * @param sf Format of the image, which must request the lines top down.
+ * @param name Filename of the image.
+ * @param vp Viewport area to draw.
+ * @param[out] result Whether the screenshot was written successfully.
+ * @return Whether the writer thread could be started, otherwise nothing has been done.
+ */
+static bool MakeLargeWorldImagePipelined(const ScreenshotFormat *sf, const char *name, const ViewPort *vp, bool *result)
+{
+	assert(sf->top_down);
+
+	LargeWorldPipeline p;
+	p.sf = sf;
+	p.name = name;
+	p.vp = vp;
+	p.band_height = Clamp<uint>(LargeWorldPipeline::BAND_PIXELS / max(vp->width, 1), 16, 128);
+	p.line_size = (size_t)vp->width * BlitterFactory::GetCurrentBlitter()->GetScreenDepth() / 8;
+	p.buffer.resize(p.line_size * p.band_height * LargeWorldPipeline::MAX_BANDS);
+
+	std::thread writer;
+	if (!StartNewThread(&writer, "ottd:screenshot", &LargeWorldPipelineWriter, &p)) return false;
+
+	const uint bands = CeilDiv(vp->height, p.band_height);
+	for (uint band = 0; band < bands; band++) {
+		{
+			/* Wait until the band which used this slot has been written. */
+			std::unique_lock<std::mutex> lk(p.lock);
+			const uint needed_lines = band >= LargeWorldPipeline::MAX_BANDS ? (band - LargeWorldPipeline::MAX_BANDS + 1) * p.band_height : 0;
+			p.cv.wait(lk, [&]() { return p.writer_done || p.written_lines >= needed_lines; });
+			if (p.writer_done) break;
+		}
+
+		const uint y = band * p.band_height;
+		uint8 *buf = p.buffer.data() + (band % LargeWorldPipeline::MAX_BANDS) * p.band_height * p.line_size;
+		LargeWorldRender(vp, buf, 0, y, vp->width, min<uint>(p.band_height, vp->height - y), vp->width);
+
+		std::lock_guard<std::mutex> lk(p.lock);
+		p.rendered_bands++;
+		p.cv.notify_all();
+	}
+
+	writer.join();
+	*result = p.result;
+	return true;
+}
+
 /**
  * Construct a pathname for a screenshot file.
  * @param default_fn Default filename.
@@ -802,10 +947,90 @@ static bool MakeLargeWorldScreenshot(ScreenshotType t)
 	SetupScreenshotViewport(t, &vp);
 
 	const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
-	return sf->proc(MakeScreenshotName(SCREENSHOT_NAME, sf->extension), LargeWorldCallback, &vp, vp.width, vp.height,
+	const char *name = MakeScreenshotName(SCREENSHOT_NAME, sf->extension);
+
+	bool result;
+	if (sf->top_down && MakeLargeWorldImagePipelined(sf, name, &vp, &result)) return result;
+
+	return sf->proc(name, LargeWorldCallback, &vp, vp.width, vp.height,
 			BlitterFactory::GetCurrentBlitter()->GetScreenDepth(), _cur_palette.palette);
 }
 
+/** An image tile of a tiled world screenshot, within the rendered block of tiles. */
+struct ScreenshotImageTile {
+	const uint8 *src; ///< First pixel of the tile.
+	size_t src_pitch; ///< Size of a line of the block in bytes.
+	size_t line_size; ///< Size of a line of the tile in bytes.
+};
+
+/**
+ * Callback copying the lines of an image tile of a tiled world screenshot.
+ * @param userdata The #ScreenshotImageTile.
+ * @param buf Destination buffer.
+ * @param y First line to write.
+ * @param pitch Pitch of the buffer, the width of the tile.
+ * @param n Number of lines to write.
+ * @see ScreenshotCallback
+ */
+static void ScreenshotImageTileCallback(void *userdata, void *buf, uint y, uint pitch, uint n)
+{
+	const ScreenshotImageTile *tile = (const ScreenshotImageTile *)userdata;
+	uint8 *dst = (uint8 *)buf;
+	for (uint i = 0; i < n; i++) {
+		memcpy(dst, tile->src + (y + i) * tile->src_pitch, tile->line_size);
+		dst += tile->line_size;
+	}
+}
+
+/**
+ * Make a screenshot of the whole world as a directory of image tiles, named \c column_row,
+ * as used by web map viewers. Tiles at the right and bottom edges are padded.
+ * The tiles of a rendered block are encoded in parallel on the worker threads.
+ * @return true on success
+ */
+static bool MakeTiledWorldScreenshot()
+{
+	ViewPort vp;
+	SetupScreenshotViewport(SC_WORLD, &vp);
+
+	const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
+	char dir[MAX_PATH];
+	strecpy(dir, MakeScreenshotName(SCREENSHOT_NAME, "tiles"), lastof(dir));
+	if (StrEmpty(dir)) return false;
+	FioCreateDirectory(dir);
+	strecat(dir, PATHSEP, lastof(dir));
+
+	const int depth = BlitterFactory::GetCurrentBlitter()->GetScreenDepth();
+	const uint bytes_per_pixel = depth / 8;
+	const uint columns = CeilDiv(vp.width, WORLD_TILES_TILE_SIZE);
+	const uint rows = CeilDiv(vp.height, WORLD_TILES_TILE_SIZE);
+	std::vector<uint8> block((size_t)WORLD_TILES_TILE_SIZE * WORLD_TILES_TILE_SIZE * WORLD_TILES_BLOCK_SIZE * bytes_per_pixel);
+	std::atomic<bool> success(true);
+
+	for (uint row = 0; row < rows && success; row++) {
+		for (uint first_column = 0; first_column < columns && success; first_column += WORLD_TILES_BLOCK_SIZE) {
+			const uint block_columns = min(WORLD_TILES_BLOCK_SIZE, columns - first_column);
+			const uint block_width = block_columns * WORLD_TILES_TILE_SIZE;
+			const int left = first_column * WORLD_TILES_TILE_SIZE;
+			const int top = row * WORLD_TILES_TILE_SIZE;
+
+			std::fill(block.begin(), block.end(), 0);
+			LargeWorldRender(&vp, block.data(), left, top, min<int>(block_width, vp.width - left), min<int>(WORLD_TILES_TILE_SIZE, vp.height - top), block_width);
+
+			_general_worker_pool.ParallelFor(block_columns, 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					char name[MAX_PATH];
+					seprintf(name, lastof(name), "%s%u_%u.%s", dir, first_column + (uint)i, row, sf->extension);
+					ScreenshotImageTile tile = { block.data() + i * WORLD_TILES_TILE_SIZE * bytes_per_pixel, (size_t)block_width * bytes_per_pixel, (size_t)WORLD_TILES_TILE_SIZE * bytes_per_pixel };
+					if (!sf->proc(name, ScreenshotImageTileCallback, &tile, WORLD_TILES_TILE_SIZE, WORLD_TILES_TILE_SIZE, depth, _cur_palette.palette)) success = false;
+				}
+			});
+		}
+	}
+
+	return success;
+}
+
 /**
  * Callback for generating a heightmap. Supports 8bpp grayscale only.
  * @param userdata Pointer to user data.
@@ -898,6 +1123,10 @@ bool MakeScreenshot(ScreenshotType t, const char *name)
 			ret = MakeLargeWorldScreenshot(t);
 			break;
 
+		case SC_WORLD_TILES:
+			ret = MakeTiledWorldScreenshot();
+			break;
+
 		case SC_HEIGHTMAP: {
 			const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
 			ret = MakeHeightmapScreenshot(MakeScreenshotName(HEIGHTMAP_NAME, sf->extension));
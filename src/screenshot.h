@@ -23,6 +23,7 @@ enum ScreenshotType {
 	SC_WORLD,       ///< World screenshot.
 	SC_HEIGHTMAP,   ///< Heightmap of the world.
 	SC_MINIMAP,     ///< Minimap screenshot.
+	SC_WORLD_TILES, ///< World screenshot as a directory of image tiles.
 };
 
 class SmallMapWindow;
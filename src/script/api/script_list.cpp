@@ -10,418 +10,338 @@
 #include "../../stdafx.h"
 #include "script_list.hpp"
 #include "script_controller.hpp"
+#include "script_tile.hpp"
+#include "script_vehicle.hpp"
 #include "../../debug.h"
 #include "../../script/squirrel.hpp"
+#include <algorithm>
 
 #include "../../safeguards.h"
 
-/**
- * Base class for any ScriptList sorter.
- */
-class ScriptListSorter {
-protected:
-	ScriptList *list;       ///< The list that's being sorted.
-	bool has_no_more_items; ///< Whether we have more items to iterate over.
-	int64 item_next;        ///< The next item we will show.
-
-public:
-	/**
-	 * Virtual dtor, needed to mute warnings.
-	 */
-	virtual ~ScriptListSorter() { }
+/** Number of pending or removed entries below which they are never merged into the sorted storage. */
+static const size_t SCRIPT_LIST_MIN_PENDING = 64;
 
-	/**
-	 * Get the first item of the sorter.
-	 */
-	virtual int64 Begin() = 0;
-
-	/**
-	 * Stop iterating a sorter.
-	 */
-	virtual void End() = 0;
-
-	/**
-	 * Get the next item of the sorter.
-	 */
-	virtual int64 Next() = 0;
-
-	/**
-	 * See if the sorter has reached the end.
-	 */
-	bool IsEnd()
-	{
-		return this->list->buckets.empty() || this->has_no_more_items;
-	}
-
-	/**
-	 * Callback from the list if an item gets removed.
-	 */
-	virtual void Remove(int item) = 0;
+/** Ordering of list entries by their item, also against a bare item. */
+struct ScriptListItemLess {
+	template <typename T> bool operator()(const T &a, const T &b) const { return a.item < b.item; }
+	template <typename T> bool operator()(const T &a, int64 b) const { return a.item < b; }
+	template <typename T> bool operator()(int64 a, const T &b) const { return a < b.item; }
+};
 
-	/**
-	 * Attach the sorter to a new list. This assumes the content of the old list has been moved to
-	 * the new list, too, so that we don't have to invalidate any iterators. Note that std::swap
-	 * doesn't invalidate iterators on lists and maps, so that should be safe.
-	 * @param target New list to attach to.
-	 */
-	virtual void Retarget(ScriptList *new_list)
-	{
-		this->list = new_list;
-	}
+/** Ordering of list entries by their value, and by their item for equal values. */
+struct ScriptListValueLess {
+	template <typename T> bool operator()(const T &a, const T &b) const { return a.value < b.value || (a.value == b.value && a.item < b.item); }
 };
 
 /**
- * Sort by value, ascending.
+ * Merge the sorted vector of pending elements into the main sorted vector.
+ * @param main The main sorted vector.
+ * @param pending The pending elements, cleared afterwards.
+ * @param less Ordering of the vectors.
  */
-class ScriptListSorterValueAscending : public ScriptListSorter {
-private:
-	ScriptList::ScriptListBucket::iterator bucket_iter;    ///< The iterator over the list to find the buckets.
-	ScriptList::ScriptItemList *bucket_list;               ///< The current bucket list we're iterator over.
-	ScriptList::ScriptItemList::iterator bucket_list_iter; ///< The iterator over the bucket list.
-
-public:
-	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
-	 */
-	ScriptListSorterValueAscending(ScriptList *list)
-	{
-		this->list = list;
-		this->End();
-	}
-
-	int64 Begin()
-	{
-		if (this->list->buckets.empty()) return 0;
-		this->has_no_more_items = false;
-
-		this->bucket_iter = this->list->buckets.begin();
-		this->bucket_list = &(*this->bucket_iter).second;
-		this->bucket_list_iter = this->bucket_list->begin();
-		this->item_next = *this->bucket_list_iter;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
+template <typename T, typename Tless>
+static void MergePending(std::vector<T> &main, std::vector<T> &pending, Tless less)
+{
+	if (pending.empty()) return;
+	size_t middle = main.size();
+	main.insert(main.end(), pending.begin(), pending.end());
+	std::inplace_merge(main.begin(), main.begin() + middle, main.end(), less);
+	pending.clear();
+}
 
-	void End()
-	{
-		this->bucket_list = nullptr;
-		this->has_no_more_items = true;
-		this->item_next = 0;
-	}
+/**
+ * Insert an element at its place in the sorted vector of pending elements.
+ * Once there are more pending elements than the square root of the size of the main vector,
+ * they are merged into it. This keeps inserting at arbitrary places cheap without node based containers.
+ * @param main The main sorted vector.
+ * @param pending The pending elements.
+ * @param elem The element to insert.
+ * @param less Ordering of the vectors.
+ */
+template <typename T, typename Tless>
+static void InsertPending(std::vector<T> &main, std::vector<T> &pending, const T &elem, Tless less)
+{
+	pending.insert(std::upper_bound(pending.begin(), pending.end(), elem, less), elem);
+	if (pending.size() >= SCRIPT_LIST_MIN_PENDING && pending.size() * pending.size() >= main.size()) MergePending(main, pending, less);
+}
 
-	/**
-	 * Find the next item, and store that information.
-	 */
-	void FindNext()
-	{
-		if (this->bucket_list == nullptr) {
-			this->has_no_more_items = true;
-			return;
+/**
+ * Find the first valid element of a sorted vector, in the given direction.
+ * @param v The sorted vector.
+ * @param key Only look at elements after this key, or at all elements when nullptr.
+ * @param ascending Whether to walk towards the end of the vector.
+ * @param less Ordering of the vector.
+ * @param valid Whether an element is valid.
+ * @return The element, or nullptr when there is none.
+ */
+template <typename T, typename Tkey, typename Tless, typename Tvalid>
+static const T *FindInSorted(const std::vector<T> &v, const Tkey *key, bool ascending, Tless less, Tvalid valid)
+{
+	if (ascending) {
+		for (auto it = (key == nullptr) ? v.begin() : std::upper_bound(v.begin(), v.end(), *key, less); it != v.end(); ++it) {
+			if (valid(*it)) return &*it;
 		}
-
-		this->bucket_list_iter++;
-		if (this->bucket_list_iter == this->bucket_list->end()) {
-			this->bucket_iter++;
-			if (this->bucket_iter == this->list->buckets.end()) {
-				this->bucket_list = nullptr;
-				return;
-			}
-			this->bucket_list = &(*this->bucket_iter).second;
-			this->bucket_list_iter = this->bucket_list->begin();
+	} else {
+		for (auto it = (key == nullptr) ? v.end() : std::lower_bound(v.begin(), v.end(), *key, less); it != v.begin();) {
+			--it;
+			if (valid(*it)) return &*it;
 		}
-		this->item_next = *this->bucket_list_iter;
-	}
-
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
 	}
+	return nullptr;
+}
 
-	void Remove(int item)
-	{
-		if (this->IsEnd()) return;
+ScriptList::ScriptList()
+{
+	this->count           = 0;
+	this->removed_count   = 0;
+	this->values_outdated = 0;
+	this->values_valid    = false;
 
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
-	}
-};
+	/* Default sorter */
+	this->sorter_type    = SORT_BY_VALUE;
+	this->sort_ascending = false;
+	this->initialized    = false;
+	this->is_end         = true;
+	this->has_next       = false;
+	this->next_item      = 0;
+	this->next_value     = 0;
+	this->modifications  = 0;
+}
 
 /**
- * Sort by value, descending.
+ * Find the entry of an item.
+ * @param item The item to look for.
+ * @return The entry, which might be a removed one, or nullptr when there is no entry.
  */
-class ScriptListSorterValueDescending : public ScriptListSorter {
-private:
-	/* Note: We cannot use reverse_iterator.
-	 *       The iterators must only be invalidated when the element they are pointing to is removed.
-	 *       This only holds for forward iterators. */
-	ScriptList::ScriptListBucket::iterator bucket_iter;    ///< The iterator over the list to find the buckets.
-	ScriptList::ScriptItemList *bucket_list;               ///< The current bucket list we're iterator over.
-	ScriptList::ScriptItemList::iterator bucket_list_iter; ///< The iterator over the bucket list.
-
-public:
-	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
-	 */
-	ScriptListSorterValueDescending(ScriptList *list)
-	{
-		this->list = list;
-		this->End();
+ScriptList::Entry *ScriptList::FindEntry(int64 item)
+{
+	for (std::vector<Entry> *v : { &this->items, &this->items_pending }) {
+		std::vector<Entry>::iterator it = std::lower_bound(v->begin(), v->end(), item, ScriptListItemLess());
+		if (it != v->end() && it->item == item) return &*it;
 	}
+	return nullptr;
+}
 
-	int64 Begin()
-	{
-		if (this->list->buckets.empty()) return 0;
-		this->has_no_more_items = false;
+/**
+ * Merge the pending items and drop the removed ones.
+ * Entries may move, but as iterations keep track of their position by item this is always allowed.
+ */
+void ScriptList::CompactItems()
+{
+	MergePending(this->items, this->items_pending, ScriptListItemLess());
+	if (this->removed_count == 0) return;
 
-		/* Go to the end of the bucket-list */
-		this->bucket_iter = this->list->buckets.end();
-		--this->bucket_iter;
-		this->bucket_list = &(*this->bucket_iter).second;
+	this->items.erase(std::remove_if(this->items.begin(), this->items.end(), [](const Entry &entry) { return entry.removed; }), this->items.end());
+	this->removed_count = 0;
+}
 
-		/* Go to the end of the items in the bucket */
-		this->bucket_list_iter = this->bucket_list->end();
-		--this->bucket_list_iter;
-		this->item_next = *this->bucket_list_iter;
+/**
+ * Check whether an iteration by value is going on, which needs the items sorted by value to find its next item.
+ * @return True iff the next item of an iteration by value has to be found.
+ */
+bool ScriptList::IsIteratingByValue() const
+{
+	return this->sorter_type == SORT_BY_VALUE && !this->is_end && this->has_next;
+}
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
+/**
+ * Check whether a key of the items sorted by value still matches its item.
+ * @param key The key.
+ * @return True iff the item is in the list, with that value.
+ */
+bool ScriptList::IsValidKey(const ValueKey &key)
+{
+	if (this->values_outdated == 0) return true;
 
-	void End()
-	{
-		this->bucket_list = nullptr;
-		this->has_no_more_items = true;
-		this->item_next = 0;
-	}
+	const Entry *entry = this->FindEntry(key.second);
+	return entry != nullptr && !entry->removed && entry->value == key.first;
+}
 
-	/**
-	 * Find the next item, and store that information.
-	 */
-	void FindNext()
-	{
-		if (this->bucket_list == nullptr) {
-			this->has_no_more_items = true;
-			return;
-		}
+/**
+ * Sort the items by value, when that has not been done yet.
+ */
+void ScriptList::BuildValues()
+{
+	if (this->values_valid) return;
 
-		if (this->bucket_list_iter == this->bucket_list->begin()) {
-			if (this->bucket_iter == this->list->buckets.begin()) {
-				this->bucket_list = nullptr;
-				return;
-			}
-			this->bucket_iter--;
-			this->bucket_list = &(*this->bucket_iter).second;
-			/* Go to the end of the items in the bucket */
-			this->bucket_list_iter = this->bucket_list->end();
-			--this->bucket_list_iter;
-		} else {
-			this->bucket_list_iter--;
+	this->values.clear();
+	this->values_pending.clear();
+	this->values.reserve(this->count);
+	for (const std::vector<Entry> *v : { &this->items, &this->items_pending }) {
+		for (const Entry &entry : *v) {
+			if (!entry.removed) this->values.emplace_back(entry.value, entry.item);
 		}
-		this->item_next = *this->bucket_list_iter;
 	}
+	std::sort(this->values.begin(), this->values.end());
+	this->values_outdated = 0;
+	this->values_valid = true;
+}
 
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+/**
+ * Update the items sorted by value after an item has been added or got a new value.
+ * Outside of iterations by value they are just sorted again when needed.
+ * @param item The item.
+ * @param value The value of the item.
+ */
+void ScriptList::AddValueKey(int64 item, int64 value)
+{
+	if (!this->values_valid) return;
+	if (!this->IsIteratingByValue()) {
+		this->values_valid = false;
+		return;
 	}
 
-	void Remove(int item)
-	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
+	ValueKey key(value, item);
+	if (std::binary_search(this->values.begin(), this->values.end(), key) || std::binary_search(this->values_pending.begin(), this->values_pending.end(), key)) {
+		/* The outdated key of an earlier value of the item is valid again. */
+		this->values_outdated--;
+		return;
 	}
-};
+	InsertPending(this->values, this->values_pending, key, std::less<ValueKey>());
+}
 
 /**
- * Sort by item, ascending.
+ * Update the items sorted by value before an item is removed or gets a new value.
+ * Its key stays behind as outdated one, until there are too many of those.
+ * @param item The item.
+ * @param value The current value of the item.
  */
-class ScriptListSorterItemAscending : public ScriptListSorter {
-private:
-	ScriptList::ScriptListMap::iterator item_iter; ///< The iterator over the items in the map.
-
-public:
-	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
-	 */
-	ScriptListSorterItemAscending(ScriptList *list)
-	{
-		this->list = list;
-		this->End();
-	}
-
-	int64 Begin()
-	{
-		if (this->list->items.empty()) return 0;
-		this->has_no_more_items = false;
-
-		this->item_iter = this->list->items.begin();
-		this->item_next = (*this->item_iter).first;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+void ScriptList::RemoveValueKey(int64 item, int64 value)
+{
+	if (!this->values_valid) return;
+	if (!this->IsIteratingByValue()) {
+		this->values_valid = false;
+		return;
 	}
 
-	void End()
-	{
-		this->has_no_more_items = true;
-	}
+	this->values_outdated++;
+	if (this->values_outdated >= (int32)SCRIPT_LIST_MIN_PENDING && this->values_outdated > this->count) this->values_valid = false;
+}
 
-	/**
-	 * Find the next item, and store that information.
-	 */
-	void FindNext()
-	{
-		if (this->item_iter == this->list->items.end()) {
-			this->has_no_more_items = true;
-			return;
-		}
-		this->item_iter++;
-		if (this->item_iter != this->list->items.end()) item_next = (*this->item_iter).first;
-	}
+/**
+ * Find an item in the order of the current sorter.
+ * @param first Whether to find the first item, instead of the item after the given one.
+ * @param[in,out] item The item to find the item after; the found item. Unchanged when nothing is found.
+ * @param[in,out] value The value of the item to find the item after; the value of the found item. Unchanged when nothing is found.
+ * @return True iff an item has been found.
+ */
+bool ScriptList::FindNextItem(bool first, int64 *item, int64 *value)
+{
+	const bool ascending = this->sort_ascending;
 
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
+	if (this->sorter_type == SORT_BY_ITEM) {
+		auto valid = [](const Entry &entry) { return !entry.removed; };
+		const int64 key = *item;
+		const Entry *found = FindInSorted(this->items, first ? nullptr : &key, ascending, ScriptListItemLess(), valid);
+		const Entry *found_pending = FindInSorted(this->items_pending, first ? nullptr : &key, ascending, ScriptListItemLess(), valid);
+		if (found == nullptr || (found_pending != nullptr && (found_pending->item < found->item) == ascending)) found = found_pending;
+		if (found == nullptr) return false;
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+		*item = found->item;
+		*value = found->value;
+		return true;
 	}
 
-	void Remove(int item)
-	{
-		if (this->IsEnd()) return;
+	this->BuildValues();
+	auto valid = [this](const ValueKey &key) { return this->IsValidKey(key); };
+	const ValueKey key(*value, *item);
+	const ValueKey *found = FindInSorted(this->values, first ? nullptr : &key, ascending, std::less<ValueKey>(), valid);
+	const ValueKey *found_pending = FindInSorted(this->values_pending, first ? nullptr : &key, ascending, std::less<ValueKey>(), valid);
+	if (found == nullptr || (found_pending != nullptr && (*found_pending < *found) == ascending)) found = found_pending;
+	if (found == nullptr) return false;
 
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
-	}
-};
+	*item = found->second;
+	*value = found->first;
+	return true;
+}
 
 /**
- * Sort by item, descending.
+ * Update the iteration before an item is removed or gets a new value.
+ * When it is the next item of the iteration, the iteration skips it.
+ * @param item The item.
  */
-class ScriptListSorterItemDescending : public ScriptListSorter {
-private:
-	/* Note: We cannot use reverse_iterator.
-	 *       The iterators must only be invalidated when the element they are pointing to is removed.
-	 *       This only holds for forward iterators. */
-	ScriptList::ScriptListMap::iterator item_iter; ///< The iterator over the items in the map.
-
-public:
-	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
-	 */
-	ScriptListSorterItemDescending(ScriptList *list)
-	{
-		this->list = list;
-		this->End();
-	}
-
-	int64 Begin()
-	{
-		if (this->list->items.empty()) return 0;
-		this->has_no_more_items = false;
-
-		this->item_iter = this->list->items.end();
-		--this->item_iter;
-		this->item_next = (*this->item_iter).first;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
+void ScriptList::ChangeItem(int64 item)
+{
+	if (this->is_end || item != this->next_item) return;
 
-	void End()
-	{
-		this->has_no_more_items = true;
+	if (!this->has_next) {
+		/* The current item was the last one. */
+		this->is_end = true;
+		return;
 	}
+	this->has_next = this->FindNextItem(false, &this->next_item, &this->next_value);
+}
 
-	/**
-	 * Find the next item, and store that information.
-	 */
-	void FindNext()
-	{
-		if (this->item_iter == this->list->items.end()) {
-			this->has_no_more_items = true;
-			return;
-		}
-		if (this->item_iter == this->list->items.begin()) {
-			/* Use 'end' as marker for 'beyond begin' */
-			this->item_iter = this->list->items.end();
-		} else {
-			this->item_iter--;
+/**
+ * Remove all items matching a predicate in one pass.
+ * The iteration ends up at the same item as when removing them one by one in the given order.
+ * @param predicate Whether an entry has to be removed.
+ * @param removed_before Whether an entry would be removed before another one, when removing them one by one.
+ */
+template <typename Tpredicate, typename Torder>
+void ScriptList::RemoveEntries(Tpredicate predicate, Torder removed_before)
+{
+	const bool iterating = !this->is_end;
+	std::vector<Entry> removed_entries;
+	bool next_removed = false;
+	int32 removed = 0;
+	for (std::vector<Entry> *v : { &this->items, &this->items_pending }) {
+		for (Entry &entry : *v) {
+			if (entry.removed || !predicate(entry)) continue;
+			if (iterating) removed_entries.push_back(entry);
+			entry.removed = true;
+			removed++;
+			if (entry.item == this->next_item) next_removed = true;
 		}
-		if (this->item_iter != this->list->items.end()) item_next = (*this->item_iter).first;
 	}
+	if (removed == 0) return;
 
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
+	this->count -= removed;
+	this->removed_count += removed;
+	this->values_valid = false;
+	this->CompactItems();
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+	if (!iterating || !next_removed) return;
+	if (!this->has_next) {
+		/* The current item was the last one. */
+		this->is_end = true;
+		return;
 	}
 
-	void Remove(int item)
-	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
+	/* Removing the next item moves the iteration to its successor, which can be an item that gets removed later on.
+	 * Follow that chain through the removed items, in the order of the sorter. */
+	const bool by_value = this->sorter_type == SORT_BY_VALUE;
+	const bool ascending = this->sort_ascending;
+	auto sorted_before = [by_value, ascending](const Entry &a, const Entry &b) {
+		if (by_value && a.value != b.value) return (a.value < b.value) == ascending;
+		return a.item != b.item && (a.item < b.item) == ascending;
+	};
+	std::sort(removed_entries.begin(), removed_entries.end(), sorted_before);
+
+	const int64 next_item = this->next_item;
+	auto current = std::find_if(removed_entries.begin(), removed_entries.end(), [next_item](const Entry &entry) { return entry.item == next_item; });
+	for (auto it = current + 1;; ++it) {
+		/* Removed items before the current one in the chain have already been removed when it is. */
+		while (it != removed_entries.end() && !removed_before(*current, *it)) ++it;
+
+		Entry successor = *current;
+		this->has_next = this->FindNextItem(false, &successor.item, &successor.value);
+		if (it != removed_entries.end() && (!this->has_next || sorted_before(*it, successor))) {
+			current = it;
+			continue;
 		}
-	}
-};
-
 
-
-ScriptList::ScriptList()
-{
-	/* Default sorter */
-	this->sorter         = new ScriptListSorterValueDescending(this);
-	this->sorter_type    = SORT_BY_VALUE;
-	this->sort_ascending = false;
-	this->initialized    = false;
-	this->modifications  = 0;
-}
-
-ScriptList::~ScriptList()
-{
-	delete this->sorter;
+		/* Without a successor, the iteration is left at the last removed item, like when removing them one by one. */
+		this->next_item = this->has_next ? successor.item : current->item;
+		this->next_value = this->has_next ? successor.value : current->value;
+		return;
+	}
 }
 
 bool ScriptList::HasItem(int64 item)
 {
-	return this->items.count(item) == 1;
+	const Entry *entry = this->FindEntry(item);
+	return entry != nullptr && !entry->removed;
 }
 
 void ScriptList::Clear()
@@ -429,41 +349,63 @@ void ScriptList::Clear()
 	this->modifications++;
 
 	this->items.clear();
-	this->buckets.clear();
-	this->sorter->End();
+	this->items_pending.clear();
+	this->values.clear();
+	this->values_pending.clear();
+	this->count = 0;
+	this->removed_count = 0;
+	this->values_outdated = 0;
+	this->values_valid = false;
+	this->is_end = true;
+	this->has_next = false;
 }
 
 void ScriptList::AddItem(int64 item, int64 value)
 {
 	this->modifications++;
 
-	if (this->HasItem(item)) return;
-
-	this->items[item] = value;
-	this->buckets[value].insert(item);
+	Entry *entry = this->FindEntry(item);
+	if (entry != nullptr) {
+		if (!entry->removed) return;
+		entry->removed = false;
+		entry->value = value;
+		this->removed_count--;
+	} else if (this->items.empty() || this->items.back().item < item) {
+		this->items.push_back({ item, value, false });
+	} else {
+		InsertPending(this->items, this->items_pending, { item, value, false }, ScriptListItemLess());
+	}
+	this->count++;
+	this->AddValueKey(item, value);
 }
 
 void ScriptList::RemoveItem(int64 item)
 {
 	this->modifications++;
 
-	ScriptListMap::iterator item_iter = this->items.find(item);
-	if (item_iter == this->items.end()) return;
+	Entry *entry = this->FindEntry(item);
+	if (entry == nullptr || entry->removed) return;
 
-	int64 value = item_iter->second;
-
-	this->sorter->Remove(item);
-	ScriptListBucket::iterator bucket_iter = this->buckets.find(value);
-	assert(bucket_iter != this->buckets.end());
-	bucket_iter->second.erase(item);
-	if (bucket_iter->second.empty()) this->buckets.erase(bucket_iter);
-	this->items.erase(item_iter);
+	this->ChangeItem(item);
+	this->RemoveValueKey(item, entry->value);
+	entry->removed = true;
+	this->count--;
+	this->removed_count++;
+	if (this->removed_count >= (int32)SCRIPT_LIST_MIN_PENDING && this->removed_count > this->count) this->CompactItems();
 }
 
 int64 ScriptList::Begin()
 {
 	this->initialized = true;
-	return this->sorter->Begin();
+
+	int64 item, value;
+	if (!this->FindNextItem(true, &item, &value)) return 0;
+
+	this->is_end = false;
+	this->next_item = item;
+	this->next_value = value;
+	this->has_next = this->FindNextItem(false, &this->next_item, &this->next_value);
+	return item;
 }
 
 int64 ScriptList::Next()
@@ -472,12 +414,20 @@ int64 ScriptList::Next()
 		DEBUG(script, 0, "Next() is invalid as Begin() is never called");
 		return 0;
 	}
-	return this->sorter->Next();
+	if (this->count == 0 || this->is_end) return 0;
+
+	int64 item = this->next_item;
+	if (!this->has_next) {
+		this->is_end = true;
+		return item;
+	}
+	this->has_next = this->FindNextItem(false, &this->next_item, &this->next_value);
+	return item;
 }
 
 bool ScriptList::IsEmpty()
 {
-	return this->items.empty();
+	return this->count == 0;
 }
 
 bool ScriptList::IsEnd()
@@ -486,37 +436,34 @@ bool ScriptList::IsEnd()
 		DEBUG(script, 0, "IsEnd() is invalid as Begin() is never called");
 		return true;
 	}
-	return this->sorter->IsEnd();
+	return this->count == 0 || this->is_end;
 }
 
 int32 ScriptList::Count()
 {
-	return (int32)this->items.size();
+	return this->count;
 }
 
 int64 ScriptList::GetValue(int64 item)
 {
-	ScriptListMap::const_iterator item_iter = this->items.find(item);
-	return item_iter == this->items.end() ? 0 : item_iter->second;
+	const Entry *entry = this->FindEntry(item);
+	return (entry == nullptr || entry->removed) ? 0 : entry->value;
 }
 
 bool ScriptList::SetValue(int64 item, int64 value)
 {
 	this->modifications++;
 
-	ScriptListMap::iterator item_iter = this->items.find(item);
-	if (item_iter == this->items.end()) return false;
+	Entry *entry = this->FindEntry(item);
+	if (entry == nullptr || entry->removed) return false;
 
-	int64 value_old = item_iter->second;
+	int64 value_old = entry->value;
 	if (value_old == value) return true;
 
-	this->sorter->Remove(item);
-	ScriptListBucket::iterator bucket_iter = this->buckets.find(value_old);
-	assert(bucket_iter != this->buckets.end());
-	bucket_iter->second.erase(item);
-	if (bucket_iter->second.empty()) this->buckets.erase(bucket_iter);
-	item_iter->second = value;
-	this->buckets[value].insert(item);
+	this->ChangeItem(item);
+	this->RemoveValueKey(item, value_old);
+	entry->value = value;
+	this->AddValueKey(item, value);
 
 	return true;
 }
@@ -528,40 +475,44 @@ void ScriptList::Sort(SorterType sorter, bool ascending)
 	if (sorter != SORT_BY_VALUE && sorter != SORT_BY_ITEM) return;
 	if (sorter == this->sorter_type && ascending == this->sort_ascending) return;
 
-	delete this->sorter;
-	switch (sorter) {
-		case SORT_BY_ITEM:
-			if (ascending) {
-				this->sorter = new ScriptListSorterItemAscending(this);
-			} else {
-				this->sorter = new ScriptListSorterItemDescending(this);
-			}
-			break;
-
-		case SORT_BY_VALUE:
-			if (ascending) {
-				this->sorter = new ScriptListSorterValueAscending(this);
-			} else {
-				this->sorter = new ScriptListSorterValueDescending(this);
-			}
-			break;
-
-		default: NOT_REACHED();
-	}
 	this->sorter_type    = sorter;
 	this->sort_ascending = ascending;
 	this->initialized    = false;
+	this->is_end         = true;
+	this->has_next       = false;
+	this->values_valid   = false;
 }
 
 void ScriptList::AddList(ScriptList *list)
 {
 	if (list == this) return;
 
-	ScriptListMap *list_items = &list->items;
-	for (ScriptListMap::iterator iter = list_items->begin(); iter != list_items->end(); iter++) {
-		this->AddItem((*iter).first);
-		this->SetValue((*iter).first, (*iter).second);
+	list->CompactItems();
+	if (!this->is_end || list->count * 8 < this->count) {
+		/* Add the items one by one, so an iteration over this list sees the same as when done from a script. */
+		for (const Entry &entry : list->items) {
+			this->AddItem(entry.item);
+			this->SetValue(entry.item, entry.value);
+		}
+		return;
 	}
+
+	this->modifications++;
+	this->CompactItems();
+
+	std::vector<Entry> merged;
+	merged.reserve(this->items.size() + list->items.size());
+	std::vector<Entry>::iterator it = this->items.begin();
+	for (const Entry &entry : list->items) {
+		while (it != this->items.end() && it->item < entry.item) merged.push_back(*it++);
+		if (it != this->items.end() && it->item == entry.item) ++it;
+		merged.push_back(entry);
+	}
+	merged.insert(merged.end(), it, this->items.end());
+
+	this->items.swap(merged);
+	this->count = (int32)this->items.size();
+	this->values_valid = false;
 }
 
 void ScriptList::SwapList(ScriptList *list)
@@ -569,54 +520,49 @@ void ScriptList::SwapList(ScriptList *list)
 	if (list == this) return;
 
 	this->items.swap(list->items);
-	this->buckets.swap(list->buckets);
-	Swap(this->sorter, list->sorter);
+	this->items_pending.swap(list->items_pending);
+	this->values.swap(list->values);
+	this->values_pending.swap(list->values_pending);
+	Swap(this->count, list->count);
+	Swap(this->removed_count, list->removed_count);
+	Swap(this->values_outdated, list->values_outdated);
+	Swap(this->values_valid, list->values_valid);
 	Swap(this->sorter_type, list->sorter_type);
 	Swap(this->sort_ascending, list->sort_ascending);
 	Swap(this->initialized, list->initialized);
+	Swap(this->is_end, list->is_end);
+	Swap(this->has_next, list->has_next);
+	Swap(this->next_item, list->next_item);
+	Swap(this->next_value, list->next_value);
 	Swap(this->modifications, list->modifications);
-	this->sorter->Retarget(this);
-	list->sorter->Retarget(list);
 }
 
 void ScriptList::RemoveAboveValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second > value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveEntries([value](const Entry &entry) { return entry.value > value; }, ScriptListItemLess());
 }
 
 void ScriptList::RemoveBelowValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second < value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveEntries([value](const Entry &entry) { return entry.value < value; }, ScriptListItemLess());
 }
 
 void ScriptList::RemoveBetweenValue(int64 start, int64 end)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second > start && (*iter).second < end) this->RemoveItem((*iter).first);
-	}
+	this->RemoveEntries([start, end](const Entry &entry) { return entry.value > start && entry.value < end; }, ScriptListItemLess());
 }
 
 void ScriptList::RemoveValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second == value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveEntries([value](const Entry &entry) { return entry.value == value; }, ScriptListItemLess());
 }
 
 void ScriptList::RemoveTop(int32 count)
@@ -630,29 +576,35 @@ void ScriptList::RemoveTop(int32 count)
 		return;
 	}
 
+	if (count <= 0) return;
+	const bool remove_all = count >= this->count;
+
+	/* Items are removed in the order of the sorter, starting with the first. */
 	switch (this->sorter_type) {
 		default: NOT_REACHED();
-		case SORT_BY_VALUE:
-			for (ScriptListBucket::iterator iter = this->buckets.begin(); iter != this->buckets.end(); iter = this->buckets.begin()) {
-				ScriptItemList *items = &(*iter).second;
-				size_t size = items->size();
-				for (ScriptItemList::iterator iter = items->begin(); iter != items->end(); iter = items->begin()) {
-					if (--count < 0) return;
-					this->RemoveItem(*iter);
-					/* When the last item is removed from the bucket, the bucket itself is removed.
-					 * This means that the iterators can be invalid after a call to RemoveItem.
-					 */
-					if (--size == 0) break;
-				}
+		case SORT_BY_VALUE: {
+			if (remove_all) {
+				this->RemoveEntries([](const Entry &) { return true; }, ScriptListValueLess());
+				break;
 			}
+			/* Sort again, so the keys are exactly the items. */
+			this->values_valid = false;
+			this->BuildValues();
+			const ValueKey limit = this->values[count];
+			this->RemoveEntries([limit](const Entry &entry) { return ValueKey(entry.value, entry.item) < limit; }, ScriptListValueLess());
 			break;
+		}
 
-		case SORT_BY_ITEM:
-			for (ScriptListMap::iterator iter = this->items.begin(); iter != this->items.end(); iter = this->items.begin()) {
-				if (--count < 0) return;
-				this->RemoveItem((*iter).first);
+		case SORT_BY_ITEM: {
+			if (remove_all) {
+				this->RemoveEntries([](const Entry &) { return true; }, ScriptListItemLess());
+				break;
 			}
+			this->CompactItems();
+			const int64 limit = this->items[count].item;
+			this->RemoveEntries([limit](const Entry &entry) { return entry.item < limit; }, ScriptListItemLess());
 			break;
+		}
 	}
 }
 
@@ -667,29 +619,37 @@ void ScriptList::RemoveBottom(int32 count)
 		return;
 	}
 
+	if (count <= 0) return;
+	const bool remove_all = count >= this->count;
+
+	/* Items are removed in the reverse order of the sorter, starting with the last. */
 	switch (this->sorter_type) {
 		default: NOT_REACHED();
-		case SORT_BY_VALUE:
-			for (ScriptListBucket::reverse_iterator iter = this->buckets.rbegin(); iter != this->buckets.rend(); iter = this->buckets.rbegin()) {
-				ScriptItemList *items = &(*iter).second;
-				size_t size = items->size();
-				for (ScriptItemList::reverse_iterator iter = items->rbegin(); iter != items->rend(); iter = items->rbegin()) {
-					if (--count < 0) return;
-					this->RemoveItem(*iter);
-					/* When the last item is removed from the bucket, the bucket itself is removed.
-					 * This means that the iterators can be invalid after a call to RemoveItem.
-					 */
-					if (--size == 0) break;
-				}
+		case SORT_BY_VALUE: {
+			auto removed_before = [](const Entry &a, const Entry &b) { return ScriptListValueLess()(b, a); };
+			if (remove_all) {
+				this->RemoveEntries([](const Entry &) { return true; }, removed_before);
+				break;
 			}
+			/* Sort again, so the keys are exactly the items. */
+			this->values_valid = false;
+			this->BuildValues();
+			const ValueKey limit = this->values[this->count - count];
+			this->RemoveEntries([limit](const Entry &entry) { return !(ValueKey(entry.value, entry.item) < limit); }, removed_before);
 			break;
+		}
 
-		case SORT_BY_ITEM:
-			for (ScriptListMap::reverse_iterator iter = this->items.rbegin(); iter != this->items.rend(); iter = this->items.rbegin()) {
-				if (--count < 0) return;
-				this->RemoveItem((*iter).first);
+		case SORT_BY_ITEM: {
+			auto removed_before = [](const Entry &a, const Entry &b) { return ScriptListItemLess()(b, a); };
+			if (remove_all) {
+				this->RemoveEntries([](const Entry &) { return true; }, removed_before);
+				break;
 			}
+			this->CompactItems();
+			const int64 limit = this->items[this->count - count].item;
+			this->RemoveEntries([limit](const Entry &entry) { return entry.item >= limit; }, removed_before);
 			break;
+		}
 	}
 }
 
@@ -699,11 +659,13 @@ void ScriptList::RemoveList(ScriptList *list)
 
 	if (list == this) {
 		Clear();
-	} else {
-		ScriptListMap *list_items = &list->items;
-		for (ScriptListMap::iterator iter = list_items->begin(); iter != list_items->end(); iter++) {
-			this->RemoveItem((*iter).first);
+	} else if (list->count * 8 < this->count) {
+		list->CompactItems();
+		for (const Entry &entry : list->items) {
+			this->RemoveItem(entry.item);
 		}
+	} else {
+		this->RemoveEntries([list](const Entry &entry) { return list->HasItem(entry.item); }, ScriptListItemLess());
 	}
 }
 
@@ -711,40 +673,28 @@ void ScriptList::KeepAboveValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second <= value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveEntries([value](const Entry &entry) { return entry.value <= value; }, ScriptListItemLess());
 }
 
 void ScriptList::KeepBelowValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second >= value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveEntries([value](const Entry &entry) { return entry.value >= value; }, ScriptListItemLess());
 }
 
 void ScriptList::KeepBetweenValue(int64 start, int64 end)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second <= start || (*iter).second >= end) this->RemoveItem((*iter).first);
-	}
+	this->RemoveEntries([start, end](const Entry &entry) { return entry.value <= start || entry.value >= end; }, ScriptListItemLess());
 }
 
 void ScriptList::KeepValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second != value) this->RemoveItem((*iter).first);
-	}
+	this->RemoveEntries([value](const Entry &entry) { return entry.value != value; }, ScriptListItemLess());
 }
 
 void ScriptList::KeepTop(int32 count)
@@ -767,10 +717,7 @@ void ScriptList::KeepList(ScriptList *list)
 
 	this->modifications++;
 
-	ScriptList tmp;
-	tmp.AddList(this);
-	tmp.RemoveList(list);
-	this->RemoveList(&tmp);
+	this->RemoveEntries([list](const Entry &entry) { return !list->HasItem(entry.item); }, ScriptListItemLess());
 }
 
 SQInteger ScriptList::_get(HSQUIRRELVM vm)
@@ -780,10 +727,10 @@ SQInteger ScriptList::_get(HSQUIRRELVM vm)
 	SQInteger idx;
 	sq_getinteger(vm, 2, &idx);
 
-	ScriptListMap::const_iterator item_iter = this->items.find(idx);
-	if (item_iter == this->items.end()) return SQ_ERROR;
+	const Entry *entry = this->FindEntry(idx);
+	if (entry == nullptr || entry->removed) return SQ_ERROR;
 
-	sq_pushinteger(vm, item_iter->second);
+	sq_pushinteger(vm, entry->value);
 	return 1;
 }
 
@@ -835,6 +782,96 @@ SQInteger ScriptList::_nexti(HSQUIRRELVM vm)
 	return 1;
 }
 
+/** Valuator calling a getter of the API directly. */
+typedef int64 ScriptListNativeValuatorProc(int64 item);
+
+/**
+ * Valuator calling a getter of the API directly, instead of through Squirrel.
+ * @tparam Tfunc Type of the getter.
+ * @tparam func The getter.
+ */
+template <typename Tfunc, Tfunc func> struct ScriptListNativeValuator;
+
+template <typename Tretval, typename Targ, Tretval (*func)(Targ)>
+struct ScriptListNativeValuator<Tretval (*)(Targ), func> {
+	/**
+	 * Check whether a native function of Squirrel calls this getter.
+	 * @param data The userdata of the native function, which is the pointer to the function it calls.
+	 * @param size The size of the userdata.
+	 * @return True iff the native function calls this getter.
+	 */
+	static bool Matches(SQUserPointer data, SQInteger size)
+	{
+		Tretval (*getter)(Targ) = func;
+		return size == (SQInteger)sizeof(getter) && memcmp(data, &getter, sizeof(getter)) == 0;
+	}
+
+	/**
+	 * Get the value of an item, converted like when it is returned to Squirrel.
+	 * @param item The item.
+	 * @return The value.
+	 */
+	static int64 Valuate(int64 item)
+	{
+		Tretval value = func((Targ)item);
+		return sizeof(Tretval) > sizeof(int32) ? (int64)value : (int64)(int32)value;
+	}
+};
+
+/** Getter of the API that can be called directly by ScriptList::Valuate. */
+struct ScriptListNativeValuatorInfo {
+	bool (*matches)(SQUserPointer data, SQInteger size); ///< Whether a native function of Squirrel calls the getter.
+	ScriptListNativeValuatorProc *valuate;                ///< Valuator calling the getter.
+};
+
+#define NATIVE_VALUATOR(func) { &ScriptListNativeValuator<decltype(&func), &func>::Matches, &ScriptListNativeValuator<decltype(&func), &func>::Valuate }
+
+/** Getters commonly used as valuator, which can be called directly. */
+static const ScriptListNativeValuatorInfo _script_list_native_valuators[] = {
+	NATIVE_VALUATOR(ScriptTile::IsBuildable),
+	NATIVE_VALUATOR(ScriptTile::IsWaterTile),
+	NATIVE_VALUATOR(ScriptTile::IsCoastTile),
+	NATIVE_VALUATOR(ScriptTile::GetSlope),
+	NATIVE_VALUATOR(ScriptTile::GetMinHeight),
+	NATIVE_VALUATOR(ScriptTile::GetMaxHeight),
+	NATIVE_VALUATOR(ScriptTile::GetOwner),
+	NATIVE_VALUATOR(ScriptTile::GetTownAuthority),
+	NATIVE_VALUATOR(ScriptTile::GetClosestTown),
+	NATIVE_VALUATOR(ScriptVehicle::GetLocation),
+	NATIVE_VALUATOR(ScriptVehicle::GetEngineType),
+	NATIVE_VALUATOR(ScriptVehicle::GetUnitNumber),
+	NATIVE_VALUATOR(ScriptVehicle::GetAge),
+	NATIVE_VALUATOR(ScriptVehicle::GetMaxAge),
+	NATIVE_VALUATOR(ScriptVehicle::GetAgeLeft),
+	NATIVE_VALUATOR(ScriptVehicle::GetCurrentSpeed),
+	NATIVE_VALUATOR(ScriptVehicle::GetState),
+	NATIVE_VALUATOR(ScriptVehicle::GetRunningCost),
+	NATIVE_VALUATOR(ScriptVehicle::GetProfitThisYear),
+	NATIVE_VALUATOR(ScriptVehicle::GetProfitLastYear),
+	NATIVE_VALUATOR(ScriptVehicle::GetVehicleType),
+	NATIVE_VALUATOR(ScriptVehicle::GetReliability),
+};
+
+#undef NATIVE_VALUATOR
+
+/**
+ * Find the direct valuator for a function passed to ScriptList::Valuate.
+ * @param vm The VM.
+ * @param index Stack index of the function.
+ * @return The valuator, or nullptr when the function has to be called through Squirrel.
+ */
+static ScriptListNativeValuatorProc *FindNativeValuator(HSQUIRRELVM vm, SQInteger index)
+{
+	SQUserPointer data;
+	SQInteger size;
+	if (!Squirrel::GetNativeFunctionUserData(vm, index, &data, &size)) return nullptr;
+
+	for (const ScriptListNativeValuatorInfo &info : _script_list_native_valuators) {
+		if (info.matches(data, size)) return info.valuate;
+	}
+	return nullptr;
+}
+
 SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 {
 	this->modifications++;
@@ -859,25 +896,37 @@ SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 	bool backup_allow = ScriptObject::GetAllowDoCommand();
 	ScriptObject::SetAllowDoCommand(false);
 
+	/* Getters of the API without extra parameters can be called directly. */
+	ScriptListNativeValuatorProc *native_valuator = (nparam == 1) ? FindNativeValuator(vm, 2) : nullptr;
+
 	/* Push the function to call */
 	sq_push(vm, 2);
 
-	for (ScriptListMap::iterator iter = this->items.begin(); iter != this->items.end(); iter++) {
+	/* Valuate in the order of the items. The entries do not move, as the list may not be modified meanwhile. */
+	this->CompactItems();
+	for (size_t index = 0; index < this->items.size(); index++) {
+		const int64 item = this->items[index].item;
+
 		/* Check for changing of items. */
 		int previous_modification_count = this->modifications;
 
-		/* Push the root table as instance object, this is what squirrel does for meta-functions. */
-		sq_pushroottable(vm);
-		/* Push all arguments for the valuator function. */
-		sq_pushinteger(vm, (*iter).first);
-		for (int i = 0; i < nparam - 1; i++) {
-			sq_push(vm, i + 3);
-		}
+		if (native_valuator != nullptr) {
+			/* Push the value like the getter would return it to Squirrel. */
+			sq_pushinteger(vm, native_valuator(item));
+		} else {
+			/* Push the root table as instance object, this is what squirrel does for meta-functions. */
+			sq_pushroottable(vm);
+			/* Push all arguments for the valuator function. */
+			sq_pushinteger(vm, item);
+			for (int i = 0; i < nparam - 1; i++) {
+				sq_push(vm, i + 3);
+			}
 
-		/* Call the function. Squirrel pops all parameters and pushes the return value. */
-		if (SQ_FAILED(sq_call(vm, nparam + 1, SQTrue, SQTrue))) {
-			ScriptObject::SetAllowDoCommand(backup_allow);
-			return SQ_ERROR;
+			/* Call the function. Squirrel pops all parameters and pushes the return value. */
+			if (SQ_FAILED(sq_call(vm, nparam + 1, SQTrue, SQTrue))) {
+				ScriptObject::SetAllowDoCommand(backup_allow);
+				return SQ_ERROR;
+			}
 		}
 
 		/* Retrieve the return value */
@@ -923,7 +972,13 @@ SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 			return sq_throwerror(vm, "modifying valuated list outside of valuator function");
 		}
 
-		this->SetValue((*iter).first, value);
+		if (this->is_end) {
+			/* Without an iteration to keep up to date, the value can be written directly. */
+			this->items[index].value = value;
+			this->values_valid = false;
+		} else {
+			this->SetValue(item, value);
+		}
 
 		/* Pop the return value. */
 		sq_poptop(vm);
@@ -12,10 +12,7 @@
 #define SCRIPT_LIST_HPP
 
 #include "script_object.hpp"
-#include <map>
-#include <set>
-
-class ScriptListSorter;
+#include <vector>
 
 /**
  * Class that creates a list which can keep item/value pairs, which you can walk.
@@ -35,22 +32,45 @@ public:
 	static const bool SORT_DESCENDING = false;
 
 private:
-	ScriptListSorter *sorter;     ///< Sorting algorithm
+	/** An item of the list and its value. */
+	struct Entry {
+		int64 item;   ///< The item.
+		int64 value;  ///< The value of the item.
+		bool removed; ///< Whether the item has been removed; the entry is dropped on the next compaction.
+	};
+	typedef std::pair<int64, int64> ValueKey; ///< Value and item of an item, the key of the sort by value.
+
+	std::vector<Entry> items;             ///< The items sorted by item, including removed ones.
+	std::vector<Entry> items_pending;     ///< Items added out of order, sorted by item; merged into #items when it grows too large.
+	std::vector<ValueKey> values;         ///< The items sorted by value, built when iterating by value. May contain outdated keys.
+	std::vector<ValueKey> values_pending; ///< Keys of items which changed during an iteration by value, sorted; merged into #values when it grows too large.
+	int32 count;                          ///< Number of items in the list.
+	int32 removed_count;                  ///< Number of removed entries in #items and #items_pending.
+	int32 values_outdated;                ///< Number of keys in #values and #values_pending of which the item has been removed or got another value.
+	bool values_valid;                    ///< Whether #values and #values_pending hold a key for every item.
+
 	SorterType sorter_type;       ///< Sorting type
 	bool sort_ascending;          ///< Whether to sort ascending or descending
 	bool initialized;             ///< Whether an iteration has been started
+	bool is_end;                  ///< Whether the iteration has gone beyond the end of the list
+	bool has_next;                ///< Whether there is an item after the current one in the iteration
+	int64 next_item;              ///< The next item of the iteration, or the current one when there is no next item
+	int64 next_value;             ///< The value of #next_item when it was found
 	int modifications;            ///< Number of modification that has been done. To prevent changing data while valuating.
 
-public:
-	typedef std::set<int64> ScriptItemList;                   ///< The list of items inside the bucket
-	typedef std::map<int64, ScriptItemList> ScriptListBucket; ///< The bucket list per value
-	typedef std::map<int64, int64> ScriptListMap;             ///< List per item
-
-	ScriptListMap items;           ///< The items in the list
-	ScriptListBucket buckets;      ///< The items in the list, sorted by value
+	Entry *FindEntry(int64 item);
+	void CompactItems();
+	bool IsIteratingByValue() const;
+	bool IsValidKey(const ValueKey &key);
+	void BuildValues();
+	void AddValueKey(int64 item, int64 value);
+	void RemoveValueKey(int64 item, int64 value);
+	bool FindNextItem(bool first, int64 *item, int64 *value);
+	void ChangeItem(int64 item);
+	template <typename Tpredicate, typename Torder> void RemoveEntries(Tpredicate predicate, Torder removed_before);
 
+public:
 	ScriptList();
-	~ScriptList();
 
 #ifdef DOXYGEN_API
 	/**
@@ -283,6 +303,10 @@ public:
 	 *    return myparam * bridge_id; // This is silly
 	 *  }
 	 *  list.Valuate(MyVal, 12);
+	 * @note Common getters without extra parameters, like ScriptTile::GetSlope,
+	 *  ScriptTile::GetOwner or ScriptVehicle::GetProfitLastYear, are called
+	 *  directly instead of through Squirrel. This is faster, but costs the
+	 *  same amount of operations.
 	 */
 	void Valuate(void *valuator_function, int params, ...);
 #endif /* DOXYGEN_API */
@@ -49,7 +49,7 @@ protected:
 		ScriptInstance *last_active;    ///< The active instance before we go instantiated.
 		ScriptAllocatorScope alc_scope; ///< Keep the correct allocator for the script instance activated
 
-		static ScriptInstance *active;  ///< The global current active instance.
+		static thread_local ScriptInstance *active; ///< The current active instance of this thread.
 	};
 
 public:
@@ -16,10 +16,18 @@
 #include "../string_func.h"
 #include "script_fatalerror.hpp"
 #include "../settings_type.h"
+#include "../company_func.h"
 #include <sqstdaux.h>
 #include <../squirrel/sqpcheader.h>
 #include <../squirrel/sqvm.h>
+#include <../squirrel/sqfuncproto.h>
+#include <../squirrel/sqclosure.h>
+#include <../squirrel/squserdata.h>
 #include "../core/alloc_func.hpp"
+#include <mutex>
+#if defined(__MINGW32__)
+#include "../3rdparty/mingw-std-threads/mingw.mutex.h"
+#endif
 
 #include "../safeguards.h"
 
@@ -114,7 +122,7 @@ struct ScriptAllocator {
 	}
 };
 
-ScriptAllocator *_squirrel_allocator = nullptr;
+thread_local ScriptAllocator *_squirrel_allocator = nullptr;
 
 /* See 3rdparty/squirrel/squirrel/sqmem.cpp for the default allocator implementation, which this overrides */
 #ifndef SQUIRREL_DEFAULT_ALLOCATOR
@@ -123,6 +131,49 @@ void *sq_vm_realloc(void *p, SQUnsignedInteger oldsize, SQUnsignedInteger size)
 void sq_vm_free(void *p, SQUnsignedInteger size) { _squirrel_allocator->Free(p, size); }
 #endif
 
+static std::mutex _script_concurrent_lock;                                 ///< Lock held by concurrently running scripts outside of bytecode.
+static thread_local ScriptConcurrentScope *_script_concurrent_scope = nullptr; ///< Concurrency state of the current thread, if any.
+
+/**
+ * Switch the current thread between running native code and bytecode of a script VM.
+ * This only has an effect inside a #ScriptConcurrentScope.
+ * @param native Whether native code is going to be run.
+ * @return Whether native code was being run before.
+ */
+bool sq_vm_set_native(bool native)
+{
+	ScriptConcurrentScope *scope = _script_concurrent_scope;
+	if (scope == nullptr || scope->native == native) return native;
+
+	if (native) {
+		_script_concurrent_lock.lock();
+		_current_company = scope->company;
+	} else {
+		scope->company = _current_company;
+		_script_concurrent_lock.unlock();
+	}
+	scope->native = native;
+	return !native;
+}
+
+/**
+ * Start running scripts concurrently with other threads, and acquire the lock to run native code.
+ * @param company The company to run the scripts as.
+ */
+ScriptConcurrentScope::ScriptConcurrentScope(CompanyID company) : company(company), native(false)
+{
+	assert(_script_concurrent_scope == nullptr);
+	_script_concurrent_scope = this;
+	sq_vm_set_native(true);
+}
+
+/** Release the lock, and stop running scripts concurrently. */
+ScriptConcurrentScope::~ScriptConcurrentScope()
+{
+	sq_vm_set_native(false);
+	_script_concurrent_scope = nullptr;
+}
+
 size_t Squirrel::GetAllocatedMemory() const noexcept
 {
 	assert(this->allocator != nullptr);
@@ -727,6 +778,19 @@ void Squirrel::InsertResult(int result)
 	vm->DecreaseOps(ops);
 }
 
+/* static */ bool Squirrel::GetNativeFunctionUserData(HSQUIRRELVM vm, SQInteger index, SQUserPointer *data, SQInteger *size)
+{
+	const SQObjectPtr &function = stack_get(vm, index);
+	if (type(function) != OT_NATIVECLOSURE) return false;
+
+	const SQObjectPtrVec &outers = _nativeclosure(function)->_outervalues;
+	if (outers.size() != 1 || type(outers[0]) != OT_USERDATA) return false;
+
+	*data = _userdataval(outers[0]);
+	*size = _userdata(outers[0])->_size;
+	return true;
+}
+
 bool Squirrel::IsSuspended()
 {
 	return this->vm->_suspended != 0;
@@ -11,6 +11,7 @@
 #define SQUIRREL_HPP
 
 #include <squirrel.h>
+#include "../company_type.h"
 
 /** The type of script we're working with, i.e. for who is it? */
 enum ScriptType {
@@ -245,6 +246,16 @@ public:
 	 */
 	static void DecreaseOps(HSQUIRRELVM vm, int amount);
 
+	/**
+	 * Get the userdata registered with a native function, i.e. the pointer to the C++ function it calls.
+	 * @param vm The VM.
+	 * @param index Stack index of the function.
+	 * @param[out] data The userdata.
+	 * @param[out] size The size of the userdata.
+	 * @return True iff the function is a native function with userdata.
+	 */
+	static bool GetNativeFunctionUserData(HSQUIRRELVM vm, SQInteger index, SQUserPointer *data, SQInteger *size);
+
 	/**
 	 * Did the squirrel code suspend or return normally.
 	 * @return True if the function suspended.
@@ -283,7 +294,7 @@ public:
 };
 
 
-extern ScriptAllocator *_squirrel_allocator;
+extern thread_local ScriptAllocator *_squirrel_allocator;
 
 class ScriptAllocatorScope {
 	ScriptAllocator *old_allocator;
@@ -302,4 +313,21 @@ public:
 	}
 };
 
+/**
+ * Scope in which the calling thread runs script VMs concurrently with other threads.
+ * Only the bytecode of the VMs runs concurrently: native functions, and everything
+ * outside of the VMs, run while holding a lock shared by all threads. The current
+ * company is saved when the lock is released and restored when it is reacquired.
+ */
+class ScriptConcurrentScope {
+	CompanyID company; ///< Current company of the thread, while it does not hold the lock.
+	bool native;       ///< Whether the thread runs native code, and thus holds the lock.
+
+	friend bool sq_vm_set_native(bool native);
+
+public:
+	ScriptConcurrentScope(CompanyID company);
+	~ScriptConcurrentScope();
+};
+
 #endif /* SQUIRREL_HPP */
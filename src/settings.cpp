@@ -1376,12 +1376,10 @@ static bool ChangeMaxHeightLevel(int32 p1)
 
 	/* Check if at least one mountain on the map is higher than the new value.
 	 * If yes, disallow the change. */
-	for (TileIndex t = 0; t < MapSize(); t++) {
-		if ((int32)TileHeight(t) > p1) {
-			ShowErrorMessage(STR_CONFIG_SETTING_TOO_HIGH_MOUNTAIN, INVALID_STRING_ID, WL_ERROR);
-			/* Return old, unchanged value */
-			return false;
-		}
+	if ((int32)GetMapMaxHeight() > p1) {
+		ShowErrorMessage(STR_CONFIG_SETTING_TOO_HIGH_MOUNTAIN, INVALID_STRING_ID, WL_ERROR);
+		/* Return old, unchanged value */
+		return false;
 	}
 
 	/* The smallmap uses an index from heightlevels to colours. Trigger rebuilding it. */
@@ -111,6 +111,12 @@ struct GUISettings {
 	bool   disable_unsuitable_building;      ///< disable infrastructure building when no suitable vehicles are available
 	byte   autosave;                         ///< how often should we do autosaves?
 	bool   threaded_saves;                   ///< should we do threaded saves?
+	uint8  worker_threads;                   ///< total number of threads used for parallel work, including the main thread (0 = automatic)
+	uint8  linkgraph_threads;                ///< number of threads running link graph jobs (0 = automatic)
+	bool   parallel_ai_scripts;              ///< run the bytecode of the AIs of a server concurrently on the worker threads
+	bool   parallel_savegame_compression;    ///< compress savegames in independent blocks on the worker threads
+	bool   background_sprite_decode;         ///< decode the sprites the viewports are about to draw on the worker threads
+	bool   parallel_viewport_draw;           ///< draw horizontal stripes of the viewports concurrently on the worker threads
 	bool   keep_all_autosave;                ///< name the autosave in a different way
 	bool   autosave_on_exit;                 ///< save an autosave when you quit the game, but do not ask "Do you really want to quit?"
 	bool   autosave_on_network_disconnect;   ///< save an autosave when you get disconnected from a network game with an error?
@@ -208,6 +214,8 @@ struct GUISettings {
 
 	uint8  developer;                        ///< print non-fatal warnings in console (>= 1), copy debug output to console (== 2)
 	bool   show_date_in_logs;                ///< whether to show dates in console logs
+	uint16 rolling_cache_check_period;       ///< number of ticks over which a check of all caches is spread, 0 = off
+	uint16 tick_profiler_slow_tick_ms;       ///< dump the tick profile when a game loop tick takes at least this many milliseconds, 0 = off
 	bool   newgrf_developer_tools;           ///< activate NewGRF developer tools and allow modifying NewGRFs in an existing game
 	bool   ai_developer_tools;               ///< activate AI developer tools
 	bool   scenario_developer;               ///< activate scenario developer: allow modifying NewGRFs in an existing game
@@ -392,6 +400,7 @@ struct ConstructionSettings {
 	uint32 purchase_land_per_64k_frames;     ///< how many tiles may, over a long period, be purchased per 65536 frames?
 	uint16 purchase_land_frame_burst;        ///< how many tiles may, over a short period, be purchased?
 	uint8  tree_growth_rate;                 ///< tree growth rate
+	bool   parallel_tile_loop;               ///< run the tile loop of clear, tree and water tiles in parallel, deferring the rest to an ordered serial pass
 };
 
 /** Settings related to the AI. */
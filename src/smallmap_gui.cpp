@@ -30,6 +30,7 @@
 #include "table/strings.h"
 
 #include <bitset>
+#include <chrono>
 
 #include "safeguards.h"
 
@@ -161,6 +162,24 @@ static bool _smallmap_industry_highlight_state;
 /** For connecting company ID to position in owner list (small map legend) */
 uint _company_to_list_pos[MAX_COMPANIES];
 
+static const uint SMALLMAP_REVALIDATE_SLICES = 16; ///< Number of refreshes of the smallmap after which every cached tile colour has been recomputed.
+
+/** Colours of the tiles in the smallmap for the current map type, so a redraw only has to compute those of changed tiles. */
+struct SmallMapTileCache {
+	std::vector<uint8> info;          ///< #SmallMapTileInfo of each tile.
+	std::vector<uint32> colours;      ///< Colours of each tile, valid when its info is not #SMTI_INVALID.
+	uint revalidate_row;              ///< First row of the next slice to recompute, see #RevalidateSmallMapTileColourSlice.
+
+	/* The settings the colours were computed with. */
+	uint8 map_type;                   ///< Map type of the smallmap.
+	uint8 land_colour;                ///< Colour scheme of the land, see #GUISettings::smallmap_land_colour.
+	bool show_heightmap;              ///< Whether the heightmap was shown.
+	IndustryType industry_highlight;  ///< Highlighted industry type.
+};
+
+static SmallMapTileCache _smallmap_tile_cache;
+uint8 *_smallmap_tile_info = nullptr; ///< Tile info of the smallmap tile colour cache, or \c nullptr when there is no cache.
+
 /**
  * Fills an array for the industries legends.
  */
@@ -290,6 +309,7 @@ void BuildLandLegend()
 		j++;
 	}
 	_legend_land_contours[i].end = true;
+	InvalidateSmallMapTileColours();
 }
 
 /**
@@ -315,12 +335,13 @@ void BuildOwnerLegend()
 
 	/* Store maximum amount of owner legend entries. */
 	_smallmap_company_count = i;
+	InvalidateSmallMapTileColours();
 }
 
 /**
  * Return the colour a tile would be displayed with in the small map in mode "Contour".
  * @param tile The tile of which we would like to get the colour.
- * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColours).
+ * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColour).
  * @return The colour of tile in the small map in mode "Contour"
  */
 static inline uint32 GetSmallMapContoursPixels(TileIndex tile, TileType t)
@@ -333,7 +354,7 @@ static inline uint32 GetSmallMapContoursPixels(TileIndex tile, TileType t)
  * Return the colour a tile would be displayed with in the small map in mode "Vehicles".
  *
  * @param tile The tile of which we would like to get the colour.
- * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColours).
+ * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColour).
  * @return The colour of tile in the small map in mode "Vehicles"
  */
 static inline uint32 GetSmallMapVehiclesPixels(TileIndex tile, TileType t)
@@ -346,7 +367,7 @@ static inline uint32 GetSmallMapVehiclesPixels(TileIndex tile, TileType t)
  * Return the colour a tile would be displayed with in the small map in mode "Industries".
  *
  * @param tile The tile of which we would like to get the colour.
- * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColours).
+ * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColour).
  * @return The colour of tile in the small map in mode "Industries"
  */
 static inline uint32 GetSmallMapIndustriesPixels(TileIndex tile, TileType t)
@@ -359,7 +380,7 @@ static inline uint32 GetSmallMapIndustriesPixels(TileIndex tile, TileType t)
  * Return the colour a tile would be displayed with in the small map in mode "Routes".
  *
  * @param tile The tile of which we would like to get the colour.
- * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColours).
+ * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColour).
  * @return The colour of tile  in the small map in mode "Routes"
  */
 static inline uint32 GetSmallMapRoutesPixels(TileIndex tile, TileType t)
@@ -415,7 +436,7 @@ static inline uint32 GetSmallMapRoutesPixels(TileIndex tile, TileType t)
  * Return the colour a tile would be displayed with in the small map in mode "link stats".
  *
  * @param tile The tile of which we would like to get the colour.
- * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColours).
+ * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColour).
  * @return The colour of tile in the small map in mode "link stats"
  */
 static inline uint32 GetSmallMapLinkStatsPixels(TileIndex tile, TileType t)
@@ -427,7 +448,7 @@ static inline uint32 GetSmallMapLinkStatsPixels(TileIndex tile, TileType t)
  * Return the colour a tile would be displayed with in the smallmap in mode "Vegetation".
  *
  * @param tile The tile of which we would like to get the colour.
- * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColours).
+ * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColour).
  * @return The colour of tile  in the smallmap in mode "Vegetation"
  */
 static inline uint32 GetSmallMapVegetationPixels(TileIndex tile, TileType t)
@@ -454,7 +475,7 @@ static inline uint32 GetSmallMapVegetationPixels(TileIndex tile, TileType t)
  * Return the colour a tile would be displayed with in the small map in mode "Owner".
  *
  * @param tile The tile of which we would like to get the colour.
- * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColours).
+ * @param t    Effective tile type of the tile (see #SmallMapWindow::GetTileColour).
  * @return The colour of tile in the small map in mode "Owner"
  */
 static inline uint32 GetSmallMapOwnerPixels(TileIndex tile, TileType t)
@@ -645,86 +666,201 @@ void SmallMapWindow::SetZoomLevel(ZoomLevelChange change, const Point *zoom_pt)
 }
 
 /**
- * Decide which colours to show to the user for a group of tiles.
- * @param ta Tile area to investigate.
- * @return Colours to display.
+ * Decide which colour to show to the user for a single tile, and how important it is compared to the other tiles in its area.
+ * @param tile Tile to investigate.
+ * @param[out] info Importance of the tile and #SmallMapTileInfo flags.
+ * @return Colours to display when this tile is the most important one of its area.
  */
-inline uint32 SmallMapWindow::GetTileColours(const TileArea &ta) const
+/* static */ inline uint32 SmallMapWindow::GetTileColour(TileIndex tile, uint8 *info)
 {
-	int importance = 0;
-	TileIndex tile = INVALID_TILE; // Position of the most important tile.
-	TileType et = MP_VOID;         // Effective tile type at that position.
-
-	TILE_AREA_LOOP(ti, ta) {
-		TileType ttype = GetTileType(ti);
+	TileType ttype = GetTileType(tile);
+	uint8 flags = 0;
 
-		switch (ttype) {
-			case MP_TUNNELBRIDGE: {
-				TransportType tt = GetTunnelBridgeTransportType(ti);
+	switch (ttype) {
+		case MP_TUNNELBRIDGE: {
+			TransportType tt = GetTunnelBridgeTransportType(tile);
 
-				switch (tt) {
-					case TRANSPORT_RAIL: ttype = MP_RAILWAY; break;
-					case TRANSPORT_ROAD: ttype = MP_ROAD;    break;
-					default:             ttype = MP_WATER;   break;
-				}
-				break;
+			switch (tt) {
+				case TRANSPORT_RAIL: ttype = MP_RAILWAY; break;
+				case TRANSPORT_ROAD: ttype = MP_ROAD;    break;
+				default:             ttype = MP_WATER;   break;
 			}
+			break;
+		}
 
-			case MP_INDUSTRY:
-				/* Special handling of industries while in "Industries" smallmap view. */
-				if (this->map_type == SMT_INDUSTRY) {
-					/* If industry is allowed to be seen, use its colour on the map.
-					 * This has the highest priority above any value in _tiletype_importance. */
-					IndustryType type = Industry::GetByTile(ti)->type;
-					if (_legend_from_industries[_industry_to_list_pos[type]].show_on_map) {
-						if (type == _smallmap_industry_highlight) {
-							if (_smallmap_industry_highlight_state) return MKCOLOUR_XXXX(PC_WHITE);
-						} else {
-							return GetIndustrySpec(type)->map_colour * 0x01010101;
-						}
+		case MP_INDUSTRY:
+			/* Special handling of industries while in "Industries" smallmap view. */
+			if (map_type == SMT_INDUSTRY) {
+				/* If industry is allowed to be seen, use its colour on the map.
+				 * This has the highest priority above any value in _tiletype_importance. */
+				IndustryType type = Industry::GetByTile(tile)->type;
+				if (_legend_from_industries[_industry_to_list_pos[type]].show_on_map) {
+					if (type != _smallmap_industry_highlight) {
+						*info = SMTI_IMPORTANCE_SHOWN;
+						return GetIndustrySpec(type)->map_colour * 0x01010101;
 					}
-					/* Otherwise make it disappear */
-					ttype = IsTileOnWater(ti) ? MP_WATER : MP_CLEAR;
+					/* The highlighted industry blinks; in its dark phase it is shown like the ground below. */
+					flags = SMTI_HIGHLIGHT;
 				}
-				break;
-
-			default:
-				break;
-		}
+				/* Otherwise make it disappear */
+				ttype = IsTileOnWater(tile) ? MP_WATER : MP_CLEAR;
+			}
+			break;
 
-		if (_tiletype_importance[ttype] > importance) {
-			importance = _tiletype_importance[ttype];
-			tile = ti;
-			et = ttype;
-		}
+		default:
+			break;
 	}
 
-	switch (this->map_type) {
+	*info = _tiletype_importance[ttype] | flags;
+
+	/* Void tiles are only shown when the whole area is void, which does not happen within the drawn part of the map.
+	 * The colour functions do not support them at the map edge, so do not compute a colour for them. */
+	if (ttype == MP_VOID) return MKCOLOUR_XXXX(PC_BLACK);
+
+	switch (map_type) {
 		case SMT_CONTOUR:
-			return GetSmallMapContoursPixels(tile, et);
+			return GetSmallMapContoursPixels(tile, ttype);
 
 		case SMT_VEHICLES:
-			return GetSmallMapVehiclesPixels(tile, et);
+			return GetSmallMapVehiclesPixels(tile, ttype);
 
 		case SMT_INDUSTRY:
-			return GetSmallMapIndustriesPixels(tile, et);
+			return GetSmallMapIndustriesPixels(tile, ttype);
 
 		case SMT_LINKSTATS:
-			return GetSmallMapLinkStatsPixels(tile, et);
+			return GetSmallMapLinkStatsPixels(tile, ttype);
 
 		case SMT_ROUTES:
-			return GetSmallMapRoutesPixels(tile, et);
+			return GetSmallMapRoutesPixels(tile, ttype);
 
 		case SMT_VEGETATION:
-			return GetSmallMapVegetationPixels(tile, et);
+			return GetSmallMapVegetationPixels(tile, ttype);
 
 		case SMT_OWNER:
-			return GetSmallMapOwnerPixels(tile, et);
+			return GetSmallMapOwnerPixels(tile, ttype);
 
 		default: NOT_REACHED();
 	}
 }
 
+/**
+ * Decide which colours to show for a group of tiles: those of the first most important tile.
+ * @param ta Tile area to investigate.
+ * @param get_colour Function returning the colour and importance info of a tile, like #SmallMapWindow::GetTileColour.
+ * @return Colours to display.
+ */
+template <typename F>
+static inline uint32 ReduceTileColours(const TileArea &ta, F get_colour)
+{
+	uint importance = 0;
+	uint32 colour = 0;
+
+	/* Same order as TILE_AREA_LOOP, without its overhead. */
+	for (uint y = 0; y < ta.h; y++) {
+		const TileIndex row = ta.tile + TileDiffXY(0, y);
+		for (TileIndex ti = row; ti < row + ta.w; ti++) {
+			uint8 info;
+			uint32 tile_colour = get_colour(ti, &info);
+
+			if ((info & SMTI_HIGHLIGHT) != 0 && _smallmap_industry_highlight_state) return MKCOLOUR_XXXX(PC_WHITE);
+
+			uint tile_importance = info & SMTI_IMPORTANCE_MASK;
+			if (tile_importance == SMTI_IMPORTANCE_SHOWN) return tile_colour;
+			if (tile_importance > importance) {
+				importance = tile_importance;
+				colour = tile_colour;
+			}
+		}
+	}
+
+	return colour;
+}
+
+/**
+ * Decide which colours to show to the user for a group of tiles.
+ * @param ta Tile area to investigate.
+ * @return Colours to display.
+ */
+/* static */ uint32 SmallMapWindow::GetTileColours(const TileArea &ta)
+{
+	return ReduceTileColours(ta, &SmallMapWindow::GetTileColour);
+}
+
+/**
+ * Decide which colours to show to the user for a group of tiles, using and filling the tile colour cache.
+ * @param ta Tile area to investigate.
+ * @return Colours to display.
+ * @pre #ValidateTileColourCache has been called.
+ */
+/* static */ uint32 SmallMapWindow::GetCachedTileColours(const TileArea &ta)
+{
+	return ReduceTileColours(ta, [](TileIndex tile, uint8 *info) -> uint32 {
+		uint8 cached = _smallmap_tile_info[tile];
+		if (cached == SMTI_INVALID) {
+			_smallmap_tile_cache.colours[tile] = GetTileColour(tile, &cached);
+			_smallmap_tile_info[tile] = cached;
+		}
+		*info = cached;
+		return _smallmap_tile_cache.colours[tile];
+	});
+}
+
+/**
+ * Make sure the tile colour cache exists and matches the current map type and colour settings;
+ * when it does not, all cached colours are discarded.
+ */
+/* static */ void SmallMapWindow::ValidateTileColourCache()
+{
+	SmallMapTileCache &cache = _smallmap_tile_cache;
+	if (_smallmap_tile_info == nullptr || cache.info.size() != MapSize()) {
+		cache.info.assign(MapSize(), SMTI_INVALID);
+		cache.colours.resize(MapSize());
+		cache.revalidate_row = 0;
+		_smallmap_tile_info = cache.info.data();
+	} else if (cache.map_type != map_type || cache.land_colour != _settings_client.gui.smallmap_land_colour ||
+			cache.show_heightmap != _smallmap_show_heightmap || cache.industry_highlight != _smallmap_industry_highlight) {
+		InvalidateSmallMapTileColours();
+	}
+	cache.map_type = map_type;
+	cache.land_colour = _settings_client.gui.smallmap_land_colour;
+	cache.show_heightmap = _smallmap_show_heightmap;
+	cache.industry_highlight = _smallmap_industry_highlight;
+}
+
+/**
+ * Discard the cached colours of all tiles, e.g. because a legend or colour scheme has changed.
+ */
+void InvalidateSmallMapTileColours()
+{
+	if (_smallmap_tile_info != nullptr) MemSetT(_smallmap_tile_info, SMTI_INVALID, _smallmap_tile_cache.info.size());
+}
+
+/**
+ * Discard the cached colours of the next slice of rows of the map.
+ * Nearly every change to a tile marks it dirty and thus invalidates its cached colour, this sweep
+ * catches the remaining ones, like changes of ownership, so that no stale colour stays around for long.
+ */
+static void RevalidateSmallMapTileColourSlice()
+{
+	SmallMapTileCache &cache = _smallmap_tile_cache;
+	if (_smallmap_tile_info == nullptr) return;
+
+	uint rows = max<uint>(1, MapSizeY() / SMALLMAP_REVALIDATE_SLICES);
+	if (cache.revalidate_row >= MapSizeY()) cache.revalidate_row = 0;
+	rows = min(rows, MapSizeY() - cache.revalidate_row);
+	MemSetT(_smallmap_tile_info + TileXY(0, cache.revalidate_row), SMTI_INVALID, rows * MapSizeX());
+	cache.revalidate_row += rows;
+}
+
+/** Release the tile colour cache, when the smallmap window closes. */
+static void FreeSmallMapTileColourCache()
+{
+	SmallMapTileCache &cache = _smallmap_tile_cache;
+	_smallmap_tile_info = nullptr;
+	cache.info = std::vector<uint8>();
+	cache.colours = std::vector<uint32>();
+}
+
 /**
  * Draws one column of tiles of the small map in a certain mode onto the screen buffer, skipping the shifted rows in between.
  *
@@ -762,7 +898,7 @@ void SmallMapWindow::DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch,
 		}
 		ta.ClampToMap(); // Clamp to map boundaries (may contain MP_VOID tiles!).
 
-		uint32 val = this->GetTileColours(ta);
+		uint32 val = this->GetCachedTileColours(ta);
 		uint8 *val8 = (uint8 *)&val;
 		int idx = max(0, -start_pos);
 		for (int pos = max(0, start_pos); pos < end_pos; pos++) {
@@ -773,6 +909,70 @@ void SmallMapWindow::DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch,
 	} while (xc += this->zoom, yc += this->zoom, dst = blitter->MoveTo(dst, pitch, 0), --reps != 0);
 }
 
+/**
+ * Benchmark computing the smallmap colours of the whole map, for each smallmap type and for two zoom levels.
+ * This is the part of redrawing the smallmap which depends on the map layout.
+ * Redraws using the tile colour cache, with all tiles unchanged, are measured too, and checked against the uncached colours.
+ * @param b Buffer to write to.
+ * @param last Last valid position in the buffer.
+ * @param iterations Number of redraws of each kind.
+ */
+void DumpSmallMapBenchmark(char *b, const char *last, uint iterations)
+{
+	static const char * const type_names[] = { "contour", "vehicles", "industry", "link stats", "routes", "vegetation", "owner" };
+	static const int zoom_levels[] = { 1, 4 };
+
+	const SmallMapWindow::SmallMapType saved_type = SmallMapWindow::map_type;
+	const bool had_cache = _smallmap_tile_info != nullptr;
+	volatile uint32 sink = 0;
+
+	/* The contour colours are only set up once a smallmap window is opened. */
+	SmallMapWindow::RebuildColourIndexIfNecessary();
+	const uint min_xy = _settings_game.construction.freeform_edges ? 1 : 0;
+
+	auto redraw = [&](int zoom, bool cached) -> uint32 {
+		uint32 result = 0;
+		for (uint y = min_xy; y < MapMaxY(); y += zoom) {
+			for (uint x = min_xy; x < MapMaxX(); x += zoom) {
+				TileArea ta(TileXY(x, y), zoom, zoom);
+				ta.ClampToMap();
+				uint32 colours = cached ? SmallMapWindow::GetCachedTileColours(ta) : SmallMapWindow::GetTileColours(ta);
+				result = (result * 31) ^ colours;
+			}
+		}
+		return result;
+	};
+
+	b += seprintf(b, last, "Smallmap redraw benchmark, %u iteration(s)\n", iterations);
+	for (uint type = SmallMapWindow::SMT_CONTOUR; type <= SmallMapWindow::SMT_OWNER; type++) {
+		SmallMapWindow::map_type = (SmallMapWindow::SmallMapType)type;
+		b += seprintf(b, last, "  %-12s", type_names[type]);
+		for (int zoom : zoom_levels) {
+			SmallMapWindow::ValidateTileColourCache();
+			InvalidateSmallMapTileColours();
+			const uint32 expected = redraw(zoom, false);
+			const bool match = redraw(zoom, true) == expected;
+
+			auto start = std::chrono::steady_clock::now();
+			for (uint i = 0; i < iterations; i++) sink = sink ^ redraw(zoom, false);
+			double uncached = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+			start = std::chrono::steady_clock::now();
+			for (uint i = 0; i < iterations; i++) sink = sink ^ redraw(zoom, true);
+			double cached = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+			b += seprintf(b, last, " zoom %d: %8.3f ms, cached %8.3f ms%s", zoom, uncached, cached, match ? "" : " (MISMATCH)");
+		}
+		b += seprintf(b, last, "\n");
+	}
+	SmallMapWindow::map_type = saved_type;
+	if (had_cache) {
+		InvalidateSmallMapTileColours();
+	} else {
+		FreeSmallMapTileColourCache();
+	}
+}
+
 /**
  * Adds vehicles to the smallmap.
  * @param dpi the part of the smallmap to be drawn into
@@ -882,6 +1082,8 @@ void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi, bool draw_indicators) cons
 	/* Clear it */
 	GfxFillRect(dpi->left, dpi->top, dpi->left + dpi->width - 1, dpi->top + dpi->height - 1, PC_BLACK);
 
+	SmallMapWindow::ValidateTileColourCache();
+
 	/* Which tile is displayed at (dpi->left, dpi->top)? */
 	int dx;
 	Point tile = this->PixelToTile(dpi->left, dpi->top, &dx);
@@ -1001,6 +1203,7 @@ SmallMapWindow::~SmallMapWindow()
 {
 	delete this->overlay;
 	this->BreakIndustryChainLink();
+	FreeSmallMapTileColourCache();
 }
 
 /**
@@ -1265,6 +1468,7 @@ void SmallMapWindow::SelectLegendItem(int click_pos, LegendAndColour *legend, in
 		legend[click_pos].show_on_map = !legend[click_pos].show_on_map;
 	}
 
+	InvalidateSmallMapTileColours();
 	if (this->map_type == SMT_INDUSTRY) this->BreakIndustryChainLink();
 }
 
@@ -1417,6 +1621,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 			for (;!tbl->end && tbl->legend != STR_LINKGRAPH_LEGEND_UNUSED; ++tbl) {
 				tbl->show_on_map = (widget == WID_SM_ENABLE_ALL);
 			}
+			InvalidateSmallMapTileColours();
 			if (this->map_type == SMT_LINKSTATS) this->SetOverlayCargoMask();
 			this->SetDirty();
 			break;
@@ -1460,6 +1665,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 			for (int i = 0; i != _smallmap_industry_count; i++) {
 				_legend_from_industries[i].show_on_map = _displayed_industries.test(_legend_from_industries[i].type);
 			}
+			InvalidateSmallMapTileColours();
 			break;
 		}
 
@@ -1507,6 +1713,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 		}
 	}
 	_smallmap_industry_highlight_state = !_smallmap_industry_highlight_state;
+	RevalidateSmallMapTileColourSlice();
 
 	this->refresh.SetInterval(_smallmap_industry_highlight != INVALID_INDUSTRYTYPE ? BLINK_PERIOD : FORCE_REFRESH_PERIOD);
 	this->SetDirty();
@@ -37,6 +37,26 @@ static const byte _tiletype_importance[] = {
 	0,
 };
 
+/** Importance and flags of a tile in the smallmap tile colour cache. */
+enum SmallMapTileInfo {
+	SMTI_INVALID            = 0,    ///< The colour of the tile has not been computed, or the tile changed since.
+	SMTI_IMPORTANCE_MASK    = 0x0F, ///< Importance of the tile, see #_tiletype_importance.
+	SMTI_IMPORTANCE_SHOWN   = 0x0F, ///< Importance of a shown industry in the industry view, which beats all other tiles.
+	SMTI_HIGHLIGHT          = 0x10, ///< The tile belongs to the highlighted industry type, and is white when it blinks.
+};
+
+extern uint8 *_smallmap_tile_info;
+void InvalidateSmallMapTileColours();
+
+/**
+ * Discard the cached smallmap colour of a tile, because it has changed.
+ * @param tile The changed tile.
+ */
+static inline void InvalidateSmallMapTileColour(TileIndex tile)
+{
+	if (_smallmap_tile_info != nullptr) _smallmap_tile_info[tile] = SMTI_INVALID;
+}
+
 /* set up the cargos to be displayed in the smallmap's route legend */
 void BuildLinkStatsLegend();
 
@@ -188,12 +208,16 @@ protected:
 	void SetZoomLevel(ZoomLevelChange change, const Point *zoom_pt);
 	void SetOverlayCargoMask();
 	void SetupWidgetData();
-	uint32 GetTileColours(const TileArea &ta) const;
+	static uint32 GetTileColour(TileIndex tile, uint8 *info);
+	static uint32 GetTileColours(const TileArea &ta);
+	static uint32 GetCachedTileColours(const TileArea &ta);
+	static void ValidateTileColourCache();
 
 	int GetPositionOnLegend(Point pt);
 
 public:
 	friend class NWidgetSmallmapDisplay;
+	friend void DumpSmallMapBenchmark(char *b, const char *last, uint iterations);
 
 	SmallMapWindow(WindowDesc *desc, int window_number);
 	virtual ~SmallMapWindow();
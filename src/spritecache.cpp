@@ -19,6 +19,7 @@
 #include "core/math_func.hpp"
 #include "core/mem_func.hpp"
 #include "scope_info.h"
+#include "worker_thread.h"
 
 #include "table/sprites.h"
 #include "table/strings.h"
@@ -28,13 +29,16 @@
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <memory>
 
 #include "safeguards.h"
 
 /* Default of 4MB spritecache */
 uint _sprite_cache_size = 4;
 
-static size_t _spritecache_bytes_used = 0;
+/** Number of bytes allocated for sprite data, also counting sprites that are being decoded in the background. */
+static std::atomic<size_t> _spritecache_bytes_used(0);
 
 PACK_N(class SpriteDataBuffer {
 	void *ptr = nullptr;
@@ -90,11 +94,13 @@ PACK_N(struct SpriteCache {
 	size_t file_pos;
 	SpriteDataBuffer buffer;
 	uint32 id;
-	uint32 lru;
+	uint32 clock_slot = UINT32_MAX; ///< Position in #_sprite_clock, or UINT32_MAX if the sprite is not in it.
 	uint16 file_slot;
 
 	/**
-	 * Bits 6 - 0:  SpriteType type  In some cases a single sprite is misused by two NewGRFs. Once as real sprite and once as recolour sprite. If the recolour sprite gets into the cache it might be drawn as real sprite which causes enormous trouble.
+	 * Bits 4 - 0:  SpriteType type  In some cases a single sprite is misused by two NewGRFs. Once as real sprite and once as recolour sprite. If the recolour sprite gets into the cache it might be drawn as real sprite which causes enormous trouble.
+	 * Bit      5:  bool referenced  True iff the sprite has been used since the clock hand last passed it.
+	 * Bit      6:  bool prefetching True iff the sprite is being decoded in the background.
 	 * Bit      7:  bool warned      True iff the user has been warned about incorrect use of this sprite.
 	 */
 	byte type_field;
@@ -103,15 +109,26 @@ PACK_N(struct SpriteCache {
 
 	void *GetPtr() { return this->buffer.GetPtr(); }
 
-	SpriteType GetType() const { return (SpriteType) GB(this->type_field, 0, 7); }
-	void SetType(SpriteType type) { SB(this->type_field, 0, 7, type); }
+	SpriteType GetType() const { return (SpriteType) GB(this->type_field, 0, 5); }
+	void SetType(SpriteType type) { SB(this->type_field, 0, 5, type); }
+	bool GetReferenced() const { return GB(this->type_field, 5, 1); }
+	void SetReferenced(bool referenced) { SB(this->type_field, 5, 1, referenced ? 1 : 0); }
+	bool GetPrefetching() const { return GB(this->type_field, 6, 1); }
+	void SetPrefetching(bool prefetching) { SB(this->type_field, 6, 1, prefetching ? 1 : 0); }
 	bool GetWarned() const { return GB(this->type_field, 7, 1); }
 	void SetWarned(bool warned) { SB(this->type_field, 7, 1, warned ? 1 : 0); }
 }, 4);
 assert_compile(sizeof(SpriteCache) <= 32);
 
 static std::vector<SpriteCache> _spritecache;
-static SpriteDataBuffer _last_sprite_allocation;
+static thread_local SpriteDataBuffer _last_sprite_allocation;
+
+/**
+ * Sprites with cached data which may be evicted, in the order the clock hand visits them.
+ * Recolour sprites are never evicted and thus never in here.
+ */
+static std::vector<SpriteID> _sprite_clock;
+static size_t _sprite_clock_hand = 0; ///< Position in #_sprite_clock of the next eviction candidate.
 
 static inline SpriteCache *GetSpriteCache(uint index)
 {
@@ -132,8 +149,6 @@ static SpriteCache *AllocateSpriteCache(uint index)
 	return GetSpriteCache(index);
 }
 
-static uint32 _sprite_lru_counter;
-
 static void *AllocSprite(size_t mem_req);
 
 /**
@@ -448,32 +463,32 @@ static void *ReadRecolourSprite(uint16 file_slot, uint num)
 	return dest;
 }
 
+/** Outcome of #DecodeSprite. */
+enum DecodeSpriteResult {
+	DSR_OK,            ///< The sprite was decoded.
+	DSR_LOAD_FAILED,   ///< The sprite could not be loaded.
+	DSR_RESIZE_FAILED, ///< The zoom levels of the sprite could not be made to match.
+};
+
 /**
- * Read a sprite from disk.
- * @param sc          Location of sprite.
- * @param id          Sprite number.
- * @param sprite_type Type of sprite.
- * @param allocator   Allocator function to use.
- * @return Read sprite data.
+ * Decode a sprite from disk.
+ * This does not access the sprite cache, so it may be called from any thread that uses its own Fio readers.
+ * @param file_slot      GRF the sprite is in.
+ * @param file_pos       Position of the sprite in the GRF.
+ * @param file_sprite_id Sprite number in the GRF, for diagnostics.
+ * @param container_ver  Container version of the GRF.
+ * @param sprite_type    Type of sprite.
+ * @param allocator      Allocator function to use.
+ * @param[out] result    Whether the sprite was decoded, or why not.
+ * @return Decoded sprite data, or nullptr on failure.
  */
-static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_type, AllocatorProc *allocator)
+static void *DecodeSprite(uint file_slot, size_t file_pos, uint32 file_sprite_id, byte container_ver, SpriteType sprite_type, AllocatorProc *allocator, DecodeSpriteResult &result)
 {
-	uint file_slot = sc->file_slot;
-	size_t file_pos = sc->file_pos;
-
-	SCOPE_INFO_FMT([&], "ReadSprite: pos: " PRINTF_SIZE ", id: %u, slot: %u (%s), type: %u", file_pos, id, file_slot, FioGetFilename(file_slot), sprite_type);
-
-	assert(sprite_type != ST_RECOLOUR);
-	assert(IsMapgenSpriteID(id) == (sprite_type == ST_MAPGEN));
-	assert(sc->GetType() == sprite_type);
-
-	DEBUG(sprite, 9, "Load sprite %d", id);
-
 	SpriteLoader::Sprite sprite[ZOOM_LVL_COUNT];
 	uint8 sprite_avail = 0;
 	sprite[ZOOM_LVL_NORMAL].type = sprite_type;
 
-	SpriteLoaderGrf sprite_loader(sc->container_ver);
+	SpriteLoaderGrf sprite_loader(container_ver);
 	if (sprite_type != ST_MAPGEN && BlitterFactory::GetCurrentBlitter()->GetScreenDepth() == 32) {
 		/* Try for 32bpp sprites first. */
 		sprite_avail = sprite_loader.LoadSprite(sprite, file_slot, file_pos, sprite_type, true);
@@ -483,10 +498,10 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 	}
 
 	if (sprite_avail == 0) {
-		if (sprite_type == ST_MAPGEN) return nullptr;
-		if (id == SPR_IMG_QUERY) usererror("Okay... something went horribly wrong. I couldn't load the fallback sprite. What should I do?");
-		return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
+		result = DSR_LOAD_FAILED;
+		return nullptr;
 	}
+	result = DSR_OK;
 
 	if (sprite_type == ST_MAPGEN) {
 		/* Ugly hack to work around the problem that the old landscape
@@ -516,9 +531,9 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 		return s;
 	}
 
-	if (!ResizeSprites(sprite, sprite_avail, file_slot, sc->id)) {
-		if (id == SPR_IMG_QUERY) usererror("Okay... something went horribly wrong. I couldn't resize the fallback sprite. What should I do?");
-		return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
+	if (!ResizeSprites(sprite, sprite_avail, file_slot, file_sprite_id)) {
+		result = DSR_RESIZE_FAILED;
+		return nullptr;
 	}
 
 	if (sprite->type == ST_FONT && ZOOM_LVL_FONT != ZOOM_LVL_NORMAL) {
@@ -533,6 +548,47 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 	return BlitterFactory::GetCurrentBlitter()->Encode(sprite, allocator);
 }
 
+/**
+ * Read a sprite from disk.
+ * @param sc          Location of sprite.
+ * @param id          Sprite number.
+ * @param sprite_type Type of sprite.
+ * @param allocator   Allocator function to use.
+ * @return Read sprite data.
+ */
+static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_type, AllocatorProc *allocator)
+{
+	uint file_slot = sc->file_slot;
+	size_t file_pos = sc->file_pos;
+
+	SCOPE_INFO_FMT([&], "ReadSprite: pos: " PRINTF_SIZE ", id: %u, slot: %u (%s), type: %u", file_pos, id, file_slot, FioGetFilename(file_slot), sprite_type);
+
+	assert(sprite_type != ST_RECOLOUR);
+	assert(IsMapgenSpriteID(id) == (sprite_type == ST_MAPGEN));
+	assert(sc->GetType() == sprite_type);
+
+	DEBUG(sprite, 9, "Load sprite %d", id);
+
+	DecodeSpriteResult result;
+	void *ptr = DecodeSprite(file_slot, file_pos, sc->id, sc->container_ver, sprite_type, allocator, result);
+	switch (result) {
+		case DSR_OK:
+			return ptr;
+
+		case DSR_LOAD_FAILED:
+			if (sprite_type == ST_MAPGEN) return nullptr;
+			if (id == SPR_IMG_QUERY) usererror("Okay... something went horribly wrong. I couldn't load the fallback sprite. What should I do?");
+			return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
+
+		case DSR_RESIZE_FAILED:
+			if (id == SPR_IMG_QUERY) usererror("Okay... something went horribly wrong. I couldn't resize the fallback sprite. What should I do?");
+			return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
+
+		default:
+			NOT_REACHED();
+	}
+}
+
 
 /** Map from sprite numbers to position in the GRF file. */
 static btree::btree_map<uint32, size_t> _grf_sprite_offsets;
@@ -643,7 +699,6 @@ bool LoadNextSprite(int load_index, uint file_slot, uint file_sprite_id, byte co
 		assert(data == _last_sprite_allocation.GetPtr());
 		sc->buffer = std::move(_last_sprite_allocation);
 	}
-	sc->lru = 0;
 	sc->id = file_sprite_id;
 	sc->SetType(type);
 	sc->SetWarned(false);
@@ -671,95 +726,262 @@ static size_t GetSpriteCacheUsage()
 	return _spritecache_bytes_used;
 }
 
+/**
+ * Mark a sprite as used, and make it a candidate for eviction if it is not yet.
+ * @param item Sprite with cached data.
+ * @param sc Sprite cache entry of the sprite.
+ */
+static void AddSpriteToClock(SpriteID item, SpriteCache *sc)
+{
+	sc->SetReferenced(true);
+	if (sc->clock_slot != UINT32_MAX || sc->GetType() == ST_RECOLOUR) return;
+
+	sc->clock_slot = (uint32)_sprite_clock.size();
+	_sprite_clock.push_back(item);
+}
+
+/**
+ * Remove a sprite from the eviction candidates.
+ * The last candidate takes its place, so the positions of the other candidates are unaffected.
+ * @param sc Sprite cache entry of the sprite.
+ */
+static void RemoveSpriteFromClock(SpriteCache *sc)
+{
+	const uint32 slot = sc->clock_slot;
+	if (slot == UINT32_MAX) return;
+	sc->clock_slot = UINT32_MAX;
+
+	const SpriteID last = _sprite_clock.back();
+	_sprite_clock.pop_back();
+	if (slot < _sprite_clock.size()) {
+		_sprite_clock[slot] = last;
+		GetSpriteCache(last)->clock_slot = slot;
+	}
+}
+
 /**
  * Delete a single entry from the sprite cache.
  * @param item Entry to delete.
  */
 static void DeleteEntryFromSpriteCache(uint item)
 {
-	GetSpriteCache(item)->buffer.Clear();
+	SpriteCache *sc = GetSpriteCache(item);
+	sc->buffer.Clear();
+	RemoveSpriteFromClock(sc);
 }
 
+/**
+ * Evict sprites from the sprite cache using the CLOCK algorithm.
+ * The hand sweeps over the eviction candidates, sprites which were used since the hand last passed
+ * them get a second chance, the others are evicted. Each eviction is therefore amortised O(1).
+ * @param target Number of bytes to free.
+ */
 static void DeleteEntriesFromSpriteCache(size_t target)
 {
 	const size_t initial_in_use = GetSpriteCacheUsage();
 
-	struct SpriteInfo {
-		uint32 lru;
-		SpriteID id;
-		uint32 size;
-
-		bool operator<(const SpriteInfo &other) const
-		{
-			return this->lru < other.lru;
+	size_t deleted = 0;
+	size_t freed = 0;
+
+	/* Every candidate is passed at most twice: once to take away its second chance and once to evict it. */
+	size_t steps = _sprite_clock.size() * 2;
+	while (freed < target && !_sprite_clock.empty() && steps-- > 0) {
+		if (_sprite_clock_hand >= _sprite_clock.size()) _sprite_clock_hand = 0;
+
+		const SpriteID item = _sprite_clock[_sprite_clock_hand];
+		SpriteCache *sc = GetSpriteCache(item);
+		if (sc->GetType() == ST_RECOLOUR) {
+			/* Replaced by a recolour sprite, which must stay cached. */
+			RemoveSpriteFromClock(sc);
+		} else if (sc->GetReferenced()) {
+			sc->SetReferenced(false);
+			_sprite_clock_hand++;
+		} else {
+			/* The last candidate moves to the position of the evicted sprite, so the hand stays where it is. */
+			freed += sc->buffer.GetSize();
+			deleted++;
+			DeleteEntryFromSpriteCache(item);
 		}
-	};
-	std::vector<SpriteInfo> candidates;
-	size_t candidate_bytes = 0;
+	}
 
-	auto push = [&](SpriteInfo info) {
-		candidates.push_back(info);
-		std::push_heap(candidates.begin(), candidates.end());
-		candidate_bytes += info.size;
-	};
+	DEBUG(sprite, 3, "DeleteEntriesFromSpriteCache, deleted: " PRINTF_SIZE ", freed: " PRINTF_SIZE ", in use: " PRINTF_SIZE " --> " PRINTF_SIZE ", requested: " PRINTF_SIZE,
+			deleted, freed, initial_in_use, GetSpriteCacheUsage(), target);
+}
 
-	auto pop = [&]() {
-		candidate_bytes -= candidates.front().size;
-		std::pop_heap(candidates.begin(), candidates.end());
-		candidates.pop_back();
-	};
+/** Sprite to decode in the background. */
+struct SpritePrefetchRequest {
+	size_t file_pos;       ///< Position of the sprite in the GRF.
+	SpriteID id;           ///< Sprite number.
+	uint32 file_sprite_id; ///< Sprite number in the GRF.
+	uint16 file_slot;      ///< GRF the sprite is in.
+	byte container_ver;    ///< Container version of the GRF.
+};
+
+/** Sprite decoded in the background, waiting to be moved into the sprite cache by the main thread. */
+struct PrefetchedSprite {
+	SpriteID id;             ///< Sprite number.
+	SpriteDataBuffer buffer; ///< Encoded sprite, empty if the sprite must be decoded on the main thread instead.
+};
+
+/** Shard of the sprites decoded in the background, sprites are spread over the shards by number so that jobs rarely contend. */
+struct PrefetchedSpriteShard {
+	std::mutex lock;                       ///< Lock for #sprites.
+	std::vector<PrefetchedSprite> sprites; ///< Decoded sprites.
+};
+
+static const uint PREFETCHED_SPRITE_SHARDS = 16;   ///< Number of shards of decoded sprites.
+static const uint SPRITE_PREFETCH_BATCH_SIZE = 16; ///< Maximum number of sprites decoded by a single job.
+
+static PrefetchedSpriteShard _prefetched_sprites[PREFETCHED_SPRITE_SHARDS];
+static std::atomic<uint> _prefetched_sprite_count(0); ///< Number of sprites in #_prefetched_sprites.
+static uint _sprite_prefetch_jobs = 0;                 ///< Number of unfinished prefetch jobs.
+static std::mutex _sprite_prefetch_lock;              ///< Lock for #_sprite_prefetch_jobs.
+static std::condition_variable _sprite_prefetch_cv;   ///< Signalled when the last unfinished prefetch job finishes.
 
-	SpriteID i = 0;
-	for (; i != _spritecache.size() && candidate_bytes < target; i++) {
-		SpriteCache *sc = GetSpriteCache(i);
-		if (sc->GetType() != ST_RECOLOUR && sc->GetPtr() != nullptr) {
-			push({ sc->lru, i, sc->buffer.GetSize() });
-			if (candidate_bytes >= target) break;
+/**
+ * Job decoding a batch of sprites on a worker thread.
+ * @param data Batch of #SpritePrefetchRequest, owned by the job.
+ */
+static void SpritePrefetchJob(void *data, void *, void *)
+{
+	std::unique_ptr<std::vector<SpritePrefetchRequest>> batch(static_cast<std::vector<SpritePrefetchRequest> *>(data));
+
+	{
+		FioThreadReadScope fio_scope;
+		for (const SpritePrefetchRequest &req : *batch) {
+			const uint diagnostics = GetSuppressedSpriteDiagnosticCount();
+
+			DecodeSpriteResult result;
+			DecodeSprite(req.file_slot, req.file_pos, req.file_sprite_id, req.container_ver, ST_NORMAL, AllocSprite, result);
+
+			PrefetchedSprite prefetched;
+			prefetched.id = req.id;
+			/* Leave sprites which failed to decode, or have something to report, to the main thread. */
+			if (result == DSR_OK && GetSuppressedSpriteDiagnosticCount() == diagnostics) prefetched.buffer = std::move(_last_sprite_allocation);
+			_last_sprite_allocation.Clear();
+
+			PrefetchedSpriteShard &shard = _prefetched_sprites[req.id % PREFETCHED_SPRITE_SHARDS];
+			std::lock_guard<std::mutex> lk(shard.lock);
+			shard.sprites.push_back(std::move(prefetched));
+			_prefetched_sprite_count++;
 		}
 	}
-	for (; i != _spritecache.size(); i++) {
-		SpriteCache *sc = GetSpriteCache(i);
-		if (sc->GetType() != ST_RECOLOUR && sc->GetPtr() != nullptr && sc->lru <= candidates.front().lru) {
-			push({ sc->lru, i, sc->buffer.GetSize() });
-			while (!candidates.empty() && candidate_bytes - candidates.front().size >= target) {
-				pop();
-			}
-		}
+
+	std::lock_guard<std::mutex> lk(_sprite_prefetch_lock);
+	if (--_sprite_prefetch_jobs == 0) _sprite_prefetch_cv.notify_all();
+}
+
+/**
+ * Hand a batch of sprites to the worker threads for decoding.
+ * @param batch Sprites to decode.
+ */
+static void StartSpritePrefetchJob(std::unique_ptr<std::vector<SpritePrefetchRequest>> &batch)
+{
+	{
+		std::lock_guard<std::mutex> lk(_sprite_prefetch_lock);
+		_sprite_prefetch_jobs++;
 	}
+	_general_worker_pool.EnqueueJob(SpritePrefetchJob, batch.release());
+}
 
-	for (auto &it : candidates) {
-		DeleteEntryFromSpriteCache(it.id);
+/**
+ * Move the sprites of a shard that were decoded in the background into the sprite cache.
+ * @param shard Shard to collect.
+ */
+static void CollectPrefetchedSprites(PrefetchedSpriteShard &shard)
+{
+	std::vector<PrefetchedSprite> sprites;
+	{
+		std::lock_guard<std::mutex> lk(shard.lock);
+		sprites.swap(shard.sprites);
 	}
+	_prefetched_sprite_count -= (uint)sprites.size();
 
-	DEBUG(sprite, 3, "DeleteEntriesFromSpriteCache, deleted: " PRINTF_SIZE ", freed: " PRINTF_SIZE ", in use: " PRINTF_SIZE " --> " PRINTF_SIZE ", delta: " PRINTF_SIZE ", requested: " PRINTF_SIZE,
-			candidates.size(), candidate_bytes, initial_in_use, GetSpriteCacheUsage(), initial_in_use - GetSpriteCacheUsage(), target);
+	for (PrefetchedSprite &prefetched : sprites) {
+		SpriteCache *sc = GetSpriteCache(prefetched.id);
+		sc->SetPrefetching(false);
+
+		/* The main thread may have needed the sprite before the job finished, and decoded it itself. */
+		if (sc->GetPtr() != nullptr || prefetched.buffer.GetPtr() == nullptr) continue;
+
+		sc->buffer = std::move(prefetched.buffer);
+		AddSpriteToClock(prefetched.id, sc);
+	}
 }
 
-void IncreaseSpriteLRU()
+/** Move all sprites that were decoded in the background into the sprite cache. */
+static void CollectPrefetchedSprites()
 {
-	int bpp = BlitterFactory::GetCurrentBlitter()->GetScreenDepth();
-	uint target_size = (bpp > 0 ? _sprite_cache_size * bpp / 8 : 1) * 1024 * 1024;
-	if (_spritecache_bytes_used > target_size) {
-		DeleteEntriesFromSpriteCache(_spritecache_bytes_used - target_size + 512 * 1024);
+	if (_prefetched_sprite_count == 0) return;
+
+	for (PrefetchedSpriteShard &shard : _prefetched_sprites) {
+		CollectPrefetchedSprites(shard);
 	}
+}
 
-	/* Increase all LRU values */
-	if (_sprite_lru_counter >= 0xC0000000) {
-		SpriteID i;
+/**
+ * Wait for all background decoding to finish, and throw away its results.
+ * This must be done before anything the decoding depends on changes, e.g. the blitter or the location of the sprites.
+ */
+void DiscardPrefetchedSprites()
+{
+	{
+		std::unique_lock<std::mutex> lk(_sprite_prefetch_lock);
+		_sprite_prefetch_cv.wait(lk, []() { return _sprite_prefetch_jobs == 0; });
+	}
 
-		DEBUG(sprite, 3, "Fixing lru %u, inuse=" PRINTF_SIZE, _sprite_lru_counter, GetSpriteCacheUsage());
+	for (PrefetchedSpriteShard &shard : _prefetched_sprites) {
+		for (const PrefetchedSprite &prefetched : shard.sprites) {
+			GetSpriteCache(prefetched.id)->SetPrefetching(false);
+		}
+		shard.sprites.clear();
+	}
+	_prefetched_sprite_count = 0;
+}
 
-		for (i = 0; i != _spritecache.size(); i++) {
-			SpriteCache *sc = GetSpriteCache(i);
-			if (sc->GetPtr() != nullptr) {
-				if (sc->lru > 0x80000000) {
-					sc->lru -= 0x80000000;
-				} else {
-					sc->lru = 0;
-				}
-			}
+/**
+ * Start decoding sprites on the worker threads, so that they are likely to be in the sprite cache by the time they are drawn.
+ * Sprites which are already cached or being decoded, and sprites which are not normal sprites, are skipped.
+ * A sprite which is needed before its job has finished is decoded by the main thread as usual.
+ * The jobs are started in order, so the sprites should be passed in the reverse order of their expected use.
+ * @param sprites Sprites to decode.
+ * @param count Number of sprites.
+ */
+void PrefetchSprites(const SpriteID *sprites, size_t count)
+{
+	if (!_settings_client.gui.background_sprite_decode || _general_worker_pool.GetWorkerCount() == 0) return;
+
+	CollectPrefetchedSprites();
+
+	std::unique_ptr<std::vector<SpritePrefetchRequest>> batch;
+	for (size_t i = 0; i < count; i++) {
+		const SpriteID id = sprites[i];
+		if (!SpriteExists(id)) continue;
+
+		SpriteCache *sc = GetSpriteCache(id);
+		if (sc->GetType() != ST_NORMAL || sc->GetPtr() != nullptr || sc->GetPrefetching()) continue;
+		sc->SetPrefetching(true);
+
+		if (!batch) {
+			batch.reset(new std::vector<SpritePrefetchRequest>());
+			batch->reserve(SPRITE_PREFETCH_BATCH_SIZE);
 		}
-		_sprite_lru_counter -= 0x80000000;
+		batch->push_back({ sc->file_pos, id, sc->id, sc->file_slot, sc->container_ver });
+		if (batch->size() == SPRITE_PREFETCH_BATCH_SIZE) StartSpritePrefetchJob(batch);
+	}
+	if (batch) StartSpritePrefetchJob(batch);
+}
+
+/** Keep the sprite cache within its size limit, and take in the sprites decoded in the background. Called every game loop. */
+void UpdateSpriteCache()
+{
+	CollectPrefetchedSprites();
+
+	int bpp = BlitterFactory::GetCurrentBlitter()->GetScreenDepth();
+	uint target_size = (bpp > 0 ? _sprite_cache_size * bpp / 8 : 1) * 1024 * 1024;
+	const size_t in_use = GetSpriteCacheUsage();
+	if (in_use > target_size) {
+		DeleteEntriesFromSpriteCache(in_use - target_size + 512 * 1024);
 	}
 }
 
@@ -842,14 +1064,21 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator)
 	if (allocator == nullptr) {
 		/* Load sprite into/from spritecache */
 
-		/* Update LRU */
-		sc->lru = ++_sprite_lru_counter;
+		/* Give the sprite a second chance when the clock hand passes it.
+		 * Only write when needed, so that cached sprites can be read by several threads at once. */
+		if (!sc->GetReferenced()) sc->SetReferenced(true);
+
+		/* Take the sprite from the background decoding, if it is there already */
+		if (sc->GetPtr() == nullptr && sc->GetPrefetching()) {
+			CollectPrefetchedSprites(_prefetched_sprites[sprite % PREFETCHED_SPRITE_SHARDS]);
+		}
 
 		/* Load the sprite, if it is not loaded, yet */
 		if (sc->GetPtr() == nullptr) {
 			void *ptr = ReadSprite(sc, sprite, type, AllocSprite);
 			assert(ptr == _last_sprite_allocation.GetPtr());
 			sc->buffer = std::move(_last_sprite_allocation);
+			AddSpriteToClock(sprite, sc);
 		}
 
 		return sc->GetPtr();
@@ -958,8 +1187,12 @@ uint32 GetSpriteMainColour(SpriteID sprite_id, PaletteID palette_id)
 
 void GfxInitSpriteMem()
 {
+	DiscardPrefetchedSprites();
+
 	/* Reset the spritecache 'pool' */
 	_spritecache.clear();
+	_sprite_clock.clear();
+	_sprite_clock_hand = 0;
 	assert(_spritecache_bytes_used == 0);
 }
 
@@ -969,6 +1202,8 @@ void GfxInitSpriteMem()
  */
 void GfxClearSpriteCache()
 {
+	DiscardPrefetchedSprites();
+
 	/* Clear sprite ptr for all cached items */
 	for (uint i = 0; i != _spritecache.size(); i++) {
 		SpriteCache *sc = GetSpriteCache(i);
@@ -976,4 +1211,4 @@ void GfxClearSpriteCache()
 	}
 }
 
-/* static */ ReusableBuffer<SpriteLoader::CommonPixel> SpriteLoader::Sprite::buffer[ZOOM_LVL_COUNT];
+/* static */ thread_local ReusableBuffer<SpriteLoader::CommonPixel> SpriteLoader::Sprite::buffer[ZOOM_LVL_COUNT];
@@ -49,7 +49,9 @@ static inline const byte *GetNonSprite(SpriteID sprite, SpriteType type)
 
 void GfxInitSpriteMem();
 void GfxClearSpriteCache();
-void IncreaseSpriteLRU();
+void UpdateSpriteCache();
+void PrefetchSprites(const SpriteID *sprites, size_t count);
+void DiscardPrefetchedSprites();
 
 void ReadGRFSpriteOffsets(byte container_version);
 size_t GetGRFSpriteOffset(uint32 id);
@@ -17,6 +17,7 @@
 #include "../core/math_func.hpp"
 #include "../core/alloc_type.hpp"
 #include "../core/bitmath_func.hpp"
+#include "../thread.h"
 #include "grf.hpp"
 
 #include "../safeguards.h"
@@ -32,6 +33,31 @@ enum SpriteColourComponent {
 };
 DECLARE_ENUM_AS_BIT_SET(SpriteColourComponent)
 
+/** Number of sprite diagnostics that were suppressed on the current thread. */
+static thread_local uint _suppressed_sprite_diagnostics = 0;
+
+/**
+ * Check whether diagnostics about a sprite can be shown from the current thread.
+ * Only the main thread can show them, other threads count them instead.
+ * @return True iff the diagnostic should be shown.
+ */
+static bool CanShowSpriteDiagnostic()
+{
+	if (IsMainThread()) return true;
+	_suppressed_sprite_diagnostics++;
+	return false;
+}
+
+/**
+ * Get the number of sprite diagnostics that were suppressed on the current thread, because they could only be shown from the main thread.
+ * A sprite that is decoded while this changes must be decoded again on the main thread for the diagnostics to be shown.
+ * @return Number of suppressed diagnostics.
+ */
+uint GetSuppressedSpriteDiagnosticCount()
+{
+	return _suppressed_sprite_diagnostics;
+}
+
 /**
  * We found a corrupted sprite. This means that the sprite itself
  * contains invalid data or is too small for the given dimensions.
@@ -42,6 +68,8 @@ DECLARE_ENUM_AS_BIT_SET(SpriteColourComponent)
  */
 static bool WarnCorruptSprite(uint file_slot, size_t file_pos, int line)
 {
+	if (!CanShowSpriteDiagnostic()) return false;
+
 	static byte warning_level = 0;
 	if (warning_level == 0) {
 		SetDParamStr(0, FioGetFilename(file_slot));
@@ -180,7 +208,7 @@ bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint file_slot, size_t fil
 			return WarnCorruptSprite(file_slot, file_pos, __LINE__);
 		}
 
-		if (dest_size > sprite->width * sprite->height * bpp) {
+		if (dest_size > sprite->width * sprite->height * bpp && CanShowSpriteDiagnostic()) {
 			static byte warning_level = 0;
 			DEBUG(sprite, warning_level, "Ignoring " OTTD_PRINTF64 " unused extra bytes from the sprite from %s at position %i", dest_size - sprite->width * sprite->height * bpp, FioGetFilename(file_slot), (int)file_pos);
 			warning_level = 6;
@@ -282,7 +310,7 @@ uint8 LoadSpriteV2(SpriteLoader::Sprite *sprite, uint file_slot, size_t file_pos
 
 			if (HasBit(loaded_sprites, zoom_lvl)) {
 				/* We already have this zoom level, skip sprite. */
-				DEBUG(sprite, 1, "Ignoring duplicate zoom level sprite %u from %s", id, FioGetFilename(file_slot));
+				if (CanShowSpriteDiagnostic()) DEBUG(sprite, 1, "Ignoring duplicate zoom level sprite %u from %s", id, FioGetFilename(file_slot));
 				FioSkipBytes(num - 2);
 				continue;
 			}
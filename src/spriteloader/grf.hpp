@@ -20,4 +20,6 @@ public:
 	uint8 LoadSprite(SpriteLoader::Sprite *sprite, uint file_slot, size_t file_pos, SpriteType sprite_type, bool load_32bpp);
 };
 
+uint GetSuppressedSpriteDiagnosticCount();
+
 #endif /* SPRITELOADER_GRF_HPP */
@@ -40,6 +40,7 @@ INSTANTIATE_POOL_METHODS(Station)
 
 
 StationKdtree _station_kdtree(Kdtree_StationXYFunc);
+StationCatchmentIndex _station_catchment_index;
 
 void RebuildStationKdtree()
 {
@@ -135,6 +136,7 @@ Station::~Station()
 
 	/* Remove station from industries and towns that reference it. */
 	this->RemoveFromAllNearbyLists();
+	this->RemoveFromCatchmentIndex();
 
 	/* Clear the persistent storage. */
 	delete this->airport.psa;
@@ -418,38 +420,54 @@ bool Station::CatchmentCoversTown(TownID t) const
 }
 
 /**
- * Recompute tiles covered in our catchment area.
- * This will additionally recompute nearby towns and industries.
+ * Add the tiles covered by our catchment area to the map-wide catchment index.
  */
-void Station::RecomputeCatchment(bool no_clear_nearby_lists)
+void Station::AddToCatchmentIndex() const
 {
-	this->industries_near.clear();
-	if (!no_clear_nearby_lists) this->RemoveFromAllNearbyLists();
+	if (this->catchment_tiles.tile == INVALID_TILE) return;
+
+	BitmapTileIterator it(this->catchment_tiles);
+	for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
+		_station_catchment_index.insert(std::make_pair(tile, this->index));
+	}
+}
+
+/**
+ * Remove the tiles covered by our catchment area from the map-wide catchment index.
+ */
+void Station::RemoveFromCatchmentIndex() const
+{
+	if (this->catchment_tiles.tile == INVALID_TILE) return;
 
+	BitmapTileIterator it(this->catchment_tiles);
+	for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
+		_station_catchment_index.erase(std::make_pair(tile, this->index));
+	}
+}
+
+/**
+ * Compute the tiles covered in our catchment area, without updating any caches.
+ * @param[out] catchment_tiles The tiles covered in our catchment area.
+ */
+void Station::ComputeCatchmentTiles(BitmapTileArea &catchment_tiles) const
+{
 	if (this->rect.IsEmpty()) {
-		this->catchment_tiles.Reset();
+		catchment_tiles.Reset();
 		return;
 	}
 
 	if (!_settings_game.station.serve_neutral_industries && this->industry != nullptr) {
 		/* Station is associated with an industry, so we only need to deliver to that industry. */
-		this->catchment_tiles.Initialize(this->industry->location);
+		catchment_tiles.Initialize(this->industry->location);
 		TILE_AREA_LOOP(tile, this->industry->location) {
 			if (IsTileType(tile, MP_INDUSTRY) && GetIndustryIndex(tile) == this->industry->index) {
-				this->catchment_tiles.SetTile(tile);
+				catchment_tiles.SetTile(tile);
 			}
 		}
-		/* The industry's stations_near may have been computed before its neutral station was built so clear and re-add here. */
-		for (Station *st : this->industry->stations_near) {
-			st->industries_near.erase(this->industry);
-		}
-		this->industry->stations_near.clear();
-		this->industry->stations_near.insert(this);
-		this->industries_near.insert(this->industry);
 		return;
 	}
 
-	this->catchment_tiles.Initialize(GetCatchmentRect());
+	catchment_tiles.Initialize(GetCatchmentRect());
 
 	/* Loop finding all station tiles */
 	TileArea ta(TileXY(this->rect.left, this->rect.top), TileXY(this->rect.right, this->rect.bottom));
@@ -461,8 +479,36 @@ void Station::RecomputeCatchment(bool no_clear_nearby_lists)
 
 		/* This tile sub-loop doesn't need to test any tiles, they are simply added to the catchment set. */
 		TileArea ta2 = TileArea(tile, 1, 1).Expand(r);
-		TILE_AREA_LOOP(tile2, ta2) this->catchment_tiles.SetTile(tile2);
+		TILE_AREA_LOOP(tile2, ta2) catchment_tiles.SetTile(tile2);
 	}
+}
+
+/**
+ * Recompute tiles covered in our catchment area.
+ * This will additionally recompute nearby towns and industries, and the catchment index.
+ */
+void Station::RecomputeCatchment(bool no_clear_nearby_lists)
+{
+	this->industries_near.clear();
+	if (!no_clear_nearby_lists) this->RemoveFromAllNearbyLists();
+	this->RemoveFromCatchmentIndex();
+
+	this->ComputeCatchmentTiles(this->catchment_tiles);
+	if (this->rect.IsEmpty()) return;
+
+	if (!_settings_game.station.serve_neutral_industries && this->industry != nullptr) {
+		/* The industry's stations_near may have been computed before its neutral station was built so clear and re-add here. */
+		for (Station *st : this->industry->stations_near) {
+			st->industries_near.erase(this->industry);
+		}
+		this->industry->stations_near.clear();
+		this->industry->stations_near.insert(this);
+		this->industries_near.insert(this->industry);
+		this->AddToCatchmentIndex();
+		return;
+	}
+
+	this->AddToCatchmentIndex();
 
 	/* Search catchment tiles for towns and industries */
 	BitmapTileIterator it(this->catchment_tiles);
@@ -487,10 +533,11 @@ void Station::RecomputeCatchment(bool no_clear_nearby_lists)
 
 /**
  * Recomputes catchment of all stations.
- * This will additionally recompute nearby stations for all towns and industries.
+ * This will additionally recompute nearby stations for all towns and industries, and rebuild the catchment index.
  */
 /* static */ void Station::RecomputeCatchmentForAll()
 {
+	_station_catchment_index.clear();
 	for (Town *t : Town::Iterate()) { t->stations_near.clear(); }
 	for (Industry *i : Industry::Iterate()) { i->stations_near.clear(); }
 	for (Station *st : Station::Iterate()) { st->RecomputeCatchment(true); }
@@ -812,6 +812,7 @@ public:
 
 	uint GetPlatformLength(TileIndex tile, DiagDirection dir) const override;
 	uint GetPlatformLength(TileIndex tile) const override;
+	void ComputeCatchmentTiles(BitmapTileArea &catchment_tiles) const;
 	void RecomputeCatchment(bool no_clear_nearby_lists = false);
 	static void RecomputeCatchmentForAll();
 
@@ -824,6 +825,8 @@ public:
 
 	bool CatchmentCoversTown(TownID t) const;
 	void RemoveFromAllNearbyLists();
+	void AddToCatchmentIndex() const;
+	void RemoveFromCatchmentIndex() const;
 
 	inline bool TileIsInCatchment(TileIndex tile) const
 	{
@@ -879,4 +882,8 @@ public:
 
 void RebuildStationKdtree();
 
+/** Map-wide index of the stations whose catchment covers a tile, as (tile, station) pairs ordered by tile. */
+typedef btree::btree_set<std::pair<TileIndex, StationID>> StationCatchmentIndex;
+extern StationCatchmentIndex _station_catchment_index;
+
 #endif /* STATION_BASE_H */
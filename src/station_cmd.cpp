@@ -1542,9 +1542,9 @@ CommandCost CmdBuildRailStation(TileIndex tile_org, DoCommandFlag flags, uint32
 				tile += tile_delta;
 			} while (--w);
 			AddTrackToSignalBuffer(tile_track, track, _current_company);
-			YapfNotifyTrackLayoutChange(tile_track, track);
 			tile_track += tile_delta ^ TileDiffXY(1, 1); // perpendicular to tile_delta
 		} while (--numtracks);
+		YapfNotifyTrackLayoutChange(new_location);
 
 		for (uint i = 0; i < affected_vehicles.size(); ++i) {
 			/* Restore reservations of trains. */
@@ -2091,16 +2091,14 @@ CommandCost CmdBuildRoadStop(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 
 static Vehicle *ClearRoadStopStatusEnum(Vehicle *v, void *)
 {
-	if (v->type == VEH_ROAD) {
-		/* Okay... we are a road vehicle on a drive through road stop.
-		 * But that road stop has just been removed, so we need to make
-		 * sure we are in a valid state... however, vehicles can also
-		 * turn on road stop tiles, so only clear the 'road stop' state
-		 * bits and only when the state was 'in road stop', otherwise
-		 * we'll end up clearing the turn around bits. */
-		RoadVehicle *rv = RoadVehicle::From(v);
-		if (HasBit(rv->state, RVS_IN_DT_ROAD_STOP)) rv->state &= RVSB_ROAD_STOP_TRACKDIR_MASK;
-	}
+	/* Okay... we are a road vehicle on a drive through road stop.
+	 * But that road stop has just been removed, so we need to make
+	 * sure we are in a valid state... however, vehicles can also
+	 * turn on road stop tiles, so only clear the 'road stop' state
+	 * bits and only when the state was 'in road stop', otherwise
+	 * we'll end up clearing the turn around bits. */
+	RoadVehicle *rv = RoadVehicle::From(v);
+	if (HasBit(rv->state, RVS_IN_DT_ROAD_STOP)) rv->state &= RVSB_ROAD_STOP_TRACKDIR_MASK;
 
 	return nullptr;
 }
@@ -2138,7 +2136,7 @@ static CommandCost RemoveRoadStop(TileIndex tile, DoCommandFlag flags)
 	/* don't do the check for drive-through road stops when company bankrupts */
 	if (IsDriveThroughStopTile(tile) && (flags & DC_BANKRUPT)) {
 		/* remove the 'going through road stop' status from all vehicles on that tile */
-		if (flags & DC_EXEC) FindVehicleOnPos(tile, nullptr, &ClearRoadStopStatusEnum);
+		if (flags & DC_EXEC) FindVehicleOnPos(tile, VEH_ROAD, nullptr, &ClearRoadStopStatusEnum);
 	} else {
 		CommandCost ret = EnsureNoVehicleOnGround(tile);
 		if (ret.Failed()) return ret;
@@ -3519,16 +3517,17 @@ static void TileLoop_Station(TileIndex tile)
 }
 
 
-void AnimateTile_Station(TileIndex tile)
+uint8 AnimateTile_Station(TileIndex tile)
 {
 	if (HasStationRail(tile)) {
-		AnimateStationTile(tile);
-		return;
+		return AnimateStationTile(tile);
 	}
 
 	if (IsAirport(tile)) {
-		AnimateAirportTile(tile);
+		return AnimateAirportTile(tile);
 	}
+
+	return 0;
 }
 
 
@@ -4183,63 +4182,37 @@ CommandCost CmdRenameStation(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 	return CommandCost();
 }
 
-static void AddNearbyStationsByCatchment(TileIndex tile, StationList *stations, StationList &nearby)
-{
-	for (Station *st : nearby) {
-		if (st->TileIsInCatchment(tile)) stations->insert(st);
-	}
-}
-
 /**
  * Find all stations around a rectangular producer (industry, house, headquarter, ...)
  *
+ * The stations are looked up in the catchment index, so this only costs a lookup per row
+ * of the producer, plus the number of stations covering its tiles.
  * @param location The location/area of the producer
  * @param[out] stations The list to store the stations in
- * @param use_nearby Use nearby station list of industry/town associated with location.tile
+ * @param use_nearby Use nearby station list of industry associated with location.tile
+ * @param industry_filter Only consider the tiles of this industry, if not INVALID_INDUSTRY
  */
 void FindStationsAroundTiles(const TileArea &location, StationList * const stations, bool use_nearby, const IndustryID industry_filter)
 {
-	if (use_nearby) {
-		/* Industries and towns maintain a list of nearby stations */
-		if (IsTileType(location.tile, MP_INDUSTRY)) {
-			/* Industry nearby stations are already filtered by catchment. */
-			*stations = Industry::GetByTile(location.tile)->stations_near;
-			return;
-		} else if (IsTileType(location.tile, MP_HOUSE)) {
-			/* Town nearby stations need to be filtered per tile. */
-			assert(location.w == 1 && location.h == 1);
-			AddNearbyStationsByCatchment(location.tile, stations, Town::GetByTile(location.tile)->stations_near);
-			return;
-		}
+	if (use_nearby && IsTileType(location.tile, MP_INDUSTRY)) {
+		/* Industry nearby stations are already filtered by catchment. */
+		*stations = Industry::GetByTile(location.tile)->stations_near;
+		return;
 	}
 
-	/* Not using, or don't have a nearby stations list, so we need to scan. */
-
-	btree::btree_set<StationID> seen_stations;
-
-	/* Scan an area around the building covering the maximum possible station
-	 * to find the possible nearby stations. */
-	uint max_c = _settings_game.station.modified_catchment ? MAX_CATCHMENT : CA_UNMODIFIED;
-	max_c += _settings_game.station.catchment_increase;
-	TileArea ta = TileArea(location).Expand(max_c);
-	TILE_AREA_LOOP(tile, ta) {
-		if (IsTileType(tile, MP_STATION)) seen_stations.insert(GetStationIndex(tile));
-	}
+	const uint x = TileX(location.tile);
+	for (uint y = TileY(location.tile); y < TileY(location.tile) + location.h; y++) {
+		const TileIndex row_end = TileXY(x + location.w - 1, y);
+		for (auto it = _station_catchment_index.lower_bound(std::make_pair(TileXY(x, y), (StationID)0)); it != _station_catchment_index.end() && it->first <= row_end; ++it) {
+			const TileIndex tile = it->first;
+			if (industry_filter != INVALID_INDUSTRY && (!IsTileType(tile, MP_INDUSTRY) || GetIndustryIndex(tile) != industry_filter)) continue;
 
-	for (StationID stationid : seen_stations) {
-		Station *st = Station::GetIfValid(stationid);
-		if (st == nullptr) continue; /* Waypoint */
+			Station *st = Station::Get(it->second);
 
-		/* Check if station is attached to an industry */
-		if (!_settings_game.station.serve_neutral_industries && st->industry != nullptr) continue;
+			/* Check if station is attached to an industry */
+			if (!_settings_game.station.serve_neutral_industries && st->industry != nullptr) continue;
 
-		/* Test if the tile is within the station's catchment */
-		TILE_AREA_LOOP(tile, location) {
-			if (industry_filter != INVALID_INDUSTRY && (!IsTileType(tile, MP_INDUSTRY) || GetIndustryIndex(tile) != industry_filter)) continue;
-			if (st->TileIsInCatchment(tile)) {
-				stations->insert(st);
-				break;
-			}
+			stations->insert(st);
 		}
 	}
 }
@@ -5037,6 +5010,7 @@ extern const TileTypeProcs _tile_type_station_procs = {
 	ClickTile_Station,          // click_tile_proc
 	AnimateTile_Station,        // animate_tile_proc
 	TileLoop_Station,           // tile_loop_proc
+	nullptr,                    // tile_loop_parallel_proc
 	ChangeTileOwner_Station,    // change_tile_owner_proc
 	nullptr,                       // add_produced_cargo_proc
 	VehicleEnter_Station,       // vehicle_enter_tile_proc
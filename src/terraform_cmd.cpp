@@ -16,6 +16,7 @@
 #include "object_base.h"
 #include "company_base.h"
 #include "company_func.h"
+#include "pathfinder/yapf/yapf_cache.h"
 
 #include "table/strings.h"
 
@@ -310,6 +311,8 @@ CommandCost CmdTerraformLand(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 		/* Mark affected areas dirty. */
 		for (TileIndexSet::const_iterator it = ts.dirty_tiles.begin(); it != ts.dirty_tiles.end(); it++) {
 			MarkTileDirtyByTile(*it);
+			/* The slope of the tile changes, which changes the cost of track on it. */
+			YapfNotifyTrackLayoutChange(*it, INVALID_TRACK);
 			TileIndexToHeightMap::const_iterator new_height = ts.tile_to_new_height.find(tile);
 			if (new_height == ts.tile_to_new_height.end()) continue;
 			MarkTileDirtyByTile(*it, ZOOM_LVL_END, 0, new_height->second);
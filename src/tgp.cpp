@@ -14,6 +14,11 @@
 #include "genworld.h"
 #include "core/random_func.hpp"
 #include "landscape_type.h"
+#include "string_func.h"
+#include "worker_thread.h"
+#include <chrono>
+#include <functional>
+#include <vector>
 
 #include "safeguards.h"
 
@@ -201,6 +206,38 @@ static HeightMap _height_map = {nullptr, 0, 0, 0, 0};
 /** Walk through all items of _height_map.h */
 #define FOR_ALL_TILES_IN_HEIGHT(h) for (h = _height_map.h; h < &_height_map.h[_height_map.total_size]; h++)
 
+/** Number of height map rows (or columns) per job of the passes that are spread over the worker threads. */
+static const int TGP_PARALLEL_ROWS = 16;
+
+/** Maximum number of partial results of the reductions over the height map. */
+static const int TGP_MAX_PARTIAL_RESULTS = 64;
+
+/** Run all passes on the calling thread, used as reference by the benchmark. */
+static bool _tgp_single_threaded = false;
+
+/**
+ * Call \a func for stripes of the range [0, \a count), spread over the worker threads.
+ * The passes that are run this way only write to the rows or columns of their stripe, and only read
+ * what no other stripe writes, so the resulting height map does not depend on the number of threads.
+ * @param count Number of rows or columns.
+ * @param chunk_size Maximum number of rows or columns per stripe.
+ * @param func Function to call, with the signature void(int begin, int end).
+ */
+template <typename F>
+static void HeightMapParallelFor(int count, int chunk_size, F func)
+{
+	if (_tgp_single_threaded) {
+		if (count > 0) func(0, count);
+		return;
+	}
+	_general_worker_pool.ParallelFor(count, chunk_size, [&func](size_t begin, size_t end) {
+		func((int)begin, (int)end);
+	});
+}
+
+/** Callback for the end of each phase of the height map generation, to report progress or to time the phases. */
+typedef std::function<void(const char *phase)> HeightMapPhaseCallback;
+
 /** Maximum number of TGP noise frequencies. */
 static const int MAX_TGP_FREQUENCIES = 10;
 
@@ -376,26 +413,31 @@ static void HeightMapGenerate()
 
 		/* It is regular iteration round.
 		 * Interpolate height values at odd x, even y tiles */
-		for (int y = 0; y <= _height_map.size_y; y += 2 * step) {
-			for (int x = 0; x <= _height_map.size_x - 2 * step; x += 2 * step) {
-				height_t h00 = _height_map.height(x + 0 * step, y);
-				height_t h02 = _height_map.height(x + 2 * step, y);
-				height_t h01 = (h00 + h02) / 2;
-				_height_map.height(x + 1 * step, y) = h01;
+		HeightMapParallelFor(_height_map.size_y / (2 * step) + 1, TGP_PARALLEL_ROWS, [step](int begin, int end) {
+			for (int y = begin * 2 * step; y < end * 2 * step; y += 2 * step) {
+				for (int x = 0; x <= _height_map.size_x - 2 * step; x += 2 * step) {
+					height_t h00 = _height_map.height(x + 0 * step, y);
+					height_t h02 = _height_map.height(x + 2 * step, y);
+					height_t h01 = (h00 + h02) / 2;
+					_height_map.height(x + 1 * step, y) = h01;
+				}
 			}
-		}
+		});
 
 		/* Interpolate height values at odd y tiles */
-		for (int y = 0; y <= _height_map.size_y - 2 * step; y += 2 * step) {
-			for (int x = 0; x <= _height_map.size_x; x += step) {
-				height_t h00 = _height_map.height(x, y + 0 * step);
-				height_t h20 = _height_map.height(x, y + 2 * step);
-				height_t h10 = (h00 + h20) / 2;
-				_height_map.height(x, y + 1 * step) = h10;
+		HeightMapParallelFor(_height_map.size_y / (2 * step), TGP_PARALLEL_ROWS, [step](int begin, int end) {
+			for (int y = begin * 2 * step; y < end * 2 * step; y += 2 * step) {
+				for (int x = 0; x <= _height_map.size_x; x += step) {
+					height_t h00 = _height_map.height(x, y + 0 * step);
+					height_t h20 = _height_map.height(x, y + 2 * step);
+					height_t h10 = (h00 + h20) / 2;
+					_height_map.height(x, y + 1 * step) = h10;
+				}
 			}
-		}
+		});
 
-		/* Add noise for next higher frequency (smaller steps) */
+		/* Add noise for next higher frequency (smaller steps).
+		 * This stays on one thread, so the random numbers end up at the same tiles whatever the number of threads. */
 		for (int y = 0; y <= _height_map.size_y; y += step) {
 			for (int x = 0; x <= _height_map.size_x; x += step) {
 				_height_map.height(x, y) += RandomHeight(amplitude);
@@ -404,18 +446,57 @@ static void HeightMapGenerate()
 	}
 }
 
+/**
+ * Get the number of rows per stripe for reductions over the height map,
+ * so that there are at most #TGP_MAX_PARTIAL_RESULTS partial results.
+ * @return Number of rows per stripe.
+ */
+static int HeightMapReductionRows()
+{
+	return max<int>(TGP_PARALLEL_ROWS, CeilDiv(_height_map.size_y + 1, TGP_MAX_PARTIAL_RESULTS));
+}
+
+/**
+ * Call \a func for each item of the height map in the stripe of rows [\a begin, \a end).
+ * @param begin First row.
+ * @param end Row after the last row.
+ * @param func Function to call, with the signature void(height_t &h).
+ */
+template <typename F>
+static inline void HeightMapForRows(int begin, int end, F func)
+{
+	height_t *last = _height_map.h + end * _height_map.dim_x;
+	for (height_t *h = _height_map.h + begin * _height_map.dim_x; h < last; h++) func(*h);
+}
+
 /** Returns min, max and average height from height map */
 static void HeightMapGetMinMaxAvg(height_t *min_ptr, height_t *max_ptr, height_t *avg_ptr)
 {
-	height_t h_min, h_max, h_avg, *h;
+	struct PartialResult {
+		height_t h_min;
+		height_t h_max;
+		int64 h_accu;
+	};
+
+	height_t h_min, h_max, h_avg;
 	int64 h_accu = 0;
 	h_min = h_max = _height_map.height(0, 0);
 
-	/* Get h_min, h_max and accumulate heights into h_accu */
-	FOR_ALL_TILES_IN_HEIGHT(h) {
-		if (*h < h_min) h_min = *h;
-		if (*h > h_max) h_max = *h;
-		h_accu += *h;
+	/* Get h_min, h_max and accumulate heights into h_accu, per stripe of rows */
+	const int rows = HeightMapReductionRows();
+	std::vector<PartialResult> results(CeilDiv(_height_map.size_y + 1, rows), { h_min, h_max, 0 });
+	HeightMapParallelFor(_height_map.size_y + 1, rows, [&](int begin, int end) {
+		PartialResult &result = results[begin / rows];
+		HeightMapForRows(begin, end, [&result](height_t h) {
+			if (h < result.h_min) result.h_min = h;
+			if (h > result.h_max) result.h_max = h;
+			result.h_accu += h;
+		});
+	});
+	for (const PartialResult &result : results) {
+		h_min = min(h_min, result.h_min);
+		h_max = max(h_max, result.h_max);
+		h_accu += result.h_accu;
 	}
 
 	/* Get average height */
@@ -431,92 +512,111 @@ static void HeightMapGetMinMaxAvg(height_t *min_ptr, height_t *max_ptr, height_t
 static int *HeightMapMakeHistogram(height_t h_min, height_t h_max, int *hist_buf)
 {
 	int *hist = hist_buf - h_min;
-	height_t *h;
-
-	/* Count the heights and fill the histogram */
-	FOR_ALL_TILES_IN_HEIGHT(h) {
-		assert(*h >= h_min);
-		assert(*h <= h_max);
-		hist[*h]++;
+	const int hist_size = h_max - h_min + 1;
+
+	/* Count the heights per stripe of rows, and add those into the histogram */
+	const int rows = HeightMapReductionRows();
+	std::vector<int> partial_hists(CeilDiv(_height_map.size_y + 1, rows) * hist_size, 0);
+	HeightMapParallelFor(_height_map.size_y + 1, rows, [&](int begin, int end) {
+		int *partial_hist = partial_hists.data() + (begin / rows) * hist_size - h_min;
+		HeightMapForRows(begin, end, [&](height_t h) {
+			assert(h >= h_min);
+			assert(h <= h_max);
+			partial_hist[h]++;
+		});
+	});
+	for (size_t i = 0; i < partial_hists.size(); i++) {
+		hist_buf[i % hist_size] += partial_hists[i];
 	}
 	return hist;
 }
 
-/** Applies sine wave redistribution onto height map */
-static void HeightMapSineTransform(height_t h_min, height_t h_max)
+/**
+ * Apply the sine wave redistribution to a single height.
+ * @param h The height to transform.
+ * @param h_min Lowest height to transform, lower heights are left alone.
+ * @param h_max Highest height.
+ */
+static inline void HeightMapSineTransformHeight(height_t *h, height_t h_min, height_t h_max)
 {
-	height_t *h;
-
-	FOR_ALL_TILES_IN_HEIGHT(h) {
-		double fheight;
-
-		if (*h < h_min) continue;
-
-		/* Transform height into 0..1 space */
-		fheight = (double)(*h - h_min) / (double)(h_max - h_min);
-		/* Apply sine transform depending on landscape type */
-		switch (_settings_game.game_creation.landscape) {
-			case LT_TOYLAND:
-			case LT_TEMPERATE:
-				/* Move and scale 0..1 into -1..+1 */
-				fheight = 2 * fheight - 1;
-				/* Sine transform */
-				fheight = sin(fheight * M_PI_2);
-				/* Transform it back from -1..1 into 0..1 space */
-				fheight = 0.5 * (fheight + 1);
-				break;
-
-			case LT_ARCTIC:
-				{
-					/* Arctic terrain needs special height distribution.
-					 * Redistribute heights to have more tiles at highest (75%..100%) range */
-					double sine_upper_limit = 0.75;
-					double linear_compression = 2;
-					if (fheight >= sine_upper_limit) {
-						/* Over the limit we do linear compression up */
-						fheight = 1.0 - (1.0 - fheight) / linear_compression;
-					} else {
-						double m = 1.0 - (1.0 - sine_upper_limit) / linear_compression;
-						/* Get 0..sine_upper_limit into -1..1 */
-						fheight = 2.0 * fheight / sine_upper_limit - 1.0;
-						/* Sine wave transform */
-						fheight = sin(fheight * M_PI_2);
-						/* Get -1..1 back to 0..(1 - (1 - sine_upper_limit) / linear_compression) == 0.0..m */
-						fheight = 0.5 * (fheight + 1.0) * m;
-					}
+	double fheight;
+
+	if (*h < h_min) return;
+
+	/* Transform height into 0..1 space */
+	fheight = (double)(*h - h_min) / (double)(h_max - h_min);
+	/* Apply sine transform depending on landscape type */
+	switch (_settings_game.game_creation.landscape) {
+		case LT_TOYLAND:
+		case LT_TEMPERATE:
+			/* Move and scale 0..1 into -1..+1 */
+			fheight = 2 * fheight - 1;
+			/* Sine transform */
+			fheight = sin(fheight * M_PI_2);
+			/* Transform it back from -1..1 into 0..1 space */
+			fheight = 0.5 * (fheight + 1);
+			break;
+
+		case LT_ARCTIC:
+			{
+				/* Arctic terrain needs special height distribution.
+				 * Redistribute heights to have more tiles at highest (75%..100%) range */
+				double sine_upper_limit = 0.75;
+				double linear_compression = 2;
+				if (fheight >= sine_upper_limit) {
+					/* Over the limit we do linear compression up */
+					fheight = 1.0 - (1.0 - fheight) / linear_compression;
+				} else {
+					double m = 1.0 - (1.0 - sine_upper_limit) / linear_compression;
+					/* Get 0..sine_upper_limit into -1..1 */
+					fheight = 2.0 * fheight / sine_upper_limit - 1.0;
+					/* Sine wave transform */
+					fheight = sin(fheight * M_PI_2);
+					/* Get -1..1 back to 0..(1 - (1 - sine_upper_limit) / linear_compression) == 0.0..m */
+					fheight = 0.5 * (fheight + 1.0) * m;
 				}
-				break;
-
-			case LT_TROPIC:
-				{
-					/* Desert terrain needs special height distribution.
-					 * Half of tiles should be at lowest (0..25%) heights */
-					double sine_lower_limit = 0.5;
-					double linear_compression = 2;
-					if (fheight <= sine_lower_limit) {
-						/* Under the limit we do linear compression down */
-						fheight = fheight / linear_compression;
-					} else {
-						double m = sine_lower_limit / linear_compression;
-						/* Get sine_lower_limit..1 into -1..1 */
-						fheight = 2.0 * ((fheight - sine_lower_limit) / (1.0 - sine_lower_limit)) - 1.0;
-						/* Sine wave transform */
-						fheight = sin(fheight * M_PI_2);
-						/* Get -1..1 back to (sine_lower_limit / linear_compression)..1.0 */
-						fheight = 0.5 * ((1.0 - m) * fheight + (1.0 + m));
-					}
+			}
+			break;
+
+		case LT_TROPIC:
+			{
+				/* Desert terrain needs special height distribution.
+				 * Half of tiles should be at lowest (0..25%) heights */
+				double sine_lower_limit = 0.5;
+				double linear_compression = 2;
+				if (fheight <= sine_lower_limit) {
+					/* Under the limit we do linear compression down */
+					fheight = fheight / linear_compression;
+				} else {
+					double m = sine_lower_limit / linear_compression;
+					/* Get sine_lower_limit..1 into -1..1 */
+					fheight = 2.0 * ((fheight - sine_lower_limit) / (1.0 - sine_lower_limit)) - 1.0;
+					/* Sine wave transform */
+					fheight = sin(fheight * M_PI_2);
+					/* Get -1..1 back to (sine_lower_limit / linear_compression)..1.0 */
+					fheight = 0.5 * ((1.0 - m) * fheight + (1.0 + m));
 				}
-				break;
+			}
+			break;
 
-			default:
-				NOT_REACHED();
-				break;
-		}
-		/* Transform it back into h_min..h_max space */
-		*h = (height_t)(fheight * (h_max - h_min) + h_min);
-		if (*h < 0) *h = I2H(0);
-		if (*h >= h_max) *h = h_max - 1;
+		default:
+			NOT_REACHED();
+			break;
 	}
+	/* Transform it back into h_min..h_max space */
+	*h = (height_t)(fheight * (h_max - h_min) + h_min);
+	if (*h < 0) *h = I2H(0);
+	if (*h >= h_max) *h = h_max - 1;
+}
+
+/** Applies sine wave redistribution onto height map */
+static void HeightMapSineTransform(height_t h_min, height_t h_max)
+{
+	HeightMapParallelFor(_height_map.size_y + 1, TGP_PARALLEL_ROWS, [h_min, h_max](int begin, int end) {
+		HeightMapForRows(begin, end, [h_min, h_max](height_t &h) {
+			HeightMapSineTransformHeight(&h, h_min, h_max);
+		});
+	});
 }
 
 /**
@@ -564,9 +664,6 @@ static void HeightMapCurves(uint level)
 		{ lengthof(curve_map_4), curve_map_4 },
 	};
 
-	height_t ht[lengthof(curve_maps)];
-	MemSetT(ht, 0, lengthof(ht));
-
 	/* Set up a grid to choose curve maps based on location; attempt to get a somewhat square grid */
 	float factor = sqrt((float)_height_map.size_x / (float)_height_map.size_y);
 	uint sx = Clamp((int)(((1 << level) * factor) + 0.5), 1, 128);
@@ -577,88 +674,101 @@ static void HeightMapCurves(uint level)
 		c[i] = Random() % lengthof(curve_maps);
 	}
 
-	/* Apply curves */
-	for (int x = 0; x < _height_map.size_x; x++) {
-
-		/* Get our X grid positions and bi-linear ratio */
-		float fx = (float)(sx * x) / _height_map.size_x + 1.0f;
-		uint x1 = (uint)fx;
-		uint x2 = x1;
-		float xr = 2.0f * (fx - x1) - 1.0f;
-		xr = sin(xr * M_PI_2);
-		xr = sin(xr * M_PI_2);
-		xr = 0.5f * (xr + 1.0f);
-		float xri = 1.0f - xr;
-
-		if (x1 > 0) {
-			x1--;
-			if (x2 >= sx) x2--;
-		}
+	/** Grid positions and bi-linear ratio of a row or column of the height map. */
+	struct GridPosition {
+		uint p1;   ///< Grid position before.
+		uint p2;   ///< Grid position after.
+		float r;   ///< Ratio of the grid position after.
+		float ri;  ///< Ratio of the grid position before.
+	};
 
-		for (int y = 0; y < _height_map.size_y; y++) {
-
-			/* Get our Y grid position and bi-linear ratio */
-			float fy = (float)(sy * y) / _height_map.size_y + 1.0f;
-			uint y1 = (uint)fy;
-			uint y2 = y1;
-			float yr = 2.0f * (fy - y1) - 1.0f;
-			yr = sin(yr * M_PI_2);
-			yr = sin(yr * M_PI_2);
-			yr = 0.5f * (yr + 1.0f);
-			float yri = 1.0f - yr;
-
-			if (y1 > 0) {
-				y1--;
-				if (y2 >= sy) y2--;
-			}
+	/* Get the grid positions and bi-linear ratios of all rows and columns once, instead of for every tile */
+	auto get_grid_position = [](uint s, int pos, int size) -> GridPosition {
+		float f = (float)(s * pos) / size + 1.0f;
+		uint p1 = (uint)f;
+		uint p2 = p1;
+		float r = 2.0f * (f - p1) - 1.0f;
+		r = sin(r * M_PI_2);
+		r = sin(r * M_PI_2);
+		r = 0.5f * (r + 1.0f);
+		float ri = 1.0f - r;
+
+		if (p1 > 0) {
+			p1--;
+			if (p2 >= s) p2--;
+		}
+		return { p1, p2, r, ri };
+	};
+	std::vector<GridPosition> grid_x(_height_map.size_x);
+	for (int x = 0; x < _height_map.size_x; x++) grid_x[x] = get_grid_position(sx, x, _height_map.size_x);
+	std::vector<GridPosition> grid_y(_height_map.size_y);
+	for (int y = 0; y < _height_map.size_y; y++) grid_y[y] = get_grid_position(sy, y, _height_map.size_y);
 
-			uint corner_a = c[x1 + sx * y1];
-			uint corner_b = c[x1 + sx * y2];
-			uint corner_c = c[x2 + sx * y1];
-			uint corner_d = c[x2 + sx * y2];
-
-			/* Bitmask of which curve maps are chosen, so that we do not bother
-			 * calculating a curve which won't be used. */
-			uint corner_bits = 0;
-			corner_bits |= 1 << corner_a;
-			corner_bits |= 1 << corner_b;
-			corner_bits |= 1 << corner_c;
-			corner_bits |= 1 << corner_d;
-
-			height_t *h = &_height_map.height(x, y);
-
-			/* Do not touch sea level */
-			if (*h < I2H(1)) continue;
-
-			/* Only scale above sea level */
-			*h -= I2H(1);
-
-			/* Apply all curve maps that are used on this tile. */
-			for (uint t = 0; t < lengthof(curve_maps); t++) {
-				if (!HasBit(corner_bits, t)) continue;
-
-				bool found = false;
-				const control_point_t *cm = curve_maps[t].list;
-				for (uint i = 0; i < curve_maps[t].length - 1; i++) {
-					const control_point_t &p1 = cm[i];
-					const control_point_t &p2 = cm[i + 1];
-
-					if (*h >= p1.x && *h < p2.x) {
-						ht[t] = p1.y + (*h - p1.x) * (p2.y - p1.y) / (p2.x - p1.x);
-						found = true;
-						break;
+	/* Apply curves */
+	HeightMapParallelFor(_height_map.size_y, TGP_PARALLEL_ROWS, [&](int begin, int end) {
+		height_t ht[lengthof(curve_maps)];
+		MemSetT(ht, 0, lengthof(ht));
+
+		for (int y = begin; y < end; y++) {
+			const uint y1 = grid_y[y].p1;
+			const uint y2 = grid_y[y].p2;
+			const float yr = grid_y[y].r;
+			const float yri = grid_y[y].ri;
+
+			for (int x = 0; x < _height_map.size_x; x++) {
+				const uint x1 = grid_x[x].p1;
+				const uint x2 = grid_x[x].p2;
+				const float xr = grid_x[x].r;
+				const float xri = grid_x[x].ri;
+
+				uint corner_a = c[x1 + sx * y1];
+				uint corner_b = c[x1 + sx * y2];
+				uint corner_c = c[x2 + sx * y1];
+				uint corner_d = c[x2 + sx * y2];
+
+				/* Bitmask of which curve maps are chosen, so that we do not bother
+				 * calculating a curve which won't be used. */
+				uint corner_bits = 0;
+				corner_bits |= 1 << corner_a;
+				corner_bits |= 1 << corner_b;
+				corner_bits |= 1 << corner_c;
+				corner_bits |= 1 << corner_d;
+
+				height_t *h = &_height_map.height(x, y);
+
+				/* Do not touch sea level */
+				if (*h < I2H(1)) continue;
+
+				/* Only scale above sea level */
+				*h -= I2H(1);
+
+				/* Apply all curve maps that are used on this tile. */
+				for (uint t = 0; t < lengthof(curve_maps); t++) {
+					if (!HasBit(corner_bits, t)) continue;
+
+					bool found = false;
+					const control_point_t *cm = curve_maps[t].list;
+					for (uint i = 0; i < curve_maps[t].length - 1; i++) {
+						const control_point_t &p1 = cm[i];
+						const control_point_t &p2 = cm[i + 1];
+
+						if (*h >= p1.x && *h < p2.x) {
+							ht[t] = p1.y + (*h - p1.x) * (p2.y - p1.y) / (p2.x - p1.x);
+							found = true;
+							break;
+						}
 					}
+					assert(found);
 				}
-				assert(found);
-			}
 
-			/* Apply interpolation of curve map results. */
-			*h = (height_t)((ht[corner_a] * yri + ht[corner_b] * yr) * xri + (ht[corner_c] * yri + ht[corner_d] * yr) * xr);
+				/* Apply interpolation of curve map results. */
+				*h = (height_t)((ht[corner_a] * yri + ht[corner_b] * yr) * xri + (ht[corner_c] * yri + ht[corner_d] * yr) * xr);
 
-			/* Readd sea level */
-			*h += I2H(1);
+				/* Readd sea level */
+				*h += I2H(1);
+			}
 		}
-	}
+	});
 }
 
 /** Adjusts heights in height map to contain required amount of water tiles */
@@ -666,7 +776,6 @@ static void HeightMapAdjustWaterLevel(amplitude_t water_percent, height_t h_max_
 {
 	height_t h_min, h_max, h_avg, h_water_level;
 	int64 water_tiles, desired_water_tiles;
-	height_t *h;
 	int *hist;
 
 	HeightMapGetMinMaxAvg(&h_min, &h_max, &h_avg);
@@ -691,13 +800,15 @@ static void HeightMapAdjustWaterLevel(amplitude_t water_percent, height_t h_max_
 	 *   values from range: h_water_level..h_max are transformed into 0..h_max_new
 	 *   where h_max_new is depending on terrain type and map size.
 	 */
-	FOR_ALL_TILES_IN_HEIGHT(h) {
-		/* Transform height from range h_water_level..h_max into 0..h_max_new range */
-		*h = (height_t)(((int)h_max_new) * (*h - h_water_level) / (h_max - h_water_level)) + I2H(1);
-		/* Make sure all values are in the proper range (0..h_max_new) */
-		if (*h < 0) *h = I2H(0);
-		if (*h >= h_max_new) *h = h_max_new - 1;
-	}
+	HeightMapParallelFor(_height_map.size_y + 1, TGP_PARALLEL_ROWS, [=](int begin, int end) {
+		HeightMapForRows(begin, end, [=](height_t &h) {
+			/* Transform height from range h_water_level..h_max into 0..h_max_new range */
+			h = (height_t)(((int)h_max_new) * (h - h_water_level) / (h_max - h_water_level)) + I2H(1);
+			/* Make sure all values are in the proper range (0..h_max_new) */
+			if (h < 0) h = I2H(0);
+			if (h >= h_max_new) h = h_max_new - 1;
+		});
+	});
 
 	free(hist_buf);
 }
@@ -838,20 +949,47 @@ static void HeightMapSmoothCoasts(uint8 water_borders)
  * one level between tiles. This routine smooths out those differences so that
  * the most it can change is one level. When OTTD can support cliffs, this
  * routine may not be necessary.
+ *
+ * Limiting each height to the lowest of its (already limited) neighbours to
+ * the north plus dh_max, in tile order, limits it to the lowest height to the
+ * north of it plus dh_max for each tile of distance. As that distance is the
+ * sum of the distances along x and y, it is done by a pass along the rows
+ * followed by a pass along the columns, which both run in parallel. The same
+ * is then done from the south.
  */
 static void HeightMapSmoothSlopes(height_t dh_max)
 {
-	for (int y = 0; y <= (int)_height_map.size_y; y++) {
-		for (int x = 0; x <= (int)_height_map.size_x; x++) {
-			height_t h_max = min(_height_map.height(x > 0 ? x - 1 : x, y), _height_map.height(x, y > 0 ? y - 1 : y)) + dh_max;
-			if (_height_map.height(x, y) > h_max) _height_map.height(x, y) = h_max;
+	assert(dh_max >= 0);
+
+	const int size_x = _height_map.size_x;
+	const int size_y = _height_map.size_y;
+
+	/* Limit along the rows */
+	auto smooth_rows = [dh_max, size_x](int begin, int end, bool forward) {
+		for (int y = begin; y < end; y++) {
+			height_t *row = &_height_map.height(0, y);
+			if (forward) {
+				for (int x = 1; x <= size_x; x++) row[x] = min<int>(row[x], row[x - 1] + dh_max);
+			} else {
+				for (int x = size_x - 1; x >= 0; x--) row[x] = min<int>(row[x], row[x + 1] + dh_max);
+			}
 		}
-	}
-	for (int y = _height_map.size_y; y >= 0; y--) {
-		for (int x = _height_map.size_x; x >= 0; x--) {
-			height_t h_max = min(_height_map.height(x < _height_map.size_x ? x + 1 : x, y), _height_map.height(x, y < _height_map.size_y ? y + 1 : y)) + dh_max;
-			if (_height_map.height(x, y) > h_max) _height_map.height(x, y) = h_max;
+	};
+	/* Limit along the columns, row after row for the columns of the stripe */
+	auto smooth_columns = [dh_max, size_y](int begin, int end, bool forward) {
+		for (int i = 1; i <= size_y; i++) {
+			const int y = forward ? i : size_y - i;
+			height_t *row = &_height_map.height(0, y);
+			const height_t *prev = &_height_map.height(0, forward ? y - 1 : y + 1);
+			for (int x = begin; x < end; x++) row[x] = min<int>(row[x], prev[x] + dh_max);
 		}
+	};
+
+	/* Wider stripes for the columns, so the stripes do not share cache lines too often */
+	const int columns = TGP_PARALLEL_ROWS * 16;
+	for (bool forward : { true, false }) {
+		HeightMapParallelFor(size_y + 1, TGP_PARALLEL_ROWS, [&](int begin, int end) { smooth_rows(begin, end, forward); });
+		HeightMapParallelFor(size_x + 1, columns, [&](int begin, int end) { smooth_columns(begin, end, forward); });
 	}
 }
 
@@ -861,8 +999,9 @@ static void HeightMapSmoothSlopes(height_t dh_max)
  *  - coast Smoothing
  *  - slope Smoothing
  *  - height histogram redistribution by sine wave transform
+ * @param phase_done Called at the end of each phase, with the name of the phase.
  */
-static void HeightMapNormalize()
+static void HeightMapNormalize(const HeightMapPhaseCallback &phase_done)
 {
 	int sea_level_setting = _settings_game.difficulty.quantity_sea_lakes;
 	const amplitude_t water_percent = sea_level_setting != (int)CUSTOM_SEA_LEVEL_NUMBER_DIFFICULTY ? _water_percent[sea_level_setting] : _settings_game.game_creation.custom_sea_level * 1024 / 100;
@@ -870,6 +1009,7 @@ static void HeightMapNormalize()
 	const height_t roughness = 7 + 3 * _settings_game.game_creation.tgen_smoothness;
 
 	HeightMapAdjustWaterLevel(water_percent, h_max_new);
+	phase_done("water level");
 
 	byte water_borders = _settings_game.construction.freeform_edges ? _settings_game.game_creation.water_borders : 0xF;
 	if (water_borders == BORDERS_RANDOM) water_borders = GB(Random(), 0, 4);
@@ -879,14 +1019,17 @@ static void HeightMapNormalize()
 
 	HeightMapSmoothCoasts(water_borders);
 	HeightMapSmoothSlopes(roughness);
+	phase_done("coasts and slopes");
 
 	HeightMapSineTransform(I2H(1), h_max_new);
+	phase_done("sine transform");
 
 	if (_settings_game.game_creation.variety > 0) {
 		HeightMapCurves(_settings_game.game_creation.variety);
 	}
 
 	HeightMapSmoothSlopes(I2H(1));
+	phase_done("curves and slopes");
 }
 
 /**
@@ -988,9 +1131,7 @@ void GenerateTerrainPerlin()
 
 	IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
 
-	HeightMapNormalize();
-
-	IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
+	HeightMapNormalize([](const char *) { IncreaseGeneratingWorldProgress(GWP_LANDSCAPE); });
 
 	/* First make sure the tiles at the north border are void tiles if needed. */
 	if (_settings_game.construction.freeform_edges) {
@@ -1000,15 +1141,76 @@ void GenerateTerrainPerlin()
 
 	int max_height = H2I(TGPGetMaxHeight());
 
-	/* Transfer height map into OTTD map */
-	for (int y = 0; y < _height_map.size_y; y++) {
-		for (int x = 0; x < _height_map.size_x; x++) {
-			TgenSetTileHeight(TileXY(x, y), Clamp(H2I(_height_map.height(x, y)), 0, max_height));
+	/* Transfer height map into OTTD map; every row only touches its own tiles */
+	HeightMapParallelFor(_height_map.size_y, TGP_PARALLEL_ROWS, [max_height](int begin, int end) {
+		for (int y = begin; y < end; y++) {
+			for (int x = 0; x < _height_map.size_x; x++) {
+				TgenSetTileHeight(TileXY(x, y), Clamp(H2I(_height_map.height(x, y)), 0, max_height));
+			}
 		}
-	}
+	});
 
 	IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
 
 	FreeHeightMap();
 	GenerateWorldSetAbortCallback(nullptr);
 }
+
+/**
+ * Time the phases of the height map generation for the map size and settings of the current game,
+ * once on the calling thread only and once spread over the worker threads, and check that both give the same height map.
+ * The map and the random state of the game are left untouched.
+ * @param b Buffer to write to.
+ * @param last Last valid position in the buffer.
+ * @param iterations Number of times to generate the height map for each way of running.
+ */
+void DumpTgpBenchmark(char *b, const char *last, uint iterations)
+{
+	if (_height_map.h != nullptr) {
+		seprintf(b, last, "The height map is in use by the world generation\n");
+		return;
+	}
+
+	b += seprintf(b, last, "TGP benchmark, %u x %u tiles, %u worker thread(s), %u iteration(s)\n", MapSizeX(), MapSizeY(), _general_worker_pool.GetWorkerCount(), iterations);
+
+	static const uint PHASES = 5;
+	const char *names[PHASES] = {};
+	double times[2][PHASES] = {};
+	uint32 checksums[2] = {};
+
+	const Randomizer saved_random = _random;
+	AllocHeightMap();
+	for (uint mode = 0; mode < 2; mode++) {
+		_tgp_single_threaded = (mode == 0);
+		for (uint i = 0; i < iterations; i++) {
+			_random = saved_random;
+			MemSetT(_height_map.h, 0, _height_map.total_size);
+
+			uint phase = 0;
+			auto start = std::chrono::steady_clock::now();
+			auto phase_done = [&](const char *name) {
+				assert(phase < PHASES);
+				auto now = std::chrono::steady_clock::now();
+				names[phase] = name;
+				times[mode][phase++] += std::chrono::duration<double, std::milli>(now - start).count() / iterations;
+				start = now;
+			};
+
+			HeightMapGenerate();
+			phase_done("generate");
+			HeightMapNormalize(phase_done);
+		}
+
+		uint32 checksum = 0;
+		for (int i = 0; i < _height_map.total_size; i++) checksum = checksum * 31 + (uint16)_height_map.h[i];
+		checksums[mode] = checksum;
+	}
+	_tgp_single_threaded = false;
+	FreeHeightMap();
+	_random = saved_random;
+
+	for (uint phase = 0; phase < PHASES; phase++) {
+		b += seprintf(b, last, "  %-18s single thread: %9.3f ms, worker threads: %9.3f ms\n", names[phase], times[0][phase], times[1][phase]);
+	}
+	b += seprintf(b, last, "  Height maps: %s (checksum %08X)\n", checksums[0] == checksums[1] ? "identical" : "DIFFERENT", checksums[1]);
+}
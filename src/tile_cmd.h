@@ -15,6 +15,7 @@
 #include "cargo_type.h"
 #include "track_type.h"
 #include "tile_map.h"
+#include "sound_type.h"
 
 /** The returned bits of VehicleEnterTile. */
 enum VehicleEnterTileStatus {
@@ -115,8 +116,45 @@ typedef TrackStatus GetTileTrackStatusProc(TileIndex tile, TransportType mode, u
  */
 typedef void AddProducedCargoProc(TileIndex tile, CargoArray &produced);
 typedef bool ClickTileProc(TileIndex tile);
-typedef void AnimateTileProc(TileIndex tile);
+
+/**
+ * Tile callback function signature for animating a tile.
+ * @param tile Tile to animate
+ * @return The animation speed of the tile: it only has to be animated again when the scaled tick counter is a multiple of 1 << speed
+ */
+typedef uint8 AnimateTileProc(TileIndex tile);
 typedef void TileLoopProc(TileIndex tile);
+
+/** What is left to do on the main thread after a #TileLoopParallelProc has run. */
+enum TileLoopParallelFlags : byte {
+	TLPF_NONE         = 0,      ///< Nothing, the tile has been processed completely.
+	TLPF_SERIAL       = 1 << 0, ///< The tile has not been processed, it has to be passed to the #TileLoopProc instead.
+	TLPF_DIRTY        = 1 << 1, ///< The tile has to be redrawn.
+	TLPF_DIRTY_DETAIL = 1 << 2, ///< The tile has to be redrawn, but not in viewports showing the map.
+	TLPF_SOUND        = 1 << 3, ///< An ambient sound effect has to be played at the tile.
+};
+DECLARE_ENUM_AS_BIT_SET(TileLoopParallelFlags)
+
+/** Result of a #TileLoopParallelProc. */
+struct TileLoopParallelResult {
+	TileLoopParallelFlags flags; ///< What is left to do on the main thread.
+	SoundFx sound;               ///< Ambient sound effect to play, if #TLPF_SOUND is set.
+};
+
+/**
+ * Tile callback function signature for the parallel tile loop, see #RunTileLoop.
+ *
+ * The function is called on a worker thread, concurrently with the calls for other tiles of the same batch.
+ * It may modify only the tile itself, and read only the tile itself and the parts of other tiles
+ * that no parallel tile loop callback modifies (tile type, height, tropic zone and water class).
+ * Anything else, including randomness other than \a random, has to be left to the #TileLoopProc
+ * by returning #TLPF_SERIAL, which must be decided before the tile is modified.
+ *
+ * @param tile   Tile to process.
+ * @param random Random bits pre-drawn for this tile.
+ * @return What is left to do on the main thread.
+ */
+typedef TileLoopParallelResult TileLoopParallelProc(TileIndex tile, uint32 random);
 typedef void ChangeTileOwnerProc(TileIndex tile, Owner old_owner, Owner new_owner);
 
 /** @see VehicleEnterTileStatus to see what the return values mean */
@@ -154,6 +192,7 @@ struct TileTypeProcs {
 	ClickTileProc *click_tile_proc;                ///< Called when tile is clicked
 	AnimateTileProc *animate_tile_proc;
 	TileLoopProc *tile_loop_proc;
+	TileLoopParallelProc *tile_loop_parallel_proc; ///< Called instead of #tile_loop_proc by the parallel tile loop, nullptr if the tile type has to be processed serially
 	ChangeTileOwnerProc *change_tile_owner_proc;
 	AddProducedCargoProc *add_produced_cargo_proc; ///< Adds produced cargo of the tile to cargo array supplied as parameter
 	VehicleEnterTileProc *vehicle_enter_tile_proc; ///< Called when a vehicle enters a tile
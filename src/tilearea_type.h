@@ -212,7 +212,7 @@ public:
 	 */
 	OrthogonalPrefetchTileIterator(const TileArea &ta) : tile(ta.w == 0 || ta.h == 0 ? INVALID_TILE : ta.tile), w(ta.w), x(ta.w), y(ta.h)
 	{
-		PREFETCH_NTA(&_m[ta.tile]);
+		PrefetchTile(ta.tile);
 	}
 
 	/** Some compilers really like this. */
@@ -241,7 +241,7 @@ public:
 		} else if (--this->y > 0) {
 			this->x = this->w;
 			this->tile += TileDiffXY(1, 1) - this->w;
-			PREFETCH_NTA(&_m[tile]);
+			PrefetchTile(tile);
 		} else {
 			this->tile = INVALID_TILE;
 		}
@@ -13,6 +13,7 @@
 #include "date_func.h"
 #include "date_type.h"
 #include "window_func.h"
+#include "departures_func.h"
 #include "vehicle_base.h"
 #include "settings_type.h"
 #include "cmd_helper.h"
@@ -117,6 +118,7 @@ static void ChangeTimetable(Vehicle *v, VehicleOrderID order_number, uint32 val,
 			}
 		}
 		SetWindowDirty(WC_VEHICLE_TIMETABLE, v->index);
+		InvalidateDepartureLists(false);
 	}
 }
 
@@ -333,6 +335,7 @@ CommandCost CmdSetVehicleOnTime(TileIndex tile, DoCommandFlag flags, uint32 p1,
 	if (flags & DC_EXEC) {
 		v->lateness_counter = 0;
 		SetWindowDirty(WC_VEHICLE_TIMETABLE, v->index);
+		InvalidateDepartureLists(false);
 	}
 
 	return CommandCost();
@@ -438,6 +441,7 @@ CommandCost CmdSetTimetableStart(TileIndex tile, DoCommandFlag flags, uint32 p1,
 			w->timetable_start = tt_start / _settings_game.economy.day_length_factor;
 			w->timetable_start_subticks = tt_start % _settings_game.economy.day_length_factor;
 			SetWindowDirty(WC_VEHICLE_TIMETABLE, w->index);
+			InvalidateDepartureLists(false);
 			++idx;
 		}
 
@@ -496,6 +500,7 @@ CommandCost CmdAutofillTimetable(TileIndex tile, DoCommandFlag flags, uint32 p1,
 				ClrBit(v2->vehicle_flags, VF_AUTOFILL_PRES_WAIT_TIME);
 			}
 			SetWindowDirty(WC_VEHICLE_TIMETABLE, v2->index);
+			InvalidateDepartureLists(false);
 		}
 	}
 
@@ -553,6 +558,7 @@ CommandCost CmdAutomateTimetable(TileIndex index, DoCommandFlag flags, uint32 p1
 				}
 			}
 			SetWindowDirty(WC_VEHICLE_TIMETABLE, v2->index);
+			InvalidateDepartureLists(false);
 		}
 		if (!HasBit(p2, 0) && !HasBit(p2, 1)) {
 			OrderList *orders = v->orders.list;
@@ -597,6 +603,7 @@ CommandCost CmdTimetableSeparation(TileIndex tile, DoCommandFlag flags, uint32 p
 			}
 			v2->ClearSeparation();
 			SetWindowDirty(WC_VEHICLE_TIMETABLE, v2->index);
+			InvalidateDepartureLists(false);
 		}
 	}
 
@@ -43,6 +43,8 @@ static const uint16 MAX_TOWN_GROWTH_TICKS = 930; ///< Max amount of original tow
 typedef Pool<Town, TownID, 64, 64000> TownPool;
 extern TownPool _town_pool;
 
+extern uint32 _town_house_change_serial;
+
 /** Data structure with cached data of towns. */
 struct TownCache {
 	uint32 num_houses;                        ///< Amount of houses
@@ -106,6 +108,7 @@ struct Town : TownPool::PoolItem<&_town_pool> {
 	TownLayout layout;               ///< town specific road layout
 
 	bool show_zone;                  ///< NOSAVE: mark town to show the local authority zone in the viewports
+	uint32 house_change_serial;      ///< NOSAVE: Value of #_town_house_change_serial at the last change to the houses or the population of this town
 
 	std::list<PersistentStorage *> psa_list;
 
@@ -113,13 +116,25 @@ struct Town : TownPool::PoolItem<&_town_pool> {
 	 * Creates a new town.
 	 * @param tile center tile of the town
 	 */
-	Town(TileIndex tile = INVALID_TILE) : xy(tile) { }
+	Town(TileIndex tile = INVALID_TILE) : xy(tile)
+	{
+		this->HousesChanged();
+	}
 
 	/** Destroy the town. */
 	~Town();
 
 	void InitializeLayout(TownLayout layout);
 
+	/**
+	 * Record a change to the houses or the population of this town.
+	 * This lets the cache check which counts the houses over several ticks skip the changed towns.
+	 */
+	inline void HousesChanged()
+	{
+		this->house_change_serial = ++_town_house_change_serial;
+	}
+
 	void UpdateLabel();
 
 	/**
@@ -61,6 +61,7 @@
 
 TownID _new_town_id;
 CargoTypes _town_cargoes_accepted; ///< Bitmap of all cargoes accepted by houses.
+uint32 _town_house_change_serial;  ///< Serial number of the last change to the houses or the population of any town, see Town::HousesChanged.
 
 /* Initialize the town-pool */
 TownPool _town_pool("Town");
@@ -441,15 +442,15 @@ static Foundation GetFoundation_Town(TileIndex tile, Slope tileh)
  * Only certain houses can be animated
  * The newhouses animation supersedes regular ones
  * @param tile TileIndex of the house to animate
+ * @return The animation speed to schedule the tile with, see #AnimateTileProc.
  */
-void AnimateTile_Town(TileIndex tile)
+uint8 AnimateTile_Town(TileIndex tile)
 {
 	if (GetHouseType(tile) >= NEW_HOUSE_OFFSET) {
-		AnimateNewHouseTile(tile);
-		return;
+		return AnimateNewHouseTile(tile);
 	}
 
-	if (_scaled_tick_counter & 3) return;
+	if (_scaled_tick_counter & 3) return 2;
 
 	/* If the house is not one with a lift anymore, then stop this animating.
 	 * Not exactly sure when this happens, but probably when a house changes.
@@ -457,7 +458,7 @@ void AnimateTile_Town(TileIndex tile)
 	 * That bug seems to have been here since day 1?? */
 	if (!(HouseSpec::Get(GetHouseType(tile))->building_flags & BUILDING_IS_ANIMATED)) {
 		DeleteAnimatedTile(tile);
-		return;
+		return 2;
 	}
 
 	if (!LiftHasDestination(tile)) {
@@ -485,6 +486,7 @@ void AnimateTile_Town(TileIndex tile)
 	}
 
 	MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
+	return 2;
 }
 
 /**
@@ -543,6 +545,7 @@ void ClearAllTownCachedNames()
 static void ChangePopulation(Town *t, int mod)
 {
 	t->cache.population += mod;
+	t->HousesChanged();
 	InvalidateWindowData(WC_TOWN_VIEW, t->index); // Cargo requirements may appear/vanish for small populations
 	if (_settings_client.gui.population_in_label) t->UpdateVirtCoord();
 
@@ -2720,6 +2723,7 @@ static CommandCost CheckCanBuildHouse(HouseID house, const Town *t)
 static void DoBuildHouse(Town *t, TileIndex tile, HouseID house, byte random_bits)
 {
 	t->cache.num_houses++;
+	t->HousesChanged();
 
 	const HouseSpec *hs = HouseSpec::Get(house);
 
@@ -2940,6 +2944,7 @@ void ClearTownHouse(Town *t, TileIndex tile)
 	}
 
 	t->cache.num_houses--;
+	t->HousesChanged();
 
 	/* Clear flags for houses that only may exist once/town. */
 	if (hs->building_flags & BUILDING_IS_CHURCH) {
@@ -4070,6 +4075,7 @@ extern const TileTypeProcs _tile_type_town_procs = {
 	nullptr,                    // click_tile_proc
 	AnimateTile_Town,        // animate_tile_proc
 	TileLoop_Town,           // tile_loop_proc
+	nullptr,                 // tile_loop_parallel_proc
 	ChangeTileOwner_Town,    // change_tile_owner_proc
 	AddProducedCargo_Town,   // add_produced_cargo_proc
 	nullptr,                    // vehicle_enter_tile_proc
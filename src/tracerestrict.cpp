@@ -236,418 +236,504 @@ static bool TestStationCondition(StationID station, TraceRestrictItem item)
  */
 void TraceRestrictProgram::Execute(const Train* v, const TraceRestrictProgramInput &input, TraceRestrictProgramResult& out) const
 {
-	// static to avoid needing to re-alloc/resize on each execution
-	static std::vector<TraceRestrictCondStackFlags> condstack;
-	condstack.clear();
-
 	bool have_previous_signal = false;
 	TileIndex previous_signal_tile = INVALID_TILE;
 
-	size_t size = this->items.size();
-	for (size_t i = 0; i < size; i++) {
-		TraceRestrictItem item = this->items[i];
+	size_t size = this->compiled.size();
+	size_t i = 0;
+	while (i < size) {
+		const TraceRestrictCompiledInstruction &insn = this->compiled[i];
+		TraceRestrictItem item = insn.item;
 		TraceRestrictItemType type = GetTraceRestrictType(item);
 
 		if (IsTraceRestrictConditional(item)) {
-			TraceRestrictCondFlags condflags = GetTraceRestrictCondFlags(item);
 			TraceRestrictCondOp condop = GetTraceRestrictCondOp(item);
+			uint16 condvalue = GetTraceRestrictValue(item);
+			bool result = false;
+			switch(type) {
+				case TRIT_COND_UNDEFINED:
+					result = false;
+					break;
 
-			if (type == TRIT_COND_ENDIF) {
-				assert(!condstack.empty());
-				if (condflags & TRCF_ELSE) {
-					// else
-					assert(!(condstack.back() & TRCSF_SEEN_ELSE));
-					HandleCondition(condstack, condflags, true);
-					condstack.back() |= TRCSF_SEEN_ELSE;
-				} else {
-					// end if
-					condstack.pop_back();
-				}
-			} else {
-				uint16 condvalue = GetTraceRestrictValue(item);
-				bool result = false;
-				switch(type) {
-					case TRIT_COND_UNDEFINED:
-						result = false;
-						break;
-
-					case TRIT_COND_TRAIN_LENGTH:
-						result = TestCondition(CeilDiv(v->gcache.cached_total_length, TILE_SIZE), condop, condvalue);
-						break;
+				case TRIT_COND_TRAIN_LENGTH:
+					result = TestCondition(CeilDiv(v->gcache.cached_total_length, TILE_SIZE), condop, condvalue);
+					break;
 
-					case TRIT_COND_MAX_SPEED:
-						result = TestCondition(v->GetDisplayMaxSpeed(), condop, condvalue);
-						break;
+				case TRIT_COND_MAX_SPEED:
+					result = TestCondition(v->GetDisplayMaxSpeed(), condop, condvalue);
+					break;
 
-					case TRIT_COND_CURRENT_ORDER:
-						result = TestOrderCondition(&(v->current_order), item);
-						break;
+				case TRIT_COND_CURRENT_ORDER:
+					result = TestOrderCondition(&(v->current_order), item);
+					break;
 
-					case TRIT_COND_NEXT_ORDER: {
-						if (v->orders.list == nullptr) break;
-						if (v->orders.list->GetNumOrders() == 0) break;
+				case TRIT_COND_NEXT_ORDER: {
+					if (v->orders.list == nullptr) break;
+					if (v->orders.list->GetNumOrders() == 0) break;
 
-						const Order *current_order = v->GetOrder(v->cur_real_order_index);
-						for (const Order *order = v->orders.list->GetNext(current_order); order != current_order; order = v->orders.list->GetNext(order)) {
-							if (order->IsGotoOrder()) {
-								result = TestOrderCondition(order, item);
-								break;
-							}
+					const Order *current_order = v->GetOrder(v->cur_real_order_index);
+					for (const Order *order = v->orders.list->GetNext(current_order); order != current_order; order = v->orders.list->GetNext(order)) {
+						if (order->IsGotoOrder()) {
+							result = TestOrderCondition(order, item);
+							break;
 						}
-						break;
 					}
+					break;
+				}
 
-					case TRIT_COND_LAST_STATION:
-						result = TestStationCondition(v->last_station_visited, item);
-						break;
+				case TRIT_COND_LAST_STATION:
+					result = TestStationCondition(v->last_station_visited, item);
+					break;
 
-					case TRIT_COND_CARGO: {
-						bool have_cargo = false;
-						for (const Vehicle *v_iter = v; v_iter != nullptr; v_iter = v_iter->Next()) {
-							if (v_iter->cargo_type == GetTraceRestrictValue(item) && v_iter->cargo_cap > 0) {
-								have_cargo = true;
-								break;
-							}
+				case TRIT_COND_CARGO: {
+					bool have_cargo = false;
+					for (const Vehicle *v_iter = v; v_iter != nullptr; v_iter = v_iter->Next()) {
+						if (v_iter->cargo_type == GetTraceRestrictValue(item) && v_iter->cargo_cap > 0) {
+							have_cargo = true;
+							break;
 						}
-						result = TestBinaryConditionCommon(item, have_cargo);
-						break;
 					}
+					result = TestBinaryConditionCommon(item, have_cargo);
+					break;
+				}
 
-					case TRIT_COND_ENTRY_DIRECTION: {
-						bool direction_match;
-						switch (GetTraceRestrictValue(item)) {
-							case TRNTSV_NE:
-							case TRNTSV_SE:
-							case TRNTSV_SW:
-							case TRNTSV_NW:
-								direction_match = (static_cast<DiagDirection>(GetTraceRestrictValue(item)) == TrackdirToExitdir(ReverseTrackdir(input.trackdir)));
-								break;
+				case TRIT_COND_ENTRY_DIRECTION: {
+					bool direction_match;
+					switch (GetTraceRestrictValue(item)) {
+						case TRNTSV_NE:
+						case TRNTSV_SE:
+						case TRNTSV_SW:
+						case TRNTSV_NW:
+							direction_match = (static_cast<DiagDirection>(GetTraceRestrictValue(item)) == TrackdirToExitdir(ReverseTrackdir(input.trackdir)));
+							break;
 
-							case TRDTSV_FRONT:
-								direction_match = IsTileType(input.tile, MP_RAILWAY) && HasSignalOnTrackdir(input.tile, input.trackdir);
-								break;
+						case TRDTSV_FRONT:
+							direction_match = IsTileType(input.tile, MP_RAILWAY) && HasSignalOnTrackdir(input.tile, input.trackdir);
+							break;
 
-							case TRDTSV_BACK:
-								direction_match = IsTileType(input.tile, MP_RAILWAY) && !HasSignalOnTrackdir(input.tile, input.trackdir);
-								break;
+						case TRDTSV_BACK:
+							direction_match = IsTileType(input.tile, MP_RAILWAY) && !HasSignalOnTrackdir(input.tile, input.trackdir);
+							break;
 
-							default:
-								NOT_REACHED();
-								break;
-						}
-						result = TestBinaryConditionCommon(item, direction_match);
-						break;
+						default:
+							NOT_REACHED();
+							break;
 					}
+					result = TestBinaryConditionCommon(item, direction_match);
+					break;
+				}
 
-					case TRIT_COND_PBS_ENTRY_SIGNAL: {
-						// TRVT_TILE_INDEX value type uses the next slot
-						i++;
-						uint32_t signal_tile = this->items[i];
-						if (!have_previous_signal) {
-							if (input.previous_signal_callback) {
-								previous_signal_tile = input.previous_signal_callback(v, input.previous_signal_ptr);
-							}
-							have_previous_signal = true;
+				case TRIT_COND_PBS_ENTRY_SIGNAL: {
+					// TRVT_TILE_INDEX value type uses the next slot
+					uint32_t signal_tile = insn.value;
+					if (!have_previous_signal) {
+						if (input.previous_signal_callback) {
+							previous_signal_tile = input.previous_signal_callback(v, input.previous_signal_ptr);
 						}
-						bool match = (signal_tile != INVALID_TILE)
-								&& (previous_signal_tile == signal_tile);
-						result = TestBinaryConditionCommon(item, match);
-						break;
+						have_previous_signal = true;
 					}
+					bool match = (signal_tile != INVALID_TILE)
+							&& (previous_signal_tile == signal_tile);
+					result = TestBinaryConditionCommon(item, match);
+					break;
+				}
 
-					case TRIT_COND_TRAIN_GROUP: {
-						result = TestBinaryConditionCommon(item, GroupIsInGroup(v->group_id, GetTraceRestrictValue(item)));
-						break;
-					}
+				case TRIT_COND_TRAIN_GROUP: {
+					result = TestBinaryConditionCommon(item, GroupIsInGroup(v->group_id, GetTraceRestrictValue(item)));
+					break;
+				}
 
-					case TRIT_COND_TRAIN_IN_SLOT: {
-						const TraceRestrictSlot *slot = TraceRestrictSlot::GetIfValid(GetTraceRestrictValue(item));
-						result = TestBinaryConditionCommon(item, slot != nullptr && slot->IsOccupant(v->index));
-						break;
-					}
+				case TRIT_COND_TRAIN_IN_SLOT: {
+					const TraceRestrictSlot *slot = TraceRestrictSlot::GetIfValid(GetTraceRestrictValue(item));
+					result = TestBinaryConditionCommon(item, slot != nullptr && slot->IsOccupant(v->index));
+					break;
+				}
 
-					case TRIT_COND_SLOT_OCCUPANCY: {
-						// TRIT_COND_SLOT_OCCUPANCY value type uses the next slot
-						i++;
-						uint32_t value = this->items[i];
-						const TraceRestrictSlot *slot = TraceRestrictSlot::GetIfValid(GetTraceRestrictValue(item));
-						switch (static_cast<TraceRestrictSlotOccupancyCondAuxField>(GetTraceRestrictAuxField(item))) {
-							case TRSOCAF_OCCUPANTS:
-								result = TestCondition(slot != nullptr ? slot->occupants.size() : 0, condop, value);
-								break;
+				case TRIT_COND_SLOT_OCCUPANCY: {
+					// TRIT_COND_SLOT_OCCUPANCY value type uses the next slot
+					uint32_t value = insn.value;
+					const TraceRestrictSlot *slot = TraceRestrictSlot::GetIfValid(GetTraceRestrictValue(item));
+					switch (static_cast<TraceRestrictSlotOccupancyCondAuxField>(GetTraceRestrictAuxField(item))) {
+						case TRSOCAF_OCCUPANTS:
+							result = TestCondition(slot != nullptr ? slot->occupants.size() : 0, condop, value);
+							break;
 
-							case TRSOCAF_REMAINING:
-								result = TestCondition(slot != nullptr ? slot->max_occupancy - slot->occupants.size() : 0, condop, value);
-								break;
+						case TRSOCAF_REMAINING:
+							result = TestCondition(slot != nullptr ? slot->max_occupancy - slot->occupants.size() : 0, condop, value);
+							break;
 
-							default:
-								NOT_REACHED();
-								break;
-						}
-						break;
+						default:
+							NOT_REACHED();
+							break;
 					}
+					break;
+				}
 
-					case TRIT_COND_PHYS_PROP: {
-						switch (static_cast<TraceRestrictPhysPropCondAuxField>(GetTraceRestrictAuxField(item))) {
-							case TRPPCAF_WEIGHT:
-								result = TestCondition(v->gcache.cached_weight, condop, condvalue);
-								break;
+				case TRIT_COND_PHYS_PROP: {
+					switch (static_cast<TraceRestrictPhysPropCondAuxField>(GetTraceRestrictAuxField(item))) {
+						case TRPPCAF_WEIGHT:
+							result = TestCondition(v->gcache.cached_weight, condop, condvalue);
+							break;
 
-							case TRPPCAF_POWER:
-								result = TestCondition(v->gcache.cached_power, condop, condvalue);
-								break;
+						case TRPPCAF_POWER:
+							result = TestCondition(v->gcache.cached_power, condop, condvalue);
+							break;
 
-							case TRPPCAF_MAX_TE:
-								result = TestCondition(v->gcache.cached_max_te / 1000, condop, condvalue);
-								break;
+						case TRPPCAF_MAX_TE:
+							result = TestCondition(v->gcache.cached_max_te / 1000, condop, condvalue);
+							break;
 
-							default:
-								NOT_REACHED();
-								break;
-						}
-						break;
+						default:
+							NOT_REACHED();
+							break;
 					}
+					break;
+				}
 
-					case TRIT_COND_PHYS_RATIO: {
-						switch (static_cast<TraceRestrictPhysPropRatioCondAuxField>(GetTraceRestrictAuxField(item))) {
-							case TRPPRCAF_POWER_WEIGHT:
-								result = TestCondition(min<uint>(UINT16_MAX, (100 * v->gcache.cached_power) / max<uint>(1, v->gcache.cached_weight)), condop, condvalue);
-								break;
+				case TRIT_COND_PHYS_RATIO: {
+					switch (static_cast<TraceRestrictPhysPropRatioCondAuxField>(GetTraceRestrictAuxField(item))) {
+						case TRPPRCAF_POWER_WEIGHT:
+							result = TestCondition(min<uint>(UINT16_MAX, (100 * v->gcache.cached_power) / max<uint>(1, v->gcache.cached_weight)), condop, condvalue);
+							break;
 
-							case TRPPRCAF_MAX_TE_WEIGHT:
-								result = TestCondition(min<uint>(UINT16_MAX, (v->gcache.cached_max_te / 10) / max<uint>(1, v->gcache.cached_weight)), condop, condvalue);
-								break;
+						case TRPPRCAF_MAX_TE_WEIGHT:
+							result = TestCondition(min<uint>(UINT16_MAX, (v->gcache.cached_max_te / 10) / max<uint>(1, v->gcache.cached_weight)), condop, condvalue);
+							break;
 
-							default:
-								NOT_REACHED();
-								break;
-						}
-						break;
+						default:
+							NOT_REACHED();
+							break;
 					}
+					break;
+				}
 
-					case TRIT_COND_TRAIN_OWNER: {
-						result = TestBinaryConditionCommon(item, v->owner == condvalue);
-						break;
-					}
+				case TRIT_COND_TRAIN_OWNER: {
+					result = TestBinaryConditionCommon(item, v->owner == condvalue);
+					break;
+				}
 
 
-					case TRIT_COND_TRAIN_STATUS: {
-						bool has_status = false;
-						switch (static_cast<TraceRestrictTrainStatusValueField>(GetTraceRestrictValue(item))) {
-							case TRTSVF_EMPTY:
-								has_status = true;
-								for (const Vehicle *v_iter = v; v_iter != nullptr; v_iter = v_iter->Next()) {
-									if (v_iter->cargo.StoredCount() > 0) {
-										has_status = false;
-										break;
-									}
+				case TRIT_COND_TRAIN_STATUS: {
+					bool has_status = false;
+					switch (static_cast<TraceRestrictTrainStatusValueField>(GetTraceRestrictValue(item))) {
+						case TRTSVF_EMPTY:
+							has_status = true;
+							for (const Vehicle *v_iter = v; v_iter != nullptr; v_iter = v_iter->Next()) {
+								if (v_iter->cargo.StoredCount() > 0) {
+									has_status = false;
+									break;
 								}
-								break;
+							}
+							break;
 
-							case TRTSVF_FULL:
-								has_status = true;
-								for (const Vehicle *v_iter = v; v_iter != nullptr; v_iter = v_iter->Next()) {
-									if (v_iter->cargo.StoredCount() < v_iter->cargo_cap) {
-										has_status = false;
-										break;
-									}
+						case TRTSVF_FULL:
+							has_status = true;
+							for (const Vehicle *v_iter = v; v_iter != nullptr; v_iter = v_iter->Next()) {
+								if (v_iter->cargo.StoredCount() < v_iter->cargo_cap) {
+									has_status = false;
+									break;
 								}
-								break;
-
-							case TRTSVF_BROKEN_DOWN:
-								has_status = v->flags & VRF_IS_BROKEN;
-								break;
+							}
+							break;
 
-							case TRTSVF_NEEDS_REPAIR:
-								has_status = v->critical_breakdown_count > 0;
-								break;
+						case TRTSVF_BROKEN_DOWN:
+							has_status = v->flags & VRF_IS_BROKEN;
+							break;
 
-							case TRTSVF_REVERSING:
-								has_status = v->reverse_distance > 0 || HasBit(v->flags, VRF_REVERSING);
-								break;
+						case TRTSVF_NEEDS_REPAIR:
+							has_status = v->critical_breakdown_count > 0;
+							break;
 
-							case TRTSVF_HEADING_TO_STATION_WAYPOINT:
-								has_status = v->current_order.IsType(OT_GOTO_STATION) || v->current_order.IsType(OT_GOTO_WAYPOINT);
-								break;
+						case TRTSVF_REVERSING:
+							has_status = v->reverse_distance > 0 || HasBit(v->flags, VRF_REVERSING);
+							break;
 
-							case TRTSVF_HEADING_TO_DEPOT:
-								has_status = v->current_order.IsType(OT_GOTO_DEPOT);
-								break;
+						case TRTSVF_HEADING_TO_STATION_WAYPOINT:
+							has_status = v->current_order.IsType(OT_GOTO_STATION) || v->current_order.IsType(OT_GOTO_WAYPOINT);
+							break;
 
-							case TRTSVF_LOADING:
-								has_status = v->current_order.IsType(OT_LOADING) || v->current_order.IsType(OT_LOADING_ADVANCE);
-								break;
+						case TRTSVF_HEADING_TO_DEPOT:
+							has_status = v->current_order.IsType(OT_GOTO_DEPOT);
+							break;
 
-							case TRTSVF_WAITING:
-								has_status = v->current_order.IsType(OT_WAITING);
-								break;
+						case TRTSVF_LOADING:
+							has_status = v->current_order.IsType(OT_LOADING) || v->current_order.IsType(OT_LOADING_ADVANCE);
+							break;
 
-							case TRTSVF_LOST:
-								has_status = HasBit(v->vehicle_flags, VF_PATHFINDER_LOST);
-								break;
+						case TRTSVF_WAITING:
+							has_status = v->current_order.IsType(OT_WAITING);
+							break;
 
-							case TRTSVF_REQUIRES_SERVICE:
-								has_status = v->NeedsServicing();
-								break;
-						}
-						result = TestBinaryConditionCommon(item, has_status);
-						break;
-					}
+						case TRTSVF_LOST:
+							has_status = HasBit(v->vehicle_flags, VF_PATHFINDER_LOST);
+							break;
 
-					case TRIT_COND_LOAD_PERCENT: {
-						result = TestCondition(CalcPercentVehicleFilled(v, nullptr), condop, condvalue);
-						break;
+						case TRTSVF_REQUIRES_SERVICE:
+							has_status = v->NeedsServicing();
+							break;
 					}
+					result = TestBinaryConditionCommon(item, has_status);
+					break;
+				}
 
-					default:
-						NOT_REACHED();
+				case TRIT_COND_LOAD_PERCENT: {
+					result = TestCondition(CalcPercentVehicleFilled(v, nullptr), condop, condvalue);
+					break;
 				}
-				HandleCondition(condstack, condflags, result);
+
+				default:
+					NOT_REACHED();
 			}
+			i = result ? insn.next_true : insn.next_false;
 		} else {
-			if (condstack.empty() || condstack.back() & TRCSF_ACTIVE) {
-				switch(type) {
-					case TRIT_PF_DENY:
-						if (GetTraceRestrictValue(item)) {
-							out.flags &= ~TRPRF_DENY;
-						} else {
-							out.flags |= TRPRF_DENY;
-						}
-						break;
+			switch(type) {
+				case TRIT_NULL:
+					// unconditional jump
+					break;
 
-					case TRIT_PF_PENALTY:
-						switch (static_cast<TraceRestrictPathfinderPenaltyAuxField>(GetTraceRestrictAuxField(item))) {
-							case TRPPAF_VALUE:
-								out.penalty += GetTraceRestrictValue(item);
-								break;
+				case TRIT_PF_DENY:
+					if (GetTraceRestrictValue(item)) {
+						out.flags &= ~TRPRF_DENY;
+					} else {
+						out.flags |= TRPRF_DENY;
+					}
+					break;
 
-							case TRPPAF_PRESET: {
-								uint16 index = GetTraceRestrictValue(item);
-								assert(index < TRPPPI_END);
-								out.penalty += _tracerestrict_pathfinder_penalty_preset_values[index];
-								break;
-							}
+				case TRIT_PF_PENALTY:
+					switch (static_cast<TraceRestrictPathfinderPenaltyAuxField>(GetTraceRestrictAuxField(item))) {
+						case TRPPAF_VALUE:
+							out.penalty += GetTraceRestrictValue(item);
+							break;
 
-							default:
-								NOT_REACHED();
+						case TRPPAF_PRESET: {
+							uint16 index = GetTraceRestrictValue(item);
+							assert(index < TRPPPI_END);
+							out.penalty += _tracerestrict_pathfinder_penalty_preset_values[index];
+							break;
 						}
-						break;
 
-					case TRIT_RESERVE_THROUGH:
-						if (GetTraceRestrictValue(item)) {
-							out.flags &= ~TRPRF_RESERVE_THROUGH;
-						} else {
-							out.flags |= TRPRF_RESERVE_THROUGH;
-						}
-						break;
+						default:
+							NOT_REACHED();
+					}
+					break;
 
-					case TRIT_LONG_RESERVE:
-						if (GetTraceRestrictValue(item)) {
-							out.flags &= ~TRPRF_LONG_RESERVE;
-						} else {
-							out.flags |= TRPRF_LONG_RESERVE;
-						}
-						break;
+				case TRIT_RESERVE_THROUGH:
+					if (GetTraceRestrictValue(item)) {
+						out.flags &= ~TRPRF_RESERVE_THROUGH;
+					} else {
+						out.flags |= TRPRF_RESERVE_THROUGH;
+					}
+					break;
 
-					case TRIT_WAIT_AT_PBS:
-						switch (static_cast<TraceRestrictWaitAtPbsValueField>(GetTraceRestrictValue(item))) {
-							case TRWAPVF_WAIT_AT_PBS:
-								out.flags |= TRPRF_WAIT_AT_PBS;
-								break;
+				case TRIT_LONG_RESERVE:
+					if (GetTraceRestrictValue(item)) {
+						out.flags &= ~TRPRF_LONG_RESERVE;
+					} else {
+						out.flags |= TRPRF_LONG_RESERVE;
+					}
+					break;
 
-							case TRWAPVF_CANCEL_WAIT_AT_PBS:
-								out.flags &= ~TRPRF_WAIT_AT_PBS;
-								break;
+				case TRIT_WAIT_AT_PBS:
+					switch (static_cast<TraceRestrictWaitAtPbsValueField>(GetTraceRestrictValue(item))) {
+						case TRWAPVF_WAIT_AT_PBS:
+							out.flags |= TRPRF_WAIT_AT_PBS;
+							break;
 
-							case TRWAPVF_PBS_RES_END_WAIT:
-								out.flags |= TRPRF_PBS_RES_END_WAIT;
-								break;
+						case TRWAPVF_CANCEL_WAIT_AT_PBS:
+							out.flags &= ~TRPRF_WAIT_AT_PBS;
+							break;
 
-							case TRWAPVF_CANCEL_PBS_RES_END_WAIT:
-								out.flags &= ~TRPRF_PBS_RES_END_WAIT;
-								break;
+						case TRWAPVF_PBS_RES_END_WAIT:
+							out.flags |= TRPRF_PBS_RES_END_WAIT;
+							break;
 
-							default:
-								NOT_REACHED();
-								break;
-						}
-						break;
+						case TRWAPVF_CANCEL_PBS_RES_END_WAIT:
+							out.flags &= ~TRPRF_PBS_RES_END_WAIT;
+							break;
 
-					case TRIT_SLOT: {
-						if (!input.permitted_slot_operations) break;
-						TraceRestrictSlot *slot = TraceRestrictSlot::GetIfValid(GetTraceRestrictValue(item));
-						if (slot == nullptr) break;
-						switch (static_cast<TraceRestrictSlotCondOpField>(GetTraceRestrictCondOp(item))) {
-							case TRSCOF_ACQUIRE_WAIT:
-								if (input.permitted_slot_operations & TRPISP_ACQUIRE) {
-									if (!slot->Occupy(v->index)) out.flags |= TRPRF_WAIT_AT_PBS;
-								}
-								break;
+						default:
+							NOT_REACHED();
+							break;
+					}
+					break;
 
-							case TRSCOF_ACQUIRE_TRY:
-								if (input.permitted_slot_operations & TRPISP_ACQUIRE) slot->Occupy(v->index);
-								break;
+				case TRIT_SLOT: {
+					if (!input.permitted_slot_operations) break;
+					TraceRestrictSlot *slot = TraceRestrictSlot::GetIfValid(GetTraceRestrictValue(item));
+					if (slot == nullptr) break;
+					switch (static_cast<TraceRestrictSlotCondOpField>(GetTraceRestrictCondOp(item))) {
+						case TRSCOF_ACQUIRE_WAIT:
+							if (input.permitted_slot_operations & TRPISP_ACQUIRE) {
+								if (!slot->Occupy(v->index)) out.flags |= TRPRF_WAIT_AT_PBS;
+							}
+							break;
 
-							case TRSCOF_RELEASE_BACK:
-								if (input.permitted_slot_operations & TRPISP_RELEASE_BACK) slot->Vacate(v->index);
-								break;
+						case TRSCOF_ACQUIRE_TRY:
+							if (input.permitted_slot_operations & TRPISP_ACQUIRE) slot->Occupy(v->index);
+							break;
 
-							case TRSCOF_RELEASE_FRONT:
-								if (input.permitted_slot_operations & TRPISP_RELEASE_FRONT) slot->Vacate(v->index);
-								break;
+						case TRSCOF_RELEASE_BACK:
+							if (input.permitted_slot_operations & TRPISP_RELEASE_BACK) slot->Vacate(v->index);
+							break;
 
-							case TRSCOF_PBS_RES_END_ACQ_WAIT:
-								if (input.permitted_slot_operations & TRPISP_PBS_RES_END_ACQUIRE) {
-									if (!slot->Occupy(v->index)) out.flags |= TRPRF_PBS_RES_END_WAIT;
-								} else if (input.permitted_slot_operations & TRPISP_PBS_RES_END_ACQ_DRY) {
-									if (!slot->OccupyDryRun(v->index)) out.flags |= TRPRF_PBS_RES_END_WAIT;
-								}
-								break;
+						case TRSCOF_RELEASE_FRONT:
+							if (input.permitted_slot_operations & TRPISP_RELEASE_FRONT) slot->Vacate(v->index);
+							break;
 
-							case TRSCOF_PBS_RES_END_ACQ_TRY:
-								if (input.permitted_slot_operations & TRPISP_PBS_RES_END_ACQUIRE) slot->Occupy(v->index);
-								break;
+						case TRSCOF_PBS_RES_END_ACQ_WAIT:
+							if (input.permitted_slot_operations & TRPISP_PBS_RES_END_ACQUIRE) {
+								if (!slot->Occupy(v->index)) out.flags |= TRPRF_PBS_RES_END_WAIT;
+							} else if (input.permitted_slot_operations & TRPISP_PBS_RES_END_ACQ_DRY) {
+								if (!slot->OccupyDryRun(v->index)) out.flags |= TRPRF_PBS_RES_END_WAIT;
+							}
+							break;
 
-							case TRSCOF_PBS_RES_END_RELEASE:
-								if (input.permitted_slot_operations & TRPISP_PBS_RES_END_RELEASE) slot->Vacate(v->index);
-								break;
+						case TRSCOF_PBS_RES_END_ACQ_TRY:
+							if (input.permitted_slot_operations & TRPISP_PBS_RES_END_ACQUIRE) slot->Occupy(v->index);
+							break;
 
-							default:
-								NOT_REACHED();
-								break;
-						}
-						break;
-					}
+						case TRSCOF_PBS_RES_END_RELEASE:
+							if (input.permitted_slot_operations & TRPISP_PBS_RES_END_RELEASE) slot->Vacate(v->index);
+							break;
 
-					case TRIT_REVERSE:
-						switch (static_cast<TraceRestrictReverseValueField>(GetTraceRestrictValue(item))) {
-							case TRRVF_REVERSE:
-								out.flags |= TRPRF_REVERSE;
-								break;
+						default:
+							NOT_REACHED();
+							break;
+					}
+					break;
+				}
 
-							case TRRVF_CANCEL_REVERSE:
-								out.flags &= ~TRPRF_REVERSE;
-								break;
+				case TRIT_REVERSE:
+					switch (static_cast<TraceRestrictReverseValueField>(GetTraceRestrictValue(item))) {
+						case TRRVF_REVERSE:
+							out.flags |= TRPRF_REVERSE;
+							break;
 
-							default:
-								NOT_REACHED();
-								break;
-						}
-						break;
+						case TRRVF_CANCEL_REVERSE:
+							out.flags &= ~TRPRF_REVERSE;
+							break;
 
-					case TRIT_SPEED_RESTRICTION: {
-						out.speed_restriction = GetTraceRestrictValue(item);
-						out.flags |= TRPRF_SPEED_RETRICTION_SET;
-						break;
+						default:
+							NOT_REACHED();
+							break;
 					}
+					break;
 
-					default:
-						NOT_REACHED();
+				case TRIT_SPEED_RESTRICTION: {
+					out.speed_restriction = GetTraceRestrictValue(item);
+					out.flags |= TRPRF_SPEED_RETRICTION_SET;
+					break;
 				}
+
+				default:
+					NOT_REACHED();
+			}
+			i = insn.next_true;
+		}
+	}
+}
+
+/**
+ * Compile the instruction list into the pre-decoded form used by Execute
+ * Conditional blocks are lowered into jumps, each condition has a target for when it is true and one for when it is false,
+ * and the end of each if/elif/else branch jumps to the matching end if. Branches which are not taken are skipped entirely.
+ * This must be called whenever the instruction list changes, the instruction list must be valid
+ */
+void TraceRestrictProgram::Compile()
+{
+	/* Pending jump targets of a conditional block */
+	struct CondBlock {
+		std::vector<uint32> next_branch;      ///< Conditions which go to the next elif/orif/else/endif when false
+		std::vector<uint32> end;              ///< Jumps which go to the end if
+	};
+	std::vector<CondBlock> condblocks;
+
+	this->compiled.clear();
+	this->input_dependent = false;
+
+	auto emit = [&](TraceRestrictItem item, uint32 value) -> uint32 {
+		uint32 index = (uint32)this->compiled.size();
+		this->compiled.emplace_back(item, value, index + 1, index + 1);
+		return index;
+	};
+	auto set_next_branch = [&](CondBlock &block, uint32 target) {
+		for (uint32 index : block.next_branch) this->compiled[index].next_false = target;
+		block.next_branch.clear();
+	};
+
+	size_t size = this->items.size();
+	for (size_t i = 0; i < size; i++) {
+		TraceRestrictItem item = this->items[i];
+		uint32 value = 0;
+		if (IsTraceRestrictDoubleItem(item)) {
+			i++;
+			value = this->items[i];
+		}
+
+		if (!IsTraceRestrictConditional(item)) {
+			emit(item, value);
+			continue;
+		}
+
+		TraceRestrictItemType type = GetTraceRestrictType(item);
+		TraceRestrictCondFlags condflags = GetTraceRestrictCondFlags(item);
+		if (type == TRIT_COND_ENDIF) {
+			assert(!condblocks.empty());
+			CondBlock &block = condblocks.back();
+			if (condflags & TRCF_ELSE) {
+				// else, the previous branch ends here
+				block.end.push_back(emit(0, 0));
+				set_next_branch(block, (uint32)this->compiled.size());
+			} else {
+				// end if
+				uint32 target = (uint32)this->compiled.size();
+				set_next_branch(block, target);
+				for (uint32 index : block.end) this->compiled[index].next_true = target;
+				condblocks.pop_back();
 			}
+			continue;
+		}
+
+		if (type == TRIT_COND_ENTRY_DIRECTION || type == TRIT_COND_PBS_ENTRY_SIGNAL) this->input_dependent = true;
+
+		if (condflags & TRCF_OR) {
+			// orif, this is skipped when reached whilst the block is active, and tested otherwise
+			assert(!condblocks.empty());
+			uint32 skip = emit(0, 0);
+			this->compiled[skip].next_true = skip + 2;
+			set_next_branch(condblocks.back(), skip + 1);
+		} else if (condflags & TRCF_ELSE) {
+			// elif, the previous branch ends here
+			assert(!condblocks.empty());
+			CondBlock &block = condblocks.back();
+			block.end.push_back(emit(0, 0));
+			set_next_branch(block, (uint32)this->compiled.size());
+		} else {
+			// if
+			condblocks.emplace_back();
 		}
+		condblocks.back().next_branch.push_back(emit(item, value));
+	}
+	assert(condblocks.empty());
+
+	const uint32 compiled_size = (uint32)this->compiled.size();
+	auto is_jump = [&](uint32 index) -> bool {
+		return index < compiled_size && GetTraceRestrictType(this->compiled[index].item) == TRIT_NULL;
+	};
+
+	/* Conditions which are always false are replaced with jumps,
+	 * then all jumps to jumps are threaded, jumps are always forwards so iterate backwards */
+	for (uint32 i = compiled_size; i-- > 0;) {
+		TraceRestrictCompiledInstruction &insn = this->compiled[i];
+		if (GetTraceRestrictType(insn.item) == TRIT_COND_UNDEFINED) {
+			insn.item = 0;
+			insn.value = 0;
+			insn.next_true = insn.next_false;
+		}
+		if (is_jump(insn.next_true)) insn.next_true = this->compiled[insn.next_true].next_true;
+		if (is_jump(insn.next_false)) insn.next_false = this->compiled[insn.next_false].next_true;
+		if (is_jump(i)) insn.next_false = insn.next_true;
 	}
-	assert(condstack.empty());
 }
 
 /**
@@ -1386,6 +1472,7 @@ CommandCost CmdProgramSignalTraceRestrict(TileIndex tile, DoCommandFlag flags, u
 		// move in modified program
 		prog->items.swap(items);
 		prog->actions_used_flags = actions_used_flags;
+		prog->Compile();
 
 		if (prog->items.size() == 0 && prog->refcount == 1) {
 			// program is empty, and this tile is the only reference to it
@@ -1549,6 +1636,7 @@ CommandCost CmdProgramSignalTraceRestrictProgMgmt(TileIndex tile, DoCommandFlag
 void TraceRestrictRemoveDestinationID(TraceRestrictOrderCondAuxField type, uint16 index)
 {
 	for (TraceRestrictProgram *prog : TraceRestrictProgram::Iterate()) {
+		bool changed = false;
 		for (size_t i = 0; i < prog->items.size(); i++) {
 			TraceRestrictItem &item = prog->items[i]; // note this is a reference,
 			if (GetTraceRestrictType(item) == TRIT_COND_CURRENT_ORDER ||
@@ -1556,10 +1644,12 @@ void TraceRestrictRemoveDestinationID(TraceRestrictOrderCondAuxField type, uint1
 					GetTraceRestrictType(item) == TRIT_COND_LAST_STATION) {
 				if (GetTraceRestrictAuxField(item) == type && GetTraceRestrictValue(item) == index) {
 					SetTraceRestrictValueDefault(item, TRVT_ORDER); // this updates the instruction in-place
+					changed = true;
 				}
 			}
 			if (IsTraceRestrictDoubleItem(item)) i++;
 		}
+		if (changed) prog->Compile();
 	}
 
 	// update windows
@@ -1573,13 +1663,16 @@ void TraceRestrictRemoveDestinationID(TraceRestrictOrderCondAuxField type, uint1
 void TraceRestrictRemoveGroupID(GroupID index)
 {
 	for (TraceRestrictProgram *prog : TraceRestrictProgram::Iterate()) {
+		bool changed = false;
 		for (size_t i = 0; i < prog->items.size(); i++) {
 			TraceRestrictItem &item = prog->items[i]; // note this is a reference,
 			if (GetTraceRestrictType(item) == TRIT_COND_TRAIN_GROUP && GetTraceRestrictValue(item) == index) {
 				SetTraceRestrictValueDefault(item, TRVT_GROUP_INDEX); // this updates the instruction in-place
+				changed = true;
 			}
 			if (IsTraceRestrictDoubleItem(item)) i++;
 		}
+		if (changed) prog->Compile();
 	}
 
 	// update windows
@@ -1594,15 +1687,18 @@ void TraceRestrictRemoveGroupID(GroupID index)
 void TraceRestrictUpdateCompanyID(CompanyID old_company, CompanyID new_company)
 {
 	for (TraceRestrictProgram *prog : TraceRestrictProgram::Iterate()) {
+		bool changed = false;
 		for (size_t i = 0; i < prog->items.size(); i++) {
 			TraceRestrictItem &item = prog->items[i]; // note this is a reference,
 			if (GetTraceRestrictType(item) == TRIT_COND_TRAIN_OWNER) {
 				if (GetTraceRestrictValue(item) == old_company) {
 					SetTraceRestrictValue(item, new_company); // this updates the instruction in-place
+					changed = true;
 				}
 			}
 			if (IsTraceRestrictDoubleItem(item)) i++;
 		}
+		if (changed) prog->Compile();
 	}
 
 	for (TraceRestrictSlot *slot : TraceRestrictSlot::Iterate()) {
@@ -1712,7 +1808,37 @@ bool TraceRestrictSlot::ValidateVehicleIndex()
 	return ok;
 }
 
+/**
+ * Check the vehicle index entries of the vehicles in a range of the vehicle pool.
+ * The entries of the occupants of the slots are checked by #ValidateSlotOccupants.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ * @return True if all entries refer to slots occupied by the vehicle.
+ */
+bool TraceRestrictSlot::ValidateVehicleIndex(size_t first, size_t last)
+{
+	for (size_t id = first; id < last; id++) {
+		auto range = slot_vehicle_index.equal_range((VehicleID)id);
+		for (auto it = range.first; it != range.second; ++it) {
+			const TraceRestrictSlot *slot = TraceRestrictSlot::GetIfValid(it->second);
+			if (slot == nullptr || !slot->IsOccupant(it->first)) return false;
+		}
+	}
+	return true;
+}
+
 void TraceRestrictSlot::ValidateSlotOccupants(std::function<void(const char *)> log)
+{
+	ValidateSlotOccupants(std::move(log), 0, TraceRestrictSlot::GetPoolSize());
+}
+
+/**
+ * Check the occupants of the slots in a range of the slot pool, and their vehicle index entries.
+ * @param log Function to log mismatches to, or \c nullptr.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ */
+void TraceRestrictSlot::ValidateSlotOccupants(std::function<void(const char *)> log, size_t first, size_t last)
 {
 	char cclog_buffer[1024];
 #define CCLOG(...) { \
@@ -1721,8 +1847,14 @@ void TraceRestrictSlot::ValidateSlotOccupants(std::function<void(const char *)>
 	if (log) log(cclog_buffer); \
 }
 
-	for (const TraceRestrictSlot *slot : TraceRestrictSlot::Iterate()) {
+	for (const TraceRestrictSlot *slot : TraceRestrictSlot::Iterate(first)) {
+		if (slot->index >= last) break;
 		for (VehicleID id : slot->occupants) {
+			auto range = slot_vehicle_index.equal_range(id);
+			if (std::none_of(range.first, range.second, [&](const std::pair<const VehicleID, TraceRestrictSlotID> &entry) { return entry.second == slot->index; })) {
+				CCLOG("Slot %u (%s) occupant %u is missing from the vehicle index", slot->index, slot->name.c_str(), id);
+			}
+
 			const Train  *t = Train::GetIfValid(id);
 			if (t) {
 				if (!t->IsFrontEngine()) CCLOG("Slot %u (%s) has non-front engine train: %s", slot->index, slot->name.c_str(), scope_dumper().VehicleInfo(t));
@@ -1796,16 +1928,20 @@ void TraceRestrictGetVehicleSlots(VehicleID id, std::vector<TraceRestrictSlotID>
 void TraceRestrictRemoveSlotID(TraceRestrictSlotID index)
 {
 	for (TraceRestrictProgram *prog : TraceRestrictProgram::Iterate()) {
+		bool changed = false;
 		for (size_t i = 0; i < prog->items.size(); i++) {
 			TraceRestrictItem &item = prog->items[i]; // note this is a reference,
 			if ((GetTraceRestrictType(item) == TRIT_SLOT || GetTraceRestrictType(item) == TRIT_COND_TRAIN_IN_SLOT) && GetTraceRestrictValue(item) == index) {
 				SetTraceRestrictValueDefault(item, TRVT_SLOT_INDEX); // this updates the instruction in-place
+				changed = true;
 			}
 			if ((GetTraceRestrictType(item) == TRIT_COND_SLOT_OCCUPANCY) && GetTraceRestrictValue(item) == index) {
 				SetTraceRestrictValueDefault(item, TRVT_SLOT_INDEX_INT); // this updates the instruction in-place
+				changed = true;
 			}
 			if (IsTraceRestrictDoubleItem(item)) i++;
 		}
+		if (changed) prog->Compile();
 	}
 
 	bool changed_order = false;
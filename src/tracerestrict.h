@@ -370,6 +370,21 @@ struct TraceRestrictProgramResult {
 			: penalty(0), flags(static_cast<TraceRestrictProgramResultFlags>(0)) { }
 };
 
+/**
+ * Pre-decoded instruction of a compiled program, see TraceRestrictProgram::Compile
+ * Control flow is resolved into jump targets, such that no condition stack is needed at execution time
+ * Unconditional jumps use the TRIT_NULL type, which is otherwise not valid in programs
+ */
+struct TraceRestrictCompiledInstruction {
+	TraceRestrictItem item;                  ///< Instruction
+	uint32 value;                            ///< Second item of double-item instructions
+	uint32 next_true;                        ///< Index of the next instruction, or the jump target, or for conditions: the next instruction if the condition is true
+	uint32 next_false;                       ///< For conditions: the next instruction if the condition is false
+
+	TraceRestrictCompiledInstruction(TraceRestrictItem item_, uint32 value_, uint32 next_true_, uint32 next_false_)
+			: item(item_), value(value_), next_true(next_true_), next_false(next_false_) { }
+};
+
 /**
  * Program type, this stores the instruction list
  * This is refcounted, see info at top of tracerestrict.cpp
@@ -378,12 +393,16 @@ struct TraceRestrictProgram : TraceRestrictProgramPool::PoolItem<&_tracerestrict
 	std::vector<TraceRestrictItem> items;
 	uint32 refcount;
 	TraceRestrictProgramActionsUsedFlags actions_used_flags;
+	std::vector<TraceRestrictCompiledInstruction> compiled; ///< Compiled form of items, this is what is executed
+	bool input_dependent;                    ///< Whether the result may depend on the signal or previous signal passed as input, and not only the train
 
 	TraceRestrictProgram()
-			: refcount(0), actions_used_flags(static_cast<TraceRestrictProgramActionsUsedFlags>(0)) { }
+			: refcount(0), actions_used_flags(static_cast<TraceRestrictProgramActionsUsedFlags>(0)), input_dependent(false) { }
 
 	void Execute(const Train *v, const TraceRestrictProgramInput &input, TraceRestrictProgramResult &out) const;
 
+	void Compile();
+
 	/**
 	 * Increment ref count, only use when creating a mapping
 	 */
@@ -433,10 +452,12 @@ struct TraceRestrictProgram : TraceRestrictProgramPool::PoolItem<&_tracerestrict
 		return items.begin() + TraceRestrictProgram::InstructionOffsetToArrayOffset(items, instruction_offset);
 	}
 
-	/** Call validation function on current program instruction list and set actions_used_flags */
+	/** Call validation function on current program instruction list and set actions_used_flags, and compile the program if it is valid */
 	CommandCost Validate()
 	{
-		return TraceRestrictProgram::Validate(items, actions_used_flags);
+		CommandCost result = TraceRestrictProgram::Validate(items, actions_used_flags);
+		if (result.Succeeded()) this->Compile();
+		return result;
 	}
 };
 
@@ -827,7 +848,9 @@ struct TraceRestrictSlot : TraceRestrictSlotPool::PoolItem<&_tracerestrictslot_p
 
 	static void RebuildVehicleIndex();
 	static bool ValidateVehicleIndex();
+	static bool ValidateVehicleIndex(size_t first, size_t last);
 	static void ValidateSlotOccupants(std::function<void(const char *)> log);
+	static void ValidateSlotOccupants(std::function<void(const char *)> log, size_t first, size_t last);
 	static void PreCleanPool();
 
 	TraceRestrictSlot(CompanyID owner = INVALID_COMPANY)
@@ -852,6 +852,100 @@ static void TileLoop_Trees(TileIndex tile)
 	MarkTileDirtyByTile(tile, ZOOM_LVL_DRAW_MAP);
 }
 
+/**
+ * Parallel variant of #TileLoop_Trees.
+ * Bits 0-15 of \a random decide about ambient sounds, bits 16-31 about the growth.
+ * Spreading and dying trees are left to the serial tile loop, as they modify or look at other tiles.
+ */
+static TileLoopParallelResult TileLoopParallel_Trees(TileIndex tile, uint32 random)
+{
+	if (GetTreeGround(tile) == TREE_GROUND_SHORE || HasGrfMiscBit(GMB_AMBIENT_SOUND_CALLBACK)) return { TLPF_SERIAL, SND_BEGIN };
+	if (GetTreeCounter(tile) == 15 && (GetTreeGrowth(tile) == 3 || GetTreeGrowth(tile) == 6)) return { TLPF_SERIAL, SND_BEGIN };
+
+	TileLoopParallelResult result = { TLPF_NONE, SND_BEGIN };
+	switch (_settings_game.game_creation.landscape) {
+		case LT_TROPIC:
+			switch (GetTropicZone(tile)) {
+				case TROPICZONE_DESERT:
+					if (GetTreeGround(tile) != TREE_GROUND_SNOW_DESERT) {
+						SetTreeGroundDensity(tile, TREE_GROUND_SNOW_DESERT, 3);
+						result.flags |= TLPF_DIRTY_DETAIL;
+					}
+					break;
+
+				case TROPICZONE_RAINFOREST: {
+					static const SoundFx forest_sounds[] = {
+						SND_42_LOON_BIRD,
+						SND_43_LION,
+						SND_44_MONKEYS,
+						SND_48_DISTANT_BIRD
+					};
+					if (Chance16I(1, 200, random)) {
+						result.flags |= TLPF_SOUND;
+						result.sound = forest_sounds[GB(random, 16, 2)];
+					}
+					break;
+				}
+
+				default: break;
+			}
+			break;
+
+		case LT_ARCTIC: {
+			int k = GetTileZ(tile) - GetSnowLine() + 1;
+			if (k < 0) {
+				switch (GetTreeGround(tile)) {
+					case TREE_GROUND_SNOW_DESERT: SetTreeGroundDensity(tile, TREE_GROUND_GRASS, 3); result.flags |= TLPF_DIRTY_DETAIL; break;
+					case TREE_GROUND_ROUGH_SNOW:  SetTreeGroundDensity(tile, TREE_GROUND_ROUGH, 3); result.flags |= TLPF_DIRTY_DETAIL; break;
+					default: break;
+				}
+			} else {
+				uint density = min<uint>(k, 3);
+
+				if (GetTreeGround(tile) != TREE_GROUND_SNOW_DESERT && GetTreeGround(tile) != TREE_GROUND_ROUGH_SNOW) {
+					TreeGround tg = GetTreeGround(tile) == TREE_GROUND_ROUGH ? TREE_GROUND_ROUGH_SNOW : TREE_GROUND_SNOW_DESERT;
+					SetTreeGroundDensity(tile, tg, density);
+					result.flags |= TLPF_DIRTY_DETAIL;
+				} else if (GetTreeDensity(tile) != density) {
+					SetTreeGroundDensity(tile, GetTreeGround(tile), density);
+					result.flags |= TLPF_DIRTY_DETAIL;
+				} else if (density == 3 && Chance16I(1, 200, random)) {
+					result.flags |= TLPF_SOUND;
+					result.sound = HasBit(random, 31) ? SND_39_HEAVY_WIND : SND_34_WIND;
+				}
+			}
+			break;
+		}
+	}
+
+	uint counter = GetTreeCounter(tile);
+
+	if ((counter & 7) == 7 && GetTreeGround(tile) == TREE_GROUND_GRASS) {
+		uint density = GetTreeDensity(tile);
+		if (density < 3) {
+			SetTreeGroundDensity(tile, TREE_GROUND_GRASS, density + 1);
+			result.flags |= TLPF_DIRTY_DETAIL;
+		}
+	}
+	if (counter < 15) {
+		if (_settings_game.construction.tree_growth_rate > 0) {
+			/* slow, very slow, extremely slow */
+			static const uint16 grow_slowing_values[3] = { 0x10000 / 5, 0x10000 / 20, 0x10000 / 120 };
+
+			if (GB(random, 16, 16) < grow_slowing_values[_settings_game.construction.tree_growth_rate - 1]) {
+				AddTreeCounter(tile, 1);
+			}
+		} else {
+			AddTreeCounter(tile, 1);
+		}
+		return result;
+	}
+	SetTreeCounter(tile, 0);
+	AddTreeGrowth(tile, 1);
+	result.flags |= TLPF_DIRTY_DETAIL;
+	return result;
+}
+
 void OnTick_Trees()
 {
 	/* Don't place trees if that's not allowed */
@@ -911,6 +1005,7 @@ extern const TileTypeProcs _tile_type_trees_procs = {
 	nullptr,                     // click_tile_proc
 	nullptr,                     // animate_tile_proc
 	TileLoop_Trees,           // tile_loop_proc
+	TileLoopParallel_Trees,   // tile_loop_parallel_proc
 	ChangeTileOwner_Trees,    // change_tile_owner_proc
 	nullptr,                     // add_produced_cargo_proc
 	nullptr,                     // vehicle_enter_tile_proc
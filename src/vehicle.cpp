@@ -63,6 +63,8 @@
 #include "table/strings.h"
 
 #include <algorithm>
+#include <chrono>
+#include <vector>
 
 #include "safeguards.h"
 
@@ -438,6 +440,7 @@ Vehicle::Vehicle(VehicleType type)
 	this->last_loading_station = INVALID_STATION;
 	this->cur_image_valid_dir  = INVALID_DIR;
 	this->vcache.cached_veh_flags = 0;
+	this->tile_grid_cell     = INVALID_VEHICLE_TILE_GRID_CELL;
 }
 
 /**
@@ -449,60 +452,147 @@ byte VehicleRandomBits()
 	return GB(Random(), 0, 8);
 }
 
-/* Size of the hash, 6 = 64 x 64, 7 = 128 x 128. Larger sizes will (in theory) reduce hash
- * lookup times at the expense of memory usage. */
-const int HASH_BITS = 7;
-const int HASH_SIZE = 1 << HASH_BITS;
-const int HASH_MASK = HASH_SIZE - 1;
-const int TOTAL_HASH_SIZE = 1 << (HASH_BITS * 2);
-const int TOTAL_HASH_MASK = TOTAL_HASH_SIZE - 1;
-
-/* Resolution of the hash, 0 = 1*1 tile, 1 = 2*2 tiles, 2 = 4*4 tiles, etc.
- * Profiling results show that 0 is fastest. */
-const int HASH_RES = 0;
+/**
+ * Entry of the vehicle tile grid.
+ * The tile and type of the vehicle are stored alongside it, to be able to filter without dereferencing the vehicle.
+ */
+struct VehicleTileGridEntry {
+	Vehicle *v;                          ///< The vehicle.
+	TileIndex tile;                      ///< Tile of the vehicle, the same as v->tile.
+	VehicleType type;                    ///< Type of the vehicle, the same as v->type.
+};
 
-static Vehicle *_vehicle_tile_hash[TOTAL_HASH_SIZE];
+/**
+ * Spatial index of the vehicles on the map by tile.
+ * The grid has one cell per tile, up to a bounded number of cells along each axis, beyond which it wraps around the map.
+ * Its dimensions follow the map size, so small maps get an exact grid, and large maps a grid with few tiles per cell.
+ * Each cell is a contiguous array of the vehicles on the tiles of the cell, in no particular order.
+ */
+static std::vector<std::vector<VehicleTileGridEntry>> _vehicle_tile_grid;
+static std::vector<uint64> _vehicle_tile_grid_occupied; ///< Bitmap of the non-empty cells, so that empty cells can be skipped without touching them.
+static uint _vehicle_tile_grid_log_x;     ///< Log2 of the number of cells along the X axis.
+static uint _vehicle_tile_grid_log_y;     ///< Log2 of the number of cells along the Y axis.
+static uint _vehicle_tile_grid_y_shift;   ///< Shift from the Y part of a tile index to the Y part of a cell index.
+static uint _vehicle_tile_grid_x_mask;    ///< Mask of the X part of a cell index.
+static uint _vehicle_tile_grid_y_mask;    ///< Mask of the Y part of a cell index.
+static uint _vehicle_tile_grid_map_log_x; ///< MapLogX() the grid was made for.
+static uint _vehicle_tile_grid_map_log_y; ///< MapLogY() the grid was made for.
+
+/** Maximum log2 of the number of cells of the vehicle tile grid. */
+static const uint VEHICLE_TILE_GRID_MAX_CELLS_LOG = 16;
 
-static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, void *data, VehicleFromPosProc *proc, bool find_first)
+/**
+ * (Re)make the vehicle tile grid, for the current map size.
+ * This does not touch the vehicles, the grid must not contain any vehicles which are still referenced.
+ */
+static void InitializeVehicleTileGrid()
 {
-	for (int y = yl; ; y = (y + (1 << HASH_BITS)) & (HASH_MASK << HASH_BITS)) {
-		for (int x = xl; ; x = (x + 1) & HASH_MASK) {
-			Vehicle *v = _vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
-			for (; v != nullptr; v = v->hash_tile_next) {
-				Vehicle *a = proc(v, data);
-				if (find_first && a != nullptr) return a;
-			}
-			if (x == xu) break;
+	uint log_x = MapLogX();
+	uint log_y = MapLogY();
+	while (log_x + log_y > VEHICLE_TILE_GRID_MAX_CELLS_LOG) {
+		if (log_x >= log_y) {
+			log_x--;
+		} else {
+			log_y--;
 		}
-		if (y == yu) break;
 	}
 
-	return nullptr;
+	_vehicle_tile_grid_log_x = log_x;
+	_vehicle_tile_grid_log_y = log_y;
+	_vehicle_tile_grid_y_shift = MapLogX() - log_x;
+	_vehicle_tile_grid_x_mask = (1 << log_x) - 1;
+	_vehicle_tile_grid_y_mask = ((1 << log_y) - 1) << log_x;
+	_vehicle_tile_grid_map_log_x = MapLogX();
+	_vehicle_tile_grid_map_log_y = MapLogY();
+
+	const size_t cells = (size_t)1 << (log_x + log_y);
+	std::vector<std::vector<VehicleTileGridEntry>> grid(cells);
+	_vehicle_tile_grid.swap(grid);
+	_vehicle_tile_grid_occupied.assign(CeilDivT<size_t>(cells, 64), 0);
 }
 
+/**
+ * Get the index of the vehicle tile grid cell of a tile.
+ * @param tile The tile, this may be outside the map (e.g. for disaster vehicles).
+ * @return The cell index.
+ */
+static inline uint GetVehicleTileGridCell(TileIndex tile)
+{
+	return (tile & _vehicle_tile_grid_x_mask) | ((tile >> _vehicle_tile_grid_y_shift) & _vehicle_tile_grid_y_mask);
+}
+
+/**
+ * Check whether a cell of the vehicle tile grid contains any vehicles.
+ * @param cell The cell index.
+ * @return True if the cell is not empty.
+ */
+static inline bool IsVehicleTileGridCellOccupied(uint cell)
+{
+	return HasBit(_vehicle_tile_grid_occupied[cell / 64], cell % 64);
+}
+
+/**
+ * Helper function for FindVehicleOnPos/HasVehicleOnPos.
+ * @note Do not call this function directly!
+ * @param tile The location on the map
+ * @param type The type of vehicles to consider, or VEH_INVALID for all types.
+ * @param data Arbitrary data passed to \a proc.
+ * @param proc The proc that determines whether a vehicle will be "found".
+ * @param find_first Whether to return on the first found or iterate over
+ *                   all vehicles
+ * @return the best matching or first vehicle (depending on find_first).
+ */
+static Vehicle *VehicleFromPos(TileIndex tile, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first)
+{
+	const uint cell_index = GetVehicleTileGridCell(tile);
+	if (!IsVehicleTileGridCellOccupied(cell_index)) return nullptr;
+
+	const std::vector<VehicleTileGridEntry> &cell = _vehicle_tile_grid[cell_index];
+
+	/* Index based, and bounded by the initial size, as proc may add vehicles, such as effect vehicles. */
+	const size_t count = cell.size();
+	for (size_t i = 0; i < count; i++) {
+		const VehicleTileGridEntry &entry = cell[i];
+		if (entry.tile != tile) continue;
+		if (type != VEH_INVALID && entry.type != type) continue;
+
+		Vehicle *a = proc(entry.v, data);
+		if (find_first && a != nullptr) return a;
+	}
+
+	return nullptr;
+}
 
 /**
  * Helper function for FindVehicleOnPos/HasVehicleOnPos.
  * @note Do not call this function directly!
  * @param x    The X location on the map
  * @param y    The Y location on the map
+ * @param type The type of vehicles to consider, or VEH_INVALID for all types.
  * @param data Arbitrary data passed to proc
  * @param proc The proc that determines whether a vehicle will be "found".
  * @param find_first Whether to return on the first found or iterate over
  *                   all vehicles
  * @return the best matching or first vehicle (depending on find_first).
  */
-static Vehicle *VehicleFromPosXY(int x, int y, void *data, VehicleFromPosProc *proc, bool find_first)
+static Vehicle *VehicleFromPosXY(int x, int y, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first)
 {
 	const int COLL_DIST = 6;
 
-	/* Hash area to scan is from xl,yl to xu,yu */
-	int xl = GB((x - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int xu = GB((x + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int yl = GB((y - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
-	int yu = GB((y + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
+	/* Tile area to scan is from xl,yl to xu,yu, this is much smaller than the grid, so each tile is in a different cell */
+	uint xl = Clamp((x - COLL_DIST) / (int)TILE_SIZE, 0, MapMaxX());
+	uint xu = Clamp((x + COLL_DIST) / (int)TILE_SIZE, 0, MapMaxX());
+	uint yl = Clamp((y - COLL_DIST) / (int)TILE_SIZE, 0, MapMaxY());
+	uint yu = Clamp((y + COLL_DIST) / (int)TILE_SIZE, 0, MapMaxY());
+
+	for (uint ty = yl; ty <= yu; ty++) {
+		for (uint tx = xl; tx <= xu; tx++) {
+			Vehicle *a = VehicleFromPos(TileXY(tx, ty), type, data, proc, find_first);
+			if (find_first && a != nullptr) return a;
+		}
+	}
 
-	return VehicleFromTileHash(xl, yl, xu, yu, data, proc, find_first);
+	return nullptr;
 }
 
 /**
@@ -516,12 +606,13 @@ static Vehicle *VehicleFromPosXY(int x, int y, void *data, VehicleFromPosProc *p
  *       should be iterated over.
  * @param x    The X location on the map
  * @param y    The Y location on the map
+ * @param type The type of vehicles to consider, or VEH_INVALID for all types.
  * @param data Arbitrary data passed to proc
  * @param proc The proc that determines whether a vehicle will be "found".
  */
-void FindVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
+void FindVehicleOnPosXY(int x, int y, VehicleType type, void *data, VehicleFromPosProc *proc)
 {
-	VehicleFromPosXY(x, y, data, proc, false);
+	VehicleFromPosXY(x, y, type, data, proc, false);
 }
 
 /**
@@ -531,39 +622,14 @@ void FindVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
  *       should be iterated over.
  * @param x    The X location on the map
  * @param y    The Y location on the map
+ * @param type The type of vehicles to consider, or VEH_INVALID for all types.
  * @param data Arbitrary data passed to proc
  * @param proc The proc that determines whether a vehicle will be "found".
  * @return True if proc returned non-nullptr.
  */
-bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
-{
-	return VehicleFromPosXY(x, y, data, proc, true) != nullptr;
-}
-
-/**
- * Helper function for FindVehicleOnPos/HasVehicleOnPos.
- * @note Do not call this function directly!
- * @param tile The location on the map
- * @param data Arbitrary data passed to \a proc.
- * @param proc The proc that determines whether a vehicle will be "found".
- * @param find_first Whether to return on the first found or iterate over
- *                   all vehicles
- * @return the best matching or first vehicle (depending on find_first).
- */
-static Vehicle *VehicleFromPos(TileIndex tile, void *data, VehicleFromPosProc *proc, bool find_first)
+bool HasVehicleOnPosXY(int x, int y, VehicleType type, void *data, VehicleFromPosProc *proc)
 {
-	int x = GB(TileX(tile), HASH_RES, HASH_BITS);
-	int y = GB(TileY(tile), HASH_RES, HASH_BITS) << HASH_BITS;
-
-	Vehicle *v = _vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
-	for (; v != nullptr; v = v->hash_tile_next) {
-		if (v->tile != tile) continue;
-
-		Vehicle *a = proc(v, data);
-		if (find_first && a != nullptr) return a;
-	}
-
-	return nullptr;
+	return VehicleFromPosXY(x, y, type, data, proc, true) != nullptr;
 }
 
 /**
@@ -576,12 +642,13 @@ static Vehicle *VehicleFromPos(TileIndex tile, void *data, VehicleFromPosProc *p
  * @note Use this function when you have the intention that all vehicles
  *       should be iterated over.
  * @param tile The location on the map
+ * @param type The type of vehicles to consider, or VEH_INVALID for all types.
  * @param data Arbitrary data passed to \a proc.
  * @param proc The proc that determines whether a vehicle will be "found".
  */
-void FindVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc)
+void FindVehicleOnPos(TileIndex tile, VehicleType type, void *data, VehicleFromPosProc *proc)
 {
-	VehicleFromPos(tile, data, proc, false);
+	VehicleFromPos(tile, type, data, proc, false);
 }
 
 /**
@@ -590,13 +657,14 @@ void FindVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc)
  * @note Use #FindVehicleOnPos when you have the intention that all vehicles
  *       should be iterated over.
  * @param tile The location on the map
+ * @param type The type of vehicles to consider, or VEH_INVALID for all types.
  * @param data Arbitrary data passed to \a proc.
  * @param proc The \a proc that determines whether a vehicle will be "found".
  * @return True if proc returned non-nullptr.
  */
-bool HasVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc)
+bool HasVehicleOnPos(TileIndex tile, VehicleType type, void *data, VehicleFromPosProc *proc)
 {
-	return VehicleFromPos(tile, data, proc, true) != nullptr;
+	return VehicleFromPos(tile, type, data, proc, true) != nullptr;
 }
 
 /**
@@ -628,7 +696,7 @@ CommandCost EnsureNoVehicleOnGround(TileIndex tile)
 	 * error message only (which may be different for different machines).
 	 * Such a message does not affect MP synchronisation.
 	 */
-	Vehicle *v = VehicleFromPos(tile, &z, &EnsureNoVehicleProcZ, true);
+	Vehicle *v = VehicleFromPos(tile, VEH_INVALID, &z, &EnsureNoVehicleProcZ, true);
 	if (v != nullptr) return_cmd_error(STR_ERROR_TRAIN_IN_THE_WAY + v->type);
 	return CommandCost();
 }
@@ -643,7 +711,6 @@ static Vehicle *EnsureNoRoadVehicleProcZ(Vehicle *v, void *data)
 {
 	int z = *(int*)data;
 
-	if (v->type != VEH_ROAD) return nullptr;
 	if (v->z_pos > z) return nullptr;
 
 	return v;
@@ -662,7 +729,7 @@ CommandCost EnsureNoRoadVehicleOnGround(TileIndex tile)
 	 * error message only (which may be different for different machines).
 	 * Such a message does not affect MP synchronisation.
 	 */
-	Vehicle *v = VehicleFromPos(tile, &z, &EnsureNoRoadVehicleProcZ, true);
+	Vehicle *v = VehicleFromPos(tile, VEH_ROAD, &z, &EnsureNoRoadVehicleProcZ, true);
 	if (v != nullptr) return_cmd_error(STR_ERROR_ROAD_VEHICLE_IN_THE_WAY);
 	return CommandCost();
 }
@@ -706,10 +773,10 @@ CommandCost TunnelBridgeIsFree(TileIndex tile, TileIndex endtile, const Vehicle
 	data.v = ignore;
 	data.t = tile;
 	data.across_only = across_only;
-	Vehicle *v = VehicleFromPos(tile, &data, &GetVehicleTunnelBridgeProc, true);
+	Vehicle *v = VehicleFromPos(tile, VEH_INVALID, &data, &GetVehicleTunnelBridgeProc, true);
 	if (v == nullptr) {
 		data.t = endtile;
-		v = VehicleFromPos(endtile, &data, &GetVehicleTunnelBridgeProc, true);
+		v = VehicleFromPos(endtile, VEH_INVALID, &data, &GetVehicleTunnelBridgeProc, true);
 	}
 
 	if (v != nullptr) return_cmd_error(STR_ERROR_TRAIN_IN_THE_WAY + v->type);
@@ -720,8 +787,6 @@ static Vehicle *EnsureNoTrainOnTrackProc(Vehicle *v, void *data)
 {
 	TrackBits rail_bits = *(TrackBits *)data;
 
-	if (v->type != VEH_TRAIN) return nullptr;
-
 	Train *t = Train::From(v);
 	if (rail_bits & TRACK_BIT_WORMHOLE) {
 		if (t->track & TRACK_BIT_WORMHOLE) return v;
@@ -748,51 +813,62 @@ CommandCost EnsureNoTrainOnTrackBits(TileIndex tile, TrackBits track_bits)
 	 * error message only (which may be different for different machines).
 	 * Such a message does not affect MP synchronisation.
 	 */
-	Vehicle *v = VehicleFromPos(tile, &track_bits, &EnsureNoTrainOnTrackProc, true);
+	Vehicle *v = VehicleFromPos(tile, VEH_TRAIN, &track_bits, &EnsureNoTrainOnTrackProc, true);
 	if (v != nullptr) return_cmd_error(STR_ERROR_TRAIN_IN_THE_WAY + v->type);
 	return CommandCost();
 }
 
 static void UpdateVehicleTileHash(Vehicle *v, bool remove)
 {
-	Vehicle **old_hash = v->hash_tile_current;
-	Vehicle **new_hash;
-
-	if (remove || HasBit(v->subtype, GVSF_VIRTUAL)) {
-		new_hash = nullptr;
+	uint new_cell;
+	/* Effect vehicles do not have a meaningful tile, they are all at tile 0, so keep them out of the grid. */
+	if (remove || HasBit(v->subtype, GVSF_VIRTUAL) || v->type == VEH_EFFECT) {
+		new_cell = INVALID_VEHICLE_TILE_GRID_CELL;
 	} else {
-		int x = GB(TileX(v->tile), HASH_RES, HASH_BITS);
-		int y = GB(TileY(v->tile), HASH_RES, HASH_BITS) << HASH_BITS;
-		new_hash = &_vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
+		if (_vehicle_tile_grid_map_log_x != MapLogX() || _vehicle_tile_grid_map_log_y != MapLogY()) {
+			/* The map has been reallocated since the grid was made, the grid does not contain any vehicles. */
+			InitializeVehicleTileGrid();
+		}
+		new_cell = GetVehicleTileGridCell(v->tile);
 	}
 
-	if (old_hash == new_hash) return;
+	if (v->tile_grid_cell == new_cell) {
+		/* Still in the same cell, only update the tile */
+		if (new_cell != INVALID_VEHICLE_TILE_GRID_CELL) _vehicle_tile_grid[new_cell][v->tile_grid_slot].tile = v->tile;
+		return;
+	}
 
-	/* Remove from the old position in the hash table */
-	if (old_hash != nullptr) {
-		if (v->hash_tile_next != nullptr) v->hash_tile_next->hash_tile_prev = v->hash_tile_prev;
-		*v->hash_tile_prev = v->hash_tile_next;
+	/* Remove from the old cell, by moving the last entry of the cell into its place */
+	if (v->tile_grid_cell != INVALID_VEHICLE_TILE_GRID_CELL) {
+		std::vector<VehicleTileGridEntry> &cell = _vehicle_tile_grid[v->tile_grid_cell];
+		assert(cell[v->tile_grid_slot].v == v);
+		if (v->tile_grid_slot != cell.size() - 1) {
+			cell[v->tile_grid_slot] = cell.back();
+			cell[v->tile_grid_slot].v->tile_grid_slot = v->tile_grid_slot;
+		}
+		cell.pop_back();
+		if (cell.empty()) ClrBit(_vehicle_tile_grid_occupied[v->tile_grid_cell / 64], v->tile_grid_cell % 64);
 	}
 
-	/* Insert vehicle at beginning of the new position in the hash table */
-	if (new_hash != nullptr) {
-		v->hash_tile_next = *new_hash;
-		if (v->hash_tile_next != nullptr) v->hash_tile_next->hash_tile_prev = &v->hash_tile_next;
-		v->hash_tile_prev = new_hash;
-		*new_hash = v;
+	/* Append to the new cell */
+	if (new_cell != INVALID_VEHICLE_TILE_GRID_CELL) {
+		std::vector<VehicleTileGridEntry> &cell = _vehicle_tile_grid[new_cell];
+		v->tile_grid_slot = (uint)cell.size();
+		cell.push_back({ v, v->tile, v->type });
+		SetBit(_vehicle_tile_grid_occupied[new_cell / 64], new_cell % 64);
 	}
 
-	/* Remember current hash position */
-	v->hash_tile_current = new_hash;
+	/* Remember current cell */
+	v->tile_grid_cell = new_cell;
 }
 
 bool ValidateVehicleTileHash(const Vehicle *v)
 {
-	if (v->type == VEH_TRAIN && Train::From(v)->IsVirtual()) return v->hash_tile_current == nullptr;
+	if ((v->type == VEH_TRAIN && Train::From(v)->IsVirtual()) || v->type == VEH_EFFECT) return v->tile_grid_cell == INVALID_VEHICLE_TILE_GRID_CELL;
 
-	int x = GB(TileX(v->tile), HASH_RES, HASH_BITS);
-	int y = GB(TileY(v->tile), HASH_RES, HASH_BITS) << HASH_BITS;
-	return v->hash_tile_current == &_vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
+	if (v->tile_grid_cell != GetVehicleTileGridCell(v->tile)) return false;
+	const std::vector<VehicleTileGridEntry> &cell = _vehicle_tile_grid[v->tile_grid_cell];
+	return v->tile_grid_slot < cell.size() && cell[v->tile_grid_slot].v == v && cell[v->tile_grid_slot].tile == v->tile && cell[v->tile_grid_slot].type == v->type;
 }
 
 static Vehicle *_vehicle_viewport_hash[1 << (GEN_HASHX_BITS + GEN_HASHY_BITS)];
@@ -825,9 +901,142 @@ static void UpdateVehicleViewportHash(Vehicle *v, int x, int y)
 
 void ResetVehicleHash()
 {
-	for (Vehicle *v : Vehicle::Iterate()) { v->hash_tile_current = nullptr; }
+	for (Vehicle *v : Vehicle::Iterate()) { v->tile_grid_cell = INVALID_VEHICLE_TILE_GRID_CELL; }
 	memset(_vehicle_viewport_hash, 0, sizeof(_vehicle_viewport_hash));
-	memset(_vehicle_tile_hash, 0, sizeof(_vehicle_tile_hash));
+	InitializeVehicleTileGrid();
+}
+
+/** Callback for the vehicle lookup benchmark, counting the vehicles it is called for. */
+static Vehicle *CountVehicleLookupBenchmarkProc(Vehicle *v, void *data)
+{
+	(*(uint *)data)++;
+	return nullptr;
+}
+
+/**
+ * Benchmark the vehicle tile grid against the tile hash it replaced, for the vehicles of the current game.
+ * The tile hash (128 x 128 chains, hashed on the tile coordinates, including the effect vehicles) is rebuilt temporarily for the comparison.
+ * @param b Buffer to write to.
+ * @param last Last valid position in the buffer.
+ * @param iterations Number of queries of each kind.
+ */
+void DumpVehicleTileGridBenchmark(char *b, const char *last, uint iterations)
+{
+	const uint HASH_BITS = 7;
+	const uint HASH_MASK = (1 << HASH_BITS) - 1;
+	std::vector<Vehicle *> hash_head(1 << (HASH_BITS * 2), nullptr);
+	std::vector<Vehicle *> hash_next(Vehicle::GetPoolSize(), nullptr);
+	auto hash_index = [&](uint x, uint y) -> uint { return (x & HASH_MASK) | ((y & HASH_MASK) << HASH_BITS); };
+
+	std::vector<TileIndex> vehicle_tiles;
+	std::vector<std::pair<int, int>> vehicle_positions;
+	for (Vehicle *v : Vehicle::Iterate()) {
+		if (HasBit(v->subtype, GVSF_VIRTUAL)) continue;
+		Vehicle *&head = hash_head[hash_index(TileX(v->tile), TileY(v->tile))];
+		hash_next[v->index] = head;
+		head = v;
+		if (v->tile_grid_cell != INVALID_VEHICLE_TILE_GRID_CELL && v->tile < MapSize()) {
+			vehicle_tiles.push_back(v->tile);
+			vehicle_positions.push_back(std::make_pair(v->x_pos, v->y_pos));
+		}
+	}
+
+	uint non_empty_cells = 0;
+	size_t largest_cell = 0;
+	for (const auto &cell : _vehicle_tile_grid) {
+		if (!cell.empty()) non_empty_cells++;
+		largest_cell = max(largest_cell, cell.size());
+	}
+	b += seprintf(b, last, "Vehicle lookup benchmark, %u queries of each kind\n", iterations);
+	b += seprintf(b, last, "  grid: %u x %u cells, %u in use, largest: %u vehicles\n",
+			1 << _vehicle_tile_grid_log_x, 1 << _vehicle_tile_grid_log_y, non_empty_cells, (uint)largest_cell);
+
+	/* Call the callback through a pointer for the hash too, as the lookup functions do */
+	VehicleFromPosProc * volatile proc_ptr = &CountVehicleLookupBenchmarkProc;
+	VehicleFromPosProc *proc = proc_ptr;
+
+	/* Local generator, so that the game state is not affected */
+	uint32 seed = 0x9E3779B9;
+	auto next_random = [&]() -> uint32 {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		return seed;
+	};
+
+	auto report = [&](const char *name, std::chrono::steady_clock::duration hash_time, uint hash_found, std::chrono::steady_clock::duration grid_time, uint grid_found) {
+		b += seprintf(b, last, "  %-20s hash: %7.1f ns/query, grid: %7.1f ns/query, found: %u / %u%s\n", name,
+				std::chrono::duration<double, std::nano>(hash_time).count() / iterations,
+				std::chrono::duration<double, std::nano>(grid_time).count() / iterations,
+				hash_found, grid_found, hash_found == grid_found ? "" : " MISMATCH");
+	};
+
+	/* Tile queries, at random tiles, at tiles with vehicles, and at tiles with vehicles for a single type */
+	for (int kind = 0; kind < 3; kind++) {
+		if (kind > 0 && vehicle_tiles.empty()) break;
+
+		std::vector<TileIndex> tiles(iterations);
+		for (TileIndex &tile : tiles) {
+			tile = (kind == 0) ? (TileIndex)(next_random() & (MapSize() - 1)) : vehicle_tiles[next_random() % vehicle_tiles.size()];
+		}
+		const VehicleType type = (kind == 2) ? VEH_TRAIN : VEH_INVALID;
+
+		uint hash_found = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (TileIndex tile : tiles) {
+			for (Vehicle *v = hash_head[hash_index(TileX(tile), TileY(tile))]; v != nullptr; v = hash_next[v->index]) {
+				if (v->tile != tile || v->type == VEH_EFFECT) continue;
+				if (type != VEH_INVALID && v->type != type) continue;
+				proc(v, &hash_found);
+			}
+		}
+		auto hash_end = std::chrono::steady_clock::now();
+		uint grid_found = 0;
+		for (TileIndex tile : tiles) {
+			FindVehicleOnPos(tile, type, &grid_found, proc);
+		}
+		auto grid_end = std::chrono::steady_clock::now();
+
+		static const char * const names[] = { "tile (random)", "tile (vehicle)", "tile (vehicle, train)" };
+		report(names[kind], hash_end - start, hash_found, grid_end - hash_end, grid_found);
+	}
+
+	/* Position queries, around vehicles */
+	if (!vehicle_positions.empty()) {
+		const int COLL_DIST = 6;
+
+		std::vector<std::pair<int, int>> positions(iterations);
+		for (auto &pos : positions) {
+			pos = vehicle_positions[next_random() % vehicle_positions.size()];
+		}
+
+		uint hash_found = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (const auto &pos : positions) {
+			uint xl = Clamp((pos.first - COLL_DIST) / (int)TILE_SIZE, 0, MapMaxX());
+			uint xu = Clamp((pos.first + COLL_DIST) / (int)TILE_SIZE, 0, MapMaxX());
+			uint yl = Clamp((pos.second - COLL_DIST) / (int)TILE_SIZE, 0, MapMaxY());
+			uint yu = Clamp((pos.second + COLL_DIST) / (int)TILE_SIZE, 0, MapMaxY());
+			for (uint y = yl; y <= yu; y++) {
+				for (uint x = xl; x <= xu; x++) {
+					for (Vehicle *v = hash_head[hash_index(x, y)]; v != nullptr; v = hash_next[v->index]) {
+						/* The hash chains contain vehicles of other tiles, and effect vehicles, which the callbacks filter out */
+						if (v->type == VEH_EFFECT) continue;
+						if (TileX(v->tile) < xl || TileX(v->tile) > xu || TileY(v->tile) < yl || TileY(v->tile) > yu) continue;
+						proc(v, &hash_found);
+					}
+				}
+			}
+		}
+		auto hash_end = std::chrono::steady_clock::now();
+		uint grid_found = 0;
+		for (const auto &pos : positions) {
+			FindVehicleOnPosXY(pos.first, pos.second, &grid_found, proc);
+		}
+		auto grid_end = std::chrono::steady_clock::now();
+
+		report("position (vehicle)", hash_end - start, hash_found, grid_end - hash_end, grid_found);
+	}
 }
 
 void ResetVehicleColourMap()
@@ -1233,10 +1442,24 @@ void RebuildVehicleTickCaches()
 	_tick_caches_valid = true;
 }
 
-void ValidateVehicleTickCaches()
+/**
+ * Check the vehicle tick caches against freshly rebuilt ones.
+ * @param log Function to log mismatches to, or \c nullptr to trigger an assertion on a mismatch.
+ */
+void ValidateVehicleTickCaches(std::function<void(const char *)> log)
 {
 	if (!_tick_caches_valid) return;
 
+	/* The rebuilt caches are only compared, the tick order of the vehicles must not change. */
+	std::vector<Train *> old_tick_train_too_heavy_cache = _tick_train_too_heavy_cache;
+	std::vector<Train *> old_tick_train_front_cache = _tick_train_front_cache;
+	std::vector<RoadVehicle *> old_tick_road_veh_front_cache = _tick_road_veh_front_cache;
+	std::vector<Aircraft *> old_tick_aircraft_front_cache = _tick_aircraft_front_cache;
+	std::vector<Ship *> old_tick_ship_cache = _tick_ship_cache;
+	btree::btree_set<VehicleID> old_tick_effect_veh_cache = _tick_effect_veh_cache;
+	std::vector<VehicleID> old_remove_from_tick_effect_veh_cache = _remove_from_tick_effect_veh_cache;
+	std::vector<Vehicle *> old_tick_other_veh_cache = _tick_other_veh_cache;
+
 	std::vector<Train *> saved_tick_train_too_heavy_cache = std::move(_tick_train_too_heavy_cache);
 	std::sort(saved_tick_train_too_heavy_cache.begin(), saved_tick_train_too_heavy_cache.end(), [&](const Vehicle *a, const Vehicle *b) {
 		return a->index < b->index;
@@ -1255,13 +1478,97 @@ void ValidateVehicleTickCaches()
 
 	RebuildVehicleTickCaches();
 
-	assert(saved_tick_train_too_heavy_cache == _tick_train_too_heavy_cache);
-	assert(saved_tick_train_front_cache == saved_tick_train_front_cache);
-	assert(saved_tick_road_veh_front_cache == _tick_road_veh_front_cache);
-	assert(saved_tick_aircraft_front_cache == _tick_aircraft_front_cache);
-	assert(saved_tick_ship_cache == _tick_ship_cache);
-	assert(saved_tick_effect_veh_cache == _tick_effect_veh_cache);
-	assert(saved_tick_other_veh_cache == _tick_other_veh_cache);
+	auto check = [&](bool ok, const char *name) {
+		if (ok) return;
+		char buffer[256];
+		seprintf(buffer, lastof(buffer), "Vehicle tick cache mismatch: %s", name);
+		if (log) {
+			DEBUG(desync, 0, "%s", buffer);
+			log(buffer);
+		} else {
+			assert_msg(false, "%s", buffer);
+		}
+	};
+	check(saved_tick_train_too_heavy_cache == _tick_train_too_heavy_cache, "train too heavy");
+	check(saved_tick_train_front_cache == _tick_train_front_cache, "train front");
+	check(saved_tick_road_veh_front_cache == _tick_road_veh_front_cache, "road vehicle front");
+	check(saved_tick_aircraft_front_cache == _tick_aircraft_front_cache, "aircraft front");
+	check(saved_tick_ship_cache == _tick_ship_cache, "ship");
+	check(saved_tick_effect_veh_cache == _tick_effect_veh_cache, "effect vehicle");
+	check(saved_tick_other_veh_cache == _tick_other_veh_cache, "other vehicle");
+
+	_tick_train_too_heavy_cache = std::move(old_tick_train_too_heavy_cache);
+	_tick_train_front_cache = std::move(old_tick_train_front_cache);
+	_tick_road_veh_front_cache = std::move(old_tick_road_veh_front_cache);
+	_tick_aircraft_front_cache = std::move(old_tick_aircraft_front_cache);
+	_tick_ship_cache = std::move(old_tick_ship_cache);
+	_tick_effect_veh_cache = std::move(old_tick_effect_veh_cache);
+	_remove_from_tick_effect_veh_cache = std::move(old_remove_from_tick_effect_veh_cache);
+	_tick_other_veh_cache = std::move(old_tick_other_veh_cache);
+}
+
+/**
+ * Whether a vehicle is in a tick cache which is sorted by vehicle index, like the rebuilt caches are.
+ * @param cache The tick cache.
+ * @param v The vehicle.
+ * @return True if the vehicle is in the cache.
+ */
+template <typename T>
+static bool IsInSortedVehicleTickCache(const std::vector<T *> &cache, const Vehicle *v)
+{
+	auto iter = std::lower_bound(cache.begin(), cache.end(), v->index, [](const T *a, VehicleID index) {
+		return a->index < index;
+	});
+	return iter != cache.end() && *iter == v;
+}
+
+/**
+ * Check whether the vehicles in a range of the vehicle pool are in the tick caches they belong in.
+ * Unlike the check of the caches as a whole, this does not find entries of vehicles which no longer exist.
+ * @param log Function to log mismatches to.
+ * @param first First index of the range.
+ * @param last Index after the range.
+ */
+void ValidateVehicleTickCaches(std::function<void(const char *)> log, size_t first, size_t last)
+{
+	if (!_tick_caches_valid) return;
+
+	auto check = [&](bool ok, const Vehicle *v, const char *name) {
+		if (ok) return;
+		char buffer[256];
+		seprintf(buffer, lastof(buffer), "Vehicle tick cache mismatch: %s, vehicle %u", name, v->index);
+		DEBUG(desync, 0, "%s", buffer);
+		log(buffer);
+	};
+	for (const Vehicle *v : Vehicle::Iterate(first)) {
+		if (v->index >= last) break;
+		switch (v->type) {
+			default:
+				check(std::find(_tick_other_veh_cache.begin(), _tick_other_veh_cache.end(), v) != _tick_other_veh_cache.end(), v, "other vehicle");
+				break;
+
+			case VEH_TRAIN:
+				check((std::find(_tick_train_too_heavy_cache.begin(), _tick_train_too_heavy_cache.end(), v) != _tick_train_too_heavy_cache.end()) == HasBit(Train::From(v)->flags, VRF_TOO_HEAVY), v, "train too heavy");
+				check(IsInSortedVehicleTickCache(_tick_train_front_cache, v) == (v->Previous() == nullptr), v, "train front");
+				break;
+
+			case VEH_ROAD:
+				check(IsInSortedVehicleTickCache(_tick_road_veh_front_cache, v) == (v->Previous() == nullptr), v, "road vehicle front");
+				break;
+
+			case VEH_AIRCRAFT:
+				check(IsInSortedVehicleTickCache(_tick_aircraft_front_cache, v) == (v->Previous() == nullptr), v, "aircraft front");
+				break;
+
+			case VEH_SHIP:
+				check(IsInSortedVehicleTickCache(_tick_ship_cache, v), v, "ship");
+				break;
+
+			case VEH_EFFECT:
+				check(_tick_effect_veh_cache.count(v->index) != 0 && std::find(_remove_from_tick_effect_veh_cache.begin(), _remove_from_tick_effect_veh_cache.end(), v->index) == _remove_from_tick_effect_veh_cache.end(), v, "effect vehicle");
+				break;
+		}
+	}
 }
 
 void VehicleTickCargoAging(Vehicle *v)
@@ -1304,10 +1611,14 @@ void CallVehicleTicks()
 	_vehicles_to_pay_repair.clear();
 	_vehicles_to_sell.clear();
 
-	if (_tick_skip_counter == 0) RunVehicleDayProc();
+	if (_tick_skip_counter == 0) {
+		TICK_PROFILE_SCOPE("VehicleDayProc");
+		RunVehicleDayProc();
+	}
 
 	{
 		PerformanceMeasurer framerate(PFE_GL_ECONOMY);
+		TICK_PROFILE_SCOPE("LoadUnloadStations");
 		Station *si_st = nullptr;
 		SCOPE_INFO_FMT([&si_st], "CallVehicleTicks: LoadUnloadStation: %s", scope_dumper().StationInfo(si_st));
 		for (Station *st : Station::Iterate()) {
@@ -1333,6 +1644,7 @@ void CallVehicleTicks()
 	}
 	{
 		PerformanceMeasurer framerate(PFE_GL_TRAINS);
+		TICK_PROFILE_SCOPE("TrainTicks");
 		for (Train *t :  _tick_train_too_heavy_cache) {
 			if (HasBit(t->flags, VRF_TOO_HEAVY)) {
 				if (t->owner == _local_company) {
@@ -1356,6 +1668,7 @@ void CallVehicleTicks()
 	}
 	{
 		PerformanceMeasurer framerate(PFE_GL_ROADVEHS);
+		TICK_PROFILE_SCOPE("RoadVehicleTicks");
 		for (RoadVehicle *front : _tick_road_veh_front_cache) {
 			v = front;
 			if (!front->RoadVehicle::Tick()) continue;
@@ -1368,6 +1681,7 @@ void CallVehicleTicks()
 	}
 	{
 		PerformanceMeasurer framerate(PFE_GL_AIRCRAFT);
+		TICK_PROFILE_SCOPE("AircraftTicks");
 		for (Aircraft *front : _tick_aircraft_front_cache) {
 			v = front;
 			if (!front->Aircraft::Tick()) continue;
@@ -1379,6 +1693,7 @@ void CallVehicleTicks()
 	}
 	{
 		PerformanceMeasurer framerate(PFE_GL_SHIPS);
+		TICK_PROFILE_SCOPE("ShipTicks");
 		for (Ship *s : _tick_ship_cache) {
 			v = s;
 			if (!s->Ship::Tick()) continue;
@@ -276,9 +276,8 @@ public:
 	Vehicle *hash_viewport_next;        ///< NOSAVE: Next vehicle in the visual location hash.
 	Vehicle **hash_viewport_prev;       ///< NOSAVE: Previous vehicle in the visual location hash.
 
-	Vehicle *hash_tile_next;            ///< NOSAVE: Next vehicle in the tile location hash.
-	Vehicle **hash_tile_prev;           ///< NOSAVE: Previous vehicle in the tile location hash.
-	Vehicle **hash_tile_current;        ///< NOSAVE: Cache of the current hash chain.
+	uint32 tile_grid_cell;              ///< NOSAVE: Cell of the tile location grid the vehicle is in, or INVALID_VEHICLE_TILE_GRID_CELL.
+	uint32 tile_grid_slot;              ///< NOSAVE: Index of the vehicle in its tile location grid cell.
 
 	byte breakdown_severity;            ///< severity of the breakdown. Note that lower means more severe
 	byte breakdown_type;                ///< Type of breakdown
@@ -1303,6 +1302,9 @@ struct FreeUnitIDGenerator {
 /** Sentinel for an invalid coordinate. */
 static const int32 INVALID_COORD = 0x7fffffff;
 
+/** Sentinel for a vehicle which is not in the vehicle tile grid. */
+static const uint32 INVALID_VEHICLE_TILE_GRID_CELL = UINT32_MAX;
+
 inline void InvalidateVehicleTickCaches()
 {
 	extern bool _tick_caches_valid;
@@ -40,10 +40,35 @@ typedef Vehicle *VehicleFromPosProc(Vehicle *v, void *data);
 
 void VehicleServiceInDepot(Vehicle *v);
 uint CountVehiclesInChain(const Vehicle *v);
-void FindVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc);
-void FindVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc);
-bool HasVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc);
-bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc);
+void FindVehicleOnPos(TileIndex tile, VehicleType type, void *data, VehicleFromPosProc *proc);
+void FindVehicleOnPosXY(int x, int y, VehicleType type, void *data, VehicleFromPosProc *proc);
+bool HasVehicleOnPos(TileIndex tile, VehicleType type, void *data, VehicleFromPosProc *proc);
+bool HasVehicleOnPosXY(int x, int y, VehicleType type, void *data, VehicleFromPosProc *proc);
+
+/** @copydoc FindVehicleOnPos(TileIndex, VehicleType, void *, VehicleFromPosProc *) */
+inline void FindVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc)
+{
+	FindVehicleOnPos(tile, VEH_INVALID, data, proc);
+}
+
+/** @copydoc FindVehicleOnPosXY(int, int, VehicleType, void *, VehicleFromPosProc *) */
+inline void FindVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
+{
+	FindVehicleOnPosXY(x, y, VEH_INVALID, data, proc);
+}
+
+/** @copydoc HasVehicleOnPos(TileIndex, VehicleType, void *, VehicleFromPosProc *) */
+inline bool HasVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc)
+{
+	return HasVehicleOnPos(tile, VEH_INVALID, data, proc);
+}
+
+/** @copydoc HasVehicleOnPosXY(int, int, VehicleType, void *, VehicleFromPosProc *) */
+inline bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
+{
+	return HasVehicleOnPosXY(x, y, VEH_INVALID, data, proc);
+}
+
 void CallVehicleTicks();
 uint8 CalcPercentVehicleFilled(const Vehicle *v, StringID *colour);
 uint8 CalcPercentVehicleFilledOfCargo(const Vehicle *v, CargoID cargo);
@@ -105,7 +105,12 @@
 #include "gui.h"
 #include "core/container_func.hpp"
 #include "tunnelbridge_map.h"
+#include "newgrf_debug.h"
+#include "spritecache.h"
+#include "worker_thread.h"
+#include "fontcache.h"
 
+#include <chrono>
 #include <map>
 #include <vector>
 #include <math.h>
@@ -213,6 +218,7 @@ struct ViewportDrawer {
 	ParentSpriteToDrawVector parent_sprites_to_draw;
 	ParentSpriteToSortVector parent_sprites_to_sort; ///< Parent sprite pointer array used for sorting
 	ChildScreenSpriteToDrawVector child_screen_sprites_to_draw;
+	std::vector<SpriteID> sprites_to_prefetch;       ///< Sprites to decode in the background, see #ViewportPrefetchSprites
 	TunnelBridgeToMapVector tunnel_to_map;
 	TunnelBridgeToMapVector bridge_to_map;
 
@@ -233,6 +239,8 @@ static void MarkRouteStepDirty(const TileIndex tile, uint order_nr);
 static DrawPixelInfo _dpi_for_text;
 static ViewportDrawer _vd;
 
+static const int VIEWPORT_DRAW_STRIPE_MIN_HEIGHT = 64; ///< Minimum height in pixels of the stripes of a viewport which are drawn concurrently.
+
 static std::vector<ViewPort *> _viewport_window_cache;
 
 RouteStepsMap _vp_route_steps;
@@ -1611,6 +1619,26 @@ void ViewportSign::MarkDirty(ZoomLevel maxzoom) const
 	}
 }
 
+/**
+ * Start decoding the tile and child sprites that are about to be drawn on the worker threads.
+ * The parent sprites are in the sprite cache already, as their extents were needed to sort them.
+ */
+static void ViewportPrefetchSprites()
+{
+	if (!_settings_client.gui.background_sprite_decode) return;
+
+	/* Drawing starts with the tile sprites and ends with the child sprites, so the worker threads
+	 * start at the end and meet the main thread somewhere halfway. */
+	_vd.sprites_to_prefetch.clear();
+	for (auto it = _vd.child_screen_sprites_to_draw.rbegin(); it != _vd.child_screen_sprites_to_draw.rend(); ++it) {
+		_vd.sprites_to_prefetch.push_back(it->image & SPRITE_MASK);
+	}
+	for (auto it = _vd.tile_sprites_to_draw.rbegin(); it != _vd.tile_sprites_to_draw.rend(); ++it) {
+		_vd.sprites_to_prefetch.push_back(it->image & SPRITE_MASK);
+	}
+	PrefetchSprites(_vd.sprites_to_prefetch.data(), _vd.sprites_to_prefetch.size());
+}
+
 static void ViewportDrawTileSprites(const TileSpriteToDrawVector *tstdv)
 {
 	for (const TileSpriteToDraw &ts : *tstdv) {
@@ -1696,6 +1724,84 @@ static void ViewportDrawParentSprites(const ParentSpriteToSortVector *psd, const
 	}
 }
 
+/**
+ * Load a sprite to draw, and its recolour sprite, into the sprite cache.
+ * @param image Sprite to draw.
+ * @param pal Palette of the sprite.
+ * @return False if the sprite or its recolour sprite does not exist or has the wrong type, i.e.\ drawing it would report a problem.
+ */
+static bool ViewportLoadSprite(SpriteID image, PaletteID pal)
+{
+	const SpriteID real_sprite = GB(image, 0, SPRITE_WIDTH);
+	if (!SpriteExists(real_sprite) || GetSpriteType(real_sprite) != ST_NORMAL) return false;
+	GetSprite(real_sprite, ST_NORMAL);
+
+	if (HasBit(image, PALETTE_MODIFIER_TRANSPARENT) || (pal != PAL_NONE && !HasBit(pal, PALETTE_TEXT_RECOLOUR))) {
+		const SpriteID remap = GB(pal, 0, PALETTE_WIDTH);
+		if (!SpriteExists(remap) || GetSpriteType(remap) != ST_RECOLOUR) return false;
+		GetNonSprite(remap, ST_RECOLOUR);
+	}
+	return true;
+}
+
+/**
+ * Load all sprites of #_vd which are about to be drawn into the sprite cache.
+ * The sprite cache only evicts sprites in #UpdateSpriteCache, so afterwards the sprites can be drawn without modifying the sprite cache.
+ * @return False if any of the sprites cannot be drawn without reporting a problem.
+ */
+static bool ViewportLoadSprites()
+{
+	for (const TileSpriteToDraw &ts : _vd.tile_sprites_to_draw) {
+		if (!ViewportLoadSprite(ts.image, ts.pal)) return false;
+	}
+	for (const ParentSpriteToDraw &ps : _vd.parent_sprites_to_draw) {
+		if (ps.image != SPR_EMPTY_BOUNDING_BOX && !ViewportLoadSprite(ps.image, ps.pal)) return false;
+	}
+	for (const ChildScreenSpriteToDraw &cs : _vd.child_screen_sprites_to_draw) {
+		if (!ViewportLoadSprite(cs.image, cs.pal)) return false;
+	}
+	return true;
+}
+
+/**
+ * Draw the ground sprites, and the sorted parent sprites with their child sprites, of #_vd.
+ * If enabled, the area is split into horizontal stripes which are drawn concurrently on the worker threads.
+ * Every stripe draws all sprites clipped to its own lines, so the result is the same as drawing the sprites in one go.
+ */
+static void ViewportDrawSprites()
+{
+	const int height = UnScaleByZoom(_vd.dpi.height, _vd.dpi.zoom);
+	uint stripes = 1;
+	if (_settings_client.gui.parallel_viewport_draw && _newgrf_debug_sprite_picker.mode != SPM_REDRAW) {
+		stripes = min<uint>(_general_worker_pool.GetWorkerCount() + 1, height / VIEWPORT_DRAW_STRIPE_MIN_HEIGHT);
+	}
+
+	if (stripes <= 1 || !ViewportLoadSprites()) {
+		if (_vd.tile_sprites_to_draw.size() != 0) ViewportDrawTileSprites(&_vd.tile_sprites_to_draw);
+		ViewportDrawParentSprites(&_vd.parent_sprites_to_sort, &_vd.child_screen_sprites_to_draw);
+		return;
+	}
+
+	Blitter *blitter = BlitterFactory::GetCurrentBlitter();
+	_general_worker_pool.ParallelFor(stripes, 1, [&](size_t begin, size_t end) {
+		DrawPixelInfo *old_dpi = _cur_dpi;
+		for (size_t i = begin; i < end; i++) {
+			const int top = (int)(height * i / stripes);
+			const int bottom = (int)(height * (i + 1) / stripes);
+
+			DrawPixelInfo dpi = _vd.dpi;
+			dpi.top += ScaleByZoom(top, dpi.zoom);
+			dpi.height = ScaleByZoom(bottom - top, dpi.zoom);
+			dpi.dst_ptr = blitter->MoveTo(_vd.dpi.dst_ptr, 0, top);
+			_cur_dpi = &dpi;
+
+			ViewportDrawTileSprites(&_vd.tile_sprites_to_draw);
+			ViewportDrawParentSprites(&_vd.parent_sprites_to_sort, &_vd.child_screen_sprites_to_draw);
+		}
+		_cur_dpi = old_dpi;
+	});
+}
+
 /**
  * Draws the bounding boxes of all ParentSprites
  * @param psd Array of ParentSprites
@@ -2695,14 +2801,14 @@ void ViewportDoDraw(const ViewPort *vp, int left, int top, int right, int bottom
 
 		DrawTextEffects(&_vd.dpi);
 
-		if (_vd.tile_sprites_to_draw.size() != 0) ViewportDrawTileSprites(&_vd.tile_sprites_to_draw);
+		ViewportPrefetchSprites();
 
 		for (auto &psd : _vd.parent_sprites_to_draw) {
 			_vd.parent_sprites_to_sort.push_back(&psd);
 		}
 
 		_vp_sprite_sorter(&_vd.parent_sprites_to_sort);
-		ViewportDrawParentSprites(&_vd.parent_sprites_to_sort, &_vd.child_screen_sprites_to_draw);
+		ViewportDrawSprites();
 
 		if (_draw_bounding_boxes) ViewportDrawBoundingBoxes(&_vd.parent_sprites_to_sort);
 	}
@@ -2803,6 +2909,98 @@ void Window::DrawViewport() const
 	dpi->top -= this->top;
 }
 
+/**
+ * Benchmark drawing a full HD viewport at the middle of the map with each usable blitter.
+ * The viewport is drawn into memory as it would be drawn to the screen, i.e. with the animation buffer of the blitter.
+ * Blitters are switched for this, so it is only possible when nothing is drawn to the screen, i.e. with the null video driver.
+ * @param b Buffer to write to.
+ * @param last Last valid position in the buffer.
+ * @param iterations Number of draws with each blitter and zoom level.
+ */
+void DumpBlitterBenchmark(char *b, const char *last, uint iterations)
+{
+	static const int WIDTH = 1920;
+	static const int HEIGHT = 1080;
+
+	if (BlitterFactory::GetCurrentBlitter()->GetScreenDepth() != 0) {
+		b += seprintf(b, last, "The blitter benchmark switches blitters, so it can only be run with the null video driver (-vnull)\n");
+		return;
+	}
+
+	const std::string old_blitter = BlitterFactory::GetCurrentBlitter()->GetName();
+	const DrawPixelInfo old_screen = _screen;
+	DrawPixelInfo *old_dpi = _cur_dpi;
+	const bool old_disable_anim = _screen_disable_anim;
+
+	std::vector<uint32> buffer(WIDTH * HEIGHT);
+	_screen.dst_ptr = buffer.data();
+	_screen.width = WIDTH;
+	_screen.height = HEIGHT;
+	_screen.pitch = WIDTH;
+	_screen_disable_anim = false;
+
+	DrawPixelInfo dpi;
+	dpi.dst_ptr = buffer.data();
+	dpi.left = 0;
+	dpi.top = 0;
+	dpi.width = WIDTH;
+	dpi.height = HEIGHT;
+	dpi.pitch = WIDTH;
+	dpi.zoom = ZOOM_LVL_NORMAL;
+	_cur_dpi = &dpi;
+
+	const uint cx = MapSizeX() / 2;
+	const uint cy = MapSizeY() / 2;
+	const Point centre = RemapCoords(cx * TILE_SIZE, cy * TILE_SIZE, TileHeight(TileXY(cx, cy)) * TILE_HEIGHT);
+	const ZoomLevel max_zoom = min(_settings_client.gui.zoom_max, ZOOM_LVL_VIEWPORT);
+
+	b += seprintf(b, last, "Blitter benchmark, %dx%d viewport at tile %u x %u, %u iteration(s)\n", WIDTH, HEIGHT, cx, cy, iterations);
+	for (const char *name : BlitterFactory::GetBlitterNames()) {
+		Blitter *blitter = BlitterFactory::SelectBlitter(name);
+		if (blitter == nullptr || blitter->GetScreenDepth() == 0) continue;
+
+		/* The cached sprites and glyphs are encoded for the previous blitter. */
+		GfxClearSpriteCache();
+		ClearFontCache();
+		blitter->PostResize();
+
+		b += seprintf(b, last, "  %-18s", blitter->GetName());
+		for (ZoomLevel zoom = _settings_client.gui.zoom_min; zoom <= max_zoom; zoom++) {
+			ViewPort vp;
+			vp.left = 0;
+			vp.top = 0;
+			vp.width = WIDTH;
+			vp.height = HEIGHT;
+			vp.zoom = zoom;
+			vp.virtual_width = ScaleByZoom(WIDTH, zoom);
+			vp.virtual_height = ScaleByZoom(HEIGHT, zoom);
+			vp.virtual_left = centre.x - vp.virtual_width / 2;
+			vp.virtual_top = centre.y - vp.virtual_height / 2;
+			vp.map_type = VPMT_BEGIN;
+			vp.overlay = nullptr;
+
+			/* The first draw loads and encodes the sprites. */
+			ViewportDrawChk(&vp, 0, 0, WIDTH, HEIGHT);
+
+			auto start = std::chrono::steady_clock::now();
+			for (uint i = 0; i < iterations; i++) ViewportDrawChk(&vp, 0, 0, WIDTH, HEIGHT);
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+			b += seprintf(b, last, " zoom %d: %8.3f ms (%6.1f Mpixel/s)", zoom, ms, WIDTH * HEIGHT / (ms * 1000.0));
+		}
+		b += seprintf(b, last, "\n");
+	}
+
+	BlitterFactory::SelectBlitter(old_blitter.c_str());
+	GfxClearSpriteCache();
+	ClearFontCache();
+
+	_screen = old_screen;
+	_cur_dpi = old_dpi;
+	_screen_disable_anim = old_disable_anim;
+	BlitterFactory::GetCurrentBlitter()->PostResize();
+}
+
 /**
  * Ensure that a given viewport has a valid scroll position.
  *
@@ -3050,6 +3248,9 @@ void ConstrainAllViewportsZoom()
  */
 void MarkTileDirtyByTile(TileIndex tile, const ZoomLevel mark_dirty_if_zoomlevel_is_below, int bridge_level_offset, int tile_height_override)
 {
+	/* Also changes which are not relevant in map mode, like the density of trees or fields, can change the smallmap colour. */
+	InvalidateSmallMapTileColour(tile);
+
 	Point pt = RemapCoords(TileX(tile) * TILE_SIZE, TileY(tile) * TILE_SIZE, tile_height_override * TILE_HEIGHT);
 	MarkAllViewportsDirty(
 			pt.x - 31  * ZOOM_LVL_BASE,
@@ -56,6 +56,11 @@ static void TileLoop_Void(TileIndex tile)
 	/* not used */
 }
 
+static TileLoopParallelResult TileLoopParallel_Void(TileIndex tile, uint32 random)
+{
+	return { TLPF_NONE, SND_BEGIN };
+}
+
 static void ChangeTileOwner_Void(TileIndex tile, Owner old_owner, Owner new_owner)
 {
 	/* not used */
@@ -81,6 +86,7 @@ extern const TileTypeProcs _tile_type_void_procs = {
 	nullptr,                     // click_tile_proc
 	nullptr,                     // animate_tile_proc
 	TileLoop_Void,            // tile_loop_proc
+	TileLoopParallel_Void,    // tile_loop_parallel_proc
 	ChangeTileOwner_Void,     // change_tile_owner_proc
 	nullptr,                     // add_produced_cargo_proc
 	nullptr,                     // vehicle_enter_tile_proc
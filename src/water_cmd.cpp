@@ -1272,6 +1272,40 @@ void TileLoop_Water(TileIndex tile)
 	}
 }
 
+/**
+ * Parallel variant of #TileLoop_Water for water tiles.
+ * It only determines whether there is anything to flood or dry up, the actual changes are left to the serial tile loop.
+ */
+static TileLoopParallelResult TileLoopParallel_Water(TileIndex tile, uint32 random)
+{
+	if (HasGrfMiscBit(GMB_AMBIENT_SOUND_CALLBACK)) return { TLPF_SERIAL, SND_BEGIN };
+
+	switch (GetFloodingBehaviour(tile)) {
+		case FLOOD_ACTIVE:
+			for (Direction dir = DIR_BEGIN; dir < DIR_END; dir++) {
+				TileIndex dest = tile + TileOffsByDir(dir);
+				if (!IsValidTile(dest)) continue;
+				if (IsTileType(dest, MP_WATER)) continue;
+
+				/* The ground of trees may be changed by the parallel tile loop of the tree tile, so do not look at it. */
+				if (IsTileType(dest, MP_TREES)) return { TLPF_SERIAL, SND_BEGIN };
+
+				int z_dest;
+				Slope slope_dest = GetFoundationSlope(dest, &z_dest) & ~SLOPE_HALFTILE_MASK & ~SLOPE_STEEP;
+				if (z_dest > 0) continue;
+
+				if (HasBit(_flood_from_dirs[slope_dest], ReverseDir(dir))) return { TLPF_SERIAL, SND_BEGIN };
+			}
+			return { TLPF_NONE, SND_BEGIN };
+
+		case FLOOD_DRYUP:
+			return { TLPF_SERIAL, SND_BEGIN };
+
+		default:
+			return { TLPF_NONE, SND_BEGIN };
+	}
+}
+
 void ConvertGroundTilesIntoWaterTiles()
 {
 	int z;
@@ -1406,6 +1440,7 @@ extern const TileTypeProcs _tile_type_water_procs = {
 	ClickTile_Water,          // click_tile_proc
 	nullptr,                     // animate_tile_proc
 	TileLoop_Water,           // tile_loop_proc
+	TileLoopParallel_Water,   // tile_loop_parallel_proc
 	ChangeTileOwner_Water,    // change_tile_owner_proc
 	nullptr,                     // add_produced_cargo_proc
 	VehicleEnter_Water,       // vehicle_enter_tile_proc
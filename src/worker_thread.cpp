@@ -0,0 +1,251 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_thread.cpp Pool of persistent worker threads. */
+
+#include "stdafx.h"
+#include "worker_thread.h"
+#include "settings_type.h"
+#include "thread.h"
+
+#include "safeguards.h"
+
+WorkerThreadPool _general_worker_pool;
+WorkerThreadPool _saveload_worker_pool;
+WorkStealingThreadPool _linkgraph_worker_pool;
+
+/**
+ * Start the worker threads of the pool.
+ * @param thread_name Name of the worker threads.
+ * @param max_workers Number of worker threads to start.
+ */
+void WorkerThreadPool::Start(const char *thread_name, uint max_workers)
+{
+	std::unique_lock<std::mutex> lk(this->lock);
+	assert(this->workers == 0);
+	this->exit = false;
+	for (uint i = 0; i < max_workers; i++) {
+		if (!StartNewThread(nullptr, thread_name, &WorkerThreadPool::Run, this)) break;
+		this->workers++;
+	}
+	if (this->workers > 0) DEBUG(misc, 1, "Started %u '%s' worker threads", this->workers, thread_name);
+}
+
+/**
+ * Stop the worker threads of the pool, once all pending jobs have been run.
+ */
+void WorkerThreadPool::Stop()
+{
+	std::unique_lock<std::mutex> lk(this->lock);
+	if (this->workers == 0) return;
+	this->exit = true;
+	this->empty_cv.notify_all();
+	this->done_cv.wait(lk, [this]() { return this->workers == 0; });
+}
+
+/**
+ * Add a job to the pool.
+ * If there are no worker threads, the job is run immediately on the calling thread.
+ * @param job Function to call.
+ * @param data1 First parameter of the function.
+ * @param data2 Second parameter of the function.
+ * @param data3 Third parameter of the function.
+ */
+void WorkerThreadPool::EnqueueJob(WorkerJobFunc *job, void *data1, void *data2, void *data3)
+{
+	std::unique_lock<std::mutex> lk(this->lock);
+	if (this->workers == 0) {
+		lk.unlock();
+		job(data1, data2, data3);
+		return;
+	}
+	bool notify = this->jobs.empty();
+	this->jobs.push_back({ job, data1, data2, data3 });
+	lk.unlock();
+	if (notify) this->empty_cv.notify_one();
+}
+
+/* static */ void WorkerThreadPool::Run(WorkerThreadPool *pool)
+{
+	std::unique_lock<std::mutex> lk(pool->lock);
+	while (!pool->exit || !pool->jobs.empty()) {
+		if (pool->jobs.empty()) {
+			pool->empty_cv.wait(lk);
+		} else {
+			WorkerJob job = pool->jobs.front();
+			pool->jobs.pop_front();
+			/* Wake up another worker if there is still more to do. */
+			if (!pool->jobs.empty()) pool->empty_cv.notify_one();
+			lk.unlock();
+			job.job(job.data1, job.data2, job.data3);
+			lk.lock();
+		}
+	}
+	pool->workers--;
+	if (pool->workers == 0) pool->done_cv.notify_all();
+}
+
+/**
+ * Get the number of worker threads of a pool in which the main thread also takes part, according to the worker_threads setting.
+ * @return Number of worker threads.
+ */
+static uint GetWorkerThreadCount()
+{
+	uint threads = _settings_client.gui.worker_threads;
+	if (threads == 0) {
+		/* Automatic: one worker for each hardware thread, except the one the main loop runs on. */
+		threads = std::thread::hardware_concurrency();
+		if (threads > 0) threads--;
+		threads = min<uint>(threads, 32);
+	} else {
+		/* The main thread also processes work, so it counts towards the requested thread total. */
+		threads--;
+	}
+	return threads;
+}
+
+/**
+ * Start the general purpose worker pool, sized according to the worker_threads setting.
+ */
+void StartGeneralWorkerPool()
+{
+	_general_worker_pool.Start("ottd:worker", GetWorkerThreadCount());
+}
+
+/**
+ * Start the worker pool (de)compressing savegame blocks, sized according to the worker_threads setting.
+ * It is separate from the general pool, so the blocks of a threaded autosave never queue ahead of the helpers of a ParallelFor of the game loop.
+ */
+void StartSaveLoadWorkerPool()
+{
+	_saveload_worker_pool.Start("ottd:saveload", GetWorkerThreadCount());
+}
+
+/* static */ thread_local WorkStealingThreadPool::WorkerInfo WorkStealingThreadPool::current_worker = { nullptr, 0 };
+
+/**
+ * Start the worker threads of the pool.
+ * @param thread_name Name of the worker threads.
+ * @param max_workers Number of worker threads to start.
+ */
+void WorkStealingThreadPool::Start(const char *thread_name, uint max_workers)
+{
+	std::unique_lock<std::mutex> lk(this->lock);
+	assert(this->threads == 0);
+	this->exit = false;
+	/* The queues must exist before any worker looks at them. If not all threads can be started,
+	 * the queues without a worker are emptied by the other workers. */
+	for (uint i = 0; i < max_workers; i++) this->queues.emplace_back(new WorkerQueue());
+	for (uint i = 0; i < max_workers; i++) {
+		if (!StartNewThread(nullptr, thread_name, &WorkStealingThreadPool::Run, this, (uint)i)) break;
+		this->workers++;
+	}
+	this->threads = this->workers;
+	if (this->threads > 0) {
+		DEBUG(misc, 1, "Started %u '%s' worker threads", this->threads, thread_name);
+	} else {
+		this->queues.clear();
+	}
+}
+
+/**
+ * Stop the worker threads of the pool, once all pending jobs have been run.
+ */
+void WorkStealingThreadPool::Stop()
+{
+	std::unique_lock<std::mutex> lk(this->lock);
+	if (this->threads == 0) return;
+	this->exit = true;
+	this->work_cv.notify_all();
+	this->done_cv.wait(lk, [this]() { return this->workers == 0; });
+	this->threads = 0;
+	this->queues.clear();
+}
+
+/**
+ * Add a job to the pool.
+ * If there are no worker threads, the job is run immediately on the calling thread.
+ * @param job Function to call.
+ * @param data1 First parameter of the function.
+ * @param data2 Second parameter of the function.
+ * @param data3 Third parameter of the function.
+ */
+void WorkStealingThreadPool::EnqueueJob(WorkerJobFunc *job, void *data1, void *data2, void *data3)
+{
+	if (this->threads == 0) {
+		job(data1, data2, data3);
+		return;
+	}
+
+	uint index = (current_worker.pool == this) ? current_worker.index : this->next_queue.fetch_add(1) % this->queues.size();
+	{
+		std::lock_guard<std::mutex> lk(this->queues[index]->lock);
+		this->queues[index]->jobs.push_back({ job, data1, data2, data3 });
+	}
+	{
+		std::lock_guard<std::mutex> lk(this->lock);
+		this->queued++;
+	}
+	this->work_cv.notify_one();
+}
+
+/**
+ * Take the next job for a worker, from its own queue or else from the queue of another worker.
+ * @param index Index of the worker.
+ * @param[out] job The job.
+ * @return Whether a job was found.
+ */
+bool WorkStealingThreadPool::PopJob(uint index, WorkerJob &job)
+{
+	const uint count = (uint)this->queues.size();
+	for (uint i = 0; i < count; i++) {
+		WorkerQueue *queue = this->queues[(index + i) % count].get();
+		std::lock_guard<std::mutex> lk(queue->lock);
+		if (queue->jobs.empty()) continue;
+		job = queue->jobs.front();
+		queue->jobs.pop_front();
+		this->queued--;
+		return true;
+	}
+	return false;
+}
+
+/* static */ void WorkStealingThreadPool::Run(WorkStealingThreadPool *pool, uint index)
+{
+	current_worker = { pool, index };
+	for (;;) {
+		WorkerJob job;
+		if (pool->PopJob(index, job)) {
+			job.job(job.data1, job.data2, job.data3);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lk(pool->lock);
+		if (pool->queued > 0) continue;
+		if (pool->exit) break;
+		pool->work_cv.wait(lk);
+	}
+
+	std::lock_guard<std::mutex> lk(pool->lock);
+	pool->workers--;
+	if (pool->workers == 0) pool->done_cv.notify_all();
+}
+
+/**
+ * Start the link graph worker pool, sized according to the linkgraph_threads setting.
+ * Unlike the general pool, the main thread does not take part, so at least one worker is started.
+ */
+void StartLinkGraphWorkerPool()
+{
+	uint threads = _settings_client.gui.linkgraph_threads;
+	if (threads == 0) {
+		/* Automatic: one worker for each hardware thread, except the one the main loop runs on. */
+		threads = std::thread::hardware_concurrency();
+		threads = Clamp<uint>(threads > 0 ? threads - 1 : 1, 1, 32);
+	}
+	_linkgraph_worker_pool.Start("ottd:linkgraph", threads);
+}
@@ -0,0 +1,266 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_thread.h Pool of persistent worker threads. */
+
+#ifndef WORKER_THREAD_H
+#define WORKER_THREAD_H
+
+#include "core/math_func.hpp"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <condition_variable>
+#if defined(__MINGW32__)
+#include "3rdparty/mingw-std-threads/mingw.mutex.h"
+#include "3rdparty/mingw-std-threads/mingw.condition_variable.h"
+#endif
+
+typedef void WorkerJobFunc(void *, void *, void *);
+
+/**
+ * Pool of persistent worker threads, jobs are run in FIFO order.
+ * All functions must be called from the main thread, except EnqueueJob and ParallelFor.
+ */
+class WorkerThreadPool {
+	struct WorkerJob {
+		WorkerJobFunc *job;
+		void *data1;
+		void *data2;
+		void *data3;
+	};
+
+	uint workers = 0;                  ///< Number of worker threads currently running
+	bool exit = false;                 ///< Whether the worker threads should exit once the job queue is empty
+	std::mutex lock;                   ///< Lock for all of the below
+	std::deque<WorkerJob> jobs;        ///< Pending jobs
+	std::condition_variable empty_cv;  ///< Signalled when a job is added, or when the threads should exit
+	std::condition_variable done_cv;   ///< Signalled when the last worker thread exits
+
+	static void Run(WorkerThreadPool *pool);
+
+public:
+	~WorkerThreadPool()
+	{
+		this->Stop();
+	}
+
+	void Start(const char *thread_name, uint max_workers);
+	void Stop();
+	void EnqueueJob(WorkerJobFunc *job, void *data1 = nullptr, void *data2 = nullptr, void *data3 = nullptr);
+
+	/**
+	 * Get the number of worker threads in the pool.
+	 * @return Number of worker threads, 0 if jobs are run synchronously.
+	 */
+	inline uint GetWorkerCount() const
+	{
+		return this->workers;
+	}
+
+	/**
+	 * Call \a func for each chunk of at most \a chunk_size items of the range [0, \a count).
+	 * Chunks are distributed between the calling thread and the worker threads, the call returns once all chunks have been processed.
+	 * The order in which chunks are processed is unspecified, \a func must therefore not depend on it.
+	 * @param count Number of items.
+	 * @param chunk_size Maximum number of items per chunk.
+	 * @param func Function to call, with the signature void(size_t begin, size_t end).
+	 */
+	template <typename F>
+	void ParallelFor(size_t count, size_t chunk_size, F func)
+	{
+		if (count == 0) return;
+		if (chunk_size == 0) chunk_size = 1;
+		const size_t chunks = CeilDivT<size_t>(count, chunk_size);
+		if (chunks == 1 || this->workers == 0) {
+			func(0, count);
+			return;
+		}
+
+		struct State {
+			F &func;
+			size_t count;
+			size_t chunk_size;
+			std::atomic<size_t> next;
+			uint pending;
+			std::mutex lock;
+			std::condition_variable done_cv;
+
+			State(F &func, size_t count, size_t chunk_size) : func(func), count(count), chunk_size(chunk_size), next(0), pending(0) {}
+
+			void RunChunks()
+			{
+				size_t begin;
+				while ((begin = this->next.fetch_add(this->chunk_size)) < this->count) {
+					this->func(begin, min(begin + this->chunk_size, this->count));
+				}
+			}
+		};
+		State state(func, count, chunk_size);
+
+		const uint helpers = (uint)min<size_t>(this->workers, chunks - 1);
+		state.pending = helpers;
+		for (uint i = 0; i < helpers; i++) {
+			this->EnqueueJob([](void *data, void *, void *) {
+				State *state = static_cast<State *>(data);
+				state->RunChunks();
+				std::lock_guard<std::mutex> lk(state->lock);
+				if (--state->pending == 0) state->done_cv.notify_one();
+			}, &state);
+		}
+		state.RunChunks();
+
+		std::unique_lock<std::mutex> lk(state.lock);
+		state.done_cv.wait(lk, [&]() { return state.pending == 0; });
+	}
+};
+
+/**
+ * Pool of persistent worker threads, each of which has its own job queue.
+ * Jobs added by a worker thread of the pool go to the queue of that worker, other jobs are distributed round-robin.
+ * Workers process their own queue first, and steal jobs from the queues of the other workers when it is empty.
+ * All functions must be called from the main thread, except EnqueueJob, GetQueueDepth and ParallelFor.
+ */
+class WorkStealingThreadPool {
+	struct WorkerJob {
+		WorkerJobFunc *job;
+		void *data1;
+		void *data2;
+		void *data3;
+	};
+
+	struct WorkerQueue {
+		std::mutex lock;             ///< Lock for the queue
+		std::deque<WorkerJob> jobs;  ///< Pending jobs of the worker
+	};
+
+	struct WorkerInfo {
+		WorkStealingThreadPool *pool;
+		uint index;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues; ///< Job queue of each worker thread
+	std::atomic<uint> next_queue;      ///< Queue to add the next job from outside the pool to
+	std::atomic<int> queued;           ///< Number of jobs in all queues
+	uint threads = 0;                  ///< Number of worker threads started, only changed while no jobs are running
+	uint workers = 0;                  ///< Number of worker threads currently running
+	bool exit = false;                 ///< Whether the worker threads should exit once all queues are empty
+	std::mutex lock;                   ///< Lock for the below, and for waiting for jobs
+	std::condition_variable work_cv;   ///< Signalled when a job is added, or when the threads should exit
+	std::condition_variable done_cv;   ///< Signalled when the last worker thread exits
+
+	static thread_local WorkerInfo current_worker;
+
+	bool PopJob(uint index, WorkerJob &job);
+	static void Run(WorkStealingThreadPool *pool, uint index);
+
+public:
+	WorkStealingThreadPool() : next_queue(0), queued(0) {}
+
+	~WorkStealingThreadPool()
+	{
+		this->Stop();
+	}
+
+	void Start(const char *thread_name, uint max_workers);
+	void Stop();
+	void EnqueueJob(WorkerJobFunc *job, void *data1 = nullptr, void *data2 = nullptr, void *data3 = nullptr);
+
+	/**
+	 * Get the number of worker threads in the pool.
+	 * @return Number of worker threads, 0 if jobs are run synchronously.
+	 */
+	inline uint GetWorkerCount() const
+	{
+		return this->threads;
+	}
+
+	/**
+	 * Get the number of jobs which are waiting to be run.
+	 * @return Number of queued jobs.
+	 */
+	inline uint GetQueueDepth() const
+	{
+		return (uint)max<int>(this->queued.load(std::memory_order_relaxed), 0);
+	}
+
+	/**
+	 * Call \a func for each chunk of at most \a chunk_size items of the range [0, \a count).
+	 * Chunks are processed by the calling thread, helped by any idle worker threads which steal the helper jobs.
+	 * The call returns once all chunks have been processed, without waiting for helper jobs which have not started yet.
+	 * The order in which chunks are processed is unspecified, \a func must therefore not depend on it.
+	 * @param count Number of items.
+	 * @param chunk_size Maximum number of items per chunk.
+	 * @param func Function to call, with the signature void(size_t begin, size_t end).
+	 */
+	template <typename F>
+	void ParallelFor(size_t count, size_t chunk_size, F func)
+	{
+		if (count == 0) return;
+		if (chunk_size == 0) chunk_size = 1;
+		const size_t chunks = CeilDivT<size_t>(count, chunk_size);
+		if (chunks == 1 || this->threads == 0) {
+			func(0, count);
+			return;
+		}
+
+		/* Helper jobs may start after the call has returned, so the state is shared with them. */
+		struct State {
+			F *func;
+			size_t count;
+			size_t chunk_size;
+			std::atomic<size_t> next;
+			uint active;
+			std::mutex lock;
+			std::condition_variable done_cv;
+
+			State(F *func, size_t count, size_t chunk_size) : func(func), count(count), chunk_size(chunk_size), next(0), active(0) {}
+
+			void RunChunks()
+			{
+				size_t begin;
+				while ((begin = this->next.fetch_add(this->chunk_size)) < this->count) {
+					(*this->func)(begin, min(begin + this->chunk_size, this->count));
+				}
+			}
+		};
+		std::shared_ptr<State> state = std::make_shared<State>(&func, count, chunk_size);
+
+		const uint helpers = (uint)min<size_t>(this->threads, chunks - 1);
+		for (uint i = 0; i < helpers; i++) {
+			this->EnqueueJob([](void *data, void *, void *) {
+				std::unique_ptr<std::shared_ptr<State>> holder(static_cast<std::shared_ptr<State> *>(data));
+				State *state = holder->get();
+				{
+					std::lock_guard<std::mutex> lk(state->lock);
+					if (state->next.load() >= state->count) return;
+					state->active++;
+				}
+				state->RunChunks();
+				std::lock_guard<std::mutex> lk(state->lock);
+				if (--state->active == 0) state->done_cv.notify_one();
+			}, new std::shared_ptr<State>(state));
+		}
+		state->RunChunks();
+
+		/* All chunks have been claimed, wait for the ones still being processed by helpers. */
+		std::unique_lock<std::mutex> lk(state->lock);
+		state->done_cv.wait(lk, [&]() { return state->active == 0; });
+	}
+};
+
+extern WorkerThreadPool _general_worker_pool;
+extern WorkerThreadPool _saveload_worker_pool;
+extern WorkStealingThreadPool _linkgraph_worker_pool;
+
+void StartGeneralWorkerPool();
+void StartSaveLoadWorkerPool();
+void StartLinkGraphWorkerPool();
+
+#endif /* WORKER_THREAD_H */